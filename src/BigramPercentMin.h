@@ -0,0 +1,54 @@
+/*
+**      SWISH++
+**      src/BigramPercentMin.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifdef WITH_WORD_POS
+
+#ifndef BigramPercentMin_H
+#define BigramPercentMin_H
+
+// local
+#include "conf_unsigned.h"
+#include "swishxx-config.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %BigramPercentMin is-a conf&lt;unsigned&gt; containing the minimum
+ * percentage of files both words of an adjacent pair must occur in for the
+ * pair to be indexed as a "bigram."  Zero means not to index bigrams at all.
+ *
+ * This is the same as index's \c -b command-line option.
+ */
+class BigramPercentMin : public conf<unsigned> {
+public:
+  BigramPercentMin() :
+    conf<unsigned>( "BigramPercentMin", BigramPercentMin_Default, 0, 100 ) { }
+  CONF_INT_ASSIGN_OPS( BigramPercentMin )
+};
+
+extern BigramPercentMin bigram_percent_min;
+
+#endif /* BigramPercentMin_H */
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* WITH_WORD_POS */
+/* vim:set et sw=2 ts=2: */
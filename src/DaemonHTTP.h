@@ -0,0 +1,48 @@
+/*
+**      SWISH++
+**      src/DaemonHTTP.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef DaemonHTTP_H
+#define DaemonHTTP_H
+
+// local
+#include "conf_bool.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %DaemonHTTP is-a conf&lt;bool&gt; containing the Boolean value
+ * indicating whether the search daemon also serves HTTP requests (see
+ * http_protocol.h).
+ *
+ * This is the same as search's \c -h command-line option.
+ */
+class DaemonHTTP : public conf<bool> {
+public:
+  DaemonHTTP() : conf<bool>( "DaemonHTTP", false ) { }
+  CONF_BOOL_ASSIGN_OPS( DaemonHTTP )
+};
+
+extern DaemonHTTP daemon_http;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* DaemonHTTP_H */
+/* vim:set et sw=2 ts=2: */
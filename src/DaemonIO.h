@@ -0,0 +1,51 @@
+/*
+**      SWISH++
+**      src/DaemonIO.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef DaemonIO_H
+#define DaemonIO_H
+
+// local
+#include "conf_enum.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %DaemonIO is-a conf_enum containing which event loop the search daemon
+ * uses for client I/O: "epoll" or "io_uring."  If io_uring can't be used,
+ * epoll is used instead.  (Where epoll isn't available, this is ignored.)
+ *
+ * This is the same as search's \c -I command-line option.
+ */
+class DaemonIO : public conf_enum {
+public:
+  DaemonIO() : conf_enum( "DaemonIO", legal_values_ ) { }
+  CONF_ENUM_ASSIGN_OPS( DaemonIO )
+
+private:
+  static char const *const legal_values_[];
+};
+
+extern DaemonIO daemon_io;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* DaemonIO_H */
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,51 @@
+/*
+**      SWISH++
+**      src/DaemonListeners.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef DaemonListeners_H
+#define DaemonListeners_H
+
+// local
+#include "config.h"
+#include "conf_unsigned.h"
+#include "swishxx-config.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %DaemonListeners is-a conf&lt;unsigned&gt; containing the number of
+ * threads the search daemon accepts connections on, each with its own event
+ * loop and pool of threads to service requests; 0 means one per CPU.
+ *
+ * This is the same as search's \c -A command-line option.
+ */
+class DaemonListeners : public conf<unsigned> {
+public:
+  DaemonListeners() :
+    conf<unsigned>( "DaemonListeners", DaemonListeners_Default, 0, 1024 ) { }
+  CONF_INT_ASSIGN_OPS( DaemonListeners )
+};
+
+extern DaemonListeners daemon_listeners;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* DaemonListeners_H */
+/* vim:set et sw=2 ts=2: */
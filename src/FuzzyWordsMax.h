@@ -0,0 +1,52 @@
+/*
+**      SWISH++
+**      src/FuzzyWordsMax.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef FuzzyWordsMax_H
+#define FuzzyWordsMax_H
+
+// local
+#include "config.h"
+#include "conf_unsigned.h"
+#include "swishxx-config.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %FuzzyWordsMax is-a conf_unsigned containing the maximum number of words
+ * a fuzzy word (word~N) can match: if more match, only those in the most
+ * files are used.
+ *
+ * This is the same as search's -z command-line option.
+ */
+class FuzzyWordsMax : public conf<unsigned> {
+public:
+  FuzzyWordsMax() : conf<unsigned>( "FuzzyWordsMax", FuzzyWordsMax_Default, 1 )
+  {
+  }
+  CONF_INT_ASSIGN_OPS( FuzzyWordsMax )
+};
+
+extern FuzzyWordsMax fuzzy_words_max;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* FuzzyWordsMax_H */
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,52 @@
+/*
+**      SWISH++
+**      src/HugePages.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef HugePages_H
+#define HugePages_H
+
+// local
+#include "conf_enum.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %HugePages is-a conf_enum containing whether the memory an index is mapped
+ * into is backed by (transparent) huge pages: "none"; "advise," the mapping of
+ * the index file is advised to use huge pages; or "copy," the index file is
+ * copied into anonymous memory that uses huge pages.
+ *
+ * This is the same as search's \c -g command-line option.
+ */
+class HugePages : public conf_enum {
+public:
+  HugePages() : conf_enum( "HugePages", legal_values_ ) { }
+  CONF_ENUM_ASSIGN_OPS( HugePages )
+
+private:
+  static char const *const legal_values_[];
+};
+
+extern HugePages huge_pages;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* HugePages_H */
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,52 @@
+/*
+**      SWISH++
+**      src/QueryEvaluator.h
+**
+**      Copyright (C) 1998-2015  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+
+#ifndef QueryEvaluator_H
+#define QueryEvaluator_H
+
+// local
+#include "conf_enum.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %QueryEvaluator is-a conf_enum containing how queries are evaluated:
+ * "node" evaluates each subquery in its entirety at a time; "cursor" evaluates
+ * the whole query a file at a time.  The results are the same either way.
+ *
+ * This is the same as search's \c -e command-line option.
+ */
+class QueryEvaluator : public conf_enum {
+public:
+  QueryEvaluator() : conf_enum( "QueryEvaluator", legal_values_ ) { }
+  CONF_ENUM_ASSIGN_OPS( QueryEvaluator )
+
+private:
+  static char const *const legal_values_[];
+};
+
+extern QueryEvaluator query_evaluator;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* QueryEvaluator_H */
+/* vim:set et sw=2 ts=2: */
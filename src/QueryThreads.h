@@ -0,0 +1,51 @@
+/*
+**      SWISH++
+**      src/QueryThreads.h
+**
+**      Copyright (C) 1998-2015  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef QueryThreads_H
+#define QueryThreads_H
+
+// local
+#include "config.h"
+#include "conf_unsigned.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %QueryThreads is-a conf&lt;unsigned&gt; containing the number of threads
+ * that parts of a single query (the indices searched, the branches of an
+ * "or," and the words a wildcard matches) are evaluated by in parallel; 0
+ * means a query is evaluated by only the thread that's servicing it.
+ *
+ * This is the same as search's \c -j command-line option.
+ */
+class QueryThreads : public conf<unsigned> {
+public:
+  QueryThreads() :
+    conf<unsigned>( "QueryThreads", QueryThreads_Default, 0, 256 ) { }
+  CONF_INT_ASSIGN_OPS( QueryThreads )
+};
+
+extern QueryThreads query_threads;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* QueryThreads_H */
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,50 @@
+/*
+**      SWISH++
+**      src/ReloadInterval.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef ReloadInterval_H
+#define ReloadInterval_H
+
+// local
+#include "config.h"
+#include "conf_unsigned.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %ReloadInterval is-a conf&lt;unsigned&gt; containing the number of seconds
+ * between checks of whether the index file(s) have been regenerated and so
+ * should be reloaded.
+ *
+ * This is the same as search's \c -H command-line option.
+ */
+class ReloadInterval : public conf<unsigned> {
+public:
+  ReloadInterval() :
+    conf<unsigned>( "ReloadInterval", ReloadInterval_Default ) { }
+  CONF_INT_ASSIGN_OPS( ReloadInterval )
+};
+
+extern ReloadInterval reload_interval;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* ReloadInterval_H */
+/* vim:set et sw=2 ts=2: */
@@ -26,6 +26,7 @@
 
 char const *const ResultsFormat::legal_values_[] = {
   "classic",
+  "json",
   "xml",
   nullptr
 };
@@ -29,7 +29,7 @@
 
 /**
  * A %ResultsFormat is-a conf_enum containing the search results format:
- * classic or XML.
+ * classic, JSON, or XML.
  *
  * This is the same as search's \c -F command-line option.
  */
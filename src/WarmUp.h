@@ -0,0 +1,52 @@
+/*
+**      SWISH++
+**      src/WarmUp.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef WarmUp_H
+#define WarmUp_H
+
+// local
+#include "conf_enum.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %WarmUp is-a conf_enum containing how much of the index to read into
+ * memory before searching: "none"; "tables," the offset tables of all the
+ * segments; "dictionary," the tables plus the words themselves and the
+ * stop-word, directory, file, and meta-name entries; or "all."
+ *
+ * This is the same as search's \c -W command-line option.
+ */
+class WarmUp : public conf_enum {
+public:
+  WarmUp() : conf_enum( "WarmUp", legal_values_ ) { }
+  CONF_ENUM_ASSIGN_OPS( WarmUp )
+
+private:
+  static char const *const legal_values_[];
+};
+
+extern WarmUp warm_up;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* WarmUp_H */
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,48 @@
+/*
+**      SWISH++
+**      src/WarmUpLock.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef WarmUpLock_H
+#define WarmUpLock_H
+
+// local
+#include "conf_bool.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %WarmUpLock is-a conf&lt;bool&gt; containing the Boolean value indicating
+ * whether to lock the part of the index read into memory by WarmUp so it
+ * won't be paged out.
+ *
+ * This is the same as search's \c -L command-line option.
+ */
+class WarmUpLock : public conf<bool> {
+public:
+  WarmUpLock() : conf<bool>( "WarmUpLock", false ) { }
+  CONF_BOOL_ASSIGN_OPS( WarmUpLock )
+};
+
+extern WarmUpLock warm_up_lock;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* WarmUpLock_H */
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,48 @@
+/*
+**      SWISH++
+**      src/WarmUpQueries.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef WarmUpQueries_H
+#define WarmUpQueries_H
+
+// local
+#include "conf_string.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %WarmUpQueries is-a conf&lt;string&gt; containing the name of a file of
+ * queries, one per line, to search for (discarding the results) after loading
+ * the index so the parts of it that are typically searched are in memory.
+ *
+ * This is the same as search's \c -Q command-line option.
+ */
+class WarmUpQueries : public conf<std::string> {
+public:
+  WarmUpQueries() : conf<std::string>( "WarmUpQueries" ) { }
+  CONF_STRING_ASSIGN_OPS( WarmUpQueries )
+};
+
+extern WarmUpQueries warm_up_queries;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* WarmUpQueries_H */
+/* vim:set et sw=2 ts=2: */
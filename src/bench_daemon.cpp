@@ -0,0 +1,392 @@
+/*
+**      SWISH++
+**      src/bench_daemon.cpp
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/*
+**      Benchmark for the search daemon's client I/O.  Usage:
+**
+**          bench_daemon [-b] [-c clients] [-k] [-m max] [-n queries]
+**                       [-q query] index_file
+**
+**      The search daemon (the "search" next to this program) is started on a
+**      Unix domain socket once for each event loop (epoll and io_uring).  Each
+**      client thread then connects, sends a query, and reads the results until
+**      the daemon closes the connection, over and over.  (With -k, each client
+**      instead connects once and sends its queries with -k, reading each one's
+**      results by their length.)  With -b, requests are sent via the binary
+**      protocol (asking for the same fields as the text results).  The
+**      throughput, the latencies, and how much CPU time the daemon used per
+**      query are printed.  The default query is cheap so that the I/O
+**      dominates.
+*/
+
+// local
+#include "binary_protocol.h"
+#include "config.h"
+
+// standard
+#include <algorithm>                    /* for min(), sort() */
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>                     /* for sockaddr_un */
+#include <sys/wait.h>                   /* for waitpid(2) */
+#include <thread>
+#include <unistd.h>                     /* for getopt(3), fork(2), etc */
+#include <vector>
+
+using namespace std;
+
+char const *me;
+static bool binary;                     // send binary requests?
+
+////////// local functions ////////////////////////////////////////////////////
+
+typedef vector<double> latency_list;    // in microseconds
+
+/**
+ * Connects to the daemon.
+ *
+ * @param socket_file The name of the daemon's socket file.
+ * @return Returns the socket's file descriptor or -1 on failure.
+ */
+static int connect_to( char const *socket_file ) {
+  int const fd = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+  struct sockaddr_un addr;
+  ::memset( &addr, 0, sizeof addr );
+  addr.sun_family = AF_UNIX;
+  ::strncpy( addr.sun_path, socket_file, sizeof( addr.sun_path ) - 1 );
+  if ( ::connect( fd, (struct sockaddr*)&addr, sizeof addr ) == -1 ) {
+    ::close( fd );
+    return -1;
+  }
+  return fd;
+}
+
+/**
+ * Gets the CPU time (user + system) a process has used.
+ *
+ * @param pid The process ID.
+ * @return Returns said time in clock ticks.
+ */
+static long cpu_ticks( pid_t pid ) {
+  ifstream stat( "/proc/" + to_string( pid ) + "/stat" );
+  string field;
+  //
+  // The command name (field 2) is in parentheses and may contain spaces, so
+  // skip past it first.
+  //
+  getline( stat, field, ')' );
+  for ( int i = 3; i <= 13; ++i )
+    stat >> field;
+  long utime = 0, stime = 0;
+  stat >> utime >> stime;
+  return utime + stime;
+}
+
+/**
+ * Reads the results of a request that kept the connection alive: a line
+ * containing their length followed by that many bytes (or, if binary, a
+ * response header followed by the number of bytes it says).
+ *
+ * @param fd The socket's file descriptor.
+ * @param buf A buffer to read into.
+ * @param buf_size The size of \a buf.
+ * @param buf_len The number of bytes in \a buf left over from the previous
+ * results; updated.
+ * @return Returns \c true only if the results were read.
+ */
+static bool read_framed( int fd, char *buf, size_t buf_size,
+                         size_t *buf_len ) {
+  char *newline = nullptr;
+  while ( binary ? *buf_len < Binary_Response_Header_Size :
+          !(newline = static_cast<char*>(
+            ::memchr( buf, '\n', *buf_len )
+          )) ) {
+    ssize_t const bytes_read =
+      ::recv( fd, buf + *buf_len, buf_size - *buf_len, 0 );
+    if ( bytes_read <= 0 )
+      return false;
+    *buf_len += bytes_read;
+  } // while
+  size_t length = binary ?
+    Binary_Response_Header_Size + binary_get32( buf + 4 ) :
+    ::strtoul( buf, nullptr, 10 ) + (newline + 1 - buf);
+  while ( *buf_len < length ) {
+    size_t const n = min( length - *buf_len, buf_size );
+    ssize_t const bytes_read = ::recv( fd, buf, n, 0 );
+    if ( bytes_read <= 0 )
+      return false;
+    length -= bytes_read;
+  } // while
+  *buf_len -= length;
+  ::memmove( buf, buf + length, *buf_len );
+  return true;
+}
+
+/**
+ * Sends queries to the daemon one after another over one connection kept
+ * alive.
+ *
+ * @param socket_file The name of the daemon's socket file.
+ * @param request The request.
+ * @param n The number of queries to send.
+ * @param latencies The latency of each query is appended to this.
+ * @param failures Incremented for each query that fails.
+ */
+static void client_kept_alive( char const *socket_file, string const &request,
+                               unsigned n, latency_list *latencies,
+                               atomic<unsigned> *failures ) {
+  char buf[ 65536 ];
+  size_t buf_len = 0;
+  int fd = -1;
+  while ( n-- > 0 ) {
+    auto const start = chrono::steady_clock::now();
+    if ( fd == -1 )
+      fd = connect_to( socket_file );
+    bool const ok = fd != -1 &&
+      ::send( fd, request.data(), request.size(), 0 ) ==
+        static_cast<ssize_t>( request.size() ) &&
+      read_framed( fd, buf, sizeof buf, &buf_len );
+    if ( !ok ) {
+      if ( fd != -1 )
+        ::close( fd );
+      fd = -1, buf_len = 0;
+      ++*failures;
+      continue;
+    }
+    chrono::duration<double,micro> const us =
+      chrono::steady_clock::now() - start;
+    latencies->push_back( us.count() );
+  } // while
+  if ( fd != -1 )
+    ::close( fd );
+}
+
+/**
+ * Sends queries to the daemon one after another.
+ *
+ * @param socket_file The name of the daemon's socket file.
+ * @param request The request.
+ * @param n The number of queries to send.
+ * @param latencies The latency of each query is appended to this.
+ * @param failures Incremented for each query that fails.
+ */
+static void client( char const *socket_file, string const &request,
+                    unsigned n, latency_list *latencies,
+                    atomic<unsigned> *failures ) {
+  char buf[ 65536 ];
+  while ( n-- > 0 ) {
+    auto const start = chrono::steady_clock::now();
+    int const fd = connect_to( socket_file );
+    bool ok = fd != -1 &&
+      ::send( fd, request.data(), request.size(), 0 ) ==
+        static_cast<ssize_t>( request.size() );
+    size_t total = 0;
+    while ( ok ) {
+      ssize_t const bytes_read = ::recv( fd, buf, sizeof buf, 0 );
+      if ( bytes_read <= 0 ) {
+        ok = !bytes_read && total;
+        break;
+      }
+      total += bytes_read;
+    } // while
+    if ( fd != -1 )
+      ::close( fd );
+    if ( !ok ) {
+      ++*failures;
+      continue;
+    }
+    chrono::duration<double,micro> const us =
+      chrono::steady_clock::now() - start;
+    latencies->push_back( us.count() );
+  } // while
+}
+
+/**
+ * Starts the daemon, runs the clients against it, prints the results, and
+ * stops the daemon.
+ *
+ * @param label The label to print.
+ * @param io The event loop for the daemon to use.
+ * @param search The path of the search executable.
+ * @param index_file The index to search.
+ * @param clients The number of concurrent clients.
+ * @param queries The total number of queries.
+ * @param request The request.
+ * @param keep_alive If \c true, keep each client's connection alive.
+ */
+static void bench( char const *label, char const *io, string const &search,
+                   char const *index_file, unsigned clients, unsigned queries,
+                   string const &request, bool keep_alive ) {
+  string const socket_file =
+    "/tmp/bench_daemon." + to_string( ::getpid() ) + ".socket";
+  //
+  // A thread that has just given back its results isn't idle yet, so allow
+  // more threads than clients lest requests be refused.
+  //
+  string const min_threads = to_string( clients );
+  string const max_threads = to_string( clients * 2 );
+
+  pid_t const pid = ::fork();
+  if ( pid == -1 ) {
+    cerr << me << ": fork() failed: " << ::strerror( errno ) << endl;
+    ::exit( 1 );
+  }
+  if ( !pid ) {
+    ::execl(
+      search.c_str(), "search", "-b", "unix", "-B", "-I", io,
+      "-i", index_file, "-u", socket_file.c_str(),
+      "-t", min_threads.c_str(), "-T", max_threads.c_str(), "-q", "4096",
+      static_cast<char*>( nullptr )
+    );
+    cerr << me << ": can not execute \"" << search << "\": "
+         << ::strerror( errno ) << endl;
+    ::_exit( 1 );
+  }
+
+  //
+  // Wait for the daemon to be ready.
+  //
+  for ( int tries = 0; ; ++tries ) {
+    int const fd = connect_to( socket_file.c_str() );
+    if ( fd != -1 ) {
+      ::close( fd );
+      break;
+    }
+    if ( tries == 100 || ::waitpid( pid, nullptr, WNOHANG ) == pid ) {
+      cerr << me << ": daemon did not start" << endl;
+      ::exit( 1 );
+    }
+    this_thread::sleep_for( chrono::milliseconds( 50 ) );
+  } // for
+
+  vector<latency_list> latencies( clients );
+  atomic<unsigned> failures( 0 );
+  vector<thread> threads_v;
+  long const cpu_start = cpu_ticks( pid );
+  auto const start = chrono::steady_clock::now();
+  for ( unsigned i = 0; i < clients; ++i )
+    threads_v.emplace_back(
+      keep_alive ? client_kept_alive : client, socket_file.c_str(), request,
+      queries / clients + (i < queries % clients), &latencies[i], &failures
+    );
+  for ( auto &t : threads_v )
+    t.join();
+  chrono::duration<double> const secs = chrono::steady_clock::now() - start;
+  long const cpu = cpu_ticks( pid ) - cpu_start;
+
+  ::kill( pid, SIGTERM );
+  ::waitpid( pid, nullptr, 0 );
+  ::unlink( socket_file.c_str() );
+
+  latency_list all;
+  for ( auto const &l : latencies )
+    all.insert( all.end(), l.begin(), l.end() );
+  if ( all.empty() ) {
+    cout << label << ": all queries failed\n";
+    return;
+  }
+  sort( all.begin(), all.end() );
+
+  cout.setf( ios::fixed );
+  cout.precision( 0 );
+  cout  << label << ": " << all.size() / secs.count() << " queries/s"
+        << ", p50 " << all[ all.size() / 2 ] << " us"
+        << ", p99 " << all[ all.size() * 99 / 100 ] << " us";
+  cout.precision( 1 );
+  cout  << ", daemon CPU "
+        << cpu * 1e6 / ::sysconf( _SC_CLK_TCK ) / all.size() << " us/query";
+  if ( failures )
+    cout << ", " << failures << " failed";
+  cout << '\n';
+}
+
+static void usage() {
+  cerr << "usage: " << me
+       << " [-b] [-c clients] [-k] [-m max] [-n queries] [-q query]"
+          " index_file\n";
+  ::exit( 1 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main( int argc, char *argv[] ) {
+  me = argv[0];
+  unsigned clients = 8;
+  bool keep_alive = false;
+  unsigned max_results = 1;
+  unsigned queries = 50000;
+  string query = "the";
+
+  for ( int opt; (opt = ::getopt( argc, argv, "bc:km:n:q:" )) != -1; ) {
+    switch ( opt ) {
+      case 'b': binary = true; break;
+      case 'c': clients = ::atoi( optarg ); break;
+      case 'k': keep_alive = true; break;
+      case 'm': max_results = ::atoi( optarg ); break;
+      case 'n': queries = ::atoi( optarg ); break;
+      case 'q': query = optarg; break;
+      default : usage();
+    } // switch
+  } // for
+  if ( optind + 1 != argc || !clients || !queries )
+    usage();
+  char const *const index_file = argv[ optind ];
+
+  string search( me );
+  string::size_type const slash = search.rfind( '/' );
+  search = (slash == string::npos ? "./" : search.substr( 0, slash + 1 ))
+         + "search";
+  string request;
+  if ( binary ) {
+    binary_put8( request, Binary_Magic );
+    binary_put8( request, Binary_Version );
+    binary_put16(
+      request, bf_path | bf_size | bf_title | (keep_alive ? bf_keep_alive : 0)
+    );
+    binary_put32( request, 0 );
+    binary_put32( request, max_results );
+    binary_put16( request, Binary_All_Indices );
+    binary_put16( request, static_cast<unsigned>( query.size() ) );
+    request += query;
+  } else {
+    request = string( "search " ) + (keep_alive ? "-k " : "") + "-m " +
+              to_string( max_results ) + ' ' + query + '\n';
+  }
+
+  cout << clients << " clients, " << queries << " queries"
+       << (binary ? ", binary" : "")
+       << (keep_alive ? ", connections kept alive" : "") << '\n';
+  bench( "epoll   ", "epoll", search, index_file, clients, queries, request,
+         keep_alive );
+  bench( "io_uring", "io_uring", search, index_file, clients, queries,
+         request, keep_alive );
+  return 0;
+}
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,288 @@
+/*
+**      SWISH++
+**      src/bench_dictionary.cpp
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/*
+**      Micro-benchmark for looking up words in an index's dictionary.  Usage:
+**
+**          bench_dictionary [-n lookups] index_file
+**
+**      Random words from the index are looked up (by binary search, as search
+**      does) and the first byte of each word's list of files is read (as
+**      search would next).  This is done with the index mapped: normally;
+**      with its mapping advised to use huge pages; and copied into anonymous
+**      memory that uses huge pages.  The entire index is read first so that
+**      only TLB misses, not page faults, differ between the three.  Where
+**      possible, the number of data TLB misses is also counted.
+*/
+
+// local
+#include "config.h"
+#include "index_segment.h"
+#include "pjl/less.h"
+#include "pjl/mmap_file.h"
+
+// standard
+#include <algorithm>                    /* for lower_bound() */
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unistd.h>                     /* for getopt(3) */
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif /* __linux__ */
+
+using namespace PJL;
+using namespace std;
+
+char const *me;
+static unsigned long volatile sink;     // defeats optimizing runs away
+
+////////// local functions ////////////////////////////////////////////////////
+
+typedef vector<string> word_list;
+
+/**
+ * A %tlb_counter counts the data TLB misses of the calling thread (in user
+ * space only) via perf_event_open(2), if possible.
+ */
+class tlb_counter {
+public:
+  tlb_counter() : fd_( -1 ) {
+#ifdef __linux__
+    perf_event_attr attr;
+    ::memset( &attr, 0, sizeof attr );
+    attr.size = sizeof attr;
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB
+                | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = ::syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 );
+#endif /* __linux__ */
+  }
+
+  ~tlb_counter() {
+    if ( fd_ != -1 )
+      ::close( fd_ );
+  }
+
+  explicit operator bool() const {
+    return fd_ != -1;
+  }
+
+  void start() {
+#ifdef __linux__
+    if ( fd_ != -1 ) {
+      ::ioctl( fd_, PERF_EVENT_IOC_RESET, 0 );
+      ::ioctl( fd_, PERF_EVENT_IOC_ENABLE, 0 );
+    }
+#endif /* __linux__ */
+  }
+
+  unsigned long long stop() {
+    unsigned long long count = 0;
+#ifdef __linux__
+    if ( fd_ != -1 ) {
+      ::ioctl( fd_, PERF_EVENT_IOC_DISABLE, 0 );
+      if ( ::read( fd_, &count, sizeof count ) != sizeof count )
+        count = 0;
+    }
+#endif /* __linux__ */
+    return count;
+  }
+
+private:
+  int fd_;
+};
+
+/**
+ * Gets how much of a mapping is backed by huge pages as reported by
+ * \c /proc/self/smaps.
+ *
+ * @param addr An address within the mapping.
+ * @return Returns said amount in kilobytes or -1 if unknown.
+ */
+static long huge_kb( void const *addr ) {
+  ifstream smaps( "/proc/self/smaps" );
+  if ( !smaps )
+    return -1;
+  auto const a = reinterpret_cast<unsigned long>( addr );
+  bool in_mapping = false;
+  long kb = 0;
+  for ( string line; getline( smaps, line ); ) {
+    unsigned long begin, end;
+    char dash;
+    istringstream iss( line );
+    if ( line.find( ':' ) > line.find( ' ' ) &&
+         iss >> hex >> begin >> dash >> end && dash == '-' ) {
+      if ( in_mapping )
+        break;                          // the next mapping
+      in_mapping = a >= begin && a < end;
+      continue;
+    }
+    if ( !in_mapping )
+      continue;
+    string key;
+    long value;
+    iss >> key >> dec >> value;
+    if ( key == "AnonHugePages:" || key == "FilePmdMapped:" )
+      kb += value;
+  } // for
+  return kb;
+}
+
+/**
+ * Looks up every word in the list in an index's dictionary.
+ *
+ * @param words The words to look up.
+ * @param segment The index's word segment.
+ */
+static void run( word_list const &words, index_segment const &segment ) {
+  unsigned long sum = 0;
+  for ( auto const &word : words ) {
+    auto const found = ::lower_bound(
+      segment.begin(), segment.end(), word.c_str(), less<char const*>()
+    );
+    if ( found != segment.end() ) {
+      char const *const entry = *found;
+      sum += entry[ ::strlen( entry ) + 1 ];  // first byte of its file list
+    }
+  } // for
+  sink = sum;
+}
+
+/**
+ * Times looking up every word in the list and prints the latency and,
+ * if possible, the number of TLB misses.
+ *
+ * @param label The label to print.
+ * @param path The full path of the index file.
+ * @param words The words to look up.
+ * @param huge If 0, don't use huge pages; if 1, advise the mapping to use
+ * them; if 2, copy the index into anonymous memory that uses them.
+ */
+static void bench( char const *label, char const *path,
+                   word_list const &words, int huge ) {
+  mmap_file file( path );
+  if ( !file ) {
+    cerr << me << ": can not map \"" << path << "\": "
+         << ::strerror( file.error() ) << endl;
+    ::exit( 1 );
+  }
+  if ( huge ) {
+    int const err = file.huge_pages( huge == 2 );
+    if ( err ) {
+      cout << label << ": " << ::strerror( err ) << '\n';
+      return;
+    }
+  }
+
+  //
+  // Read the entire index so only TLB misses differ.
+  //
+  unsigned long sum = 0;
+  auto const page_size = mmap_file::page_size();
+  for ( auto p = file.begin(); p < file.end(); p += page_size )
+    sum += *p;
+  sink = sum;
+
+  index_segment const segment( file, index_segment::isi_word );
+  tlb_counter tlb;
+  tlb.start();
+  auto const start = chrono::steady_clock::now();
+  run( words, segment );
+  chrono::duration<double> const secs = chrono::steady_clock::now() - start;
+  auto const misses = tlb.stop();
+
+  cout.setf( ios::fixed );
+  cout.precision( 1 );
+  cout  << label << ": " << secs.count() * 1e9 / words.size() << " ns/lookup";
+  if ( tlb )
+    cout << ", " << double( misses ) / words.size() << " dTLB misses/lookup";
+  long const kb = huge_kb( file.begin() );
+  if ( kb >= 0 )
+    cout << ", " << kb / 1024 << " of " << file.size() / (1024 * 1024)
+         << " MB in huge pages";
+  cout << '\n';
+}
+
+static void usage() {
+  cerr << "usage: " << me << " [-n lookups] index_file\n";
+  ::exit( 1 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main( int argc, char *argv[] ) {
+  me = argv[0];
+  unsigned lookups = 1000000;
+
+  for ( int opt; (opt = ::getopt( argc, argv, "n:" )) != -1; ) {
+    switch ( opt ) {
+      case 'n': lookups = ::atoi( optarg ); break;
+      default : usage();
+    } // switch
+  } // for
+  if ( optind + 1 != argc || !lookups )
+    usage();
+  char const *const path = argv[ optind ];
+
+  //
+  // Pick the words to look up at random (but repeatably) from the index.
+  //
+  word_list words;
+  {
+    mmap_file file( path );
+    if ( !file ) {
+      cerr << me << ": can not map \"" << path << "\": "
+           << ::strerror( file.error() ) << endl;
+      return 1;
+    }
+    index_segment const segment( file, index_segment::isi_word );
+    if ( !segment.size() ) {
+      cerr << me << ": \"" << path << "\": no words" << endl;
+      return 1;
+    }
+    mt19937 rng( 1 );
+    uniform_int_distribution<size_t> pick( 0, segment.size() - 1 );
+    words.reserve( lookups );
+    while ( words.size() < lookups )
+      words.push_back( segment[ pick( rng ) ] );
+    cout << segment.size() << " words, " << lookups << " lookups\n";
+  }
+
+  bench( "4K pages      ", path, words, 0 );
+  bench( "huge (advise) ", path, words, 1 );
+  bench( "huge (copy)   ", path, words, 2 );
+  return 0;
+}
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
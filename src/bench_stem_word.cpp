@@ -0,0 +1,392 @@
+/*
+**      SWISH++
+**      src/bench_stem_word.cpp
+**
+**      Copyright (C) 1998-2016  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/*
+**      Micro-benchmark for stem_word().  Usage:
+**
+**          bench_stem_word [-i iterations] [-t threads] file ...
+**
+**      The words in the given files are stemmed using: the original stemmer
+**      that compared every suffix of every rule in turn (kept here as a
+**      baseline); porter_stem(); and stem_word() (which adds the cache).  The
+**      results of the first two are also checked for being identical.
+*/
+
+// local
+#include "config.h"
+#include "stem_word.h"
+#include "word_util.h"
+
+// standard
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>                     /* for getopt(3) */
+#include <vector>
+#ifdef WITH_SEARCH_DAEMON
+#include <thread>
+#endif /* WITH_SEARCH_DAEMON */
+
+using namespace std;
+
+char const *me;
+static unsigned long volatile sink;     // defeats optimizing runs away
+
+////////// baseline stemmer ///////////////////////////////////////////////////
+
+namespace baseline {
+
+struct rule_list {
+  short           id;
+  char const     *old_suffix, *new_suffix;
+  unsigned short  old_suffix_len, new_suffix_len;
+  short           min_stem_size;
+  bool          (*condition)( char const*, char const* );
+};
+
+static int word_size( char const *word ) {
+  int size = 0;
+  enum state_type { st_initial, st_vowel, st_consonant };
+  state_type state = st_initial;
+  for ( ; *word; ++word ) {
+    switch ( state ) {
+      case st_initial:
+        state = is_vowel( *word ) ? st_vowel : st_consonant;
+        break;
+      case st_vowel:
+        state = is_vowel( *word ) ? st_vowel : st_consonant;
+        if ( state == st_consonant )
+          ++size;
+        break;
+      case st_consonant:
+        state = is_vowel( *word ) || *word == 'y' ? st_vowel : st_consonant;
+        break;
+    } // switch
+  } // for
+  return size;
+}
+
+static bool ends_with_cvc( char const *word, char const *word_end ) {
+  if ( word_end - word < 3 )
+    return false;
+  char const *c = word_end;
+  return !(is_vowel( *--c ) || *c == 'w' || *c == 'x' || *c == 'y' ) &&
+          (is_vowel( *--c ) || *c == 'y') && !is_vowel( *--c );
+}
+
+static bool add_e( char const *word, char const *word_end ) {
+  return word_size( word ) == 1 && ends_with_cvc( word, word_end );
+}
+
+static bool has_vowel( char const *word, char const* ) {
+  if ( !*word )
+    return false;
+  return is_vowel( *word ) || ::strpbrk( word + 1, "aeiouy" );
+}
+
+static bool remove_e( char const *word, char const *word_end ) {
+  return word_size( word ) == 1 && !ends_with_cvc( word, word_end );
+}
+
+static int replace_suffix( char *word, char *&word_end,
+                           rule_list const *rule ) {
+  for ( ; rule->id; ++rule ) {
+    char *const suffix = word_end - rule->old_suffix_len;
+    if ( suffix < word )
+      continue;
+    if ( ::strcmp( suffix, rule->old_suffix ) )
+      continue;
+    char const ch = *suffix;
+    *suffix = '\0';
+    if ( word_size( word ) > rule->min_stem_size &&
+       ( !rule->condition || (*rule->condition)( word, word_end ) ) ) {
+      ::strcpy( suffix, rule->new_suffix );
+      word_end = suffix + rule->new_suffix_len;
+      break;
+    }
+    *suffix = ch;
+  } // for
+  return rule->id;
+}
+
+static char const* stem_word( char const *word, char *buf ) {
+  static rule_list const rules_1a[] = {
+    { 101, "sses",    "ss",    4,  2,  -1, nullptr },
+    { 102, "ies",     "i",     3,  1,  -1, nullptr },
+    { 103, "ss",      "ss",    2,  2,  -1, nullptr },
+    { 104, "s",       "",      1,  0,  -1, nullptr },
+    { 0,   nullptr,   nullptr, 0,  0,   0, nullptr }
+  };
+  static rule_list const rules_1b[] = {
+    { 105, "eed",     "ee",    3,  2,  0, nullptr   },
+    { 106, "ed",      "",      2,  0, -1, has_vowel },
+    { 107, "ing",     "",      3,  0, -1, has_vowel },
+    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
+  };
+  static rule_list const rules_1b1[] = {
+    { 108, "at",      "ate",   2,  3, -1, nullptr   },
+    { 109, "bl",      "ble",   2,  3, -1, nullptr   },
+    { 110, "iz",      "ize",   2,  3, -1, nullptr   },
+    { 111, "bb",      "b",     2,  1, -1, nullptr   },
+    { 112, "dd",      "d",     2,  1, -1, nullptr   },
+    { 113, "ff",      "f",     2,  1, -1, nullptr   },
+    { 114, "gg",      "g",     2,  1, -1, nullptr   },
+    { 115, "mm",      "m",     2,  1, -1, nullptr   },
+    { 116, "nn",      "n",     2,  1, -1, nullptr   },
+    { 117, "pp",      "p",     2,  1, -1, nullptr   },
+    { 118, "rr",      "r",     2,  1, -1, nullptr   },
+    { 119, "tt",      "t",     2,  1, -1, nullptr   },
+    { 120, "ww",      "w",     2,  1, -1, nullptr   },
+    { 121, "xx",      "x",     2,  1, -1, nullptr   },
+    { 122, "",        "e",     0,  1, -1, add_e     },
+    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
+  };
+  static rule_list const rules_1c[] = {
+    { 123, "y",       "i",     1,  1, -1, has_vowel },
+    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
+  };
+  static rule_list const rules_2[] = {
+    { 201, "ational", "ate",   7,  3,  0, nullptr   },
+    { 202, "tional",  "tion",  6,  4,  0, nullptr   },
+    { 203, "enci",    "ence",  4,  4,  0, nullptr   },
+    { 204, "anci",    "ance",  4,  4,  0, nullptr   },
+    { 205, "izer",    "ize",   4,  3,  0, nullptr   },
+    { 206, "abli",    "able",  4,  4,  0, nullptr   },
+    { 207, "alli",    "al",    4,  2,  0, nullptr   },
+    { 208, "entli",   "ent",   5,  3,  0, nullptr   },
+    { 209, "eli",     "e",     3,  1,  0, nullptr   },
+    { 210, "ousli",   "ous",   5,  3,  0, nullptr   },
+    { 211, "ization", "ize",   7,  3,  0, nullptr   },
+    { 212, "ation",   "ate",   5,  3,  0, nullptr   },
+    { 213, "ator",    "ate",   4,  3,  0, nullptr   },
+    { 214, "alism",   "al",    5,  2,  0, nullptr   },
+    { 215, "iveness", "ive",   7,  3,  0, nullptr   },
+    { 216, "fulnes",  "ful",   6,  3,  0, nullptr   },
+    { 217, "ousness", "ous",   7,  3,  0, nullptr   },
+    { 218, "aliti",   "al",    5,  2,  0, nullptr   },
+    { 219, "iviti",   "ive",   5,  3,  0, nullptr   },
+    { 220, "biliti",  "ble",   6,  3,  0, nullptr   },
+    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
+  };
+  static rule_list const rules_3[] = {
+    { 301, "icate",   "ic",    5,  2,  0, nullptr   },
+    { 302, "ative",   "",      5,  0,  0, nullptr   },
+    { 303, "alize",   "al",    5,  2,  0, nullptr   },
+    { 304, "iciti",   "ic",    5,  2,  0, nullptr   },
+    { 305, "ical",    "ic",    4,  2,  0, nullptr   },
+    { 308, "ful",     "",      3,  0,  0, nullptr   },
+    { 309, "ness",    "",      4,  0,  0, nullptr   },
+    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
+  };
+  static rule_list const rules_4[] = {
+    { 401, "al",      "",      2,  0,  1, nullptr   },
+    { 402, "ance",    "",      4,  0,  1, nullptr   },
+    { 403, "ence",    "",      4,  0,  1, nullptr   },
+    { 405, "er",      "",      2,  0,  1, nullptr   },
+    { 406, "ic",      "",      2,  0,  1, nullptr   },
+    { 407, "able",    "",      4,  0,  1, nullptr   },
+    { 408, "ible",    "",      4,  0,  1, nullptr   },
+    { 409, "ant",     "",      3,  0,  1, nullptr   },
+    { 410, "ement",   "",      5,  0,  1, nullptr   },
+    { 411, "ment",    "",      4,  0,  1, nullptr   },
+    { 412, "ent",     "",      3,  0,  1, nullptr   },
+    { 413, "sion",    "s",     4,  1,  1, nullptr   },
+    { 414, "tion",    "t",     4,  1,  1, nullptr   },
+    { 415, "ou",      "",      2,  0,  1, nullptr   },
+    { 416, "ism",     "",      3,  0,  1, nullptr   },
+    { 417, "ate",     "",      3,  0,  1, nullptr   },
+    { 418, "iti",     "",      3,  0,  1, nullptr   },
+    { 419, "ous",     "",      3,  0,  1, nullptr   },
+    { 420, "ive",     "",      3,  0,  1, nullptr   },
+    { 421, "ize",     "",      3,  0,  1, nullptr   },
+    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
+  };
+  static rule_list const rules_5a[] = {
+    { 501, "e",       "",      1,  0,  1, nullptr   },
+    { 502, "e",       "",      1,  0, -1, remove_e  },
+    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
+  };
+  static rule_list const rules_5b[] = {
+    { 503, "ll",      "l",     2,  1,  1,  nullptr  },
+    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr  }
+  };
+
+  size_t const len = ::strlen( word );
+  if ( len > static_cast<size_t>( Word_Hard_Max_Size ) ||
+       ::strspn( word, "abcdefghijklmnopqrstuvwxyz" ) < len )
+    return word;
+
+  ::strcpy( buf, word );
+  char *word_end = buf + len;
+  replace_suffix( buf, word_end, rules_1a );
+  int const rule = replace_suffix( buf, word_end, rules_1b );
+  if ( rule == 106 || rule == 107 )
+    replace_suffix( buf, word_end, rules_1b1 );
+  replace_suffix( buf, word_end, rules_1c );
+  replace_suffix( buf, word_end, rules_2  );
+  replace_suffix( buf, word_end, rules_3  );
+  replace_suffix( buf, word_end, rules_4  );
+  replace_suffix( buf, word_end, rules_5a );
+  replace_suffix( buf, word_end, rules_5b );
+  return buf;
+}
+
+} // namespace baseline
+
+////////// local functions ////////////////////////////////////////////////////
+
+typedef char const* (*stem_func)( char const*, char* );
+typedef vector<string> word_list;
+
+/**
+ * Reads all the words in a file.  A word is a run of letters; it is converted
+ * to lower case.
+ *
+ * @param path The full path of the file to read.
+ * @param words The list to append the words to.
+ */
+static void read_words( char const *path, word_list &words ) {
+  ifstream in( path );
+  if ( !in ) {
+    cerr << me << ": can not open \"" << path << '"' << endl;
+    ::exit( 1 );
+  }
+  string word;
+  for ( char c; in.get( c ); ) {
+    if ( isalpha( c ) ) {
+      word += tolower( c );
+      continue;
+    }
+    if ( word.size() >= static_cast<size_t>( Word_Hard_Min_Size ) &&
+         word.size() <= static_cast<size_t>( Word_Hard_Max_Size ) )
+      words.push_back( word );
+    word.clear();
+  } // for
+}
+
+/**
+ * Stems every word in the list a given number of times.
+ *
+ * @param f The stemming function to use.
+ * @param words The words to stem.
+ * @param iterations The number of times to stem the entire list.
+ */
+static void run( stem_func f, word_list const &words,
+                          unsigned iterations ) {
+  unsigned long sum = 0;
+  char buf[ Stem_Buf_Size ];
+  while ( iterations-- > 0 )
+    for ( auto const &word : words )
+      sum += *f( word.c_str(), buf );
+  sink = sum;
+}
+
+/**
+ * Times stemming every word in the list and prints the throughput.
+ *
+ * @param label The label to print.
+ * @param f The stemming function to use.
+ * @param words The words to stem.
+ * @param iterations The number of times to stem the entire list.
+ * @param threads The number of threads to stem the list concurrently in.
+ */
+static void bench( char const *label, stem_func f, word_list const &words,
+                   unsigned iterations, unsigned threads ) {
+  auto const start = chrono::steady_clock::now();
+#ifdef WITH_SEARCH_DAEMON
+  vector<thread> pool;
+  for ( unsigned t = 1; t < threads; ++t )
+    pool.emplace_back( run, f, cref( words ), iterations );
+#else
+  threads = 1;
+#endif /* WITH_SEARCH_DAEMON */
+  run( f, words, iterations );
+#ifdef WITH_SEARCH_DAEMON
+  for ( auto &t : pool )
+    t.join();
+#endif /* WITH_SEARCH_DAEMON */
+  chrono::duration<double> const secs = chrono::steady_clock::now() - start;
+
+  double const stems = double( words.size() ) * iterations * threads;
+  cout.setf( ios::fixed );
+  cout.precision( 3 );
+  cout  << label << ": " << threads << " thread(s), " << secs.count()
+        << " s, " << stems / secs.count() / 1e6 << " M words/s\n";
+}
+
+static void usage() {
+  cerr << "usage: " << me << " [-i iterations] [-t threads] file ...\n";
+  ::exit( 1 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main( int argc, char *argv[] ) {
+  me = argv[0];
+  unsigned iterations = 20, threads = 1;
+
+  for ( int opt; (opt = ::getopt( argc, argv, "i:t:" )) != -1; ) {
+    switch ( opt ) {
+      case 'i': iterations = ::atoi( optarg ); break;
+      case 't': threads    = ::atoi( optarg ); break;
+      default : usage();
+    } // switch
+  } // for
+  if ( optind == argc || !iterations || !threads )
+    usage();
+
+  word_list words;
+  for ( ; optind < argc; ++optind )
+    read_words( argv[ optind ], words );
+  cout << words.size() << " words\n";
+
+  //
+  // Ensure the new stemmer gives the same results as the old one.
+  //
+  unsigned mismatches = 0;
+  for ( auto const &word : words ) {
+    char old_buf[ Stem_Buf_Size ], new_buf[ Stem_Buf_Size ];
+    char const *const old_stem = baseline::stem_word( word.c_str(), old_buf );
+    char const *const new_stem = stem_word( word.c_str(), new_buf );
+    if ( ::strcmp( old_stem, new_stem ) ) {
+      cerr  << me << ": \"" << word << "\": " << old_stem << " != "
+            << new_stem << endl;
+      ++mismatches;
+    }
+  } // for
+  if ( mismatches )
+    return 2;
+
+  bench( "baseline   ", baseline::stem_word, words, iterations, 1 );
+  bench( "porter_stem", porter_stem, words, iterations, 1 );
+  bench( "stem_word  ", stem_word, words, iterations, 1 );
+  if ( threads > 1 ) {
+    bench( "baseline   ", baseline::stem_word, words, iterations, threads );
+    bench( "porter_stem", porter_stem, words, iterations, threads );
+    bench( "stem_word  ", stem_word, words, iterations, threads );
+  }
+  return 0;
+}
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
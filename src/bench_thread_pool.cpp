@@ -0,0 +1,290 @@
+/*
+**      SWISH++
+**      src/bench_thread_pool.cpp
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/*
+**      Micro-benchmark for handing tasks to threads.  Usage:
+**
+**          bench_thread_pool [-n tasks] [-t threads] ...
+**
+**      For each number of threads (default: 1, 8, and 64):
+**
+**      1. That many producer threads push tasks through a queue to as many
+**         consumer threads via: a std::queue guarded by a mutex and a
+**         condition variable (as thread_pool's queue used to be, kept here as
+**         a baseline); and an mpmc_queue with an event_count (as thread_pool's
+**         queue is now).  The throughput is printed.
+**
+**      2. That many client threads each give a thread_pool of that many
+**         threads one task at a time via new_task() and wait for it to start.
+**         The handoff latency (from calling new_task() to the task starting)
+**         is printed.
+*/
+
+// local
+#include "config.h"
+#include "pjl/event_count.h"
+#include "pjl/mpmc_queue.h"
+#include "pjl/thread_pool.h"
+
+// standard
+#include <algorithm>                    /* for sort() */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unistd.h>                     /* for getopt(3), sysconf(3) */
+#include <vector>
+
+using namespace PJL;
+using namespace std;
+
+typedef chrono::steady_clock bench_clock;
+
+char const *me;
+
+////////// queues /////////////////////////////////////////////////////////////
+
+/**
+ * The baseline: a queue guarded by a mutex and a condition variable.
+ */
+class locked_queue {
+public:
+  void push( long value ) {
+    {
+      lock_guard<mutex> lock( mutex_ );
+      queue_.push( value );
+    }
+    not_empty_.notify_one();
+  }
+
+  long pop() {
+    unique_lock<mutex> lock( mutex_ );
+    not_empty_.wait( lock, [this]{ return !queue_.empty(); } );
+    long const value = queue_.front();
+    queue_.pop();
+    return value;
+  }
+
+private:
+  mutex               mutex_;
+  condition_variable  not_empty_;
+  std::queue<long>    queue_;
+};
+
+/**
+ * An mpmc_queue with an event_count to wait with, spinning briefly first the
+ * same way thread_pool does.
+ */
+class lock_free_queue {
+public:
+  lock_free_queue() : queue_( 1024 ) { }
+
+  void push( long value ) {
+    while ( !queue_.push( value ) )
+      this_thread::yield();
+    not_empty_.notify_one();
+  }
+
+  long pop() {
+    long value;
+    static unsigned const spin_max =
+      ::sysconf( _SC_NPROCESSORS_ONLN ) > 1 ? 2000 : 0;
+    for ( unsigned spin = 0; spin < spin_max; ++spin )
+      if ( queue_.pop( &value ) )
+        return value;
+    while ( !queue_.pop( &value ) ) {
+      event_count::key_type const key = not_empty_.prepare_wait();
+      if ( queue_.pop( &value ) ) {
+        not_empty_.cancel_wait();
+        break;
+      }
+      not_empty_.wait( key, -1 );
+    } // while
+    return value;
+  }
+
+private:
+  mpmc_queue<long>  queue_;
+  event_count       not_empty_;
+};
+
+/**
+ * Times pushing tasks through a queue from producer to consumer threads and
+ * prints the throughput.
+ *
+ * @tparam QueueType The type of queue.
+ * @param label The label to print.
+ * @param tasks The total number of tasks.
+ * @param threads The number of producer threads (and of consumer threads).
+ */
+template<class QueueType>
+static void bench_queue( char const *label, unsigned tasks,
+                         unsigned threads ) {
+  QueueType q;
+  unsigned const per_thread = tasks / threads;
+  atomic<long> sum( 0 );
+  auto const start = bench_clock::now();
+
+  vector<thread> pool;
+  for ( unsigned t = 0; t < threads; ++t ) {
+    pool.emplace_back( [&]{
+      for ( unsigned i = 0; i < per_thread; ++i )
+        q.push( i );
+    } );
+    pool.emplace_back( [&]{
+      long s = 0;
+      for ( unsigned i = 0; i < per_thread; ++i )
+        s += q.pop();
+      sum += s;
+    } );
+  } // for
+  for ( auto &t : pool )
+    t.join();
+
+  chrono::duration<double> const secs = bench_clock::now() - start;
+  double const n = double( per_thread ) * threads;
+  cout.setf( ios::fixed );
+  cout.precision( 3 );
+  cout  << label << ": " << threads << " producer(s)/consumer(s), "
+        << n / secs.count() / 1e6 << " M tasks/s\n";
+}
+
+////////// thread_pool ////////////////////////////////////////////////////////
+
+/**
+ * A task given to a thread_pool: the time it was given and whether it has
+ * started.
+ */
+struct handoff {
+  bench_clock::time_point given;
+  bench_clock::duration   latency;
+  atomic<bool>            started;
+};
+
+/**
+ * A %handoff_thread just records how long it took for a task to start.
+ */
+class handoff_thread : public thread_pool::thread {
+public:
+  handoff_thread( thread_pool &p ) : thread_pool::thread( p ) { }
+
+private:
+  thread* create( thread_pool &p ) const {
+    return new handoff_thread( p );
+  }
+
+  void main( argument_type arg ) {
+    auto const h = static_cast<handoff*>( arg.p );
+    h->latency = bench_clock::now() - h->given;
+    h->started.store( true, memory_order_release );
+  }
+};
+
+/**
+ * Times giving tasks to a thread_pool one at a time from each of several
+ * client threads and prints the handoff latency.
+ *
+ * @param tasks The total number of tasks.
+ * @param threads The number of client threads (and of pool threads).
+ */
+static void bench_thread_pool( unsigned tasks, unsigned threads ) {
+  thread_pool pool( new handoff_thread( pool ), threads, threads, 60 );
+  unsigned const per_thread = tasks / threads;
+  vector<vector<double>> latencies( threads );  // in microseconds
+  auto const start = bench_clock::now();
+
+  vector<thread> clients;
+  for ( unsigned t = 0; t < threads; ++t ) {
+    clients.emplace_back( [&,t]{
+      handoff h;
+      latencies[t].reserve( per_thread );
+      for ( unsigned i = 0; i < per_thread; ++i ) {
+        h.started.store( false, memory_order_relaxed );
+        h.given = bench_clock::now();
+        pool.new_task( &h, true );
+        while ( !h.started.load( memory_order_acquire ) )
+          this_thread::yield();
+        latencies[t].push_back(
+          chrono::duration<double,micro>( h.latency ).count()
+        );
+      } // for
+    } );
+  } // for
+  for ( auto &t : clients )
+    t.join();
+  chrono::duration<double> const secs = bench_clock::now() - start;
+
+  vector<double> all;
+  for ( auto const &l : latencies )
+    all.insert( all.end(), l.begin(), l.end() );
+  sort( all.begin(), all.end() );
+
+  cout.setf( ios::fixed );
+  cout.precision( 0 );
+  cout  << "thread_pool: " << threads << " client(s)/thread(s), "
+        << all.size() / secs.count() << " tasks/s";
+  cout.precision( 1 );
+  cout  << ", median " << all[ all.size() / 2 ] << " us"
+        << ", p99 " << all[ all.size() * 99 / 100 ] << " us\n";
+}
+
+////////// local functions ////////////////////////////////////////////////////
+
+static void usage() {
+  cerr << "usage: " << me << " [-n tasks] [-t threads] ...\n";
+  ::exit( 1 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main( int argc, char *argv[] ) {
+  me = argv[0];
+  unsigned tasks = 200000;
+  vector<unsigned> thread_counts;
+
+  for ( int opt; (opt = ::getopt( argc, argv, "n:t:" )) != -1; ) {
+    switch ( opt ) {
+      case 'n': tasks = ::atoi( optarg ); break;
+      case 't': thread_counts.push_back( ::atoi( optarg ) ); break;
+      default : usage();
+    } // switch
+  } // for
+  if ( optind != argc || !tasks )
+    usage();
+  if ( thread_counts.empty() )
+    thread_counts = { 1, 8, 64 };
+
+  cout << tasks << " tasks\n";
+  for ( unsigned const threads : thread_counts ) {
+    if ( !threads || threads > tasks )
+      usage();
+    bench_queue<locked_queue   >( "locked   ", tasks, threads );
+    bench_queue<lock_free_queue>( "lock-free", tasks, threads );
+    bench_thread_pool( tasks / 10, threads );
+  } // for
+  return 0;
+}
+
+/* vim:set et sw=2 ts=2: */
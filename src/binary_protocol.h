@@ -0,0 +1,214 @@
+/*
+**      SWISH++
+**      src/binary_protocol.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef binary_protocol_H
+#define binary_protocol_H
+
+// standard
+#include <algorithm>                    /* for min() */
+#include <cstddef>                      /* for size_t */
+#include <cstdint>
+#include <cstring>                      /* for strlen(3) */
+#include <string>
+
+/*
+**      The search daemon's binary protocol is for programs rather than people:
+**      a request is a fixed-size header followed by the query (rather than a
+**      "command-line" that must be split and parsed) and a response is the
+**      results packed into binary fields (rather than formatted as text).  A
+**      request is distinguished from a text request line by its first byte.
+**      All integers are unsigned and in network byte order.
+**
+**      Request:
+**
+**          offset  size  field
+**               0     1  Binary_Magic
+**               1     1  Binary_Version
+**               2     2  flags (binary_flag)
+**               4     4  number of initial results to skip
+**               8     4  maximum number of results (Binary_Default_Max for
+**                        the daemon's default)
+**              12     2  index to search: its position in the list of index
+**                        files (Binary_All_Indices for all)
+**              14     2  query length, Q
+**              16     Q  query
+**
+**      Response:
+**
+**          offset  size  field
+**               0     1  Binary_Magic
+**               1     1  Binary_Version
+**               2     1  status (binary_status)
+**               3     1  0
+**               4     4  number of bytes that follow the header
+**               8     4  total number of results
+**              12     4  number of results in the response, N
+**              16        N results, each:
+**
+**                    4  file index (within its index)
+**                    2  index (as above)
+**                    2  rank (1-100)
+**                   2+n  path (length-prefixed) if bf_path
+**                    8  file size if bf_size
+**                   2+n  title (length-prefixed) if bf_title
+**
+**      The connection is closed after the response unless bf_keep_alive is
+**      set.  After a bad request (or a malformed query), the connection is
+**      reset.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned char const Binary_Magic              = 0xFE;
+unsigned char const Binary_Version            = 1;
+size_t const        Binary_Request_Header_Size  = 16;
+size_t const        Binary_Response_Header_Size = 16;
+uint32_t const      Binary_Default_Max        = 0xFFFFFFFF;
+unsigned const      Binary_All_Indices        = 0xFFFF;
+
+/**
+ * The request flags of the binary protocol.
+ */
+enum binary_flag {
+  bf_path       = 0x01,                 // include each result's path
+  bf_size       = 0x02,                 // ... file size
+  bf_title      = 0x04,                 // ... title
+  bf_keep_alive = 0x08                  // keep the connection alive after
+};
+
+/**
+ * The response status of the binary protocol.
+ */
+enum binary_status {
+  bs_ok,
+  bs_malformed_query,
+  bs_bad_request
+};
+
+////////// inlines ////////////////////////////////////////////////////////////
+
+/**
+ * Gets a 2-byte integer.
+ *
+ * @param p A pointer to the first byte.
+ * @return Returns said integer.
+ */
+inline unsigned binary_get16( char const *p ) {
+  unsigned char const *const u = reinterpret_cast<unsigned char const*>( p );
+  return u[0] << 8 | u[1];
+}
+
+/**
+ * Gets a 4-byte integer.
+ *
+ * @param p A pointer to the first byte.
+ * @return Returns said integer.
+ */
+inline uint32_t binary_get32( char const *p ) {
+  return static_cast<uint32_t>( binary_get16( p ) ) << 16 |
+         binary_get16( p + 2 );
+}
+
+/**
+ * Appends a 1-byte integer.
+ *
+ * @param s The string to append to.
+ * @param n The integer.
+ */
+inline void binary_put8( std::string &s, unsigned n ) {
+  s += static_cast<char>( n );
+}
+
+/**
+ * Appends a 2-byte integer.
+ *
+ * @param s The string to append to.
+ * @param n The integer.
+ */
+inline void binary_put16( std::string &s, unsigned n ) {
+  char const b[] = { static_cast<char>( n >> 8 ), static_cast<char>( n ) };
+  s.append( b, sizeof b );
+}
+
+/**
+ * Appends a 4-byte integer.
+ *
+ * @param s The string to append to.
+ * @param n The integer.
+ */
+inline void binary_put32( std::string &s, uint32_t n ) {
+  binary_put16( s, n >> 16 );
+  binary_put16( s, n & 0xFFFF );
+}
+
+/**
+ * Appends an 8-byte integer.
+ *
+ * @param s The string to append to.
+ * @param n The integer.
+ */
+inline void binary_put64( std::string &s, uint64_t n ) {
+  binary_put32( s, static_cast<uint32_t>( n >> 32 ) );
+  binary_put32( s, static_cast<uint32_t>( n ) );
+}
+
+/**
+ * Appends a length-prefixed string (truncated if longer than a 2-byte length
+ * allows).
+ *
+ * @param s The string to append to.
+ * @param t The string to append.
+ */
+inline void binary_put_string( std::string &s, char const *t ) {
+  size_t const n = std::min( ::strlen( t ), size_t( 0xFFFF ) );
+  binary_put16( s, static_cast<unsigned>( n ) );
+  s.append( t, n );
+}
+
+/**
+ * Overwrites a 4-byte integer.
+ *
+ * @param s The string containing the integer.
+ * @param pos The position of the integer's first byte.
+ * @param n The integer.
+ */
+inline void binary_set32( std::string &s, size_t pos, uint32_t n ) {
+  s[ pos     ] = static_cast<char>( n >> 24 );
+  s[ pos + 1 ] = static_cast<char>( n >> 16 );
+  s[ pos + 2 ] = static_cast<char>( n >>  8 );
+  s[ pos + 3 ] = static_cast<char>( n );
+}
+
+/**
+ * Checks whether what's been received from a client starts with a binary
+ * request.
+ *
+ * @param s What's been received.
+ * @return Returns \c true only if it does.
+ */
+inline bool is_binary_request( std::string const &s ) {
+  return !s.empty() && static_cast<unsigned char>( s[0] ) == Binary_Magic;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* binary_protocol_H */
+/* vim:set et sw=2 ts=2: */
@@ -25,7 +25,7 @@
 #include "index_segment.h"
 #include "ResultSeparator.h"
 
-extern index_segment directories;
+extern thread_local index_segment directories;
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -99,10 +99,13 @@ conf_var::map_type& conf_var::map_ref() {
       "filesreserve",
       "filterfile",
       "followlinks",
+      "fuzzywordsmax",
+      "hugepages",
       "includefile",
       "includemeta",
       "incremental",
       "indexfile",
+      "queryevaluator",
       "recursesubdirs",
       "resultsformat",
       "resultseparator",
@@ -112,19 +115,29 @@ conf_var::map_type& conf_var::map_ref() {
       "tempdirectory",
       "titlelines",
       "verbosity",
+      "warmup",
+      "warmuplock",
+      "warmupqueries",
       "wordfilesmax",
       "wordpercentmax",
       "wordthreshold",
 #ifdef WITH_WORD_POS
+      "bigrampercentmin",
       "storewordpositions",
       "wordsnear",
 #endif /* WITH_WORD_POS */
 #ifdef WITH_SEARCH_DAEMON
+      "daemonhttp",
+      "daemonio",
+      "daemonlisteners",
+      "daemonpinlisteners",
       "group",
 #ifdef __APPLE__
       "launchdcooperation",
 #endif /* __APPLE__ */
       "pidfile",
+      "querythreads",
+      "reloadinterval",
       "searchbackground",
       "searchdaemon",
       "socketaddress",
@@ -51,6 +51,9 @@ enum {
   // common between index and search
   Exit_No_Read_Index            = 40,
 
+  // unique to search
+  Exit_No_Read_Queries          = 41,
+
   // unique to search
   Exit_Malformed_Query          = 50,
 #ifdef WITH_WORD_POS
@@ -76,6 +79,9 @@ enum {
   Exit_No_Init_Thread_Mutex     = 77,
   Exit_No_User                  = 78,
   Exit_No_Group                 = 79,
+  Exit_No_Pipe                  = 80,
+  Exit_No_Epoll                 = 81,
+  Exit_No_IO_Uring              = 82,
 #endif /* WITH_SEARCH_DAEMON */
 
   Exit_End_Enum_Marker
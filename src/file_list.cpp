@@ -23,9 +23,11 @@
 #include "config.h"
 #include "file_list.h"
 #include "pjl/vlq.h"
+#include "search_results.h"
 #include "word_markers.h"
 
 using namespace PJL;
+using namespace std;
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -87,10 +89,13 @@ file_list::const_iterator& file_list::const_iterator::operator++() {
     v_.meta_ids_.clear();
 
 #ifdef WITH_WORD_POS
-  if ( v_.pos_deltas_.empty() )
-    v_.pos_deltas_.reserve( v_.occurrences_ );
-  else
-    v_.pos_deltas_.clear();
+  pos_ = nullptr;
+  if ( decode_word_pos_ ) {
+    if ( v_.pos_deltas_.empty() )
+      v_.pos_deltas_.reserve( v_.occurrences_ );
+    else
+      v_.pos_deltas_.clear();
+  }
 #endif /* WITH_WORD_POS */
 
   while ( true ) {
@@ -115,10 +120,19 @@ file_list::const_iterator& file_list::const_iterator::operator++() {
         break;
 #ifdef WITH_WORD_POS
       case Word_Pos_List_Marker:
+        pos_ = c_;
+        if ( !decode_word_pos_ ) {
+          while ( *c_ != Stop_Marker )
+            while ( *c_++ & 0x80 )
+              ;
+          break;
+        }
         while ( *c_ != Stop_Marker )
           v_.pos_deltas_.push_back( vlq::decode(c_) );
         break;
 #endif /* WITH_WORD_POS */
+      case File_Bitmap_List_Marker:     // used only by bitmap()
+      case Max_Rank_List_Marker:        // used only by max_rank()
       default:
         //
         // Encountered a list marker we don't know about: we are decoding a
@@ -132,5 +146,162 @@ file_list::const_iterator& file_list::const_iterator::operator++() {
   } // while
 }
 
+#ifdef WITH_WORD_POS
+file_list::word_pos_iterator& file_list::word_pos_iterator::operator++() {
+  if ( *c_ == Stop_Marker )
+    c_ = nullptr;
+  else
+    pos_ += vlq::decode( c_ );
+  return *this;
+}
+#endif /* WITH_WORD_POS */
+
+template<class VisitorType>
+void file_list::for_each_file( meta_id_type meta_id,
+                               VisitorType visit ) const {
+  byte const *p = ptr_;
+  while ( true ) {
+    int const index = vlq::decode( p );
+    while ( *p++ & 0x80 ) ;             // skip occurrences
+    int const rank = vlq::decode( p );
+
+    bool has_meta_id = meta_id == Meta_ID_None;
+    while ( true ) {
+      //
+      // At this point, p must be pointing to a marker.
+      //
+      byte const marker = *p++;
+      if ( marker == Stop_Marker || marker == Word_Entry_Continues_Marker ) {
+        if ( has_meta_id )
+          visit( index, rank );
+        if ( marker == Stop_Marker )
+          return;
+        break;
+      }
+      if ( marker == Meta_Name_List_Marker && !has_meta_id ) {
+        while ( *p != Stop_Marker )
+          if ( static_cast<meta_id_type>( vlq::decode( p ) ) == meta_id )
+            has_meta_id = true;
+      } else {
+        while ( *p != Stop_Marker )
+          while ( *p++ & 0x80 )
+            ;
+      }
+      ++p;                              // skip Stop_Marker
+    } // while
+  } // while
+}
+
+void file_list::add_ranks( meta_id_type meta_id, int factor,
+                           search_results &results ) const {
+  for_each_file(
+    meta_id,
+    [factor,&results]( int index, int rank ) {
+      results.add( index, rank * factor );
+    }
+  );
+}
+
+void file_list::mark_files( meta_id_type meta_id, vector<bool> &marks ) const {
+  if ( meta_id == Meta_ID_None ) {
+    if ( byte const *const bits = bitmap() ) {
+      for ( size_t i = 0; i < marks.size(); ++i )
+        if ( in_bitmap( bits, i ) )
+          marks[i] = true;
+      return;
+    }
+  }
+  for_each_file(
+    meta_id,
+    [&marks]( int index, int ) {
+      marks[ index ] = true;
+    }
+  );
+}
+
+file_list::byte const* file_list::bitmap() const {
+  byte const *p = ptr_;
+  while ( *p++ & 0x80 ) ;               // skip file index
+  while ( *p++ & 0x80 ) ;               // skip occurrences
+  while ( *p++ & 0x80 ) ;               // skip rank
+  while ( true ) {
+    //
+    // At this point, p must be pointing to a marker.
+    //
+    switch ( *p++ ) {
+      case Stop_Marker:
+      case Word_Entry_Continues_Marker:
+        return nullptr;
+      case File_Bitmap_List_Marker:
+        return p;
+      default:
+        while ( *p != Stop_Marker )
+          while ( *p++ & 0x80 )
+            ;
+        ++p;
+    } // switch
+  } // while
+}
+
+int file_list::max_rank() const {
+  byte const *p = ptr_;
+  while ( *p++ & 0x80 ) ;               // skip file index
+  while ( *p++ & 0x80 ) ;               // skip occurrences
+  while ( *p++ & 0x80 ) ;               // skip rank
+  while ( true ) {
+    //
+    // At this point, p must be pointing to a marker.
+    //
+    switch ( *p++ ) {
+      case Stop_Marker:
+      case Word_Entry_Continues_Marker:
+        return -1;
+      case Max_Rank_List_Marker:
+        return vlq::decode( p );
+      default:
+        while ( *p != Stop_Marker )
+          while ( *p++ & 0x80 )
+            ;
+        ++p;
+    } // switch
+  } // while
+}
+
+file_list::const_iterator& file_list::const_iterator::skip_to( int index ) {
+  if ( !c_ || static_cast<int>( v_.index_ ) >= index )
+    return *this;
+  while ( c_ != &end_value ) {
+    //
+    // Peek at the next file's index: if it's far enough, decode the file
+    // normally; otherwise step over it.
+    //
+    byte const *p = c_;
+    if ( static_cast<int>( vlq::decode( p ) ) >= index )
+      return operator++();
+    while ( *p++ & 0x80 ) ;             // skip occurrences
+    while ( *p++ & 0x80 ) ;             // skip rank
+
+    while ( true ) {
+      //
+      // At this point, p must be pointing to a marker.
+      //
+      byte const marker = *p++;
+      if ( marker == Stop_Marker ) {
+        c_ = nullptr;                   // skipped the last file: at end
+        return *this;
+      }
+      if ( marker == Word_Entry_Continues_Marker )
+        break;
+      while ( *p != Stop_Marker )       // must be a list marker
+        while ( *p++ & 0x80 )
+          ;
+      ++p;
+    } // while
+    c_ = p;
+  } // while
+  c_ = nullptr;
+  return *this;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /* vim:set et sw=2 ts=2: */
@@ -24,11 +24,16 @@
 
 // local
 #include "index_segment.h"
+#include "meta_id.h"
 #include "word_info.h"
+#include "word_markers.h"
 
 // standard
 #include <cstddef>                  /* for ptrdiff_t */
 #include <iterator>
+#include <vector>
+
+class search_results;
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -37,10 +42,10 @@
  * created, the list of files can be iterated over.
  */
 class file_list {
-  typedef unsigned char byte;         // for convenience
 public:
   ////////// typedefs /////////////////////////////////////////////////////////
 
+  typedef unsigned char byte;         // for convenience
   typedef int size_type;
   typedef ptrdiff_t difference_type;
   typedef word_info::file value_type;
@@ -58,6 +63,33 @@ public:
 
   ////////// iterators ////////////////////////////////////////////////////////
 
+#ifdef WITH_WORD_POS
+  /**
+   * A %word_pos_iterator iterates over the absolute positions of a word in a
+   * file by decoding them from the index file as it goes rather than all at
+   * once into the file's \c pos_deltas_.
+   */
+  class word_pos_iterator {
+  public:
+    word_pos_iterator() : c_( nullptr ), pos_( 0 ) { }
+
+    bool      at_end() const            { return !c_; }
+    unsigned  operator*() const         { return pos_; }
+    word_pos_iterator& operator++();
+
+  private:
+    explicit word_pos_iterator( byte const *p ) : c_( p ), pos_( 0 ) {
+      if ( c_ )
+        operator++();
+    }
+
+    byte const *c_;
+    unsigned pos_;
+
+    friend class file_list;
+  };
+#endif /* WITH_WORD_POS */
+
   class const_iterator;
   friend class const_iterator;
 
@@ -74,6 +106,32 @@ public:
     const_iterator& operator++();
     const_iterator operator++(int);
 
+    /**
+     * Advances to the first file whose index is at least the given index.  The
+     * files skipped over are stepped over without being decoded (the same way
+     * calc_size() steps over them) so skipping is much faster than repeatedly
+     * incrementing.  If the current file's index is already at least the
+     * given index, does nothing.
+     *
+     * @param index The file index to advance to.
+     * @return Returns this iterator.
+     */
+    const_iterator& skip_to( int index );
+
+#ifdef WITH_WORD_POS
+    /**
+     * Gets an iterator over the positions of the word in the current file.
+     * Unlike \c pos_deltas_, this works even if the iterator was obtained
+     * from begin() without decoding the positions.
+     *
+     * @return Returns said iterator.  It is at its end if the index file has
+     * no word position data.
+     */
+    word_pos_iterator word_pos() const {
+      return word_pos_iterator( pos_ );
+    }
+#endif /* WITH_WORD_POS */
+
     friend bool operator==( const_iterator const &i, const_iterator const &j ) {
       return i.c_ == j.c_;
     }
@@ -83,13 +141,21 @@ public:
     }
 
   private:
-    const_iterator( byte const *p ) : c_( p ) {
+    const_iterator( byte const *p, bool decode_word_pos = true ) : c_( p )
+#ifdef WITH_WORD_POS
+      , decode_word_pos_( decode_word_pos )
+#endif /* WITH_WORD_POS */
+    {
       if ( c_ )
         operator++();
     }
 
     byte const *c_;
     value_type v_;
+#ifdef WITH_WORD_POS
+    byte const *pos_;                   // current file's word positions
+    bool decode_word_pos_;              // into v_.pos_deltas_?
+#endif /* WITH_WORD_POS */
 
     static byte const end_value;
     friend class file_list;
@@ -98,9 +164,74 @@ public:
   ////////// member functions /////////////////////////////////////////////////
 
   const_iterator  begin() const       { return const_iterator( ptr_ ); }
+
+  /**
+   * Gets an iterator positioned at the first file.
+   *
+   * @param decode_word_pos If \c false, the files' word positions are not
+   * decoded into \c pos_deltas_ (use const_iterator::word_pos() instead).
+   * This makes iterating faster when positions are needed for few files.
+   * @return Returns said iterator.
+   */
+  const_iterator begin( bool decode_word_pos ) const {
+    return const_iterator( ptr_, decode_word_pos );
+  }
+
   const_iterator  end() const         { return const_iterator( nullptr ); }
   size_type       size() const;
 
+  /**
+   * Marks the files the word is in that have the given meta ID.  The files
+   * are stepped over without being fully decoded (the same way calc_size()
+   * steps over them) so this is much faster than iterating.
+   *
+   * @param meta_id The meta ID a file must have to be marked.
+   * @param marks The marks, one per file in the index: \c marks[i] is set to
+   * \c true for every file \a i marked.
+   */
+  void mark_files( meta_id_type meta_id, std::vector<bool> &marks ) const;
+
+  /**
+   * Adds the rank of every file the word is in that has the given meta ID to
+   * search results.  The files are stepped over the same way mark_files()
+   * steps over them so this is much faster than iterating.
+   *
+   * @param meta_id The meta ID a file must have for its rank to be added.
+   * @param factor The factor to multiply each rank by.
+   * @param results The search results to add to.
+   */
+  void add_ranks( meta_id_type meta_id, int factor,
+                  search_results &results ) const;
+
+  /**
+   * Gets the maximum rank of the word over all the files it's in as recorded
+   * in the index file.
+   *
+   * @return Returns said rank or -1 if the index file was generated by a
+   * version of index that didn't record it.
+   */
+  int max_rank() const;
+
+  /**
+   * Gets the bitmap of all the files the word is in as recorded in the index
+   * file.
+   *
+   * @return Returns said bitmap (to be passed to in_bitmap()) or null if the
+   * index file has none for the word.
+   */
+  byte const* bitmap() const;
+
+  /**
+   * Checks whether a file is in a bitmap.
+   *
+   * @param bitmap The bitmap returned by bitmap().
+   * @param index The file's index.
+   * @return Returns \c true only if the file is in the bitmap.
+   */
+  static bool in_bitmap( byte const *bitmap, int index ) {
+    return bitmap[ index / File_Bitmap_Bits ] >> index % File_Bitmap_Bits & 1;
+  }
+
 private:
   byte const       *ptr_;
   mutable size_type size_;
@@ -112,6 +243,18 @@ private:
    * @return Returns said size.
    */
   size_type calc_size() const;
+
+  /**
+   * Steps over every file the word is in that has the given meta ID without
+   * fully decoding it.
+   *
+   * @tparam VisitorType The visitor type.
+   * @param meta_id The meta ID a file must have to be visited.
+   * @param visit The visitor called as <code>visit( index, rank )</code> for
+   * each file.
+   */
+  template<class VisitorType>
+  void for_each_file( meta_id_type meta_id, VisitorType visit ) const;
 };
 
 ////////// inlines ////////////////////////////////////////////////////////////
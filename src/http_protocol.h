@@ -0,0 +1,102 @@
+/*
+**      SWISH++
+**      src/http_protocol.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef http_protocol_H
+#define http_protocol_H
+
+// standard
+#include <cstddef>                      /* for size_t */
+#include <cstring>                      /* for memcmp(3) */
+#include <string>
+
+/*
+**      If enabled (via DaemonHTTP), the search daemon also serves HTTP/1.0 and
+**      HTTP/1.1 requests so the results of a query can be gotten by a browser
+**      or any HTTP client (rather than via a CGI script that forwards the
+**      query):
+**
+**          GET /search?q=query&max=n&skip=n HTTP/1.1
+**
+**      where q is required, max defaults to ResultsMax, and skip defaults to
+**      0.  The results are in JSON (as given by json_formatter).  A request is
+**      distinguished from a text request line by the line ending in an HTTP
+**      version.  Persistent connections are supported as usual: HTTP/1.1
+**      connections are kept alive unless the client sends "Connection: close"
+**      and HTTP/1.0 connections are closed unless the client sends
+**      "Connection: keep-alive".
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The maximum size of an HTTP request (its request line and headers).
+ */
+size_t const Http_Request_Max = 8192;
+
+////////// inlines ////////////////////////////////////////////////////////////
+
+/**
+ * Checks whether a line is an HTTP request line, i.e., whether it ends in an
+ * HTTP/1.x version.
+ *
+ * @param s A pointer to the start of the line.
+ * @param n The length of the line (without its terminator).
+ * @return Returns \c true only if it is.
+ */
+inline bool is_http_request_line( char const *s, size_t n ) {
+  return n > 9 && ::memcmp( s + n - 9, " HTTP/1.", 8 ) == 0 &&
+         (s[ n - 1 ] == '0' || s[ n - 1 ] == '1');
+}
+
+/**
+ * Checks whether a request gotten from a client is an HTTP request.
+ *
+ * @param s The request.
+ * @return Returns \c true only if it is.
+ */
+inline bool is_http_request( std::string const &s ) {
+  auto const end = s.find_first_of( "\r\n" );
+  return end != std::string::npos && is_http_request_line( s.data(), end );
+}
+
+/**
+ * Finds the end of the headers of an HTTP request, i.e., the blank line after
+ * them (that may or may not have a carriage return).
+ *
+ * @param s What's been received of the request.
+ * @param pos The position to start looking from.
+ * @return Returns the position just past the blank line or
+ * \c std::string::npos if it hasn't been received yet.
+ */
+inline size_t http_headers_end( std::string const &s, size_t pos ) {
+  for ( ; (pos = s.find( '\n', pos )) != std::string::npos; ++pos ) {
+    if ( pos + 1 < s.size() && s[ pos + 1 ] == '\n' )
+      return pos + 2;
+    if ( pos + 2 < s.size() && s[ pos + 1 ] == '\r' && s[ pos + 2 ] == '\n' )
+      return pos + 3;
+  } // for
+  return std::string::npos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* http_protocol_H */
+/* vim:set et sw=2 ts=2: */
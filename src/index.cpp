@@ -22,6 +22,9 @@
 // local
 #include "config.h"
 #include "AssociateMeta.h"
+#ifdef WITH_WORD_POS
+#include "BigramPercentMin.h"
+#endif /* WITH_WORD_POS */
 #include "ChangeDirectory.h"
 #include "ExcludeFile.h"
 #include "ExcludeMeta.h"
@@ -42,12 +45,14 @@
 #include "index_segment.h"
 #include "meta_id.h"
 #include "pjl/itoa.h"
+#include "pjl/less.h"
 #include "pjl/mmap_file.h"
 #include "pjl/option_stream.h"
 #include "pjl/vlq.h"
 #include "RecurseSubdirs.h"
 #include "StopWordFile.h"
 #include "stop_words.h"
+#include "swishxx-config.h"
 #ifdef WITH_WORD_POS
 #include "StoreWordPositions.h"
 #endif /* WITH_WORD_POS */
@@ -63,6 +68,7 @@
 #include "word_util.h"
 
 // standard
+#include <algorithm>
 #include <cmath>                        /* for log(3) */
 #include <cstdlib>                      /* for getenv(3), exit(3) */
 #include <cstring>
@@ -70,7 +76,9 @@
 #include <iomanip>                      /* for setfill(), setw() */
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <memory>                       /* for unique_ptr */
+#include <queue>
 #include <string>
 #include <time.h>
 #include <sys/time.h>                   /* needed by FreeBSD systems */
@@ -107,6 +115,7 @@ unsigned long         num_indexed_words;  // over all files indexed
 static unsigned long  num_unique_words;   // over all files indexed
 static vector<string> partial_index_file_names;
 RecurseSubdirs        recurse_subdirectories;
+static vector<unsigned> reversed_words;   // word ordinals by reversed spelling
 string                temp_file_name_prefix;
 Verbosity             verbosity;          // how much to print
 word_map              words;              // the index being generated
@@ -114,12 +123,26 @@ WordFilesMax          word_files_max;
 WordPercentMax        word_percent_max;
 WordThreshold         word_threshold;
 
+/**
+ * The ordinals of the words containing each trigram.  A trigram is packed into
+ * an \c unsigned most-significant byte first so that the map is in the order
+ * of the trigrams' spellings.
+ */
+typedef map<unsigned,vector<unsigned>> trigram_map;
+static trigram_map    trigrams;
+
 #ifdef WITH_WORD_POS
+BigramPercentMin      bigram_percent_min;
+static word_map       bigrams;            // adjacent pairs of frequent words
 StoreWordPositions    store_word_positions;
 int                   word_pos;           // ith word in file
 #endif /* WITH_WORD_POS */
 
 // local functions
+#ifdef WITH_WORD_POS
+static void           index_bigrams( word_map const& );
+#endif /* WITH_WORD_POS */
+static void           index_wildcards( vector<char const*> const& );
 static void           load_old_index( char const *index_file_name );
 static void           max_out_limits();
 static void           merge_indicies( ostream& );
@@ -132,7 +155,8 @@ static void           write_full_index( ostream& );
 static void           write_meta_name_index( ostream&, off_t* );
 static void           write_partial_index();
 static void           write_stop_word_index( ostream&, off_t* );
-static void           write_word_index( ostream&, off_t* );
+static void           write_trigram_index( ostream&, off_t* );
+static void           write_word_index( ostream&, word_map const&, off_t* );
 
 #define SWISHXX_INDEX
 #include "do_file.cpp"
@@ -182,6 +206,61 @@ inline int rank_word( int file_index, int occurences_in_file, double factor ) {
   return r > 0 ? r : 1;
 }
 
+/**
+ * The index of a file and the number of times a word occurs in it.
+ */
+typedef pair<int,int> file_occurrences;
+
+/**
+ * Computes the maximum rank of a word over all the files it's in.
+ *
+ * @param files The files the word is in.
+ * @param factor The same as for rank_word().
+ * @return Returns said rank.
+ */
+static int max_rank_word( vector<file_occurrences> const &files,
+                          double factor ) {
+  int max_rank = 1;
+  for ( auto const &file : files ) {
+    int const rank = rank_word( file.first, file.second, factor );
+    if ( rank > max_rank )
+      max_rank = rank;
+  } // for
+  return max_rank;
+}
+
+/**
+ * Gets the bitmap of the files a word is in, but only if the word is in enough
+ * files for it to be worth writing.
+ *
+ * @param files The files the word is in.
+ * @param bitmap The bitmap, one per file in the index.
+ * @return Returns \c true only if the bitmap should be written.
+ */
+static bool word_file_bitmap( vector<file_occurrences> const &files,
+                              vector<bool> &bitmap ) {
+  if ( files.size() * File_Bitmap_Ratio < file_info::num_files() )
+    return false;
+  bitmap.assign( file_info::num_files(), false );
+  for ( auto const &file : files )
+    bitmap[ file.first ] = true;
+  return true;
+}
+
+#ifdef WITH_WORD_POS
+/**
+ * Checks whether a word is in enough files for the pairs of it and other such
+ * words to be indexed as bigrams.
+ *
+ * @param file_count The number of files the word occurs in.
+ * @return Returns \c true only if the word is frequent enough.
+ */
+inline bool is_bigram_word( unsigned file_count ) {
+  return bigram_percent_min && store_word_positions &&
+    file_count * 100 >= bigram_percent_min * file_info::num_files();
+}
+#endif /* WITH_WORD_POS */
+
 ////////// main ///////////////////////////////////////////////////////////////
 
 int main( int argc, char *argv[] ) {
@@ -195,6 +274,9 @@ int main( int argc, char *argv[] ) {
   static option_stream::spec const opt_spec[] = {
     { "help",           0, '?', option_stream::arg_lone, "" },
     { "no-assoc-meta",  0, 'A', "mM", "" },
+#ifdef WITH_WORD_POS
+    { "bigram-percent", 1, 'b', "", "" },
+#endif /* WITH_WORD_POS */
     { "config-file",    1, 'c', "", "" },
     { "chdir",          1, 'd', "", "" },
     { "pattern",        1, 'e', "", "" },
@@ -224,6 +306,9 @@ int main( int argc, char *argv[] ) {
     { nullptr,          0,'\0', "", "" }
   };
 
+#ifdef WITH_WORD_POS
+  char const     *bigram_percent_min_arg = nullptr;
+#endif /* WITH_WORD_POS */
   ChangeDirectory change_directory;
   char const     *change_directory_arg = nullptr;
   char const     *config_file_name_arg = ConfigFile_Default;
@@ -265,6 +350,12 @@ int main( int argc, char *argv[] ) {
         no_associate_meta_opt = true;
         break;
 
+#ifdef WITH_WORD_POS
+      case 'b': // Specify the bigram word/file percentage.
+        bigram_percent_min_arg = opt.arg();
+        break;
+#endif /* WITH_WORD_POS */
+
       case 'c': // Specify config. file.
         config_file_name_arg = opt.arg();
         break;
@@ -393,6 +484,10 @@ int main( int argc, char *argv[] ) {
   //
   conf_var::parse_file( config_file_name_arg );
 
+#ifdef WITH_WORD_POS
+  if ( bigram_percent_min_arg )
+    bigram_percent_min = bigram_percent_min_arg;
+#endif /* WITH_WORD_POS */
   if ( files_grow_arg )
     files_grow = files_grow_arg;
   if ( files_reserve_arg )
@@ -553,6 +648,121 @@ int main( int argc, char *argv[] ) {
   ::exit( Exit_Success );
 }
 
+#ifdef WITH_WORD_POS
+/**
+ * Indexes the "bigrams" (pairs of adjacent words) of the frequent words, i.e.,
+ * those for which is_bigram_word() is \c true.  A bigram is a word_info whose
+ * "word" is the two words separated by a space, whose word positions are
+ * those of the first word wherever the second word immediately follows it,
+ * and whose rank in a file is the sum of the ranks of its two words.  A phrase
+ * search for frequent words can then look up their bigrams rather than
+ * merging the (long) lists of their positions.
+ *
+ * @param words The words whose files have been ranked.
+ */
+static void index_bigrams( word_map const &words ) {
+  vector<word_map::value_type const*> frequent;
+  for ( auto const &w : words )
+    if ( is_bigram_word( w.second.files_.size() ) )
+      frequent.push_back( &w );
+  if ( frequent.empty() )
+    return;
+
+  if ( verbosity > 1 )
+    cout << me << ": indexing bigrams of " << frequent.size() << " words..."
+         << flush;
+
+  //
+  // Visit the files of all the frequent words in file order and, for each
+  // file, sort the words' positions to find the adjacent ones.
+  //
+  typedef word_info::file_list::const_iterator file_iterator;
+  typedef pair<unsigned,size_t> index_word;   // file index or position, word
+  vector<file_iterator> file( frequent.size() );
+  vector<unsigned> rank( frequent.size() );
+  priority_queue<index_word,vector<index_word>,greater<index_word>> next;
+  for ( size_t i = 0; i < frequent.size(); ++i ) {
+    file[i] = frequent[i]->second.files_.begin();
+    next.emplace( file[i]->index_, i );
+  } // for
+
+  map<pair<size_t,size_t>,word_info> pairs;
+  vector<index_word> positions;
+  while ( !next.empty() ) {
+    unsigned const file_index = next.top().first;
+    positions.clear();
+    do {
+      size_t const i = next.top().second;
+      next.pop();
+      rank[i] = file[i]->rank_;
+      unsigned pos = 0;
+      for ( auto const delta : file[i]->pos_deltas_ )
+        positions.emplace_back( pos += delta, i );
+      if ( ++file[i] != frequent[i]->second.files_.end() )
+        next.emplace( file[i]->index_, i );
+    } while ( !next.empty() && next.top().first == file_index );
+
+    ::sort( positions.begin(), positions.end() );
+    for ( size_t k = 1; k < positions.size(); ++k ) {
+      index_word const &a = positions[ k - 1 ], &b = positions[k];
+      if ( b.first != a.first + 1 )
+        continue;
+      word_info &info = pairs[ make_pair( a.second, b.second ) ];
+      if ( info.files_.empty() || info.files_.back().index_ != file_index ) {
+        info.files_.emplace_back( file_index );
+        info.files_.back().rank_ = rank[ a.second ] + rank[ b.second ];
+      } else
+        ++info.files_.back().occurrences_;
+      info.files_.back().add_word_pos( a.first );
+      ++info.occurrences_;
+    } // for
+  } // while
+
+  for ( auto &p : pairs ) {
+    word_info &info = bigrams[
+      frequent[ p.first.first ]->first + ' ' + frequent[ p.first.second ]->first
+    ];
+    info.files_.swap( p.second.files_ );
+    info.occurrences_ = p.second.occurrences_;
+  } // for
+
+  if ( verbosity > 1 )
+    cout << ' ' << bigrams.size() << " bigrams\n";
+}
+#endif /* WITH_WORD_POS */
+
+/**
+ * Indexes the words for wildcards other than at the end of a word: computes
+ * the order of the words by their reversed spellings (so all the words ending
+ * in a given suffix are adjacent) and, for every trigram (sequence of three
+ * characters), the words containing it.
+ *
+ * @param word_list The words that will be written, in order.
+ */
+static void index_wildcards( vector<char const*> const &word_list ) {
+  reversed_words.resize( word_list.size() );
+  for ( unsigned i = 0; i < word_list.size(); ++i )
+    reversed_words[i] = i;
+  less_reversed_n<char const*> const less_reversed;
+  ::sort(
+    reversed_words.begin(), reversed_words.end(),
+    [&]( unsigned i, unsigned j ) {
+      return less_reversed( word_list[i], word_list[j] );
+    }
+  );
+
+  for ( unsigned i = 0; i < word_list.size(); ++i ) {
+    auto const w = reinterpret_cast<unsigned char const*>( word_list[i] );
+    if ( !w[0] || !w[1] )
+      continue;
+    for ( auto c = w + 2; *c; ++c ) {
+      vector<unsigned> &ordinals = trigrams[ c[-2] << 16 | c[-1] << 8 | c[0] ];
+      if ( ordinals.empty() || ordinals.back() != i )
+        ordinals.push_back( i );
+    } // for
+  } // for
+}
+
 /**
  * Checks to see if the word is too frequent by either exceeding the maximum
  * number or percentage of files it can be in.
@@ -687,7 +897,11 @@ void merge_indicies( ostream &o ) {
   vector<mmap_file> index( partial_index_file_names.size() );
   vector<index_segment> words( partial_index_file_names.size() );
   vector<index_segment::const_iterator> word( partial_index_file_names.size() );
+  vector<char const*> word_list;        // words to be written, in order
   size_t i, j;
+#ifdef WITH_WORD_POS
+  word_map bigram_words;                // frequent words and their files
+#endif /* WITH_WORD_POS */
 
   ////////// Reopen all the partial indicies //////////////////////////////////
 
@@ -759,11 +973,63 @@ void merge_indicies( ostream &o ) {
       //
       stop_words->insert( *word[i] );
       --num_unique_words;
+    } else {
+      word_list.push_back( *word[i] );
+#ifdef WITH_WORD_POS
+      if ( is_bigram_word( file_count ) )
+        bigram_words[ *word[i] ];
+#endif /* WITH_WORD_POS */
     }
 
     ++word[i];
   } // while
 
+  // The words remaining in the last non-exhausted index are in no other.
+  for ( j = 0; j < partial_index_file_names.size(); ++j ) {
+    for ( ; word[j] != words[j].end(); ++word[j] ) {
+      word_list.push_back( *word[j] );
+#ifdef WITH_WORD_POS
+      if ( is_bigram_word( file_list( word[j] ).size() ) )
+        bigram_words[ *word[j] ];
+#endif /* WITH_WORD_POS */
+    } // for
+  } // for
+
+#ifdef WITH_WORD_POS
+  ////////// Collect the words to index bigrams of ////////////////////////////
+
+  if ( !bigram_words.empty() ) {
+    //
+    // The partial indicies are of files in increasing order, so appending
+    // each index's files for a word keeps them in order.
+    //
+    for ( i = 0; i < partial_index_file_names.size(); ++i ) {
+      for ( auto w = words[i].begin(); w != words[i].end(); ++w ) {
+        auto const found = bigram_words.find( *w );
+        if ( found == bigram_words.end() )
+          continue;
+        word_info &info = found->second;
+        for ( auto const &file : file_list( w ) ) {
+          info.files_.push_back( file );
+          info.occurrences_ += file.occurrences_;
+        } // for
+      } // for
+    } // for
+
+    for ( auto &w : bigram_words ) {
+      double const factor = (double)Rank_Factor / w.second.occurrences_;
+      for ( auto &file : w.second.files_ )
+        file.rank_ = rank_word( file.index_, file.occurrences_, factor );
+    } // for
+    if ( verbosity > 1 && !bigram_words.empty() )
+      cout << '\n';
+    index_bigrams( bigram_words );
+  }
+#endif /* WITH_WORD_POS */
+
+  index_wildcards( word_list );
+  word_list.clear();
+
   ////////// Write index file header //////////////////////////////////////////
 
 #define SWISHXX_WRITE_HEADER
@@ -778,22 +1044,24 @@ void merge_indicies( ostream &o ) {
   for ( i = 0; i < partial_index_file_names.size(); ++i )
     word[i] = words[i].begin();         // reset all iterators
   int word_index = 0;
+  vector<file_occurrences> word_files;
+  vector<bool> word_bitmap;
   while ( true ) {
 
     ////////// Find the next word /////////////////////////////////////////////
 
-    // Find at least two non-exhausted indicies noting the first.
+    //
+    // Find at least two non-exhausted indicies noting the first.  Stop words
+    // must be skipped in all the indicies (so don't stop after finding two)
+    // otherwise one could be taken as the least word below.
+    //
     int n = 0;
     for ( j = 0; j < partial_index_file_names.size(); ++j ) {
       for ( ; word[j] != words[j].end(); ++word[j] )
         if ( !contains( *stop_words, *word[j] ) )
             break;
-      if ( word[j] != words[j].end() ) {
-        if ( !n++ )
-          i = j;
-        else if ( n >= 2 )
-          break;
-      }
+      if ( word[j] != words[j].end() && !n++ )
+        i = j;
     } // for
     if ( n < 2 )                        // couldn't find at least 2
       break;
@@ -810,15 +1078,20 @@ void merge_indicies( ostream &o ) {
     ////////// Calc. total occurrences in all indicies ////////////////////////
 
     int total_occurrences = 0;
+    word_files.clear();
     for ( j = i; j < partial_index_file_names.size(); ++j ) {
       if ( word[j] == words[j].end() )
         continue;
       if ( ::strcmp( *word[j], *word[i] ) )
         continue;
-      for ( auto const &file : file_list( word[j] ) )
+      for ( auto const &file : file_list( word[j] ) ) {
         total_occurrences += file.occurrences_;
+        word_files.emplace_back( file.index_, file.occurrences_ );
+      } // for
     } // for
     double const factor = (double)Rank_Factor / total_occurrences;
+    int const max_rank = max_rank_word( word_files, factor );
+    bool const has_bitmap = word_file_bitmap( word_files, word_bitmap );
 
     ////////// Copy all index info and compute ranks //////////////////////////
 
@@ -831,14 +1104,19 @@ void merge_indicies( ostream &o ) {
       for ( auto const &file : file_list( word[j] ) ) {
         if ( continues )
           o << Word_Entry_Continues_Marker << assert_stream;
-        else
-          continues = true;
 
         o << vlq::encode( file.index_ )
           << vlq::encode( file.occurrences_ )
           << vlq::encode( rank_word( file.index_, file.occurrences_, factor ) )
           << assert_stream;
 
+        if ( !continues ) {
+          word_info::write_max_rank( o, max_rank );
+          if ( has_bitmap )
+            word_info::write_file_bitmap( o, word_bitmap );
+          continues = true;
+        }
+
         if ( !file.meta_ids_.empty() )
           file.write_meta_ids( o );
 #ifdef WITH_WORD_POS
@@ -871,10 +1149,15 @@ void merge_indicies( ostream &o ) {
       ////////// Calc. total occurrences in all indicies //////////////////////
 
       int total_occurrences = 0;
+      word_files.clear();
       file_list const list( word[j] );
-      for ( auto const &file : list )
+      for ( auto const &file : list ) {
         total_occurrences += file.occurrences_;
+        word_files.emplace_back( file.index_, file.occurrences_ );
+      } // for
       double const factor = (double)Rank_Factor / total_occurrences;
+      int const max_rank = max_rank_word( word_files, factor );
+      bool const has_bitmap = word_file_bitmap( word_files, word_bitmap );
 
       ////////// Copy all index info and compute ranks ////////////////////////
 
@@ -882,14 +1165,19 @@ void merge_indicies( ostream &o ) {
       for ( auto const &file : list ) {
         if ( continues )
           o << Word_Entry_Continues_Marker << assert_stream;
-        else
-          continues = true;
 
         o << vlq::encode( file.index_ )
           << vlq::encode( file.occurrences_ )
           << vlq::encode( rank_word( file.index_, file.occurrences_, factor ) )
           << assert_stream;
 
+        if ( !continues ) {
+          word_info::write_max_rank( o, max_rank );
+          if ( has_bitmap )
+            word_info::write_file_bitmap( o, word_bitmap );
+          continues = true;
+        }
+
         if ( !file.meta_ids_.empty() )
           file.write_meta_ids( o );
 #ifdef WITH_WORD_POS
@@ -905,6 +1193,11 @@ void merge_indicies( ostream &o ) {
   write_dir_index      ( o, dir_offset );
   write_file_index     ( o, file_offset );
   write_meta_name_index( o, meta_name_offset );
+#ifdef WITH_WORD_POS
+  if ( num_bigrams )
+    write_word_index( o, bigrams, bigram_offset );
+#endif /* WITH_WORD_POS */
+  write_trigram_index( o, trigram_offset );
 
   ////////// Go back and write the computed offsets /////////////////////////
 
@@ -1023,6 +1316,15 @@ static void write_full_index( ostream &o ) {
   if ( !( num_unique_words = words.size() ) )
     return;
 
+#ifdef WITH_WORD_POS
+  index_bigrams( words );
+#endif /* WITH_WORD_POS */
+  vector<char const*> word_list;
+  word_list.reserve( words.size() );
+  for ( auto const &w : words )
+    word_list.push_back( w.first.c_str() );
+  index_wildcards( word_list );
+
   if ( verbosity > 1 )
     cout << me << ": writing index..." << flush;
 
@@ -1030,11 +1332,16 @@ static void write_full_index( ostream &o ) {
 #include "index_header.cpp"
 #undef SWISHXX_WRITE_HEADER
 
-  write_word_index     ( o, word_offset );
+  write_word_index     ( o, words, word_offset );
   write_stop_word_index( o, stop_word_offset );
   write_dir_index      ( o, dir_offset );
   write_file_index     ( o, file_offset );
   write_meta_name_index( o, meta_name_offset );
+#ifdef WITH_WORD_POS
+  if ( num_bigrams )
+    write_word_index( o, bigrams, bigram_offset );
+#endif /* WITH_WORD_POS */
+  write_trigram_index( o, trigram_offset );
 
 #define SWISHXX_REWRITE_HEADER
 #include "index_header.cpp"
@@ -1090,7 +1397,7 @@ static void write_partial_index() {
   streampos const word_offset_pos = o.tellp();
   my_write( o, word_offset, num_words * sizeof( word_offset[0] ) );
 
-  write_word_index( o, word_offset );
+  write_word_index( o, words, word_offset );
 
   // Go back and write the computed offsets.
   o.seekp( word_offset_pos );
@@ -1119,27 +1426,68 @@ static void write_stop_word_index( ostream &o, off_t *offset ) {
 }
 
 /**
- * Writes the word index to the given ostream recording the offsets as it goes.
+ * Writes the trigram index to the given ostream recording the offsets as it
+ * goes.  Each entry is a trigram followed by the number of words containing
+ * it and the differences between successive ordinals of those words (the
+ * first being relative to zero).
  *
  * @param o The ostream to write the index to.
  * @param offset A pointer to a built-in vector where to record the offsets.
  */
-static void write_word_index( ostream &o, off_t *offset ) {
+static void write_trigram_index( ostream &o, off_t *offset ) {
+  int trigram_index = 0;
+  for ( auto const &t : trigrams ) {
+    offset[ trigram_index++ ] = o.tellp();
+    o << static_cast<char>( t.first >> 16 )
+      << static_cast<char>( t.first >> 8 )
+      << static_cast<char>( t.first ) << '\0'
+      << vlq::encode( t.second.size() );
+    unsigned prev = 0;
+    for ( auto const ordinal : t.second ) {
+      o << vlq::encode( ordinal - prev );
+      prev = ordinal;
+    } // for
+    o << assert_stream;
+  } // for
+}
+
+/**
+ * Writes a word index to the given ostream recording the offsets as it goes.
+ *
+ * @param o The ostream to write the index to.
+ * @param words The words to write: either the words or the bigrams.
+ * @param offset A pointer to a built-in vector where to record the offsets.
+ */
+static void write_word_index( ostream &o, word_map const &words,
+                              off_t *offset ) {
   int word_index = 0;
   for ( auto w : words ) {
     offset[ word_index++ ] = o.tellp();
     o << w.first << '\0' << assert_stream;
     bool continues = false;
     word_info const &info = w.second;
+    unsigned max_rank = 1;
+    vector<file_occurrences> word_files;
+    for ( auto const &file : info.files_ ) {
+      if ( file.rank_ > max_rank )
+        max_rank = file.rank_;
+      word_files.emplace_back( file.index_, file.occurrences_ );
+    } // for
+    vector<bool> word_bitmap;
+    bool const has_bitmap = word_file_bitmap( word_files, word_bitmap );
     for ( auto file : info.files_ ) {
       if ( continues )
         o << Word_Entry_Continues_Marker << assert_stream;
-      else
-        continues = true;
       o << vlq::encode( file.index_ )
         << vlq::encode( file.occurrences_ )
         << vlq::encode( file.rank_ )
         << assert_stream;
+      if ( !continues ) {
+        word_info::write_max_rank( o, max_rank );
+        if ( has_bitmap )
+          word_info::write_file_bitmap( o, word_bitmap );
+        continues = true;
+      }
       if ( !file.meta_ids_.empty() )
         file.write_meta_ids( o );
 #ifdef WITH_WORD_POS
@@ -1164,6 +1512,9 @@ static ostream& usage( ostream &o ) {
   "========\n"
   "-?     | --help             : Print this help message\n"
   "-A     | --no-assoc-meta    : Don't associate meta names [default: do]\n"
+#ifdef WITH_WORD_POS
+  "-b n   | --bigram-percent n : Bigram word/file percentage [default: " << BigramPercentMin_Default << "]\n"
+#endif /* WITH_WORD_POS */
   "-c f   | --config-file f    : Name of configuration file [default: " << ConfigFile_Default << "]\n"
   "-e m:p | --pattern m:p      : Module and file pattern to index [default: none]\n"
   "-E p   | --no-pattern p     : File pattern not to index [default: none]\n"
@@ -39,6 +39,17 @@
   off_t *const file_offset      = new off_t[ num_files ];
   off_t *const meta_name_offset = num_meta_names ?
                                   new off_t[ num_meta_names ] : nullptr;
+#ifdef WITH_WORD_POS
+  long const num_bigrams        = bigrams.size();
+#else
+  long const num_bigrams        = 0;
+#endif /* WITH_WORD_POS */
+  off_t *const bigram_offset    = num_bigrams ?
+                                  new off_t[ num_bigrams ] : nullptr;
+  off_t *const reversed_offset  = new off_t[ num_unique_words ];
+  long const num_trigrams       = trigrams.size();
+  off_t *const trigram_offset   = num_trigrams ?
+                                  new off_t[ num_trigrams ] : nullptr;
 
   my_write( o, &num_unique_words, sizeof( num_unique_words ) );
   auto const word_offset_pos = o.tellp();
@@ -65,6 +76,27 @@
     my_write( o, meta_name_offset,
       num_meta_names * sizeof( meta_name_offset[0] )
     );
+
+  //
+  // The bigram, reversed-word, and trigram segments are optional (search
+  // treats them as empty if absent), but the bigram segment header must be
+  // written, even if empty, to keep the position of the ones after it.
+  //
+  my_write( o, &num_bigrams, sizeof( num_bigrams ) );
+  auto const bigram_offset_pos = o.tellp();
+  if ( num_bigrams )
+    my_write( o, bigram_offset, num_bigrams * sizeof( bigram_offset[0] ) );
+
+  my_write( o, &num_unique_words, sizeof( num_unique_words ) );
+  auto const reversed_offset_pos = o.tellp();
+  my_write( o, reversed_offset,
+    num_unique_words * sizeof( reversed_offset[0] )
+  );
+
+  my_write( o, &num_trigrams, sizeof( num_trigrams ) );
+  auto const trigram_offset_pos = o.tellp();
+  if ( num_trigrams )
+    my_write( o, trigram_offset, num_trigrams * sizeof( trigram_offset[0] ) );
 #endif /* SWISHXX_WRITE_HEADER */
 
 #ifdef SWISHXX_REWRITE_HEADER
@@ -86,12 +118,33 @@
       num_meta_names * sizeof( meta_name_offset[0] )
     );
   }
+  if ( num_bigrams ) {
+    o.seekp( bigram_offset_pos );
+    my_write( o, bigram_offset, num_bigrams * sizeof( bigram_offset[0] ) );
+  }
+  //
+  // The reversed-word segment's entries are the word entries themselves, just
+  // in a different order.
+  //
+  for ( unsigned long i = 0; i < num_unique_words; ++i )
+    reversed_offset[i] = word_offset[ reversed_words[i] ];
+  o.seekp( reversed_offset_pos );
+  my_write( o, reversed_offset,
+    num_unique_words * sizeof( reversed_offset[0] )
+  );
+  if ( num_trigrams ) {
+    o.seekp( trigram_offset_pos );
+    my_write( o, trigram_offset, num_trigrams * sizeof( trigram_offset[0] ) );
+  }
 
   delete[] word_offset;
   delete[] stop_word_offset;
   delete[] dir_offset;
   delete[] file_offset;
   delete[] meta_name_offset;
+  delete[] bigram_offset;
+  delete[] reversed_offset;
+  delete[] trigram_offset;
 #endif /* SWISHXX_REWRITE_HEADER */
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -26,12 +26,41 @@ using namespace PJL;
 
 ///////////////////////////////////////////////////////////////////////////////
 
+index_segment::index_segment( index_segment const &from,
+                              std::vector<size_type> const &entries ) :
+  begin_( from.begin_ ), num_entries_( entries.size() )
+{
+  subset_offset_.reserve( entries.size() );
+  for ( auto const i : entries )
+    subset_offset_.push_back( from.offset_[i] );
+  offset_ = subset_offset_.data();
+}
+
+index_segment& index_segment::operator=( index_segment const &from ) {
+  begin_ = from.begin_;
+  num_entries_ = from.num_entries_;
+  subset_offset_ = from.subset_offset_;
+  offset_ = subset_offset_.empty() ? from.offset_ : subset_offset_.data();
+  return *this;
+}
+
 void index_segment::set_index_file( mmap_file const &file, segment_id id ) {
   auto c = begin_ = file.begin();
   auto p = reinterpret_cast<size_type const*>( c );
   num_entries_ = p[0];
+  //
+  // All the segment headers precede the first word's entry, so if we get that
+  // far, the index was written without the requested (optional) segment.
+  //
+  auto const first_word = id > isi_meta_name ?
+    c + reinterpret_cast<off_t const*>( &p[1] )[0] : file.end();
   for ( int i = id; i > 0; --i ) {
     c += sizeof( num_entries_ ) + num_entries_ * sizeof( off_t );
+    if ( c >= first_word ) {
+      num_entries_ = 0;
+      offset_ = nullptr;
+      return;
+    }
     p = reinterpret_cast<size_type const*>( c );
     num_entries_ = p[0];
   } // for
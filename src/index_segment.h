@@ -28,13 +28,15 @@
 // standard
 #include <cstddef>                      /* for ptrdiff_t */
 #include <iterator>
+#include <vector>
 #include <sys/types.h>                  /* for off_t */
 
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
- * An %index_segment is used to access either the word, stop-word, file, or
- * meta-name index portions of a generated index.
+ * An %index_segment is used to access either the word, stop-word, file,
+ * meta-name, bigram, reversed-word, or trigram index portions of a generated
+ * index.  It can also be a subset of the entries of another segment.
  *
  * By implementing fully-blown random access iterators for it, the STL
  * algorithms work, in particular binary_search() and equal_range() that are
@@ -55,17 +57,35 @@ public:
     isi_stop_word = 1,
     isi_dir       = 2,
     isi_file      = 3,
-    isi_meta_name = 4
+    isi_meta_name = 4,
+    isi_bigram    = 5,                  // optional: may be empty
+    isi_reversed  = 6,                  // optional: may be empty
+    isi_trigram   = 7                   // optional: may be empty
   };
 
   ////////// constructors /////////////////////////////////////////////////////
 
-  index_segment() { }
+  index_segment() : num_entries_( 0 ), offset_( nullptr ) { }
 
   index_segment( PJL::mmap_file const &file, segment_id id ) {
     set_index_file( file, id );
   }
 
+  /**
+   * Constructs an %index_segment of some of the entries of another.
+   *
+   * @param from The segment to take the entries of.
+   * @param entries The indices of the entries to take.
+   */
+  index_segment( index_segment const &from,
+                 std::vector<size_type> const &entries );
+
+  index_segment( index_segment const &from ) {
+    *this = from;
+  }
+
+  index_segment& operator=( index_segment const& );
+
   ////////// member functions /////////////////////////////////////////////////
 
   /**
@@ -78,7 +98,8 @@ public:
    *    parsed until after the instance is constructed.
    *
    * @param file The file to use.
-   * @param id The segment_id to use.
+   * @param id The segment_id to use.  If the index file doesn't have an
+   * optional segment, the segment is empty.
    */
   void set_index_file( PJL::mmap_file const &file, segment_id id );
 
@@ -131,7 +152,7 @@ public:
     }
 
     friend bool operator==( const_iterator const &i, const_iterator const &j ) {
-      return i.i_ == j.i_;
+      return i.i_ == j.i_ && i.index_ == j.index_;
     }
     friend bool operator!=( const_iterator const &i, const_iterator const &j ) {
       return !( i == j );
@@ -170,6 +191,7 @@ private:
   PJL::mmap_file::const_iterator  begin_;
   size_type                       num_entries_;
   off_t const                    *offset_;
+  std::vector<off_t>              subset_offset_; // used only for a subset
 };
 
 ///////////////////////////////////////////////////////////////////////////////
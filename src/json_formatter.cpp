@@ -0,0 +1,117 @@
+/*
+**      SWISH++
+**      src/json_formatter.cpp
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+// local
+#include "config.h"
+#include "file_info.h"
+#include "index_segment.h"
+#include "json_formatter.h"
+
+using namespace std;
+
+extern thread_local index_segment directories;
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Writes a string escaped for use within a JSON string: \c '"' and \c '\\' are
+ * preceded by a \c '\\' and control characters are replaced by \c \\uXXXX
+ * escapes.  Since text in an index is ISO 8859-1, characters beyond ASCII are
+ * also replaced by \c \\uXXXX escapes so the output is always valid UTF-8.
+ *
+ * See also:
+ *    Tim Bray.  "The JavaScript Object Notation (JSON) Data Interchange
+ *    Format," RFC 8259, section 7, December 2017.
+ *
+ * @param o The ostream to write to.
+ * @param s The string to be escaped.
+ */
+static void json_escape( ostream &o, char const *s ) {
+  static char const hex[] = "0123456789abcdef";
+  for ( char const *run = s; ; ++s ) {
+    unsigned char const c = *s;
+    if ( c >= 0x20 && c < 0x80 && c != '"' && c != '\\' )
+      continue;
+    o.write( run, s - run );
+    if ( !c )
+      return;
+    run = s + 1;
+    switch ( c ) {
+      case '"':
+      case '\\':
+        o << '\\' << static_cast<char>( c );
+        break;
+      case '\n':
+        o << "\\n";
+        break;
+      case '\t':
+        o << "\\t";
+        break;
+      default:
+        char const u[] = {
+          '\\', 'u', '0', '0', hex[ c >> 4 ], hex[ c & 0xF ]
+        };
+        o.write( u, sizeof u );
+    } // switch
+  } // for
+}
+
+////////// member functions ///////////////////////////////////////////////////
+
+json_formatter::~json_formatter() {
+  // do nothing
+}
+
+void json_formatter::pre( stop_word_set const &stop_words ) const {
+  out_ << "{\n";
+  if ( !stop_words.empty() ) {
+    out_ << "  \"ignored\": [";
+    char const *sep = " \"";
+    for ( auto const &word : stop_words ) {
+      out_ << sep;
+      json_escape( out_, word.c_str() );
+      out_ << '"';
+      sep = ", \"";
+    } // for
+    out_ << " ],\n";
+  }
+  out_ << "  \"results\": " << results_ << ",\n"
+          "  \"files\": [";
+}
+
+void json_formatter::result( int rank, file_info const &fi ) const {
+  out_ << (first_ ? "\n" : ",\n")
+       << "    { \"rank\": " << rank << ", \"path\": \"";
+  json_escape( out_, directories[ fi.dir_index() ] );
+  out_ << '/';
+  json_escape( out_, fi.file_name() );
+  out_ << "\", \"size\": " << fi.size() << ", \"title\": \"";
+  json_escape( out_, fi.title() );
+  out_ << "\" }";
+  first_ = false;
+}
+
+void json_formatter::post() const {
+  out_ << (first_ ? " ]\n" : "\n  ]\n") << "}\n";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,52 @@
+/*
+**      SWISH++
+**      src/json_formatter.h
+**
+**      Copyright (C) 1998-2015  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef json_formatter_H
+#define json_formatter_H
+
+// local
+#include "results_formatter.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %json_formatter is-a results_formatter for formatting search results in
+ * JSON.  Strings are escaped as they're written so formatting allocates no
+ * memory.
+ */
+class json_formatter : public results_formatter {
+public:
+  json_formatter( std::ostream &o, int results ) :
+    results_formatter( o, results ), first_( true ) { }
+  virtual ~json_formatter();
+
+  virtual void pre( stop_word_set const& ) const;
+  virtual void result( int rank, file_info const& ) const;
+  virtual void post() const;
+
+private:
+  mutable bool first_;                  // is the next result the first?
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* json_formatter_H */
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,183 @@
+/*
+**      PJL C++ Library
+**      event_count.cpp
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+// local
+#include "event_count.h"
+
+// standard
+#include <cerrno>
+#ifdef HAVE_LINUX_FUTEX_H
+#include <climits>                      /* for INT_MAX */
+#include <linux/futex.h>
+#include <sys/syscall.h>                /* for SYS_futex */
+#include <time.h>                       /* for timespec */
+#include <unistd.h>                     /* for syscall(2) */
+#else
+#include <sys/time.h>                   /* for gettimeofday(2) */
+#endif /* HAVE_LINUX_FUTEX_H */
+
+namespace PJL {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Stops waiting (or preparing to): counts the calling thread as no longer
+ * waiting and, if any have been woken, as one of those.  (A thread that stops
+ * waiting because it timed out may not actually have been woken, but that
+ * only makes a later notify wake a thread unnecessarily.)
+ */
+void event_count::end_wait() {
+  state_type s = state_.load( std::memory_order_relaxed );
+  state_type t;
+  do {
+    state_type const waiters = (s & (Woken - 1)) - 1;
+    state_type woken = s >> 32;
+    if ( woken )
+      --woken;
+    if ( woken > waiters )
+      woken = waiters;
+    t = woken << 32 | waiters;
+  } while ( !state_.compare_exchange_weak( s, t, std::memory_order_relaxed ) );
+}
+
+/**
+ * Counts waiting threads as woken.
+ *
+ * @param all If \c true, counts all of them; otherwise only one.
+ * @return Returns \c true only if there were any waiting threads not already
+ * woken, i.e., if a thread actually needs to be woken.
+ */
+bool event_count::wake( bool all ) {
+  //
+  // The fence pairs with the one implied by the increment in prepare_wait():
+  // either this sees the waiter or the waiter sees the condition that was
+  // made true before this was called.
+  //
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+  state_type s = state_.load( std::memory_order_relaxed );
+  state_type t;
+  do {
+    state_type const waiters = s & (Woken - 1);
+    if ( (s >> 32) >= waiters )
+      return false;
+    t = all ? waiters << 32 | waiters : s + Woken;
+  } while ( !state_.compare_exchange_weak( s, t, std::memory_order_relaxed ) );
+  __atomic_add_fetch( &epoch_, 1, __ATOMIC_SEQ_CST );
+  return true;
+}
+
+#ifdef HAVE_LINUX_FUTEX_H
+
+event_count::event_count() : epoch_( 0 ), state_( 0 ) {
+}
+
+event_count::~event_count() {
+  // do nothing
+}
+
+void event_count::notify( bool all ) {
+  if ( !wake( all ) )
+    return;
+  ::syscall(
+    SYS_futex, &epoch_, FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1,
+    nullptr, nullptr, 0
+  );
+}
+
+bool event_count::wait( key_type key, int timeout_ms ) {
+  struct timespec ts, *pts = nullptr;
+  if ( timeout_ms >= 0 ) {
+    ts.tv_sec  = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    pts = &ts;
+  }
+  //
+  // If epoch_ is no longer equal to key, the futex returns immediately.
+  //
+  bool const timed_out = ::syscall(
+    SYS_futex, &epoch_, FUTEX_WAIT_PRIVATE, key, pts, nullptr, 0
+  ) == -1 && errno == ETIMEDOUT;
+  end_wait();
+  return !timed_out;
+}
+
+#else /* HAVE_LINUX_FUTEX_H */
+
+event_count::event_count() : epoch_( 0 ), state_( 0 ) {
+  ::pthread_mutex_init( &lock_, nullptr );
+  ::pthread_cond_init( &cond_, nullptr );
+}
+
+event_count::~event_count() {
+  ::pthread_cond_destroy( &cond_ );
+  ::pthread_mutex_destroy( &lock_ );
+}
+
+void event_count::notify( bool all ) {
+  if ( !wake( all ) )
+    return;
+  //
+  // The epoch was incremented without the lock, but a waiter checks it with
+  // the lock held until it's waiting, so the broadcast below can't be missed.
+  // A signal isn't enough even for notify_one(): it could wake a thread that
+  // began waiting after the increment (and so would just wait again) rather
+  // than one that began before.
+  //
+  (void)all;
+  ::pthread_mutex_lock( &lock_ );
+  ::pthread_cond_broadcast( &cond_ );
+  ::pthread_mutex_unlock( &lock_ );
+}
+
+bool event_count::wait( key_type key, int timeout_ms ) {
+  struct timespec future;
+  if ( timeout_ms >= 0 ) {
+    struct timeval now;
+    ::gettimeofday( &now, nullptr );
+    long const ns = now.tv_usec * 1000L + (timeout_ms % 1000) * 1000000L;
+    future.tv_sec  = now.tv_sec + timeout_ms / 1000 + ns / 1000000000L;
+    future.tv_nsec = ns % 1000000000L;
+  }
+  bool timed_out = false;
+  //
+  // Waiting on a condition is a cancellation point, so ensure the mutex is
+  // unlocked even if the thread is cancelled.
+  //
+  pthread_cleanup_push( (void (*)(void*))::pthread_mutex_unlock, &lock_ );
+  ::pthread_mutex_lock( &lock_ );
+  while ( __atomic_load_n( &epoch_, __ATOMIC_SEQ_CST ) == key && !timed_out ) {
+    if ( timeout_ms < 0 )
+      ::pthread_cond_wait( &cond_, &lock_ );
+    else
+      timed_out =
+        ::pthread_cond_timedwait( &cond_, &lock_, &future ) == ETIMEDOUT;
+  } // while
+  pthread_cleanup_pop( 1 );
+  end_wait();
+  return !timed_out;
+}
+
+#endif /* HAVE_LINUX_FUTEX_H */
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace PJL
+/* vim:set et sw=2 ts=2: */
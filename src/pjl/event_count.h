@@ -0,0 +1,149 @@
+/*
+**      PJL C++ Library
+**      event_count.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef event_count_H
+#define event_count_H
+
+// local
+#include "config.h"
+
+// standard
+#include <atomic>
+#include <cstdint>
+#ifndef HAVE_LINUX_FUTEX_H
+#include <pthread.h>
+#endif /* HAVE_LINUX_FUTEX_H */
+
+namespace PJL {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An %event_count lets threads wait for a condition that's checked without a
+ * lock (such as an mpmc_queue not being empty) without the condition being
+ * signalled ever being missed.  A thread waits like:
+ * \code
+ *    while ( !condition() ) {
+ *      event_count::key_type const key = ec.prepare_wait();
+ *      if ( condition() ) {
+ *        ec.cancel_wait();
+ *        break;
+ *      }
+ *      ec.wait( key, -1 );
+ *    }
+ * \endcode
+ * and a thread that makes the condition true calls notify_one() (or
+ * notify_all()) afterwards.  If the condition became true after the key was
+ * gotten, wait() returns immediately.  Notifying when no thread is waiting
+ * costs only a memory fence and an atomic load; so does notifying when every
+ * waiting thread has already been woken but not yet run, so a producer that
+ * makes the condition true repeatedly doesn't make a system call each time.
+ *
+ * On Linux, threads wait via a futex(2) directly; elsewhere, via a condition
+ * variable.
+ *
+ * See also:
+ *    Dmitry Vyukov.  "Eventcount," comp.programming.threads, 2008.
+ */
+class event_count {
+public:
+  typedef unsigned key_type;
+
+  event_count();
+  ~event_count();
+
+  /**
+   * Stops preparing to wait because the condition became true in the
+   * meantime.
+   */
+  void cancel_wait() {
+    end_wait();
+  }
+
+  /**
+   * Wakes up at most one waiting thread.
+   */
+  void notify_one() {
+    notify( false );
+  }
+
+  /**
+   * Wakes up all waiting threads.
+   */
+  void notify_all() {
+    notify( true );
+  }
+
+  /**
+   * Prepares to wait: the condition must be checked again after this and,
+   * only if still false, wait() called; otherwise cancel_wait() must be
+   * called.
+   *
+   * @return Returns the key to pass to wait().
+   */
+  key_type prepare_wait() {
+    state_.fetch_add( 1, std::memory_order_seq_cst );
+    return __atomic_load_n( &epoch_, __ATOMIC_SEQ_CST );
+  }
+
+  /**
+   * Waits until notified (or the time-out expires).
+   *
+   * @param key The key returned by prepare_wait().
+   * @param timeout_ms The maximum number of milliseconds to wait or -1 to
+   * wait indefinitely.
+   * @return Returns \c false only if the time-out expired.  (A spurious
+   * wake-up is possible, so the condition must always be checked again.)
+   */
+  bool wait( key_type key, int timeout_ms );
+
+private:
+  //
+  // The state is the number of threads preparing to or waiting (in the low 32
+  // bits) and the number of those that have been woken but not yet stopped
+  // waiting (in the high 32 bits), the latter never exceeding the former.  They
+  // are in one word so they can be updated together.
+  //
+  typedef std::uint64_t state_type;
+  static state_type const Waiter = 1;
+  static state_type const Woken  = state_type(1) << 32;
+
+  unsigned                epoch_;       // incremented by each notify
+  std::atomic<state_type> state_;
+#ifndef HAVE_LINUX_FUTEX_H
+  pthread_mutex_t       lock_;
+  pthread_cond_t        cond_;
+#endif /* HAVE_LINUX_FUTEX_H */
+
+  void end_wait();
+  void notify( bool all );
+  bool wake( bool all );
+
+  event_count( event_count const& ) = delete;
+  event_count& operator=( event_count const& ) = delete;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace PJL
+
+#endif /* event_count_H */
+/* vim:set et sw=2 ts=2: */
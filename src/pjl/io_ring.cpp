@@ -0,0 +1,278 @@
+/*
+**      PJL C++ Library
+**      io_ring.cpp
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+// local
+#include "io_ring.h"
+
+#ifdef HAVE_IO_RING
+
+// standard
+#include <algorithm>                    /* for max() */
+#include <cerrno>
+#include <cstring>                      /* for memset(3) */
+#include <sys/mman.h>                   /* for mmap(2) */
+#include <sys/syscall.h>                /* for SYS_io_uring_* */
+#include <unistd.h>                     /* for close(2), syscall(2) */
+
+using namespace std;
+
+namespace PJL {
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Maps anonymous memory.
+ *
+ * @param size The number of bytes to map.
+ * @return Returns a pointer to the memory or null on failure.
+ */
+static void* mmap_anonymous( size_t size ) {
+  void *const p = ::mmap(
+    nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+  );
+  return p == MAP_FAILED ? nullptr : p;
+}
+
+/**
+ * Gets a pointer to an offset within memory.
+ *
+ * @tparam T The type to point to.
+ * @param base The start of the memory.
+ * @param offset The offset in bytes.
+ * @return Returns said pointer.
+ */
+template<typename T>
+inline T* offset_ptr( void *base, unsigned offset ) {
+  return reinterpret_cast<T*>( static_cast<char*>( base ) + offset );
+}
+
+////////// member functions ///////////////////////////////////////////////////
+
+io_ring::io_ring( unsigned entries ) :
+  fd_( -1 ), error_( 0 ),
+  rings_( MAP_FAILED ), rings_size_( 0 ),
+  sqes_( static_cast<sqe_type*>( MAP_FAILED ) ), sqes_size_( 0 ),
+  sqe_tail_( 0 ),
+  buffers_( nullptr ), buffers_count_( 0 ), buffer_size_( 0 )
+{
+  //
+  // Since an %io_ring is used by only one thread, ask that completions be
+  // processed only when that thread waits for them rather than interrupting
+  // it; older kernels don't support that, so try without.
+  //
+  static unsigned const setup_flags[] = {
+#if defined( IORING_SETUP_SINGLE_ISSUER ) && defined( IORING_SETUP_DEFER_TASKRUN )
+    IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN,
+#endif
+    IORING_SETUP_COOP_TASKRUN,
+    0
+  };
+  struct io_uring_params p;
+  int fd = -1;
+  for ( unsigned const flags : setup_flags ) {
+    ::memset( &p, 0, sizeof p );
+    p.flags = flags;
+    fd = static_cast<int>( ::syscall( SYS_io_uring_setup, entries, &p ) );
+    if ( fd != -1 || errno != EINVAL )
+      break;
+  } // for
+  if ( fd == -1 ) {
+    error_ = errno;
+    return;
+  }
+  //
+  // Both rings must be in a single mapping, completions must never be
+  // dropped, and waiting must be able to time out.
+  //
+  unsigned const needed =
+    IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+  if ( (p.features & needed) != needed ) {
+    ::close( fd );
+    error_ = ENOSYS;
+    return;
+  }
+
+  rings_size_ = max(
+    p.sq_off.array + p.sq_entries * sizeof( unsigned ),
+    p.cq_off.cqes  + p.cq_entries * sizeof( cqe_type )
+  );
+  rings_ = ::mmap(
+    nullptr, rings_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+    fd, IORING_OFF_SQ_RING
+  );
+  if ( rings_ == MAP_FAILED ) {
+    error_ = errno;
+    ::close( fd );
+    return;
+  }
+  sqes_size_ = p.sq_entries * sizeof( sqe_type );
+  sqes_ = static_cast<sqe_type*>( ::mmap(
+    nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+    fd, IORING_OFF_SQES
+  ) );
+  if ( sqes_ == MAP_FAILED ) {
+    error_ = errno;
+    ::munmap( rings_, rings_size_ );
+    rings_ = MAP_FAILED;
+    ::close( fd );
+    return;
+  }
+
+  sq_head_    = offset_ptr<unsigned>( rings_, p.sq_off.head );
+  sq_tail_    = offset_ptr<unsigned>( rings_, p.sq_off.tail );
+  sq_array_   = offset_ptr<unsigned>( rings_, p.sq_off.array );
+  sq_mask_    = *offset_ptr<unsigned>( rings_, p.sq_off.ring_mask );
+  sq_entries_ = p.sq_entries;
+  sqe_tail_   = *sq_tail_;
+
+  cq_head_    = offset_ptr<unsigned>( rings_, p.cq_off.head );
+  cq_tail_    = offset_ptr<unsigned>( rings_, p.cq_off.tail );
+  cq_mask_    = *offset_ptr<unsigned>( rings_, p.cq_off.ring_mask );
+  cqes_       = offset_ptr<cqe_type>( rings_, p.cq_off.cqes );
+
+  fd_ = fd;
+}
+
+io_ring::~io_ring() {
+  if ( buffers_ )
+    ::munmap( buffers_, buffers_count_ * buffer_size_ );
+  if ( sqes_ != MAP_FAILED )
+    ::munmap( sqes_, sqes_size_ );
+  if ( rings_ != MAP_FAILED )
+    ::munmap( rings_, rings_size_ );
+  if ( fd_ != -1 )
+    ::close( fd_ );
+}
+
+int io_ring::enter( unsigned to_submit, unsigned min_complete, unsigned flags,
+                    void const *arg, size_t arg_size ) {
+  return static_cast<int>( ::syscall(
+    SYS_io_uring_enter, fd_, to_submit, min_complete, flags, arg, arg_size
+  ) );
+}
+
+/**
+ * Makes all the submission queue entries obtained so far visible to the
+ * kernel.
+ *
+ * @return Returns the number of entries not yet submitted.
+ */
+unsigned io_ring::flush_sqes() {
+  unsigned tail = *sq_tail_;
+  for ( ; tail != sqe_tail_; ++tail )
+    sq_array_[ tail & sq_mask_ ] = tail & sq_mask_;
+  __atomic_store_n( sq_tail_, tail, __ATOMIC_RELEASE );
+  return tail - __atomic_load_n( sq_head_, __ATOMIC_ACQUIRE );
+}
+
+io_ring::sqe_type* io_ring::get_sqe() {
+  if ( sqe_tail_ - __atomic_load_n( sq_head_, __ATOMIC_ACQUIRE ) >=
+       sq_entries_ ) {
+    if ( submit() == -1 ||
+         sqe_tail_ - __atomic_load_n( sq_head_, __ATOMIC_ACQUIRE ) >=
+         sq_entries_ ) {
+      return nullptr;
+    }
+  }
+  sqe_type *const sqe = &sqes_[ sqe_tail_++ & sq_mask_ ];
+  ::memset( sqe, 0, sizeof *sqe );
+  return sqe;
+}
+
+int io_ring::provide_buffers( unsigned count, size_t size ) {
+  buffers_ = static_cast<char*>( mmap_anonymous( count * size ) );
+  if ( !buffers_ )
+    return errno;
+  buffers_count_ = count;
+  buffer_size_ = size;
+
+  sqe_type *const sqe = get_sqe();
+  sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+  sqe->fd = static_cast<int>( count );
+  sqe->addr = reinterpret_cast<unsigned long>( buffers_ );
+  sqe->len = static_cast<unsigned>( size );
+  sqe->user_data = Internal_Data;
+  //
+  // Wait for the result here since it's the only request.
+  //
+  unsigned const to_submit = flush_sqes();
+  if ( enter( to_submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0 ) == -1 )
+    return errno;
+  unsigned const head = *cq_head_;
+  int const result = cqes_[ head & cq_mask_ ].res;
+  __atomic_store_n( cq_head_, head + 1, __ATOMIC_RELEASE );
+  return result < 0 ? -result : 0;
+}
+
+void io_ring::recycle( unsigned id ) {
+  sqe_type *const sqe = get_sqe();
+  if ( !sqe )
+    return;
+  sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+  sqe->fd = 1;
+  sqe->addr = reinterpret_cast<unsigned long>( buffers_ + id * buffer_size_ );
+  sqe->len = static_cast<unsigned>( buffer_size_ );
+  sqe->off = id;
+  sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+  sqe->user_data = Internal_Data;
+}
+
+int io_ring::submit() {
+  unsigned const to_submit = flush_sqes();
+  if ( !to_submit )
+    return 0;
+  int const n = enter( to_submit, 0, 0, nullptr, 0 );
+  if ( n == -1 && (errno == EINTR || errno == EAGAIN || errno == EBUSY) )
+    return 0;                           // try again next time
+  return n;
+}
+
+int io_ring::wait( int timeout_ms ) {
+  struct __kernel_timespec ts;
+  struct io_uring_getevents_arg arg;
+  ::memset( &arg, 0, sizeof arg );
+  if ( timeout_ms >= 0 ) {
+    ts.tv_sec  = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    arg.ts = reinterpret_cast<unsigned long>( &ts );
+  }
+  unsigned const to_submit = flush_sqes();
+  if ( enter( to_submit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+              &arg, sizeof arg ) == -1 ) {
+    switch ( errno ) {
+      case EAGAIN:
+      case EBUSY:
+      case EINTR:
+      case ETIME:
+        break;
+      default:
+        return -1;
+    }
+  }
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace PJL
+
+#endif /* HAVE_IO_RING */
+/* vim:set et sw=2 ts=2: */
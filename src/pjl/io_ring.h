@@ -0,0 +1,216 @@
+/*
+**      PJL C++ Library
+**      io_ring.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef io_ring_H
+#define io_ring_H
+
+// local
+#include "config.h"
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+//
+// Multishot accept arrived in Linux 5.19, so require a header at least that
+// recent.
+//
+#ifdef IORING_ACCEPT_MULTISHOT
+#define HAVE_IO_RING 1
+#endif
+#endif /* HAVE_LINUX_IO_URING_H */
+
+#ifdef HAVE_IO_RING
+
+// standard
+#include <cstddef>                      /* for size_t */
+
+namespace PJL {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An %io_ring is a thin wrapper around a Linux io_uring(7) instance that's
+ * used directly via its system calls (so liburing isn't needed).  Submission
+ * queue entries are obtained via get_sqe(), filled in, and submitted en masse
+ * by either submit() or wait(); completion queue entries are then consumed via
+ * for_each_cqe().
+ *
+ * An %io_ring can optionally have a set of provided buffers (buffer group 0)
+ * for requests that set \c IOSQE_BUFFER_SELECT: the kernel picks a buffer only
+ * once there's data to put into it.
+ *
+ * An %io_ring is not thread-safe.
+ */
+class io_ring {
+public:
+  typedef struct io_uring_sqe sqe_type;
+  typedef struct io_uring_cqe cqe_type;
+
+  /**
+   * Constructs an %io_ring.  If the kernel doesn't support io_uring (or the
+   * features needed), the %io_ring is invalid.
+   *
+   * @param entries The number of submission queue entries (a power of 2).
+   */
+  explicit io_ring( unsigned entries );
+
+  ~io_ring();
+
+  /**
+   * Gets the address of a provided buffer.
+   *
+   * @param id The buffer's ID as given by a completion queue entry.
+   * @return Returns said address.
+   */
+  char const* buffer( unsigned id ) const {
+    return buffers_ + id * buffer_size_;
+  }
+
+  /**
+   * Gets the error that occurred setting up this %io_ring, if any.
+   *
+   * @return Returns said error or 0 if none.
+   */
+  int error() const {
+    return error_;
+  }
+
+  /**
+   * Calls a function for each available completion queue entry and consumes
+   * them.  Completions of the %io_ring's own requests are skipped.
+   *
+   * @tparam CompletionFunction The type of function to call: it's given a
+   * <code>cqe_type const&</code>.
+   * @param f The function to call.
+   * @return Returns the number of entries consumed.
+   */
+  template<typename CompletionFunction>
+  unsigned for_each_cqe( CompletionFunction f );
+
+  /**
+   * Gets a cleared submission queue entry, submitting those obtained so far
+   * first if the queue is full.
+   *
+   * @return Returns said entry or null if none could be obtained.
+   */
+  sqe_type* get_sqe();
+
+  /**
+   * Sets up provided buffers as buffer group 0.  This must be called before
+   * any other requests are submitted.
+   *
+   * @param count The number of buffers.
+   * @param size The size of each buffer.
+   * @return Returns 0 on success or an error code otherwise.
+   */
+  int provide_buffers( unsigned count, size_t size );
+
+  /**
+   * Gives a provided buffer back to the kernel once its contents have been
+   * used.  This is done by a request submitted along with the others.
+   *
+   * @param id The buffer's ID.
+   */
+  void recycle( unsigned id );
+
+  /**
+   * Submits all the submission queue entries obtained so far.
+   *
+   * @return Returns the number submitted or -1 on error.
+   */
+  int submit();
+
+  /**
+   * Submits all the submission queue entries obtained so far and waits for
+   * at least one completion.
+   *
+   * @param timeout_ms The maximum number of milliseconds to wait or -1 to
+   * wait indefinitely.
+   * @return Returns 0 if at least one entry completed or the wait timed out
+   * or was interrupted; returns -1 on error.
+   */
+  int wait( int timeout_ms );
+
+  /**
+   * Checks whether the %io_ring is valid.
+   *
+   * @return Returns \c true only if so.
+   */
+  explicit operator bool() const {
+    return fd_ != -1;
+  }
+
+private:
+  /**
+   * The user data of the %io_ring's own requests.
+   */
+  static unsigned long long const Internal_Data = ~0ull;
+
+  int         fd_;
+  int         error_;
+
+  void       *rings_;                   // mmap'd SQ and CQ rings
+  size_t      rings_size_;
+  sqe_type   *sqes_;                    // mmap'd SQE array
+  size_t      sqes_size_;
+
+  unsigned   *sq_head_, *sq_tail_, *sq_array_;
+  unsigned    sq_mask_, sq_entries_;
+  unsigned    sqe_tail_;                // next SQE to hand out
+
+  unsigned   *cq_head_, *cq_tail_;
+  unsigned    cq_mask_;
+  cqe_type   *cqes_;
+
+  char       *buffers_;
+  unsigned    buffers_count_;
+  size_t      buffer_size_;
+
+  int enter( unsigned to_submit, unsigned min_complete, unsigned flags,
+             void const *arg, size_t arg_size );
+  unsigned flush_sqes();
+
+  io_ring( io_ring const& ) = delete;
+  io_ring& operator=( io_ring const& ) = delete;
+};
+
+////////// inlines ////////////////////////////////////////////////////////////
+
+template<typename CompletionFunction>
+unsigned io_ring::for_each_cqe( CompletionFunction f ) {
+  unsigned head = *cq_head_;
+  unsigned const tail = __atomic_load_n( cq_tail_, __ATOMIC_ACQUIRE );
+  unsigned const n = tail - head;
+  for ( ; head != tail; ++head ) {
+    cqe_type const &cqe = cqes_[ head & cq_mask_ ];
+    if ( cqe.user_data != Internal_Data )
+      f( cqe );
+  } // for
+  __atomic_store_n( cq_head_, head, __ATOMIC_RELEASE );
+  return n;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace PJL
+
+#endif /* HAVE_IO_RING */
+#endif /* io_ring_H */
+/* vim:set et sw=2 ts=2: */
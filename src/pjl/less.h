@@ -71,6 +71,40 @@ private:
   size_type const n_;
 };
 
+template<typename T> struct less_reversed_n;
+
+/**
+ * A %less_reversed_n is-a less&lt;char const*&gt; that compares C-style
+ * strings as if they were spelled backwards, but only for a certain maximum
+ * length (from the end).  It's used to find all the words having a given
+ * suffix.
+ */
+template<>
+struct less_reversed_n<char const*> : less<char const*> {
+  typedef size_t size_type;
+
+  less_reversed_n( size_type max_len = ~0u ) : n_( max_len ) { }
+
+  result_type operator()( first_argument_type i,
+                          second_argument_type j ) const {
+    auto i_end = i + std::strlen( i ), j_end = j + std::strlen( j );
+    for ( size_type n = n_; n > 0; --n ) {
+      if ( j_end == j )
+        return false;
+      if ( i_end == i )
+        return true;
+      auto const ci = static_cast<unsigned char>( *--i_end );
+      auto const cj = static_cast<unsigned char>( *--j_end );
+      if ( ci != cj )
+        return ci < cj;
+    } // for
+    return false;
+  }
+
+private:
+  size_type const n_;
+};
+
 } // namespace std
 
 ///////////////////////////////////////////////////////////////////////////////
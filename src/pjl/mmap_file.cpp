@@ -24,12 +24,15 @@
 
 // standard
 #include <cerrno>
+#include <cstdint>                      /* for uintptr_t */
+#include <cstring>                      /* for memcpy(3) */
 #include <fcntl.h>                      /* for open(2), O_RDONLY, etc */
 #include <time.h>                       /* needed by sys/resource.h */
 #include <sys/time.h>                   /* needed by FreeBSD systems */
 #include <sys/resource.h>               /* for get/setrlimit(2) */
 #include <sys/stat.h>                   /* for stat(2) */
-#include <unistd.h>                     /* for close(2) */
+#include <unistd.h>                     /* for close(2), sysconf(3) */
+#include <vector>
 #if defined( MULTI_THREADED ) && defined( RLIMIT_VMEM )
 #include <pthread.h>
 #endif
@@ -74,6 +77,173 @@ int mmap_file::behavior( behavior_type behavior ) const {
   return 0;
 }
 
+/**
+ * Widens part of a file to the pages containing it.
+ *
+ * @param part A pointer to the first byte of the part.  On return, it is the
+ * start of the first page.
+ * @param n The number of bytes in the part.  On return, it is the number of
+ * bytes in all the pages.
+ */
+static void to_pages( mmap_file::const_pointer *part,
+                      mmap_file::size_type *n ) {
+  auto const page_size = mmap_file::page_size();
+  auto const offset = reinterpret_cast<uintptr_t>( *part ) % page_size;
+  *part -= offset;
+  *n += offset;
+}
+
+int mmap_file::behavior( behavior_type behavior, const_pointer part,
+                         size_type n ) const {
+#if defined( HAVE_MADVISE ) && !defined( __APPLE__ )
+  to_pages( &part, &n );
+  if ( ::madvise( const_cast<char*>( part ), n, behavior ) == -1 )
+    return errno;
+#else
+  (void)behavior;
+  (void)part;
+  (void)n;
+#endif /* HAVE_MADVISE && !__APPLE__ */
+  return 0;
+}
+
+mmap_file::size_type mmap_file::huge_page_size() {
+#ifdef MADV_HUGEPAGE
+  static size_type size;
+  if ( !size ) {
+    ifstream sys( "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size" );
+    if ( !(sys >> size) )
+      size = 2 * 1024 * 1024;           // the most common size
+  }
+  return size;
+#else
+  return 0;
+#endif /* MADV_HUGEPAGE */
+}
+
+#ifdef MADV_HUGEPAGE
+/**
+ * Maps memory at an address that's a multiple of \a align by reserving enough
+ * to contain an aligned address and then unmapping the surplus.
+ *
+ * @param size The number of bytes to map.
+ * @param align The alignment: must be a multiple of the page size.
+ * @param prot The protection, as for mmap(2).
+ * @param flags The flags, as for mmap(2).
+ * @param fd The file descriptor to map or -1 for anonymous memory.
+ * @return Returns the address or \c MAP_FAILED on failure.
+ */
+static void* mmap_aligned( size_t size, size_t align, int prot, int flags,
+                           int fd ) {
+  size_t const reserved = size + align;
+  auto const addr = static_cast<char*>(
+    ::mmap( nullptr, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 )
+  );
+  if ( addr == MAP_FAILED )
+    return MAP_FAILED;
+  auto const aligned = reinterpret_cast<char*>(
+    (reinterpret_cast<uintptr_t>( addr ) + align - 1) & ~(align - 1)
+  );
+  if ( ::mmap( aligned, size, prot, flags | MAP_FIXED, fd, 0 ) == MAP_FAILED ) {
+    int const mmap_errno = errno;
+    ::munmap( addr, reserved );
+    errno = mmap_errno;
+    return MAP_FAILED;
+  }
+
+  //
+  // Unmap the surplus before and after (rounded up to a page) the aligned
+  // mapping so that unmapping just size bytes later unmaps everything.
+  //
+  auto const page_size = mmap_file::page_size();
+  auto const end = aligned + (size + page_size - 1) / page_size * page_size;
+  if ( aligned > addr )
+    ::munmap( addr, aligned - addr );
+  if ( addr + reserved > end )
+    ::munmap( end, addr + reserved - end );
+  return aligned;
+}
+#endif /* MADV_HUGEPAGE */
+
+int mmap_file::huge_pages( bool copy ) {
+#ifdef MADV_HUGEPAGE
+  if ( !addr_ )
+    return EINVAL;
+  auto const align = huge_page_size();
+  void *const addr = copy ?
+    mmap_aligned(
+      size_, align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1
+    ) :
+    mmap_aligned( size_, align, PROT_READ, MAP_SHARED, fd_ );
+  if ( addr == MAP_FAILED )
+    return errno;
+
+  //
+  // Advise before copying so the copy faults in huge pages directly rather
+  // than waiting for them to be collapsed later.
+  //
+  if ( ::madvise( static_cast<caddr_t>( addr ), size_, MADV_HUGEPAGE ) == -1 ) {
+    int const madvise_errno = errno;
+    ::munmap( static_cast<char*>( addr ), size_ );
+    return madvise_errno;
+  }
+  if ( copy ) {
+    ::memcpy( addr, addr_, size_ );
+    ::mprotect( addr, size_, PROT_READ );
+  }
+
+  ::munmap( static_cast<char*>( addr_ ), size_ );
+  addr_ = addr;
+  return 0;
+#else
+  (void)copy;
+  return ENOSYS;
+#endif /* MADV_HUGEPAGE */
+}
+
+int mmap_file::lock( const_pointer part, size_type n ) const {
+#ifdef HAVE_MLOCK
+  to_pages( &part, &n );
+  if ( ::mlock( part, n ) == -1 )
+    return errno;
+  return 0;
+#else
+  (void)part;
+  (void)n;
+  return ENOSYS;
+#endif /* HAVE_MLOCK */
+}
+
+mmap_file::size_type mmap_file::page_size() {
+  static size_type const size = ::sysconf( _SC_PAGESIZE );
+  return size;
+}
+
+mmap_file::size_type mmap_file::resident( const_pointer part,
+                                          size_type n ) const {
+#ifdef HAVE_MINCORE
+  to_pages( &part, &n );
+  auto const page_size = mmap_file::page_size();
+  vector<unsigned char> pages( (n + page_size - 1) / page_size );
+#ifdef __linux__
+  typedef unsigned char *mincore_vec;   // Linux differs from BSD
+#else
+  typedef char *mincore_vec;
+#endif /* __linux__ */
+  if ( ::mincore( const_cast<char*>( part ), n,
+                  reinterpret_cast<mincore_vec>( pages.data() ) ) == -1 )
+    return 0;
+  size_type num_resident = 0;
+  for ( auto const page : pages )
+    num_resident += page & 1;
+  return num_resident;
+#else
+  (void)part;
+  (void)n;
+  return 0;
+#endif /* HAVE_MINCORE */
+}
+
 void mmap_file::close() {
   if ( addr_ )
     ::munmap( static_cast<char*>( addr_ ), size_ );
@@ -75,11 +75,13 @@ public:
 #ifdef HAVE_MADVISE
     bt_normal       = MADV_NORMAL,
     bt_random       = MADV_RANDOM,
-    bt_sequential   = MADV_SEQUENTIAL
+    bt_sequential   = MADV_SEQUENTIAL,
+    bt_willneed     = MADV_WILLNEED
 #else
     bt_normal,
     bt_random,
-    bt_sequential
+    bt_sequential,
+    bt_willneed
 #endif /* HAVE_MADVISE */
   };
 
@@ -147,6 +149,67 @@ public:
     return *( begin() + i );
   }
 
+  /**
+   * Gives advice about how part of the file will be accessed.  Unlike
+   * behavior() for the whole file, failure doesn't affect error().
+   *
+   * @param behavior The behavior.
+   * @param part A pointer to the first byte of the part.
+   * @param n The number of bytes in the part.
+   * @return Returns 0 on success or an \c errno value on failure.
+   */
+  int behavior( behavior_type behavior, const_pointer part, size_type n ) const;
+
+  /**
+   * Gets the size of a (transparent) huge page of memory.
+   *
+   * @return Returns said size or 0 if huge pages aren't supported.
+   */
+  static size_type huge_page_size();
+
+  /**
+   * Requests that the file's memory be backed by (transparent) huge pages so
+   * that accessing it randomly incurs far fewer TLB misses.
+   *
+   * @param copy If \c false, the file is remapped at an address aligned to a
+   * huge page and its mapping is advised to use huge pages: whether it does
+   * depends on the kernel and filesystem supporting huge pages for the page
+   * cache.  If \c true, the file is instead copied into anonymous memory
+   * (that always supports huge pages if any memory does): its memory is then
+   * no longer shared with other processes mapping the same file.
+   * @return Returns 0 on success or an \c errno value on failure (\c ENOSYS if
+   * huge pages aren't supported).  On failure, the file remains mapped as it
+   * was.
+   */
+  int huge_pages( bool copy );
+
+  /**
+   * Locks part of the file into memory (via mlock(2)) so it won't be paged
+   * out.
+   *
+   * @param part A pointer to the first byte of the part.
+   * @param n The number of bytes in the part.
+   * @return Returns 0 on success or an \c errno value on failure.
+   */
+  int lock( const_pointer part, size_type n ) const;
+
+  /**
+   * Gets the size of a page of memory.
+   *
+   * @return Returns said size.
+   */
+  static size_type page_size();
+
+  /**
+   * Counts how many of the pages of part of the file are resident in memory
+   * (via mincore(2)).
+   *
+   * @param part A pointer to the first byte of the part.
+   * @param n The number of bytes in the part.
+   * @return Returns said number or 0 if it can't be determined.
+   */
+  size_type resident( const_pointer part, size_type n ) const;
+
 private:
   void       *addr_;
   int         fd_;                      // Unix file descriptor
@@ -0,0 +1,228 @@
+/*
+**      PJL C++ Library
+**      mpmc_queue.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef mpmc_queue_H
+#define mpmc_queue_H
+
+// standard
+#include <atomic>
+#include <cstddef>                      /* for size_t */
+#include <cstdint>                      /* for intptr_t */
+#include <new>                          /* for placement new */
+#include <type_traits>                  /* for aligned_storage */
+#include <utility>                      /* for move() */
+
+namespace PJL {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An %mpmc_queue is a bounded, lock-free queue for any number of producer and
+ * consumer threads.  Each cell of its ring buffer has a sequence number that
+ * says whether the cell is ready to be pushed into or popped from for a given
+ * position, so a push or pop is just a compare-and-swap of the tail or head
+ * position (plus, if another thread won the race, a retry).
+ *
+ * Neither push() nor pop() ever waits: a push into a full queue or a pop from
+ * an empty one simply fails.  (Waiting is up to the caller: see event_count.)
+ *
+ * See also:
+ *    Dmitry Vyukov.  "Bounded MPMC queue," 1024cores.net, 2010.
+ *
+ * @tparam T The type of value in the queue.
+ */
+template<typename T>
+class mpmc_queue {
+public:
+  typedef T value_type;
+  typedef size_t size_type;
+
+  /**
+   * Constructs an %mpmc_queue.
+   *
+   * @param capacity The maximum number of values the queue can contain.  It
+   * is rounded up to a power of 2.
+   */
+  explicit mpmc_queue( size_type capacity );
+
+  /**
+   * Destroys an %mpmc_queue and any values it still contains.  No other
+   * thread may be using it.
+   */
+  ~mpmc_queue();
+
+  /**
+   * Gets the maximum number of values the queue can contain.
+   *
+   * @return Returns said number.
+   */
+  size_type capacity() const {
+    return mask_ + 1;
+  }
+
+  /**
+   * Pops a value from the front of the queue.
+   *
+   * @param value Set to the value popped, if any.
+   * @return Returns \c true only if a value was popped, i.e., the queue wasn't
+   * empty.
+   */
+  bool pop( value_type *value );
+
+  /**
+   * Pushes a value onto the back of the queue.
+   *
+   * @param value The value to push.
+   * @return Returns \c true only if the value was pushed, i.e., the queue
+   * wasn't full.
+   */
+  bool push( value_type const &value );
+
+private:
+  /**
+   * Producers and consumers each have their own position so those of one
+   * aren't on the same cache line as those of the other.
+   */
+  static size_t const Cache_Line_Size = 64;
+
+  struct cell {
+    std::atomic<size_t> seq_;
+    typename std::aligned_storage<sizeof(T),alignof(T)>::type value_;
+  };
+
+  char                pad0_[ Cache_Line_Size ];
+  cell *const         cells_;
+  size_type const     mask_;
+  char                pad1_[ Cache_Line_Size ];
+  std::atomic<size_t> tail_;            // next position to push into
+  char                pad2_[ Cache_Line_Size ];
+  std::atomic<size_t> head_;            // next position to pop from
+  char                pad3_[ Cache_Line_Size ];
+
+  static size_type round_up( size_type n ) {
+    size_type p = 2;
+    while ( p < n )
+      p <<= 1;
+    return p;
+  }
+
+  mpmc_queue( mpmc_queue const& ) = delete;
+  mpmc_queue& operator=( mpmc_queue const& ) = delete;
+};
+
+////////// inlines ////////////////////////////////////////////////////////////
+
+template<typename T>
+mpmc_queue<T>::mpmc_queue( size_type capacity ) :
+  cells_( new cell[ round_up( capacity ) ] ),
+  mask_( round_up( capacity ) - 1 ),
+  tail_( 0 ), head_( 0 )
+{
+  for ( size_type i = 0; i <= mask_; ++i )
+    cells_[i].seq_.store( i, std::memory_order_relaxed );
+}
+
+template<typename T>
+mpmc_queue<T>::~mpmc_queue() {
+  size_t const tail = tail_.load( std::memory_order_relaxed );
+  for ( size_t pos = head_.load( std::memory_order_relaxed ); pos != tail;
+        ++pos ) {
+    cell &c = cells_[ pos & mask_ ];
+    if ( c.seq_.load( std::memory_order_relaxed ) == pos + 1 )
+      reinterpret_cast<value_type*>( &c.value_ )->~value_type();
+  } // for
+  delete[] cells_;
+}
+
+template<typename T>
+bool mpmc_queue<T>::pop( value_type *value ) {
+  cell *c;
+  size_t pos = head_.load( std::memory_order_relaxed );
+  while ( true ) {
+    c = &cells_[ pos & mask_ ];
+    size_t const seq = c->seq_.load( std::memory_order_acquire );
+    intptr_t const diff =
+      static_cast<intptr_t>( seq ) - static_cast<intptr_t>( pos + 1 );
+    if ( !diff ) {
+      //
+      // The cell has been pushed into for this position: try to claim it.
+      //
+      if ( head_.compare_exchange_weak( pos, pos + 1,
+                                        std::memory_order_relaxed ) )
+        break;
+    } else if ( diff < 0 ) {
+      return false;                     // empty
+    } else {
+      //
+      // Another consumer claimed the cell first.
+      //
+      pos = head_.load( std::memory_order_relaxed );
+    }
+  } // while
+  value_type *const v = reinterpret_cast<value_type*>( &c->value_ );
+  *value = std::move( *v );
+  v->~value_type();
+  //
+  // Make the cell ready to be pushed into on the next lap around the ring.
+  //
+  c->seq_.store( pos + mask_ + 1, std::memory_order_release );
+  return true;
+}
+
+template<typename T>
+bool mpmc_queue<T>::push( value_type const &value ) {
+  cell *c;
+  size_t pos = tail_.load( std::memory_order_relaxed );
+  while ( true ) {
+    c = &cells_[ pos & mask_ ];
+    size_t const seq = c->seq_.load( std::memory_order_acquire );
+    intptr_t const diff =
+      static_cast<intptr_t>( seq ) - static_cast<intptr_t>( pos );
+    if ( !diff ) {
+      //
+      // The cell is free for this position: try to claim it.
+      //
+      if ( tail_.compare_exchange_weak( pos, pos + 1,
+                                        std::memory_order_relaxed ) )
+        break;
+    } else if ( diff < 0 ) {
+      return false;                     // full
+    } else {
+      //
+      // Another producer claimed the cell first.
+      //
+      pos = tail_.load( std::memory_order_relaxed );
+    }
+  } // while
+  new( &c->value_ ) value_type( value );
+  //
+  // Make the cell ready to be popped from.
+  //
+  c->seq_.store( pos + 1, std::memory_order_release );
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace PJL
+
+#endif /* mpmc_queue_H */
+/* vim:set et sw=2 ts=2: */
@@ -25,7 +25,7 @@
 
 // standard
 #include <cstdlib>                      /* for exit(3) */
-#include <time.h>
+#include <unistd.h>                     /* for sysconf(3) */
 #ifdef DEBUG_threads
 #include <iostream>
 #endif /* DEBUG_threads */
@@ -40,6 +40,13 @@ namespace PJL {
 
 pthread_key_t thread_pool::thread::thread_obj_key_;
 
+/**
+ * The number of times an idle thread tries to get a task before going to
+ * sleep.  Under load, a task is likely to be queued within that time, so the
+ * thread avoids both going to sleep and having to be woken up.
+ */
+static unsigned const Spin_Max = 2000;
+
 //
 // Macros to wrap critical sections.
 //
@@ -94,9 +101,7 @@ pthread_key_t thread_pool::thread::thread_obj_key_;
  */
 void thread_pool_decrement_busy( void *p ) {
   auto const t = static_cast<thread_pool::thread*>( p );
-  MUTEX_LOCK( &t->pool_.t_busy_lock_, true );
   --t->pool_.t_busy_;
-  MUTEX_UNLOCK();
 }
 
 /**
@@ -123,6 +128,17 @@ extern "C" void thread_pool_thread_data_cleanup( void *p ) {
   }
 }
 
+/**
+ * Tells the CPU that the calling thread is spinning.
+ */
+static inline void spin_pause() {
+#if defined( __i386__ ) || defined( __x86_64__ )
+  __builtin_ia32_pause();
+#elif defined( __aarch64__ )
+  __asm__ __volatile__( "yield" );
+#endif
+}
+
 /**
  * This is the starting point of execution for a POSIX thread.  It waits for a
  * task to appear in its thread pool's task queue and performs the task.  After
@@ -171,6 +187,14 @@ void* thread_pool_thread_main( void *p ) {
   //
   ::pthread_mutex_destroy( &t->run_lock_ );
 
+  //
+  // Spinning is pointless if there's only one CPU since the thread that would
+  // queue a task can't run while we spin.
+  //
+  static unsigned const spin_max =
+    ::sysconf( _SC_NPROCESSORS_ONLN ) > 1 ? Spin_Max : 0;
+  thread_pool &pool = t->pool_;
+
   while ( true ) {
 
 #   ifdef DEBUG_threads
@@ -178,68 +202,82 @@ void* thread_pool_thread_main( void *p ) {
 #   endif
 
     thread_pool::thread::argument_type arg;
-    result = 0;
-
-    MUTEX_LOCK( &t->pool_.q_lock_, false );
-    while ( t->pool_.queue_.empty() ) {
-      bool no;
-      MUTEX_LOCK( &t->pool_.t_lock_, false );
-      no = t->pool_.threads_.size() <= t->pool_.min_threads_;
-      ::pthread_cond_signal( &t->pool_.t_idle_ );
-      MUTEX_UNLOCK();
-      if ( no ) {
-        //
-        // There are no threads beyond those originally created: signal that
-        // we're idle and wait indefinitely for a task.
-        //
-        ::pthread_cond_wait( &t->pool_.q_not_empty_, &t->pool_.q_lock_ );
-        result = 0;                     // ignore possible prior timeout
-        continue;
+    bool got_task = pool.take_task( &arg );
+    for ( unsigned spin = 0; !got_task && spin < spin_max; ++spin ) {
+      spin_pause();
+      got_task = pool.take_task( &arg );
+    } // for
+
+    for ( bool timed_out = false; !got_task; ) {
+      //
+      // Signal that we're idle, but only if new_task() is waiting for that.
+      //
+      if ( pool.t_idle_waiters_ ) {
+        MUTEX_LOCK( &pool.t_lock_, false );
+        ::pthread_cond_signal( &pool.t_idle_ );
+        MUTEX_UNLOCK();
       }
       //
-      // More threads exist than the minimum.  Check to see if we timed out
-      // waiting for a task on the last loop.
+      // If there are no threads beyond those originally created, wait
+      // indefinitely for a task; otherwise, wait only a finite amount of time.
       //
-      if ( result == ETIMEDOUT ) {
+      bool no = pool.t_count_ <= pool.min_threads_;
+      if ( !no && timed_out ) {
         //
-        // No task became available: commit suicide by deleting the instance of
-        // the thread: it will exit the POSIX thread so the "delete" below will
-        // never return.
+        // Threads that time out together would all see more threads than the
+        // minimum, so recheck and reserve our exit under the lock lest they
+        // all exit.
         //
-        delete t;
-        internal_error
-          << "thread_pool_thread_main(): thread exists after destruction"
-          << report_error;
+        MUTEX_LOCK( &pool.t_lock_, false );
+        no = pool.threads_.size() - pool.t_exiting_ <= pool.min_threads_;
+        if ( !no ) {
+          ++pool.t_exiting_;
+          t->exiting_ = true;
+        }
+        MUTEX_UNLOCK();
+        if ( !no ) {
+          //
+          // No task became available: commit suicide by deleting the instance
+          // of the thread: it will exit the POSIX thread so the "delete" below
+          // will never return.
+          //
+          delete t;
+          internal_error
+            << "thread_pool_thread_main(): thread exists after destruction"
+            << report_error;
+        }
+      }
+      event_count::key_type const key = pool.q_not_empty_.prepare_wait();
+      if ( (got_task = pool.take_task( &arg )) ) {
+        pool.q_not_empty_.cancel_wait();
+        break;
       }
       //
-      // Wait only a finite amount of time for a task to become available.
+      // The thread pool's destructor cancels threads before waking them, so
+      // check for cancellation only after preparing to wait lest the wake-up
+      // be missed.
       //
-      struct timespec future;
-      future.tv_sec = ::time( nullptr ) + t->pool_.timeout_;
-      future.tv_nsec = 0;
-      result = ::pthread_cond_timedwait(
-        &t->pool_.q_not_empty_, &t->pool_.q_lock_, &future
+      ::pthread_testcancel();
+      timed_out = !pool.q_not_empty_.wait(
+        key, no ? -1 : static_cast<int>( pool.timeout_ * 1000 )
       );
       //
+      // Waiting isn't a cancellation point, so check for cancellation after.
+      //
+      ::pthread_testcancel();
+      got_task = pool.take_task( &arg );
+      //
       // Loop around again to retest the condition that there are still more
       // threads than the minimum.  We want to be absolutely sure before we
       // commit suicide.
       //
-    } // while
+    } // for
 
 #   ifdef DEBUG_threads
     cerr << "thread_pool_thread_main(): got task" << endl;
 #   endif
 
-    DEFER_CANCEL();
-    arg = t->pool_.queue_.front();
-    t->pool_.queue_.pop();
-    RESTORE_CANCEL();
-    MUTEX_UNLOCK();                     // t->pool_.q_lock_
-
-    MUTEX_LOCK( &t->pool_.t_busy_lock_, true );
-    ++t->pool_.t_busy_;
-    MUTEX_UNLOCK();
+    ++pool.t_busy_;
     pthread_cleanup_push( thread_pool_decrement_busy, t );
 
 #   ifdef DEBUG_threads
@@ -282,7 +320,7 @@ void thread_pool_thread_once() {
 
 thread_pool::thread::thread( thread_pool &p,
                              thread_start_function_type start_func ) :
-    in_cleanup_( false ), pool_( p )
+    in_cleanup_( false ), exiting_( false ), pool_( p )
 {
 # ifdef DEBUG_threads
   cerr << "thread::thread(" << (unsigned long)this << ')' << endl;
@@ -313,22 +351,32 @@ thread_pool::thread::~thread() {
   cerr << "thread::~thread(" << (unsigned long)this << ')' << endl;
 # endif
 
-  DEFER_CANCEL();
+  //
+  // Disable cancellation altogether: if we're committing suicide just as our
+  // thread pool's destructor cancels us, acting on it here would delete us
+  // again via thread_pool_thread_data_cleanup().
+  //
+  int cancel_state;
+  ::pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, &cancel_state );
+  ::pthread_mutex_lock( &pool_.t_lock_ );
   if ( !pool_.destructing_ ) {
     //
     // We are committing suicide.  But first, we have to delete the pointer to
     // us in our thread pool's set of threads.
     //
-    MUTEX_LOCK( &pool_.t_lock_, false );
     pool_.threads_.erase( this );
-    MUTEX_UNLOCK();
+    pool_.t_count_ = static_cast<unsigned>( pool_.threads_.size() );
+    if ( exiting_ )
+      --pool_.t_exiting_;
   } else {
     //
     // The thread pool to which we belong has had its destructor called and is
-    // in the process of destroying itself and us.  Therefore, we don't have to
-    // do anything.
+    // waiting for all its threads to be cancelled: tell it that we are.
     //
+    if ( !--pool_.t_count_ )
+      ::pthread_cond_signal( &pool_.t_idle_ );
   }
+  ::pthread_mutex_unlock( &pool_.t_lock_ );
 
   if ( !in_cleanup_ ) {
     //
@@ -357,22 +405,22 @@ thread_pool::thread::~thread() {
       ::pthread_cancel( thread_ );
     }
   }
-  RESTORE_CANCEL();
+  ::pthread_setcancelstate( cancel_state, nullptr );
 }
 
 thread_pool::thread_pool( thread *prototype, unsigned min_threads,
                           unsigned max_threads, unsigned timeout ) :
-  min_threads_( min_threads ), max_threads_( max_threads ), t_busy_( 0 ),
-  destructing_( false ), timeout_( timeout )
+  min_threads_( min_threads ), max_threads_( max_threads ), t_count_( 0 ),
+  t_exiting_( 0 ), t_busy_( 0 ), t_idle_waiters_( 0 ),
+  queue_( Task_Queue_Size ),
+  o_size_( 0 ), destructing_( false ), timeout_( timeout )
 {
-  if ( ::pthread_mutex_init( &t_busy_lock_, nullptr ) ||
-       ::pthread_mutex_init( &q_lock_, nullptr ) ||
-       ::pthread_mutex_init( &t_lock_, nullptr ) ) {
+  if ( ::pthread_mutex_init( &t_lock_, nullptr ) ||
+       ::pthread_mutex_init( &o_lock_, nullptr ) ) {
     error() << "could not init thread mutex" << endl;
     ::exit( Exit_No_Init_Thread_Mutex );
   }
-  if ( ::pthread_cond_init( &q_not_empty_, nullptr ) ||
-       ::pthread_cond_init( &t_idle_, nullptr ) ) {
+  if ( ::pthread_cond_init( &t_idle_, nullptr ) ) {
     error() << "could not init thread condition" << endl;
     ::exit( Exit_No_Init_Thread_Condition );
   }
@@ -382,27 +430,38 @@ thread_pool::thread_pool( thread *prototype, unsigned min_threads,
   prototype->run();
   for ( unsigned i = 1; i < min_threads_; ++i )
     threads_.insert( prototype->create_and_run() );
+  t_count_ = static_cast<unsigned>( threads_.size() );
   MUTEX_UNLOCK();
 }
 
 thread_pool::~thread_pool() {
   DEFER_CANCEL();
+  MUTEX_LOCK( &t_lock_, false );
   //
   // Set the destructing_ flag to prevent the thread destructor from removing
-  // itself from our set since we're deleting the whole set anyway.
+  // itself from our set since we're discarding the whole set anyway.
   //
   destructing_ = true;
-
-  MUTEX_LOCK( &t_lock_, false );
-  for ( auto &t : threads_ )
-    delete &t;
+  //
+  // Cancel all the threads, but don't delete their thread objects here: each
+  // is deleted by thread_pool_thread_data_cleanup() in its own thread as it
+  // exits.  (Deleting them here would delete them twice.)
+  //
+  for ( auto const t : threads_ )
+    ::pthread_cancel( t->thread_ );
+  threads_.clear();
+  //
+  // Wake up the threads waiting for a task so they act on being cancelled,
+  // then wait for all of them to exit since they use our data members.
+  //
+  q_not_empty_.notify_all();
+  while ( t_count_ )
+    ::pthread_cond_wait( &t_idle_, &t_lock_ );
   MUTEX_UNLOCK();
 
   ::pthread_cond_destroy( &t_idle_ );
-  ::pthread_cond_destroy( &q_not_empty_ );
+  ::pthread_mutex_destroy( &o_lock_ );
   ::pthread_mutex_destroy( &t_lock_ );
-  ::pthread_mutex_destroy( &t_busy_lock_ );
-  ::pthread_mutex_destroy( &q_lock_ );
   RESTORE_CANCEL();
 }
 
@@ -411,52 +470,88 @@ bool thread_pool::new_task( thread::argument_type arg, bool block ) {
   cerr << "thread_pool::new_task()" << endl;
 # endif
 
-  bool all_are_busy, queue_task = true;
-
-  MUTEX_LOCK( &t_lock_, false );
-  MUTEX_LOCK( &t_busy_lock_, false );
-  all_are_busy = t_busy_ == threads_.size();
-  MUTEX_UNLOCK();
-
-  if ( all_are_busy ) {
-    if ( threads_.size() < max_threads_ ) {
-      //
-      // We haven't maxed-out the number of threads we can make, so create
-      // another one to handle the request by using the first thread in the
-      // pool as a prototype.
-      //
-#     ifdef DEBUG_threads
-      cerr << "creating a new thread" << endl;
-#     endif
-      thread *const prototype = *threads_.begin();
-      DEFER_CANCEL();
-      threads_.insert( prototype->create_and_run() );
-      RESTORE_CANCEL();
-    } else if ( block ) {
-      //
-      // We've maxed out the number of threads we can make, so just wait until
-      // one becomes idle.
-      //
-#     ifdef DEBUG_threads
-      cerr << "waiting for idle thread" << endl;
-#     endif
-      ::pthread_cond_wait( &t_idle_, &t_lock_ );
-    } else {
-      queue_task = false;
+  //
+  // Only if all threads are busy (or appear to be) is a lock needed to either
+  // create another thread or wait for one to become idle.
+  //
+  bool queue_task = true;
+  if ( t_busy_ >= t_count_ ) {
+    MUTEX_LOCK( &t_lock_, false );
+    if ( t_busy_ >= threads_.size() ) {
+      if ( threads_.size() < max_threads_ ) {
+        //
+        // We haven't maxed-out the number of threads we can make, so create
+        // another one to handle the request by using the first thread in the
+        // pool as a prototype.
+        //
+#       ifdef DEBUG_threads
+        cerr << "creating a new thread" << endl;
+#       endif
+        thread *const prototype = *threads_.begin();
+        DEFER_CANCEL();
+        threads_.insert( prototype->create_and_run() );
+        t_count_ = static_cast<unsigned>( threads_.size() );
+        RESTORE_CANCEL();
+      } else if ( block ) {
+        //
+        // We've maxed out the number of threads we can make, so just wait
+        // until one becomes idle.  An idle thread signals only if it sees a
+        // waiter, so check again after becoming one.
+        //
+#       ifdef DEBUG_threads
+        cerr << "waiting for idle thread" << endl;
+#       endif
+        ++t_idle_waiters_;
+        if ( t_busy_ >= threads_.size() )
+          ::pthread_cond_wait( &t_idle_, &t_lock_ );
+        --t_idle_waiters_;
+      } else {
+        queue_task = false;
+      }
     }
+    MUTEX_UNLOCK();                     // t_lock_
   }
-  MUTEX_UNLOCK();                       // t_lock_
 
   if ( queue_task ) {
-    MUTEX_LOCK( &q_lock_, true );
-    queue_.push( arg );
-    ::pthread_cond_signal( &q_not_empty_ );
-    MUTEX_UNLOCK();
+    //
+    // Once there are tasks in the overflow queue, queue new tasks there too
+    // so they're taken in order.
+    //
+    if ( o_size_ || !queue_.push( arg ) ) {
+      MUTEX_LOCK( &o_lock_, true );
+      overflow_.push_back( arg );
+      ++o_size_;
+      MUTEX_UNLOCK();
+    }
+    q_not_empty_.notify_one();
   }
 
   return queue_task;
 }
 
+/**
+ * Takes a task from the queue or, if it's empty, from the overflow queue.
+ *
+ * @param arg A pointer to receive the task's argument.
+ * @return Returns \c true only if a task was taken.
+ */
+bool thread_pool::take_task( thread::argument_type *arg ) {
+  if ( queue_.pop( arg ) )
+    return true;
+  if ( !o_size_ )
+    return false;
+  bool took = false;
+  MUTEX_LOCK( &o_lock_, true );
+  if ( !overflow_.empty() ) {
+    *arg = overflow_.front();
+    overflow_.pop_front();
+    --o_size_;
+    took = true;
+  }
+  MUTEX_UNLOCK();
+  return took;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 } // namespace PJL
@@ -22,9 +22,14 @@
 #ifndef thread_pool_H
 #define thread_pool_H
 
+// local
+#include "event_count.h"
+#include "mpmc_queue.h"
+
 // standard
+#include <atomic>
+#include <deque>
 #include <pthread.h>
-#include <queue>
 #include <unordered_set>
 
 namespace PJL {
@@ -57,6 +62,13 @@ extern "C" {
  * If, for whatever reason, you don't want the dynamic behavior, just set
  * \c max_threads to be equal to \c min_threads.
  *
+ * Handing a task to an idle thread takes no lock: the task queue is a
+ * lock-free mpmc_queue, the number of busy threads is an atomic counter, and
+ * an idle thread spins briefly for a task before sleeping on an event_count
+ * (that a new task wakes only if a thread is actually asleep).  A lock is
+ * taken only when all threads are busy (to create a thread or wait for one)
+ * or the queue is full (to queue the task in an unbounded overflow queue).
+ *
  * See also:
  *    Bradford Nichols, Dick Buttlar, and Jacqueline Proulx Farrell.
  *    "Pthreads Programming," O'Reilly & Associates, Sebastopol, CA, 1996.
@@ -129,6 +141,7 @@ public:
 
   private:
     bool                  in_cleanup_;  // in clean-up func?
+    bool                  exiting_;     // committing suicide?
     thread_pool&          pool_;        // our owning pool
     pthread_mutex_t       run_lock_;
     pthread_t             thread_;      // our POSIX thread
@@ -179,10 +192,10 @@ public:
    * @param block Whether to block if all the threads are busy and no more can
    * be created.
    * @return Returns \c true if there is a thread to service the new task;
-   * return \c false only if \a block is \c false and a new task can not be
-   * queued.  (If \a block is \c true and all the threads are busy and no more
-   * can be created, then the calling thread will block until a thread becomes
-   * available.)
+   * return \c false only if \a block is \c false, all the threads are busy,
+   * and no more can be created.  (If \a block is \c true, then the calling
+   * thread will instead block until a thread becomes available.)  A task is
+   * never refused because the queue is full.
    */
   bool new_task( thread::argument_type arg, bool block = false );
 
@@ -195,19 +208,34 @@ public:
 
 private:
   typedef std::unordered_set<thread*> thread_set;
-  typedef std::queue<thread::argument_type> task_queue_type;
+  typedef mpmc_queue<thread::argument_type> task_queue_type;
+  typedef std::deque<thread::argument_type> overflow_queue_type;
+
+  /**
+   * The maximum number of tasks that can be in the lock-free queue.  A task is
+   * queued only if there's a thread to do it, but the threads count as busy
+   * only once they've taken their tasks, so a burst of tasks can outrun them:
+   * tasks beyond this many go into the overflow queue.
+   */
+  static unsigned const Task_Queue_Size = 1024;
+
+  bool take_task( thread::argument_type *arg );
 
   unsigned volatile min_threads_, max_threads_;
   thread_set        threads_;
   pthread_mutex_t   t_lock_;
+  std::atomic<unsigned> t_count_;       // threads_.size() without t_lock_
+  unsigned          t_exiting_;         // threads committing suicide
 
-  unsigned volatile t_busy_;            // how many are busy
-  pthread_mutex_t   t_busy_lock_;
+  std::atomic<unsigned> t_busy_;        // how many are busy
+  std::atomic<unsigned> t_idle_waiters_;// new_task() calls waiting for idle
   pthread_cond_t    t_idle_;            // a thread is idle
 
   task_queue_type   queue_;
-  pthread_mutex_t   q_lock_;
-  pthread_cond_t    q_not_empty_;       // a task is available
+  overflow_queue_type overflow_;        // tasks that didn't fit in queue_
+  pthread_mutex_t   o_lock_;            // guards overflow_
+  std::atomic<unsigned> o_size_;        // overflow_.size() without o_lock_
+  event_count       q_not_empty_;       // a task is available
 
   bool              destructing_;       // destructor called?
   unsigned volatile timeout_;
@@ -0,0 +1,208 @@
+/*
+**      PJL C++ Library
+**      timer_wheel.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef timer_wheel_H
+#define timer_wheel_H
+
+// standard
+#include <cstddef>                      /* for size_t */
+#include <list>
+#include <vector>
+
+namespace PJL {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %timer_wheel is a hashed timing wheel: timers are kept in a circular array
+ * of slots, one per tick, so scheduling and cancelling a timer and advancing
+ * the wheel by one tick are all O(1) (plus the number of timers that expire).
+ * Timers further in the future than the number of slots wrap around the wheel
+ * and keep a count of the remaining rounds.
+ *
+ * See also:
+ *    George Varghese and Tony Lauck.  "Hashed and Hierarchical Timing Wheels:
+ *    Data Structures for the Efficient Implementation of a Timer Facility,"
+ *    Proceedings of the 11th ACM Symposium on Operating Systems Principles,
+ *    1987.
+ *
+ * @tparam T The type of value associated with each timer.
+ */
+template<typename T>
+class timer_wheel {
+  struct timer {
+    T       value;
+    size_t  rounds;                     // remaining full turns of the wheel
+  };
+  typedef std::list<timer> slot_type;
+
+public:
+  typedef size_t size_type;
+
+  /**
+   * A %handle refers to a scheduled timer so it can be cancelled.
+   */
+  class handle {
+  public:
+    handle() : slot_( nullptr ) { }
+
+    explicit operator bool() const {
+      return slot_ != nullptr;
+    }
+
+  private:
+    slot_type                    *slot_;
+    typename slot_type::iterator  timer_;
+
+    handle( slot_type *slot, typename slot_type::iterator timer ) :
+      slot_( slot ), timer_( timer )
+    {
+    }
+
+    friend class timer_wheel;
+  };
+
+  /**
+   * Constructs a %timer_wheel.
+   *
+   * @param num_slots The number of slots.  Timers no more than this many ticks
+   * in the future never need more than one turn of the wheel.
+   */
+  explicit timer_wheel( size_type num_slots = 64 ) :
+    slots_( num_slots ), current_( 0 ), size_( 0 ), now_( 0 ), resync_( false )
+  {
+  }
+
+  /**
+   * Advances the wheel to a given time, one tick per unit of time, expiring
+   * the timers that are due.
+   *
+   * If the wheel was empty when a timer was scheduled since the last advance,
+   * the wheel may have been idle (and so not advanced) for an arbitrarily
+   * long time: rather than ticking past (and so expiring) timers that were
+   * just scheduled, the wheel simply jumps to the time.
+   *
+   * @param now The current time.
+   * @param expire The function to call with the value of every timer that
+   * expired.
+   */
+  template<class ExpireFunction>
+  void advance_to( long now, ExpireFunction expire ) {
+    if ( resync_ ) {
+      now_ = now;
+      resync_ = false;
+    }
+    for ( ; now_ < now; ++now_ )
+      tick( expire );
+  }
+
+  /**
+   * Cancels a timer.  Cancelling an already expired or cancelled timer is
+   * undefined.
+   *
+   * @param h The handle of the timer.  It's reset.
+   */
+  void cancel( handle &h ) {
+    h.slot_->erase( h.timer_ );
+    h.slot_ = nullptr;
+    --size_;
+  }
+
+  /**
+   * Gets whether there are no timers.
+   *
+   * @return Returns \c true only if there are no timers.
+   */
+  bool empty() const {
+    return !size_;
+  }
+
+  /**
+   * Schedules a timer.
+   *
+   * @param value The value associated with the timer.
+   * @param ticks The number of ticks from now when the timer expires.  If 0,
+   * it expires at the next tick.
+   * @return Returns a handle to the timer.
+   */
+  handle schedule( T const &value, size_type ticks ) {
+    if ( !ticks )
+      ticks = 1;
+    if ( !size_ )
+      resync_ = true;
+    slot_type &slot = slots_[ (current_ + ticks) % slots_.size() ];
+    slot.push_back( timer{ value, (ticks - 1) / slots_.size() } );
+    ++size_;
+    return handle( &slot, --slot.end() );
+  }
+
+  /**
+   * Gets the number of timers.
+   *
+   * @return Returns said number.
+   */
+  size_type size() const {
+    return size_;
+  }
+
+  /**
+   * Advances the wheel by one tick, expiring the timers that are due.
+   *
+   * @param expire The function to call with the value of every timer that
+   * expired.  By then, the timer no longer exists.
+   */
+  template<class ExpireFunction>
+  void tick( ExpireFunction expire ) {
+    current_ = (current_ + 1) % slots_.size();
+    slot_type &slot = slots_[ current_ ];
+    //
+    // Remove all the due timers before calling expire() in case it schedules
+    // or cancels other timers.
+    //
+    std::vector<T> due;
+    for ( auto t = slot.begin(); t != slot.end(); ) {
+      if ( t->rounds ) {
+        --t->rounds;
+        ++t;
+        continue;
+      }
+      due.push_back( t->value );
+      t = slot.erase( t );
+      --size_;
+    } // for
+    for ( auto const &value : due )
+      expire( value );
+  }
+
+private:
+  std::vector<slot_type> slots_;
+  size_type current_;                   // the slot of the current tick
+  size_type size_;
+  long      now_;                       // the time as of the last advance
+  bool      resync_;                    // jump to the time at the next advance
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace PJL
+
+#endif /* timer_wheel_H */
+/* vim:set et sw=2 ts=2: */
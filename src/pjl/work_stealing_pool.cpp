@@ -0,0 +1,233 @@
+/*
+**      PJL C++ Library
+**      work_stealing_pool.cpp
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+// local
+#include "work_stealing_pool.h"
+
+// standard
+#include <iterator>                     /* for next() */
+
+using namespace std;
+
+namespace PJL {
+
+//
+// The pool (if any) the current thread is a worker of and its index.
+//
+static thread_local work_stealing_pool const *worker_pool;
+static thread_local unsigned worker_index;
+
+///////////////////////////////////////////////////////////////////////////////
+
+void work_stealing_pool::task_group::run( task_function f ) {
+  if ( !pool_.size() ) {
+    f();
+    return;
+  }
+  pending_.fetch_add( 1, memory_order_relaxed );
+  pool_.push( task{ std::move( f ), this } );
+}
+
+void work_stealing_pool::task_group::wait() {
+  while ( pending_.load() ) {
+    task t;
+    if ( pool_.take_own( this, &t ) ) {
+      pool_.perform( t );
+      continue;
+    }
+    //
+    // There's nothing of this group left to take, so its remaining tasks are
+    // being performed by other threads: wait for the last one to be done.
+    //
+    event_count::key_type const key = pool_.group_done_.prepare_wait();
+    if ( !pending_.load() ) {
+      pool_.group_done_.cancel_wait();
+      break;
+    }
+    pool_.group_done_.wait( key, -1 );
+  } // while
+}
+
+work_stealing_pool::work_stealing_pool( unsigned num_workers ) :
+  queued_( 0 ), stopping_( false )
+{
+  //
+  // All the deques must exist before any worker starts since a worker may
+  // steal from any of them.
+  //
+  for ( unsigned i = 0; i < num_workers; ++i )
+    workers_.emplace_back( new task_deque );
+  for ( unsigned i = 0; i < num_workers; ++i )
+    threads_.emplace_back( &work_stealing_pool::main, this, i );
+}
+
+work_stealing_pool::~work_stealing_pool() {
+  stopping_ = true;
+  work_queued_.notify_all();
+  for ( auto &thread : threads_ )
+    thread.join();
+}
+
+/**
+ * The main function of a worker thread: performs tasks until the pool is
+ * destroyed, sleeping whenever there are none.
+ *
+ * @param index The index of the worker's deque.
+ */
+void work_stealing_pool::main( unsigned index ) {
+  worker_pool = this;
+  worker_index = index;
+  while ( true ) {
+    task t;
+    if ( take( &t ) ) {
+      perform( t );
+      continue;
+    }
+    event_count::key_type const key = work_queued_.prepare_wait();
+    if ( stopping_ ) {
+      work_queued_.cancel_wait();
+      break;
+    }
+    if ( queued_.load() ) {
+      work_queued_.cancel_wait();
+      continue;
+    }
+    work_queued_.wait( key, -1 );
+  } // while
+}
+
+/**
+ * Performs a task and, if it was the last one of its group, wakes up the
+ * threads waiting for a group.
+ *
+ * @param t The task.
+ */
+void work_stealing_pool::perform( task &t ) {
+  task_group *const group = t.group;
+  {
+    task_function const f( std::move( t.f ) );
+    f();
+  }
+  //
+  // Once pending_ is 0, the group may be destroyed by the thread waiting for
+  // it, so it mustn't be touched after: that's why the event_count that's
+  // notified is the pool's rather than the group's.
+  //
+  if ( group->pending_.fetch_sub( 1 ) == 1 )
+    group_done_.notify_all();
+}
+
+/**
+ * Queues a task onto the current thread's deque if it's a worker or onto the
+ * deque for non-workers otherwise.
+ *
+ * @param t The task.
+ */
+void work_stealing_pool::push( task &&t ) {
+  task_deque &d = worker_pool == this ? *workers_[ worker_index ] : injected_;
+  {
+    lock_guard<mutex> const lock( d.lock_ );
+    d.tasks_.push_back( std::move( t ) );
+    ++queued_;
+  }
+  work_queued_.notify_one();
+}
+
+/**
+ * Takes a task to perform: a worker first takes the newest task from the
+ * back of its own deque; failing that, or for a non-worker, the oldest task
+ * from the front of the deque for non-workers or of any other worker's deque.
+ *
+ * @param t The task taken, if any.
+ * @return Returns \c true only if a task was taken.
+ */
+bool work_stealing_pool::take( task *t ) {
+  if ( !queued_.load() )
+    return false;
+
+  auto const take_from = [this,t]( task_deque &d, bool back ) {
+    lock_guard<mutex> const lock( d.lock_ );
+    if ( d.tasks_.empty() )
+      return false;
+    if ( back ) {
+      *t = std::move( d.tasks_.back() );
+      d.tasks_.pop_back();
+    } else {
+      *t = std::move( d.tasks_.front() );
+      d.tasks_.pop_front();
+    }
+    --queued_;
+    return true;
+  };
+
+  unsigned const n = size();
+  bool const is_worker = worker_pool == this;
+  if ( is_worker && take_from( *workers_[ worker_index ], true ) )
+    return true;
+  if ( take_from( injected_, false ) )
+    return true;
+  //
+  // Start stealing from the next worker over so that not every thief tries
+  // the same victim first.
+  //
+  unsigned const first = is_worker ? worker_index + 1 : 0;
+  for ( unsigned i = 0; i < n; ++i ) {
+    unsigned const victim = (first + i) % n;
+    if ( (!is_worker || victim != worker_index) &&
+         take_from( *workers_[ victim ], false ) )
+      return true;
+  } // for
+  return false;
+}
+
+/**
+ * Takes a task of a particular group to perform.  A group's tasks are on the
+ * deque of the thread that spawned them: for a worker, since any groups its
+ * tasks spawned have already been waited for, they're at the back; for a
+ * non-worker, they may be interleaved with other non-workers' tasks.
+ *
+ * @param group The task_group to take a task of.
+ * @param t The task taken, if any.
+ * @return Returns \c true only if a task was taken.
+ */
+bool work_stealing_pool::take_own( task_group const *group, task *t ) {
+  if ( !queued_.load() )
+    return false;
+  bool const is_worker = worker_pool == this;
+  task_deque &d = is_worker ? *workers_[ worker_index ] : injected_;
+  lock_guard<mutex> const lock( d.lock_ );
+  for ( auto i = d.tasks_.rbegin(); i != d.tasks_.rend(); ++i ) {
+    if ( i->group == group ) {
+      *t = std::move( *i );
+      d.tasks_.erase( std::next( i ).base() );
+      --queued_;
+      return true;
+    }
+    if ( is_worker )
+      break;
+  } // for
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace PJL
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,178 @@
+/*
+**      PJL C++ Library
+**      work_stealing_pool.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef work_stealing_pool_H
+#define work_stealing_pool_H
+
+// local
+#include "event_count.h"
+
+// standard
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>                       /* for unique_ptr */
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace PJL {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %work_stealing_pool is a fixed set of worker threads that perform tasks
+ * that are parts of some larger piece of work (such as evaluating a query)
+ * in parallel.  Unlike a thread_pool, whose threads each do an entire task
+ * independently, tasks are spawned in groups by a thread that then waits for
+ * all of them to be done (and a task may itself spawn a group of tasks):
+ * \code
+ *    work_stealing_pool::task_group group( pool );
+ *    for ( auto &part : parts )
+ *      group.run( [&part]{ do_part( part ); } );
+ *    group.wait();
+ * \endcode
+ *
+ * Each worker has its own deque of tasks: it pushes the tasks it spawns onto
+ * and pops them off the back (so it does the most recently spawned, hence
+ * cache-warm, ones first) while idle workers steal tasks from the front (the
+ * oldest ones, hence likely the biggest).  Tasks spawned by threads that
+ * aren't workers go onto a deque of their own that all workers steal from.
+ * Since each deque has its own lock that's only ever held briefly, workers
+ * seldom contend.
+ *
+ * A thread waiting for a group doesn't just sleep: it performs its group's
+ * tasks that no other thread has taken yet so it neither wastes its CPU nor
+ * (when the waiting thread is itself a worker) deadlocks.  It performs only
+ * its own group's tasks, however: a task of some unrelated piece of work
+ * could change the thread's state that the tasks of its group still being
+ * performed by other threads depend on.
+ *
+ * See also:
+ *    Robert D. Blumofe and Charles E. Leiserson.  "Scheduling Multithreaded
+ *    Computations by Work Stealing," Journal of the ACM, 46(5), 1999.
+ */
+class work_stealing_pool {
+public:
+  typedef std::function<void()> task_function;
+
+  /**
+   * A %task_group is a group of tasks that are waited for together.
+   */
+  class task_group {
+  public:
+    /**
+     * Constructs a %task_group.
+     *
+     * @param pool The work_stealing_pool to perform the tasks.
+     */
+    explicit task_group( work_stealing_pool &pool ) :
+      pool_( pool ), pending_( 0 )
+    {
+    }
+
+    /**
+     * Destroys a %task_group after waiting for all its tasks to be done.
+     */
+    ~task_group() {
+      wait();
+    }
+
+    /**
+     * Spawns a task.  If the pool has no workers, it's performed right away.
+     *
+     * @param f The function to call to perform the task.
+     */
+    void run( task_function f );
+
+    /**
+     * Waits for all the tasks spawned so far to be done, performing tasks
+     * in the meantime.
+     */
+    void wait();
+
+  private:
+    work_stealing_pool   &pool_;
+    std::atomic<unsigned> pending_;     // tasks spawned but not yet done
+
+    friend class work_stealing_pool;
+
+    task_group( task_group const& ) = delete;
+    task_group& operator=( task_group const& ) = delete;
+  };
+
+  /**
+   * Constructs a %work_stealing_pool and starts its workers.
+   *
+   * @param num_workers The number of worker threads.
+   */
+  explicit work_stealing_pool( unsigned num_workers );
+
+  /**
+   * Destroys a %work_stealing_pool after stopping its workers.  No tasks may
+   * still be pending.
+   */
+  ~work_stealing_pool();
+
+  /**
+   * Gets the number of worker threads.
+   *
+   * @return Returns said number.
+   */
+  unsigned size() const {
+    return static_cast<unsigned>( workers_.size() );
+  }
+
+private:
+  struct task {
+    task_function f;
+    task_group   *group;
+  };
+
+  struct task_deque {
+    std::mutex        lock_;
+    std::deque<task>  tasks_;
+  };
+
+  std::vector<std::unique_ptr<task_deque>> workers_;
+  task_deque            injected_;      // tasks spawned by non-workers
+  std::vector<std::thread> threads_;
+  std::atomic<unsigned> queued_;        // tasks in all deques
+  std::atomic<bool>     stopping_;
+  event_count           work_queued_;   // a task was queued
+  event_count           group_done_;    // a task_group's last task was done
+
+  void main( unsigned index );
+  void perform( task& );
+  void push( task&& );
+  bool take( task* );
+  bool take_own( task_group const*, task* );
+
+  work_stealing_pool( work_stealing_pool const& ) = delete;
+  work_stealing_pool& operator=( work_stealing_pool const& ) = delete;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace PJL
+
+#endif /* work_stealing_pool_H */
+/* vim:set et sw=2 ts=2: */
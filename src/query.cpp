@@ -21,14 +21,16 @@
 
 // local
 #include "config.h"
-#include "IndexFile.h"
 #include "StemWords.h"
 #include "exit_codes.h"
 #include "file_list.h"
+#include "FuzzyWordsMax.h"
 #include "pjl/vlq.h"
 #include "query.h"
 #include "query_node.h"
+#include "search_index.h"
 #include "stem_word.h"
+#include "swishxx-config.h"
 #include "util.h"
 #include "word_util.h"
 
@@ -36,9 +38,9 @@
 #include <cassert>
 #include <algorithm>                    /* for binary_search(), etc */
 #include <cstdlib>                      /* for exit(3) */
-#ifdef DEBUG_parse_query
+#include <cstring>
 #include <iostream>
-#endif /* DEBUG_parse_query */
+#include <string>
 #include <vector>
 
 using namespace PJL;
@@ -106,35 +108,38 @@ private:
 
 } // namespace
 
-extern index_segment files, meta_names, stop_words, words;
-
 // local functions
 static void assert_index_has_word_pos_data();
+static index_segment find_fuzzy( token const& );
+static index_segment find_wildcard( token const& );
 static bool parse_meta   ( parse_q_args&, parse_r_args&, parse_v_args );
+#ifdef WITH_WORD_POS
+static bool parse_phrase ( parse_q_args&, parse_r_args&, parse_v_args );
+#endif /* WITH_WORD_POS */
 static bool parse_primary( parse_q_args&, parse_r_args&, parse_v_args );
 static bool parse_query2 ( parse_q_args&, parse_r_args&, parse_v_args );
-static bool parse_relop  ( token_stream&, token::type& );
-
-////////// extern functions ///////////////////////////////////////////////////
+static bool parse_relop  ( token_stream&, token::type&, int& );
+static void parse_word   ( parse_q_args&, parse_r_args&, parse_v_args,
+                           token const& );
 
 /**
- * Parses a query.  This is merely a front-end for \c parse_query2(), but has a
- * less ugly API.
+ * Parses a query into a tree of query_nodes.  This is merely a front-end for
+ * \c parse_query2(), but has a less ugly API.
  *
  * @param query The token_stream whence the query string is extracted.
- * @param results The query results go here.
+ * @param node_pool The pool the nodes are allocated from.
  * @param stop_words_found The set of stop-words in the query, if any.
- * @return Returns \c true only if a query was successfully parsed.
+ * @return Returns the root of the tree or null if the query could not be
+ * parsed.
  */
-bool parse_query( token_stream &query, search_results &results,
-                  stop_word_set &stop_words_found ) {
-  node_pool_type node_pool;
-
+static query_node* parse_query_tree( token_stream &query,
+                                     node_pool_type &node_pool,
+                                     stop_word_set &stop_words_found ) {
   parse_q_args q_args( node_pool, query, stop_words_found );
   parse_r_args r_args;
   parse_v_args v_args;
   if ( !parse_query2( q_args, r_args, v_args ) )
-    return false;
+    return nullptr;
 
 #ifdef WITH_WORD_POS
   if ( q_args.got_near ) {
@@ -145,13 +150,74 @@ bool parse_query( token_stream &query, search_results &results,
     //
     near_node::distributor const d( 0 );
     r_args.node = r_args.node->visit( d );
-#   ifdef DEBUG_eval_query
-    r_args.node->print( cerr );
-    cerr << endl;
-#   endif
   }
 #endif /* WITH_WORD_POS */
-  r_args.node->eval( results );
+
+  query_node::optimizer const o;
+  r_args.node = r_args.node->visit( o );
+# ifdef DEBUG_eval_query
+  r_args.node->print( cerr );
+# endif
+  return r_args.node;
+}
+
+////////// extern functions ///////////////////////////////////////////////////
+
+/**
+ * Parses and evaluates a query.
+ *
+ * @param query The token_stream whence the query string is extracted.
+ * @param results The query results go here.
+ * @param stop_words_found The set of stop-words in the query, if any.
+ * @return Returns \c true only if a query was successfully parsed.
+ */
+bool parse_query( token_stream &query, search_results &results,
+                  stop_word_set &stop_words_found ) {
+  node_pool_type node_pool;
+  query_node *const root =
+    parse_query_tree( query, node_pool, stop_words_found );
+  if ( !root )
+    return false;
+  root->eval( results );
+  return true;
+}
+
+/**
+ * Parses a query and compiles it into a tree of cursors for evaluating it
+ * document-at-a-time.
+ *
+ * @param query The token_stream whence the query string is extracted.
+ * @param cursor The root of the cursor tree goes here.
+ * @param stop_words_found The set of stop-words in the query, if any.
+ * @return Returns \c true only if a query was successfully parsed.
+ */
+bool parse_query( token_stream &query, query_cursor_ptr &cursor,
+                  stop_word_set &stop_words_found ) {
+  node_pool_type node_pool;
+  query_node *const root =
+    parse_query_tree( query, node_pool, stop_words_found );
+  if ( !root )
+    return false;
+  cursor = root->make_cursor();
+  return true;
+}
+
+/**
+ * Parses a query and prints the tree of query_nodes it would be evaluated as.
+ *
+ * @param query The token_stream whence the query string is extracted.
+ * @param o The ostream to print to.
+ * @param stop_words_found The set of stop-words in the query, if any.
+ * @return Returns \c true only if a query was successfully parsed.
+ */
+bool explain_query( token_stream &query, ostream &o,
+                    stop_word_set &stop_words_found ) {
+  node_pool_type node_pool;
+  query_node *const root =
+    parse_query_tree( query, node_pool, stop_words_found );
+  if ( !root || !query.eof() )
+    return false;
+  root->print( o );
   return true;
 }
 
@@ -184,8 +250,7 @@ static void assert_index_has_word_pos_data() {
   file_list const list( words.begin() );
   auto const file( list.begin() );
   if ( file->pos_deltas_.empty() ) {
-    extern IndexFile index_file_name;
-    error() << '"' << index_file_name
+    error() << '"' << search_index::in_use()->name()
             << "\" does not contain word position data"
             << endl;
     ::exit( Exit_No_Word_Pos_Data );
@@ -207,11 +272,18 @@ static void assert_index_has_word_pos_data() {
  *
  *    primary:    '(' query ')'
  *            |   'not' meta
+ *            |   '"' phrase '"'
+ *            |   word
+ *            |   word*
+ *
+ *    phrase:     phrase word
+ *            |   phrase word*
  *            |   word
  *            |   word*
  *
  *    relop:      'and'
  *            |   'near'
+ *            |   'near/'N
  *            |   'not' 'near'
  *            |   'or'
  *            |   (empty)
@@ -243,7 +315,8 @@ static bool parse_query2( parse_q_args &q_args, parse_r_args& r_args,
   // followed by a "rest" in the grammar.
   //
   token::type relop;
-  while ( parse_relop( q_args.query, relop ) ) {
+  int near_window;
+  while ( parse_relop( q_args.query, relop, near_window ) ) {
     parse_r_args r_args_rhs;
     parse_v_args v_args_rhs( v_args );
     if ( !parse_meta( q_args, r_args_rhs, v_args_rhs ) )
@@ -293,6 +366,34 @@ static bool parse_query2( parse_q_args &q_args, parse_r_args& r_args,
           break;
         }
         q_args.got_near = true;
+        if ( near_window ) {
+          //
+          // For "near/N", the child nodes must be words (or the left one a
+          // "near/N" for the same N so "a near/N b near/N c" is a single
+          // proximity_node for all three).
+          //
+          if ( dynamic_cast<empty_node*>( lhs_node ) )
+            break;
+          if ( dynamic_cast<empty_node*>( r_args_rhs.node ) ) {
+            r_args.node = r_args_rhs.node;
+            break;
+          }
+          word_node *const rhs_word =
+            dynamic_cast<word_node*>( r_args_rhs.node );
+          if ( !rhs_word )
+            return false;
+          proximity_node *p = dynamic_cast<proximity_node*>( lhs_node );
+          if ( !p || p->window() != near_window ) {
+            word_node *const lhs_word = dynamic_cast<word_node*>( lhs_node );
+            if ( !lhs_word )
+              return false;
+            p = new proximity_node( q_args.node_pool, near_window );
+            p->add_term( lhs_word, 0 );
+          }
+          p->add_term( rhs_word, 0 );
+          r_args.node = p;
+          break;
+        }
         r_args.node = relop == token::tt_not_near ?
           new not_near_node( q_args.node_pool, lhs_node, r_args_rhs.node ) :
           new near_node( q_args.node_pool, lhs_node, r_args_rhs.node );
@@ -367,11 +468,15 @@ parsed_meta_id:
  * @param query The token_stream whence the relational operator string is
  * extracted (if present).
  * @param relop Where the type of the relational operator is deposited.
+ * @param near_window Where the N of a "near/N" is deposited: it's 0 for all
+ * other relational operators.
  * @return Returns \c true unless no token at all could be parsed.
  */
-static bool parse_relop( token_stream &query, token::type &relop ) {
+static bool parse_relop( token_stream &query, token::type &relop,
+                         int &near_window ) {
   token const t( query );
   token::type t_type = t;
+  near_window = 0;
   switch ( t_type ) {
 
     case token::tt_none:
@@ -380,14 +485,17 @@ static bool parse_relop( token_stream &query, token::type &relop ) {
 #ifdef WITH_WORD_POS
     case token::tt_not: {
       token const t2( query );
-      if ( t2 != token::tt_near ) {
+      if ( t2 != token::tt_near || t2.near_window() ) {
         query.put_back( t2 );
         break;
       }
       t_type = token::tt_not_near;
     }
+    // fall through - "not near" is parsed like "near" from here on
     case token::tt_near:
+      near_window = t.near_window();
 #endif /* WITH_WORD_POS */
+      // fall through - "near" takes its operands as "and" and "or" do
     case token::tt_and:
     case token::tt_or:
 #     ifdef DEBUG_parse_query
@@ -402,6 +510,8 @@ static bool parse_relop( token_stream &query, token::type &relop ) {
           // no break;
         case token::tt_near:
           cerr << "near";
+          if ( near_window )
+            cerr << '/' << near_window;
           break;
 #endif /* WITH_WORD_POS */
         case token::tt_or:
@@ -438,65 +548,17 @@ static bool parse_primary( parse_q_args& q_args, parse_r_args& r_args,
                            parse_v_args v_args ) {
   r_args.ignore = false;
   r_args.node = new empty_node;
-  word_range range;
   token t( q_args.query );
 
   switch ( t ) {
 
-    case token::tt_word: {
-      less_stem const comparator( stem_words );
-      //
-      // First check to see if the word wasn't indexed either because it's not
-      // an "OK" word according to the heuristics employed or because it's a
-      // stop-word.
-      //
-      if ( !is_ok_word( t.str() ) ||
-           ::binary_search(
-             stop_words.begin(), stop_words.end(), t.lower_str(), comparator
-           ) ) {
-        q_args.stop_words_found.insert( t.str() );
-#       ifdef DEBUG_parse_query
-        cerr << "---> word \"" << t.str() << "\" (ignored: not OK)\n";
-#       endif /* DEBUG_parse_query */
-        //
-        // The following "return true" indicates that a word was parsed
-        // successfully, not that we found the word.
-        //
-        return r_args.ignore = true;
-      }
-      //
-      // Look up the word.
-      //
-      range =
-        ::equal_range( words.begin(), words.end(), t.lower_str(), comparator );
-      if ( range.first == words.end() ||
-           comparator( t.lower_str(), *range.first ) ) {
-        //
-        // The following "return true" indicates that a word was parsed
-        // successfully, not that we found the word.
-        //
-        return true;
-      }
-      break;
-    }
-
-    case token::tt_word_star: {
-      less_n<char const*> const comparator( t.length() );
-      //
-      // Look up all matching words.
-      //
-      range =
-        ::equal_range( words.begin(), words.end(), t.lower_str(), comparator );
-      if ( range.first == words.end() ||
-           comparator( t.lower_str(), *range.first ) ) {
-        //
-        // The following "return true" indicates that a word was parsed
-        // successfully, not that we found the word.
-        //
-        return true;
-      }
-      break;
-    }
+    case token::tt_star_word:
+    case token::tt_star_word_star:
+    case token::tt_word:
+    case token::tt_word_fuzzy:
+    case token::tt_word_star:
+      parse_word( q_args, r_args, v_args, t );
+      return true;
 
     case token::tt_lparen:
 #     ifdef DEBUG_parse_query
@@ -526,9 +588,392 @@ static bool parse_primary( parse_q_args& q_args, parse_r_args& r_args,
       return true;
     }
 
+#ifdef WITH_WORD_POS
+    case token::tt_quote:
+      return parse_phrase( q_args, r_args, v_args );
+#endif /* WITH_WORD_POS */
+
     default:
       return false;
   } // switch
+}
+
+#ifdef WITH_WORD_POS
+/**
+ * Parses an exact phrase (the words up to the closing quote) from the given
+ * token_stream.  Words that weren't indexed (stop-words) are skipped over
+ * since they still count for the positions of the words that were.  Within a
+ * phrase, "and," "or," "near," and "not" are words rather than operators.
+ *
+ * @param q_args The query-wide arguments.
+ * @param r_args The query reference arguments.
+ * @param v_args The query value arguments.
+ * @return Returns \c true only if a phrase was successfully parsed.
+ */
+static bool parse_phrase( parse_q_args &q_args, parse_r_args &r_args,
+                          parse_v_args v_args ) {
+# ifdef DEBUG_parse_query
+  cerr << "---> begin phrase\n";
+# endif /* DEBUG_parse_query */
+  proximity_node *const phrase = new proximity_node( q_args.node_pool, 0 );
+  word_node *only_word = nullptr;
+  int num_words = 0;
+  bool found_all = true;
+
+  for ( int offset = 0; ; ++offset ) {
+    token const t( q_args.query );
+    switch ( t ) {
+      case token::tt_and:
+      case token::tt_near:
+      case token::tt_not:
+      case token::tt_or:
+      case token::tt_star_word:
+      case token::tt_star_word_star:
+      case token::tt_word:
+      case token::tt_word_fuzzy:
+      case token::tt_word_star:
+        break;
+      case token::tt_quote:
+        goto end_of_phrase;
+      default:
+        return false;
+    } // switch
+
+    parse_r_args r_word;
+    parse_word( q_args, r_word, v_args, t );
+    if ( r_word.ignore )
+      continue;
+    word_node *const word = dynamic_cast<word_node*>( r_word.node );
+    if ( !word ) {                      // word isn't in the index
+      found_all = false;
+      continue;
+    }
+    phrase->add_term( word, offset );
+    only_word = word;
+    ++num_words;
+  } // for
+
+end_of_phrase:
+# ifdef DEBUG_parse_query
+  cerr << "---> end phrase\n";
+# endif /* DEBUG_parse_query */
+  r_args.ignore = false;
+  if ( !found_all )
+    r_args.node = new empty_node;
+  else if ( num_words > 1 ) {
+    q_args.got_near = true;
+    r_args.node = phrase;
+  } else if ( only_word ) {
+    //
+    // A phrase of a single word is just the word.
+    //
+    r_args.node = only_word;
+  } else {
+    //
+    // Every word in the phrase was a stop-word.
+    //
+    r_args.ignore = true;
+    r_args.node = new empty_node;
+  }
+  return true;
+}
+#endif /* WITH_WORD_POS */
+
+/**
+ * Finds the first word at or after the given one that's not before some other
+ * word.  Rather than a binary search of all the remaining words, this
+ * "gallops" ahead by doubling steps first since the word sought is usually
+ * near and so are the pages of the index it touches.
+ *
+ * @tparam BeforePredicate The type of \a before.
+ * @param first The word to start at.
+ * @param before The predicate that's \c true only for words before the one
+ * sought.
+ * @return Returns an iterator positioned at said word or words.end() if none.
+ */
+template<class BeforePredicate>
+static index_segment::const_iterator
+seek_word( index_segment::const_iterator first, BeforePredicate before ) {
+  auto const last = words.end();
+  ptrdiff_t step = 1;
+  while ( step < last - first && before( *( first + step ) ) ) {
+    first += step;
+    step *= 2;
+  } // while
+  return ::partition_point(
+    first, step < last - first ? first + step : last, before
+  );
+}
+
+/**
+ * Finds the words within some number of edits (insertions, deletions, or
+ * substitutions of characters) of a fuzzy word, i.e., word~N.
+ *
+ * This is done by running the rows of the edit-distance matrix against the
+ * words in order as a Levenshtein automaton: a word shares the rows for its
+ * prefix in common with the previous word, and, as soon as every distance in
+ * a row exceeds N, no word beginning with the prefix so far can match, so all
+ * such words are skipped by binary search.  Hence only viable prefixes are
+ * visited rather than every word.
+ *
+ * If more than FuzzyWordsMax words match, only those in the most files are
+ * used.
+ *
+ * @param t The token containing the word.
+ * @return Returns the subset of the words segment of the matching words.
+ */
+static index_segment find_fuzzy( token const &t ) {
+  char const *const s = t.lower_str();
+  size_t const len = t.length();
+  int const max_edits = max( 0, min( t.fuzzy_edits(), Fuzzy_Edits_Max ) );
+  //
+  // Row d is for the first d characters of a word: its jth distance is
+  // between those and the first j characters of the fuzzy word.  No row past
+  // len + max_edits is ever needed since every distance in it exceeds the
+  // maximum.
+  //
+  size_t const row_size = len + 1;
+  vector<int> rows( ( len + max_edits + 2 ) * row_size );
+  for ( size_t j = 0; j <= len; ++j )
+    rows[j] = j;
+
+  typedef pair<index_segment::size_type,int> candidate; // ordinal, distance
+  vector<candidate> candidates;
+  char const *prev = "";
+  size_t valid_rows = 0;                // past row 0 valid for prev
+
+  for ( auto w = words.begin(); w != words.end(); ) {
+    char const *const word = *w;
+    size_t d = 0;
+    while ( d < valid_rows && word[d] == prev[d] )
+      ++d;
+
+    bool viable = true;
+    for ( ; word[d]; ++d ) {
+      int const *const above = &rows[ d * row_size ];
+      int *const row = &rows[ ( d + 1 ) * row_size ];
+      int min_distance = row[0] = d + 1;
+      for ( size_t j = 1; j <= len; ++j ) {
+        row[j] = min( {
+          above[ j - 1 ] + ( word[d] != s[ j - 1 ] ),
+          above[j] + 1,
+          row[ j - 1 ] + 1
+        } );
+        if ( row[j] < min_distance )
+          min_distance = row[j];
+      } // for
+      if ( min_distance > max_edits ) {
+        viable = false;
+        break;
+      }
+    } // for
+
+    prev = word;
+    valid_rows = d;
+    if ( viable ) {
+      int const distance = rows[ d * row_size + len ];
+      if ( distance <= max_edits )
+        candidates.emplace_back( w - words.begin(), distance );
+      ++w;
+      continue;
+    }
+
+    //
+    // The prefix died at word[d], so the least distance in row d must be
+    // exactly max_edits, hence the only characters that can follow the first
+    // d and keep the prefix viable are those of the fuzzy word matched at a
+    // distance of max_edits or less.  Skip to the words beginning with the
+    // first d characters followed by the least such character after word[d]
+    // or, if none, past all the words beginning with the first d characters.
+    //
+    auto const c = static_cast<unsigned char>( word[d] );
+    int next_c = -1;
+    int const *const row = &rows[ d * row_size ];
+    for ( size_t j = 1; j <= len; ++j ) {
+      auto const s_c = static_cast<unsigned char>( s[ j - 1 ] );
+      if ( row[ j - 1 ] <= max_edits && s_c > c &&
+           ( next_c < 0 || s_c < next_c ) )
+        next_c = s_c;
+    } // for
+    if ( next_c >= 0 ) {
+      string const next_prefix = string( word, d ) + static_cast<char>( next_c );
+      w = seek_word( w, [&]( char const *other ) {
+        return ::strcmp( other, next_prefix.c_str() ) < 0;
+      } );
+    } else if ( d ) {
+      w = seek_word( w, [&]( char const *other ) {
+        return ::strncmp( other, word, d ) <= 0;
+      } );
+    } else
+      break;
+  } // for
+
+  if ( candidates.size() > fuzzy_words_max ) {
+    //
+    // Keep only the words in the most files (and, among those, the closest).
+    //
+    vector<pair<candidate,file_list::size_type>> by_files;
+    for ( auto const &c : candidates )
+      by_files.emplace_back( c, file_list( words.begin() + c.first ).size() );
+    ::partial_sort(
+      by_files.begin(), by_files.begin() + fuzzy_words_max, by_files.end(),
+      []( pair<candidate,file_list::size_type> const &i,
+          pair<candidate,file_list::size_type> const &j ) {
+        return i.second > j.second ||
+             ( i.second == j.second && i.first.second < j.first.second );
+      }
+    );
+    by_files.resize( fuzzy_words_max );
+    candidates.clear();
+    for ( auto const &f : by_files )
+      candidates.push_back( f.first );
+    ::sort( candidates.begin(), candidates.end() );
+  }
+
+  vector<index_segment::size_type> matches;
+  for ( auto const &c : candidates )
+    matches.push_back( c.first );
+  return index_segment( words, matches );
+}
+
+/**
+ * Finds the words matching a wildcard other than at the end of a word, i.e.,
+ * *word or *word*.  For the former, this is used only if the index has no
+ * reversed-word segment (where all the words ending in a given suffix are
+ * adjacent and so can be found by binary search).  For the latter, if the
+ * index has a trigram segment and the word has at least 3 characters, only
+ * the words containing its rarest trigram are checked.  Otherwise, all the
+ * words have to be checked.
+ *
+ * @param t The token containing the word.
+ * @return Returns the subset of the words segment of the matching words.
+ */
+static index_segment find_wildcard( token const &t ) {
+  char const *const s = t.lower_str();
+  size_t const len = t.length();
+  vector<index_segment::size_type> matches;
+
+  if ( t == token::tt_star_word_star && len >= 3 && trigrams.size() ) {
+    unsigned char const *rarest = nullptr;
+    index_segment::size_type rarest_count = 0;
+    for ( size_t i = 0; i + 3 <= len; ++i ) {
+      char const trigram[] = { s[i], s[i+1], s[i+2], '\0' };
+      less<char const*> const comparator;
+      auto const found = ::lower_bound(
+        trigrams.begin(), trigrams.end(), trigram, comparator
+      );
+      if ( found == trigrams.end() || comparator( trigram, *found ) )
+        return index_segment( words, matches );  // no word has the trigram
+      auto p = reinterpret_cast<unsigned char const*>( *found ) + 4;
+      index_segment::size_type const count = vlq::decode( p );
+      if ( !rarest || count < rarest_count )
+        rarest = p, rarest_count = count;
+    } // for
+    index_segment::size_type ordinal = 0;
+    while ( rarest_count-- > 0 ) {
+      ordinal += vlq::decode( rarest );
+      if ( ::strstr( words[ ordinal ], s ) )
+        matches.push_back( ordinal );
+    } // while
+  } else {
+    for ( index_segment::size_type i = 0; i < words.size(); ++i ) {
+      char const *const w = words[i];
+      if ( t == token::tt_star_word_star ? ::strstr( w, s ) != nullptr :
+           ::strlen( w ) >= len && !::strcmp( w + ::strlen( w ) - len, s ) )
+        matches.push_back( i );
+    } // for
+  }
+
+  return index_segment( words, matches );
+}
+
+/**
+ * Parses a word (or a word*, *word, *word*, or word~N) that's already been
+ * extracted as a token.
+ *
+ * @param q_args The query-wide arguments.
+ * @param r_args The query reference arguments: \c node is set to either a
+ * word_node or an empty_node if the word isn't in the index; \c ignore is set
+ * to \c true only if the word should be ignored because it wasn't indexed.
+ * @param v_args The query value arguments.
+ * @param t The token containing the word.
+ */
+static void parse_word( parse_q_args &q_args, parse_r_args &r_args,
+                        parse_v_args v_args, token const &t ) {
+  r_args.ignore = false;
+  r_args.node = new empty_node;
+  word_range range;
+  index_segment matches;                // used only by find_*()
+  bool use_matches = false;
+  string word( t.str() );
+
+  if ( t == token::tt_word_star ) {
+    less_n<char const*> const comparator( t.length() );
+    //
+    // Look up all matching words.
+    //
+    range =
+      ::equal_range( words.begin(), words.end(), t.lower_str(), comparator );
+    if ( range.first == words.end() ||
+         comparator( t.lower_str(), *range.first ) )
+      return;
+    word += '*';
+  } else if ( t == token::tt_star_word && reversed.size() ) {
+    less_reversed_n<char const*> const comparator( t.length() );
+    //
+    // Look up all matching words by their reversed spellings.
+    //
+    range = ::equal_range(
+      reversed.begin(), reversed.end(), t.lower_str(), comparator
+    );
+    if ( range.first == reversed.end() ||
+         comparator( t.lower_str(), *range.first ) )
+      return;
+    word.insert( 0, 1, '*' );
+  } else if ( t == token::tt_star_word || t == token::tt_star_word_star ) {
+    matches = find_wildcard( t );
+    if ( !matches.size() )
+      return;
+    range = word_range( matches.begin(), matches.end() );
+    use_matches = true;
+    word.insert( 0, 1, '*' );
+    if ( t == token::tt_star_word_star )
+      word += '*';
+  } else if ( t == token::tt_word_fuzzy ) {
+    matches = find_fuzzy( t );
+    if ( !matches.size() )
+      return;
+    range = word_range( matches.begin(), matches.end() );
+    use_matches = true;
+    word += '~';
+    word += to_string( max( 0, min( t.fuzzy_edits(), Fuzzy_Edits_Max ) ) );
+  } else {
+    less_stem const comparator( stem_words );
+    //
+    // First check to see if the word wasn't indexed either because it's not
+    // an "OK" word according to the heuristics employed or because it's a
+    // stop-word.
+    //
+    if ( !is_ok_word( t.str() ) ||
+         ::binary_search(
+           stop_words.begin(), stop_words.end(), t.lower_str(), comparator
+         ) ) {
+      q_args.stop_words_found.insert( t.str() );
+#     ifdef DEBUG_parse_query
+      cerr << "---> word \"" << t.str() << "\" (ignored: not OK)\n";
+#     endif /* DEBUG_parse_query */
+      r_args.ignore = true;
+      return;
+    }
+    //
+    // Look up the word.
+    //
+    range =
+      ::equal_range( words.begin(), words.end(), t.lower_str(), comparator );
+    if ( range.first == words.end() ||
+         comparator( t.lower_str(), *range.first ) )
+      return;
+  }
 
 # ifdef DEBUG_parse_query
   cerr << "---> word \"" << t.str() << "\", meta-ID=" << v_args.meta_id << "\n";
@@ -554,10 +999,14 @@ static bool parse_primary( parse_q_args& q_args, parse_r_args& r_args,
   } // for
 
   if ( !r_args.ignore ) {
-    r_args.node =
-      new word_node( q_args.node_pool, t.str(), range, v_args.meta_id );
+    r_args.node = use_matches ?
+      new word_node(
+        q_args.node_pool, word.c_str(), matches, v_args.meta_id
+      ) :
+      new word_node(
+        q_args.node_pool, word.c_str(), range, v_args.meta_id
+      );
   }
-  return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -23,23 +23,20 @@
 #define query_H
 
 // local
+#include "config.h"
 #include "index_segment.h"
+#include "query_cursor.h"
+#include "search_results.h"
 #include "token.h"
 #include "WordFilesMax.h"
 #include "WordPercentMax.h"
 
 // standard
-#include <map>
+#include <iostream>
 #include <set>
 #include <string>
 #include <utility>                      /* for pair<> */
 
-/**
- * A %search_results contains a set of search results where the key int is a
- * file index and the value int is that file's rank.
- */
-typedef std::map<int,int> search_results;
-
 /**
  * A %word_range is-a pair of iterators marking the beginning and end of a
  * range over which a given word matches.
@@ -49,6 +46,18 @@ typedef std::pair<index_segment::const_iterator,index_segment::const_iterator>
 
 typedef std::set<std::string> stop_word_set;
 
+#ifdef MULTI_THREADED
+namespace PJL {
+  class work_stealing_pool;
+}
+
+/**
+ * The threads that parts of a query are evaluated by in parallel or null if
+ * none.  See start_query_threads().
+ */
+extern PJL::work_stealing_pool *query_workers;
+#endif /* MULTI_THREADED */
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -59,12 +68,14 @@ typedef std::set<std::string> stop_word_set;
  * @return Returns \c true only if a word is too frequent.
  */
 inline bool is_too_frequent( size_t file_count ) {
-  extern index_segment files;
+  extern thread_local index_segment files;
   return  file_count > word_files_max ||
           file_count * 100 / files.size() >= word_percent_max;
 }
 
 bool parse_query( token_stream&, search_results&, stop_word_set& );
+bool parse_query( token_stream&, query_cursor_ptr&, stop_word_set& );
+bool explain_query( token_stream&, std::ostream&, stop_word_set& );
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,747 @@
+/*
+**      SWISH++
+**      src/query_cursor.cpp
+**
+**      Copyright (C) 1998-2016  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+// local
+#include "config.h"
+#include "query_cursor.h"
+#include "util.h"
+#ifdef WITH_WORD_POS
+#include "WordsNear.h"
+#endif /* WITH_WORD_POS */
+
+// standard
+#include <algorithm>
+#include <functional>                   /* for greater */
+#include <utility>                      /* for move */
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+
+query_cursor::file_index_type const query_cursor::End;
+
+query_cursor::~query_cursor() {
+  // Out-of-line because it's virtual.
+}
+
+bool query_cursor::can_mark_files() const {
+  return false;
+}
+
+void query_cursor::mark_files( vector<bool>& ) const {
+  // do nothing
+}
+
+query_cursor::rank_type query_cursor::max_score() const {
+  return INT_MAX;
+}
+
+void query_cursor::prune_below( rank_type ) {
+  // do nothing
+}
+
+void query_cursor::skip_to( file_index_type target ) {
+  while ( doc_ < target )
+    next();
+}
+
+////////// and_cursor /////////////////////////////////////////////////////////
+
+and_cursor::and_cursor( query_cursor_list &children, rank_type divisor ) :
+  children_( std::move( children ) ), divisor_( divisor )
+{
+  align();
+}
+
+void and_cursor::align() {
+  if ( children_.empty() ) {
+    doc_ = End;
+    return;
+  }
+  file_index_type target = 0;
+  for ( auto const &child : children_ )
+    target = max( target, child->doc() );
+
+  for ( bool aligned = false; !aligned; ) {
+    if ( target == End )
+      break;
+    aligned = true;
+    for ( auto const &child : children_ ) {
+      child->skip_to( target );
+      if ( child->doc() != target ) {
+        //
+        // This child has no file at the target: it overshot, so its file
+        // becomes the new target that all the children have to catch up to.
+        //
+        target = child->doc();
+        aligned = false;
+        break;
+      }
+    } // for
+  } // for
+  doc_ = target;
+}
+
+void and_cursor::next() {
+  children_.front()->next();
+  align();
+}
+
+query_cursor::rank_type and_cursor::score() {
+  //
+  // This is the same as and_node::eval(): sum the ranks, then divide.
+  //
+  rank_type rank = 0;
+  for ( auto const &child : children_ )
+    rank += child->score();
+  return rank / divisor_;
+}
+
+void and_cursor::skip_to( file_index_type target ) {
+  if ( doc_ < target ) {
+    children_.front()->skip_to( target );
+    align();
+  }
+}
+
+////////// empty_cursor ///////////////////////////////////////////////////////
+
+void empty_cursor::next() {
+  // do nothing
+}
+
+bool empty_cursor::can_mark_files() const {
+  return true;
+}
+
+void empty_cursor::mark_files( vector<bool>& ) const {
+  // do nothing
+}
+
+query_cursor::rank_type empty_cursor::max_score() const {
+  return 0;
+}
+
+query_cursor::rank_type empty_cursor::score() {
+  return 0;
+}
+
+////////// not_cursor /////////////////////////////////////////////////////////
+
+not_cursor::not_cursor( query_cursor_ptr &&child, file_index_type num_files ) :
+  child_( std::move( child ) ), num_files_( num_files )
+{
+  doc_ = 0;
+  settle();
+}
+
+void not_cursor::settle() {
+  for ( ; doc_ < num_files_; ++doc_ ) {
+    child_->skip_to( doc_ );
+    if ( child_->doc() != doc_ )
+      return;
+  } // for
+  doc_ = End;
+}
+
+void not_cursor::next() {
+  ++doc_;
+  settle();
+}
+
+query_cursor::rank_type not_cursor::score() {
+  return 100;                           // same as not_node::eval()
+}
+
+void not_cursor::skip_to( file_index_type target ) {
+  if ( doc_ < target ) {
+    doc_ = target;
+    settle();
+  }
+}
+
+////////// or_cursor //////////////////////////////////////////////////////////
+
+/**
+ * Pops the top entry of a heap of or_cursor children ordered by file index.
+ *
+ * @param heap The heap.
+ * @return Returns the popped entry.
+ */
+template<class HeapType>
+inline typename HeapType::value_type heap_pop( HeapType &heap ) {
+  typedef typename HeapType::value_type value_type;
+  ::pop_heap( heap.begin(), heap.end(), greater<value_type>() );
+  value_type const top = heap.back();
+  heap.pop_back();
+  return top;
+}
+
+/**
+ * Pushes an entry onto a heap of or_cursor children ordered by file index.
+ *
+ * @param heap The heap.
+ * @param entry The entry to push.
+ */
+template<class HeapType>
+inline void heap_push( HeapType &heap, typename HeapType::value_type entry ) {
+  typedef typename HeapType::value_type value_type;
+  heap.push_back( entry );
+  ::push_heap( heap.begin(), heap.end(), greater<value_type>() );
+}
+
+or_cursor::or_cursor( query_cursor_list &children ) :
+  children_( std::move( children ) ), first_essential_( 0 ), threshold_( -1 )
+{
+  ::stable_sort(
+    children_.begin(), children_.end(),
+    []( query_cursor_ptr const &a, query_cursor_ptr const &b ) {
+      return a->max_score() < b->max_score();
+    }
+  );
+  bound_type sum = 0;
+  for ( child_index i = 0; i < children_.size(); ++i ) {
+    sum += children_[i]->max_score();
+    bound_.push_back( sum );
+    push( i );
+  } // for
+  settle();
+}
+
+void or_cursor::advance() {
+  for ( auto const i : current_ ) {
+    //
+    // A child that has become non-essential isn't advanced here: it'll be
+    // skipped only if need be.
+    //
+    if ( i >= first_essential_ )
+      children_[i]->next();
+    push( i );
+  } // for
+  current_.clear();
+}
+
+bool or_cursor::can_mark_files() const {
+  for ( auto const &child : children_ )
+    if ( !child->can_mark_files() )
+      return false;
+  return true;
+}
+
+void or_cursor::mark_files( vector<bool> &marks ) const {
+  for ( auto const &child : children_ )
+    child->mark_files( marks );
+}
+
+query_cursor::rank_type or_cursor::max_score() const {
+  if ( bound_.empty() )
+    return 0;
+  return bound_.back() < INT_MAX ? static_cast<rank_type>( bound_.back() ) :
+    INT_MAX;
+}
+
+void or_cursor::next() {
+  advance();
+  settle();
+}
+
+void or_cursor::prune_below( rank_type threshold ) {
+  if ( threshold <= threshold_ )
+    return;
+  threshold_ = threshold;
+  //
+  // Children that become non-essential are moved to their own heap lazily.
+  //
+  while ( first_essential_ < children_.size() &&
+          bound_[ first_essential_ ] <= threshold_ )
+    ++first_essential_;
+}
+
+void or_cursor::push( child_index i ) {
+  query_cursor const &child = *children_[i];
+  if ( !child.at_end() )
+    heap_push(
+      i >= first_essential_ ? essential_ : non_essential_,
+      heap_entry( child.doc(), i )
+    );
+}
+
+query_cursor::rank_type or_cursor::score() {
+  return score_;
+}
+
+void or_cursor::settle() {
+  while ( true ) {
+    //
+    // Gather all the essential children positioned at the lowest file index.
+    //
+    doc_ = End;
+    while ( !essential_.empty() ) {
+      heap_entry const &top = essential_.front();
+      if ( top.second < first_essential_ ) {
+        heap_push( non_essential_, heap_pop( essential_ ) );
+        continue;
+      }
+      if ( doc_ == End )
+        doc_ = top.first;
+      else if ( top.first != doc_ )
+        break;
+      current_.push_back( heap_pop( essential_ ).second );
+    } // while
+    if ( doc_ == End )
+      return;
+
+    bound_type rank = 0;
+    for ( auto const i : current_ )
+      rank += children_[i]->score();
+
+    if ( first_essential_ &&
+         rank + bound_[ first_essential_ - 1 ] > threshold_ ) {
+      //
+      // The file might make it: catch the non-essential children up to it and
+      // add the ranks of those that match it.
+      //
+      while ( !non_essential_.empty() &&
+              non_essential_.front().first <= doc_ ) {
+        child_index const i = heap_pop( non_essential_ ).second;
+        query_cursor &child = *children_[i];
+        child.skip_to( doc_ );
+        if ( child.doc() == doc_ ) {
+          rank += child.score();
+          child.next();
+        }
+        push( i );
+      } // while
+    }
+    if ( rank > threshold_ ) {
+      score_ = static_cast<rank_type>( rank );
+      return;
+    }
+    advance();
+  } // while
+}
+
+void or_cursor::skip_to( file_index_type target ) {
+  if ( doc_ >= target )
+    return;
+  for ( auto const i : current_ ) {
+    if ( i >= first_essential_ )
+      children_[i]->skip_to( target );
+    push( i );
+  } // for
+  current_.clear();
+  while ( !essential_.empty() && essential_.front().first < target ) {
+    child_index const i = heap_pop( essential_ ).second;
+    if ( i >= first_essential_ )
+      children_[i]->skip_to( target );
+    push( i );
+  } // while
+  settle();
+}
+
+////////// posting_cursor /////////////////////////////////////////////////////
+
+posting_cursor::posting_cursor( index_segment::const_iterator const &word,
+                                meta_id_type meta_id, bool decode_word_pos ) :
+  list_( word ), file_( list_.begin( decode_word_pos ) ), meta_id_( meta_id ),
+  max_rank_( list_.max_rank() )
+{
+  settle();
+}
+
+bool posting_cursor::can_mark_files() const {
+  return true;
+}
+
+void posting_cursor::mark_files( vector<bool> &marks ) const {
+  list_.mark_files( meta_id_, marks );
+}
+
+query_cursor::rank_type posting_cursor::max_score() const {
+  return max_rank_ >= 0 ? max_rank_ : INT_MAX;
+}
+
+void posting_cursor::settle() {
+  while ( file_ != list_.end() && !file_->has_meta_id( meta_id_ ) )
+    ++file_;
+  doc_ = file_ != list_.end() ? file_->index_ : End;
+}
+
+void posting_cursor::next() {
+  ++file_;
+  settle();
+}
+
+query_cursor::rank_type posting_cursor::score() {
+  return file_->rank_;
+}
+
+void posting_cursor::skip_to( file_index_type target ) {
+  if ( doc_ < target ) {
+    file_.skip_to( target );
+    settle();
+  }
+}
+
+////////// results_cursor /////////////////////////////////////////////////////
+
+results_cursor::results_cursor( search_results &&results ) :
+  results_( std::move( results ) ),
+  begin_( results_.begin() ), i_( begin_ ), end_( results_.end() ),
+  max_rank_( 0 ), threshold_( -1 )
+{
+  for ( auto i = i_; i != end_; ++i )
+    max_rank_ = max( max_rank_, results_[ *i ] );
+  settle();
+}
+
+bool results_cursor::can_mark_files() const {
+  return true;
+}
+
+void results_cursor::mark_files( vector<bool> &marks ) const {
+  for ( auto i = begin_; i != end_; ++i )
+    marks[ *i ] = true;
+}
+
+query_cursor::rank_type results_cursor::max_score() const {
+  return max_rank_;
+}
+
+void results_cursor::next() {
+  ++i_;
+  settle();
+}
+
+query_cursor::rank_type results_cursor::score() {
+  return results_[ doc_ ];
+}
+
+void results_cursor::prune_below( rank_type threshold ) {
+  threshold_ = threshold;
+}
+
+void results_cursor::settle() {
+  while ( i_ != end_ && results_[ *i_ ] <= threshold_ )
+    ++i_;
+  doc_ = i_ != end_ ? *i_ : End;
+}
+
+void results_cursor::skip_to( file_index_type target ) {
+  if ( doc_ < target ) {
+    i_ = lower_bound( i_, end_, target );
+    settle();
+  }
+}
+
+////////// scaled_cursor //////////////////////////////////////////////////////
+
+scaled_cursor::scaled_cursor( query_cursor_ptr &&child, rank_type factor ) :
+  child_( std::move( child ) ), factor_( factor )
+{
+  doc_ = child_->doc();
+}
+
+bool scaled_cursor::can_mark_files() const {
+  return child_->can_mark_files();
+}
+
+void scaled_cursor::mark_files( vector<bool> &marks ) const {
+  child_->mark_files( marks );
+}
+
+query_cursor::rank_type scaled_cursor::max_score() const {
+  rank_type const max_score = child_->max_score();
+  if ( max_score == INT_MAX )
+    return INT_MAX;
+  return static_cast<rank_type>(
+    min( static_cast<long long>( max_score ) * factor_, (long long)INT_MAX )
+  );
+}
+
+void scaled_cursor::next() {
+  child_->next();
+  doc_ = child_->doc();
+}
+
+void scaled_cursor::prune_below( rank_type threshold ) {
+  //
+  // For integers, rank * factor > threshold iff rank > threshold / factor.
+  //
+  child_->prune_below( threshold / factor_ );
+}
+
+query_cursor::rank_type scaled_cursor::score() {
+  return child_->score() * factor_;
+}
+
+void scaled_cursor::skip_to( file_index_type target ) {
+  child_->skip_to( target );
+  doc_ = child_->doc();
+}
+
+#ifdef WITH_WORD_POS
+////////// near_cursor ////////////////////////////////////////////////////////
+
+bool is_near( file_list::const_reference file0,
+              file_list::const_reference file1 ) {
+  file_list::const_pointer const file[] = { &file0, &file1 };
+  unsigned pdi[2];                      // pos_deltas_[i] index
+  unsigned pos[2];                      // absolute position for file[i]
+  for ( int i = 0; i < 2; ++i ) {
+    pdi[i] = 0;
+    pos[i] = file[i]->pos_deltas_[0];
+  } // for
+
+  while ( true ) {
+    //
+    // Two words are near each other only if their absolute positions differ
+    // by at most words_near.
+    //
+    int const delta = pos[1] - pos[0];
+    if ( pjl_abs( delta ) <= words_near )
+      return true;
+    //
+    // Increment the ith file's pos_deltas_ index and add the next delta to the
+    // accumulated absolute position.
+    //
+    int const i = delta < 1;
+    if ( ++pdi[i] >= file[i]->pos_deltas_.size() )
+      return false;
+    pos[i] += file[i]->pos_deltas_[ pdi[i] ];
+  } // while
+}
+
+near_cursor::near_cursor( posting_cursor_list &left,
+                          posting_cursor_list &right ) :
+  left_( std::move( left ) ), right_( std::move( right ) )
+{
+  settle( 0 );
+}
+
+void near_cursor::settle( file_index_type target ) {
+  while ( true ) {
+    doc_ = End;
+    for ( auto const &l : left_ ) {
+      l->skip_to( target );
+      doc_ = min( doc_, l->doc() );
+    } // for
+    if ( doc_ == End || right_.empty() ) {
+      doc_ = End;
+      return;
+    }
+    for ( auto const &r : right_ )
+      r->skip_to( doc_ );
+
+    //
+    // Check every pair of left- and right-hand words in the file.  As in
+    // near_node::eval(), the rank is that of the last pair found to be near.
+    //
+    bool found = false;
+    for ( auto const &l : left_ ) {
+      if ( l->doc() != doc_ )
+        continue;
+      for ( auto const &r : right_ ) {
+        if ( r->doc() == doc_ && is_near( l->file(), r->file() ) ) {
+          rank_ = (l->score() + r->score()) / 2;
+          found = true;
+        }
+      } // for
+    } // for
+    if ( found )
+      return;
+    target = doc_ + 1;
+  } // while
+}
+
+void near_cursor::next() {
+  settle( doc_ + 1 );
+}
+
+query_cursor::rank_type near_cursor::score() {
+  return rank_;
+}
+
+void near_cursor::skip_to( file_index_type target ) {
+  if ( doc_ < target )
+    settle( target );
+}
+
+////////// not_near_cursor ////////////////////////////////////////////////////
+
+not_near_cursor::not_near_cursor( index_segment::const_iterator const &word0,
+                                  meta_id_type meta_id0,
+                                  index_segment::const_iterator const &word1,
+                                  meta_id_type meta_id1 ) :
+  list0_( word0 ), file0_( list0_.begin() ), meta_id0_( meta_id0 ),
+  list1_( word1 ), file1_( list1_.begin() ), meta_id1_( meta_id1 )
+{
+  next();
+}
+
+void not_near_cursor::next() {
+  //
+  // This deliberately mirrors the loop in not_near_node::eval(), including
+  // advancing file1_ along with file0_, so the results are the same.
+  //
+  while ( file0_ != list0_.end() ) {
+    bool matches = false;
+    if ( file0_->has_meta_id( meta_id0_ ) ) {
+      while ( file1_ != list1_.end() && file1_->index_ < file0_->index_ )
+        ++file1_;
+      matches = !(
+        file1_ != list1_.end() &&
+        file0_->index_ == file1_->index_ &&
+        file1_->has_meta_id( meta_id1_ ) &&
+        is_near( *file0_, *file1_ )
+      );
+    }
+    doc_  = file0_->index_;
+    rank_ = file0_->rank_;
+    ++file0_;
+    if ( file1_ != list1_.end() )
+      ++file1_;
+    if ( matches )
+      return;
+  } // while
+  doc_ = End;
+}
+
+query_cursor::rank_type not_near_cursor::score() {
+  return rank_;
+}
+
+////////// proximity_cursor ///////////////////////////////////////////////////
+
+proximity_cursor::proximity_cursor( term_list &terms, int window,
+                                    int num_words ) :
+  terms_( std::move( terms ) ), window_( window ), num_words_( num_words ),
+  last_pos_( terms_.size() )
+{
+  settle( 0 );
+}
+
+bool proximity_cursor::is_within_window() {
+  streams_.clear();
+  heap_.clear();
+  for ( term_list::size_type t = 0; t < terms_.size(); ++t ) {
+    for ( auto const &word : terms_[t].words_ ) {
+      if ( word->doc() != doc_ )
+        continue;
+      pos_stream const s = { word->word_pos(), t };
+      if ( !s.pos_.at_end() ) {
+        heap_push(
+          heap_, heap_entry( *s.pos_ - terms_[t].offset_, streams_.size() )
+        );
+        streams_.push_back( s );
+      }
+    } // for
+  } // for
+
+  ::fill( last_pos_.begin(), last_pos_.end(), INT_MIN );
+  term_list::size_type terms_seen = 0;
+  while ( !heap_.empty() ) {
+    heap_entry const top = heap_pop( heap_ );
+    pos_stream &s = streams_[ top.second ];
+    if ( last_pos_[ s.term_ ] == INT_MIN )
+      ++terms_seen;
+    last_pos_[ s.term_ ] = top.first;
+    //
+    // Positions are merged in ascending order, so the current position is the
+    // last of the window of the last positions of all the terms: the terms
+    // are within the window if the first of them is.
+    //
+    if ( terms_seen == terms_.size() &&
+         top.first - *::min_element( last_pos_.begin(), last_pos_.end() )
+           <= window_ )
+      return true;
+    if ( !(++s.pos_).at_end() )
+      heap_push(
+        heap_, heap_entry( *s.pos_ - terms_[ s.term_ ].offset_, top.second )
+      );
+  } // while
+  return false;
+}
+
+void proximity_cursor::next() {
+  settle( doc_ + 1 );
+}
+
+query_cursor::rank_type proximity_cursor::score() {
+  return rank_;
+}
+
+void proximity_cursor::settle( file_index_type target ) {
+  while ( true ) {
+    //
+    // Leapfrog the terms until they're all in the same file.
+    //
+    for ( term_list::size_type t = 0; t < terms_.size(); ) {
+      file_index_type const doc = skip_term( terms_[t], target );
+      if ( doc == End ) {
+        doc_ = End;
+        return;
+      }
+      if ( doc > target ) {
+        target = doc;
+        t = 0;
+      } else
+        ++t;
+    } // for
+    doc_ = target;
+
+    // A single term (e.g., a bigram) is trivially within any window.
+    if ( terms_.size() == 1 || is_within_window() ) {
+      rank_ = 0;
+      for ( auto const &t : terms_ ) {
+        for ( auto const &word : t.words_ ) {
+          if ( word->doc() == doc_ ) {
+            rank_ += word->score();
+            if ( t.either_ )
+              break;
+          }
+        } // for
+      } // for
+      rank_ /= static_cast<rank_type>( num_words_ );
+      return;
+    }
+    target = doc_ + 1;
+  } // while
+}
+
+query_cursor::file_index_type
+proximity_cursor::skip_term( term &t, file_index_type target ) {
+  file_index_type doc = End;
+  for ( auto const &word : t.words_ ) {
+    word->skip_to( target );
+    doc = min( doc, word->doc() );
+  } // for
+  return doc;
+}
+
+void proximity_cursor::skip_to( file_index_type target ) {
+  if ( doc_ < target )
+    settle( target );
+}
+#endif /* WITH_WORD_POS */
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
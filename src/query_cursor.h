@@ -0,0 +1,523 @@
+/*
+**      SWISH++
+**      src/query_cursor.h
+**
+**      Copyright (C) 1998-2016  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef query_cursor_H
+#define query_cursor_H
+
+// local
+#include "config.h"
+#include "file_list.h"
+#include "index_segment.h"
+#include "meta_id.h"
+#include "search_results.h"
+
+// standard
+#include <climits>                      /* for INT_MAX */
+#include <memory>                       /* for unique_ptr */
+#include <utility>                      /* for pair */
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %query_cursor is the abstract base class for all cursors used to evaluate
+ * a query "document-at-a-time."  A cursor is positioned at a file in which
+ * the (sub)query it was compiled from matches; cursors only ever move forward
+ * (in increasing file index order).  A tree of cursors is compiled from a
+ * tree of query_nodes via query_node::make_cursor().
+ *
+ * Unlike query_node::eval(), which produces all the results of a subtree at
+ * once, cursors produce a single result at a time so the memory used is
+ * (except for results_cursor) proportional to the size of the query rather
+ * than the number of results.
+ * The results (file indicies and ranks) are exactly the same, however.
+ */
+class query_cursor {
+public:
+  typedef int file_index_type;
+  typedef int rank_type;
+
+  /**
+   * The file index of a cursor that has reached the end.
+   */
+  static file_index_type const End = INT_MAX;
+
+  virtual ~query_cursor();
+
+  /**
+   * Gets the index of the file the cursor is positioned at.
+   *
+   * @return Returns said index or \c End.
+   */
+  file_index_type doc() const {
+    return doc_;
+  }
+
+  bool at_end() const {
+    return doc_ == End;
+  }
+
+  /**
+   * Advances the cursor to the next matching file.
+   */
+  virtual void next() = 0;
+
+  /**
+   * Gets the rank of the file the cursor is positioned at.  The cursor must
+   * not be at the end.
+   *
+   * @return Returns said rank.
+   */
+  virtual rank_type score() = 0;
+
+  /**
+   * Advances the cursor to the first matching file whose index is at least
+   * the given index.  If the cursor is already there, does nothing.
+   *
+   * @param target The file index to advance to.
+   */
+  virtual void skip_to( file_index_type target );
+
+  /**
+   * Checks whether all the files the cursor matches can be marked (see
+   * mark_files()).
+   *
+   * @return Returns \c true only if they can.
+   */
+  virtual bool can_mark_files() const;
+
+  /**
+   * Marks all the files the cursor matches (regardless of its position).
+   * This is much faster than iterating over them and is used to count the
+   * total number of results when files are pruned (see prune_below()).  It
+   * may be called only if can_mark_files() returns \c true.
+   *
+   * @param marks The marks, one per file in the index: \c marks[i] is set to
+   * \c true for every file \a i the cursor matches.
+   */
+  virtual void mark_files( std::vector<bool> &marks ) const;
+
+  /**
+   * Gets an upper bound of the rank of any file the cursor matches.
+   *
+   * @return Returns said bound or \c INT_MAX if there is none.
+   */
+  virtual rank_type max_score() const;
+
+  /**
+   * Informs the cursor that only files whose ranks are greater than the given
+   * rank are wanted so it may skip over files whose ranks can't be.  This is
+   * only ever called for the root cursor.
+   *
+   * @param threshold The rank a file's rank must be greater than.
+   */
+  virtual void prune_below( rank_type threshold );
+
+protected:
+  query_cursor() : doc_( End ) { }
+
+  file_index_type doc_;
+};
+
+typedef std::unique_ptr<query_cursor> query_cursor_ptr;
+typedef std::vector<query_cursor_ptr> query_cursor_list;
+
+/**
+ * An %and_cursor is-a query_cursor that matches only those files all of its
+ * child cursors match.  Its children "leapfrog" each other: each is skipped
+ * directly to the highest file index any other is positioned at.
+ */
+class and_cursor : public query_cursor {
+public:
+  /**
+   * Constructs an %and_cursor.
+   *
+   * @param children The child cursors.  They are moved from.
+   * @param divisor The sum of the ranks of the children is divided by this.
+   */
+  and_cursor( query_cursor_list &children, rank_type divisor );
+
+  void next();
+  rank_type score();
+  void skip_to( file_index_type );
+
+private:
+  query_cursor_list children_;
+  rank_type const divisor_;
+
+  /**
+   * Advances the child cursors until they're all positioned at the same file.
+   */
+  void align();
+};
+
+/**
+ * An %empty_cursor is-a query_cursor that never matches any file.
+ */
+class empty_cursor : public query_cursor {
+public:
+  void next();
+  rank_type score();
+  bool can_mark_files() const;
+  void mark_files( std::vector<bool>& ) const;
+  rank_type max_score() const;
+};
+
+/**
+ * A %not_cursor is-a query_cursor that matches all files its child cursor
+ * does not.
+ */
+class not_cursor : public query_cursor {
+public:
+  /**
+   * Constructs a %not_cursor.
+   *
+   * @param child The child cursor.
+   * @param num_files The total number of files in the index.
+   */
+  not_cursor( query_cursor_ptr &&child, file_index_type num_files );
+
+  void next();
+  rank_type score();
+  void skip_to( file_index_type );
+
+private:
+  query_cursor_ptr const child_;
+  file_index_type const num_files_;
+
+  void settle();
+};
+
+/**
+ * An %or_cursor is-a query_cursor that matches all files any of its child
+ * cursors match.  The rank is the sum of the ranks of the children positioned
+ * at the file.  The children are kept in a heap ordered by file index so
+ * advancing is O(log n) in the number of children (which can be large for a
+ * "word*" query).
+ *
+ * Once pruning (see prune_below()), it uses the "MaxScore" algorithm: the
+ * children are ordered by their maximum ranks and those whose maximum ranks
+ * sum to no more than the threshold are "non-essential" since a file matched
+ * only by them can't have a rank greater than the threshold.  Only the
+ * essential children are iterated over; the non-essential ones are merely
+ * skipped to the files the essential ones match to add to their ranks.
+ *
+ * See also:
+ *    Howard Turtle and James Flood.  "Query Evaluation: Strategies and
+ *    Optimizations."  Information Processing & Management, 31(6), 1995.
+ *    pp. 831-850.
+ */
+class or_cursor : public query_cursor {
+public:
+  /**
+   * Constructs an %or_cursor.
+   *
+   * @param children The child cursors.  They are moved from.
+   */
+  explicit or_cursor( query_cursor_list &children );
+
+  void next();
+  rank_type score();
+  void skip_to( file_index_type );
+  bool can_mark_files() const;
+  void mark_files( std::vector<bool>& ) const;
+  rank_type max_score() const;
+  void prune_below( rank_type );
+
+private:
+  typedef long long bound_type;
+  typedef query_cursor_list::size_type child_index;
+  typedef std::pair<file_index_type,child_index> heap_entry;
+  typedef std::vector<heap_entry> heap_type;
+
+  query_cursor_list children_;          // in ascending max_score() order
+  std::vector<bound_type> bound_;       // sum of max_score() of [0,i]
+  heap_type essential_;                 // essential children not at doc_
+  heap_type non_essential_;
+  std::vector<child_index> current_;    // essential children at doc_
+  child_index first_essential_;
+  rank_type threshold_;                 // -1 = not pruning
+  rank_type score_;
+
+  void advance();
+  void push( child_index );
+  void settle();
+};
+
+/**
+ * A %posting_cursor is-a query_cursor over the list of files a single word is
+ * in (its "postings").
+ */
+class posting_cursor : public query_cursor {
+public:
+  /**
+   * Constructs a %posting_cursor.
+   *
+   * @param word The word.
+   * @param meta_id The meta ID a file must have for the word to match.
+   * @param decode_word_pos If \c false, the word's positions in files are not
+   * decoded into \c pos_deltas_ (use word_pos() instead).
+   */
+  posting_cursor( index_segment::const_iterator const &word,
+                  meta_id_type meta_id, bool decode_word_pos = true );
+
+  /**
+   * Gets the file the cursor is positioned at.
+   *
+   * @return Returns said file.
+   */
+  file_list::const_reference file() const {
+    return *file_;
+  }
+
+#ifdef WITH_WORD_POS
+  /**
+   * Gets an iterator over the positions of the word in the file the cursor is
+   * positioned at.
+   *
+   * @return Returns said iterator.
+   */
+  file_list::word_pos_iterator word_pos() const {
+    return file_.word_pos();
+  }
+#endif /* WITH_WORD_POS */
+
+  void next();
+  rank_type score();
+  void skip_to( file_index_type );
+  bool can_mark_files() const;
+  void mark_files( std::vector<bool>& ) const;
+  rank_type max_score() const;
+
+private:
+  file_list const list_;
+  file_list::const_iterator file_;
+  meta_id_type const meta_id_;
+  rank_type const max_rank_;
+
+  void settle();
+};
+
+/**
+ * A %results_cursor is-a query_cursor over search results that were already
+ * evaluated all at once by query_node::eval().  Once pruning (see
+ * prune_below()), it skips over the files whose ranks are too low.
+ */
+class results_cursor : public query_cursor {
+public:
+  /**
+   * Constructs a %results_cursor.
+   *
+   * @param results The results.  They are moved from.
+   */
+  explicit results_cursor( search_results &&results );
+
+  void next();
+  rank_type score();
+  void skip_to( file_index_type );
+  bool can_mark_files() const;
+  void mark_files( std::vector<bool>& ) const;
+  rank_type max_score() const;
+  void prune_below( rank_type );
+
+private:
+  search_results results_;
+  search_results::const_iterator begin_, i_, end_;
+  rank_type max_rank_;
+  rank_type threshold_;
+
+  void settle();
+};
+
+/**
+ * A %scaled_cursor is-a query_cursor that matches the same files as its child
+ * cursor, but with ranks multiplied by a factor.  It's used for a word that
+ * occurs more than once in the same "and" or "or".
+ */
+class scaled_cursor : public query_cursor {
+public:
+  /**
+   * Constructs a %scaled_cursor.
+   *
+   * @param child The child cursor.
+   * @param factor The factor to multiply ranks by.
+   */
+  scaled_cursor( query_cursor_ptr &&child, rank_type factor );
+
+  void next();
+  rank_type score();
+  void skip_to( file_index_type );
+  bool can_mark_files() const;
+  void mark_files( std::vector<bool>& ) const;
+  rank_type max_score() const;
+  void prune_below( rank_type );
+
+private:
+  query_cursor_ptr const child_;
+  rank_type const factor_;
+};
+
+#ifdef WITH_WORD_POS
+/**
+ * A %near_cursor is-a query_cursor that matches files where any of a set of
+ * left-hand words is near any of a set of right-hand words.
+ */
+class near_cursor : public query_cursor {
+public:
+  typedef std::vector<std::unique_ptr<posting_cursor>> posting_cursor_list;
+
+  /**
+   * Constructs a %near_cursor.
+   *
+   * @param left The cursors for the left-hand words.  They are moved from.
+   * @param right The cursors for the right-hand words.  They are moved from.
+   */
+  near_cursor( posting_cursor_list &left, posting_cursor_list &right );
+
+  void next();
+  rank_type score();
+  void skip_to( file_index_type );
+
+private:
+  posting_cursor_list left_, right_;
+  rank_type rank_;
+
+  void settle( file_index_type );
+};
+
+/**
+ * A %not_near_cursor is-a query_cursor that matches files where a left-hand
+ * word is either not near a right-hand word or the right-hand word isn't in
+ * the file at all.  It walks both words' lists of files in lock-step exactly
+ * as not_near_node::eval() does so the results are the same.
+ */
+class not_near_cursor : public query_cursor {
+public:
+  /**
+   * Constructs a %not_near_cursor.
+   *
+   * @param word0 The left-hand word.
+   * @param meta_id0 The meta ID a file must have for \a word0 to match.
+   * @param word1 The right-hand word.
+   * @param meta_id1 The meta ID a file must have for \a word1 to match.
+   */
+  not_near_cursor( index_segment::const_iterator const &word0,
+                   meta_id_type meta_id0,
+                   index_segment::const_iterator const &word1,
+                   meta_id_type meta_id1 );
+
+  void next();
+  rank_type score();
+
+private:
+  file_list const list0_;
+  file_list::const_iterator file0_;
+  meta_id_type const meta_id0_;
+  file_list const list1_;
+  file_list::const_iterator file1_;
+  meta_id_type const meta_id1_;
+  rank_type rank_;
+};
+
+/**
+ * A %proximity_cursor is-a query_cursor that matches files where a sequence of
+ * terms all occur within a window of a given number of words.  A term is the
+ * set of words a word_node is for.  Each term has an offset that is
+ * subtracted from its positions first, so an exact phrase is simply a window
+ * of 0 words where each term's offset is its position within the phrase.
+ *
+ * Files all the terms are in are found first by "leapfrogging" as and_cursor
+ * does.  Only for those files are the terms' positions decoded (directly from
+ * the index file) and merged in ascending order via a min-heap while keeping
+ * the last position of each term: the terms are within the window if the last
+ * positions are.  The rank is the sum of the ranks of the terms' words
+ * divided by the number of words which, for two single words, is the same as
+ * for near_cursor.  (The number of words is given separately since a term can
+ * be a bigram of two words.)
+ */
+class proximity_cursor : public query_cursor {
+public:
+  typedef near_cursor::posting_cursor_list posting_cursor_list;
+
+  struct term {
+    posting_cursor_list words_;         // decoding positions lazily
+    int offset_;
+    bool either_;                       // rank only one word, not all?
+
+    term() : offset_( 0 ), either_( false ) { }
+  };
+  typedef std::vector<term> term_list;
+
+  /**
+   * Constructs a %proximity_cursor.
+   *
+   * @param terms The terms.  They are moved from.  Every term must have at
+   * least one word.
+   * @param window The maximum number of words the terms may span.
+   * @param num_words The number of words the sum of the ranks is divided by.
+   */
+  proximity_cursor( term_list &terms, int window, int num_words );
+
+  void next();
+  rank_type score();
+  void skip_to( file_index_type );
+
+private:
+  struct pos_stream {
+    file_list::word_pos_iterator pos_;
+    term_list::size_type term_;
+  };
+  typedef std::pair<int,std::vector<pos_stream>::size_type> heap_entry;
+
+  term_list terms_;
+  int const window_;
+  int const num_words_;
+  rank_type rank_;
+
+  //
+  // These are used only by is_within_window(), but are kept here so memory
+  // is allocated only once rather than once per file.
+  //
+  std::vector<pos_stream> streams_;
+  std::vector<heap_entry> heap_;
+  std::vector<int> last_pos_;
+
+  bool is_within_window();
+  void settle( file_index_type );
+  file_index_type skip_term( term&, file_index_type );
+};
+
+/**
+ * Checks whether two words in the same file are near each other.
+ *
+ * @param file0 The file entry for the first word.
+ * @param file1 The file entry for the second word.
+ * @return Returns \c true only if some position of the first word is at most
+ * words_near positions from some position of the second.
+ */
+bool is_near( file_list::const_reference file0,
+              file_list::const_reference file1 );
+#endif /* WITH_WORD_POS */
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* query_cursor_H */
+/* vim:set et sw=2 ts=2: */
@@ -20,18 +20,45 @@
 */
 
 // local
+#include "config.h"
 #include "file_list.h"
 #include "index_segment.h"
+#ifdef MULTI_THREADED
+#include "pjl/work_stealing_pool.h"
+#endif /* MULTI_THREADED */
 #include "query_node.h"
+#include "search_index.h"
+#include "swishxx-config.h"
 #include "WordsNear.h"
 #include "util.h"
 
 // standard
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <utility>                      /* for move(), pair */
 #include <vector>
 
 using namespace std;
 
+#ifdef MULTI_THREADED
+using PJL::work_stealing_pool;
+
+/**
+ * The minimum total cost of the parts of a node (see query_node::cost()) for
+ * them to be evaluated in parallel: below that, it's faster for a thread to
+ * evaluate them all itself than to hand any of them to other threads.
+ */
+static size_t const Parallel_Cost_Min = 32768;
+
+/**
+ * The minimum cost of a chunk of parts of a node evaluated by one thread.
+ */
+static size_t const Parallel_Chunk_Cost_Min = 8192;
+
+work_stealing_pool *query_workers;
+#endif /* MULTI_THREADED */
+
 ///////////////////////////////////////////////////////////////////////////////
 
 empty_node empty_node::singleton_;
@@ -44,6 +71,32 @@ void empty_node::eval( search_results& ) {
 
 and_node::and_node( pool_type &p, child_node_list &nodes ) : query_node( p ) {
   child_nodes_.swap( nodes );
+  //
+  // See the comment in and_node::eval() for why it's +1.
+  //
+  num_ands_ = child_nodes_.size() + 1;
+  //
+  // Order the child nodes cheapest first so both eval() and the and_cursor
+  // are driven by the rarest term.  A "not" child merely filters the results
+  // of the others, so it goes last regardless of its cost.  (The order doesn't
+  // otherwise matter since addition is commutative.)  Costs are computed only
+  // once each since computing one steps through the words' lists of files.
+  //
+  typedef pair<size_t,query_node*> costed_node;
+  vector<costed_node> costed_nodes;
+  costed_nodes.reserve( child_nodes_.size() );
+  for ( auto const &child : child_nodes_ )
+    costed_nodes.emplace_back(
+      dynamic_cast<not_node*>( child ) ? ~size_t( 0 ) : child->cost(), child
+    );
+  ::stable_sort(
+    costed_nodes.begin(), costed_nodes.end(),
+    []( costed_node const &a, costed_node const &b ) {
+      return a.first < b.first;
+    }
+  );
+  for ( size_t i = 0; i < costed_nodes.size(); ++i )
+    child_nodes_[i] = costed_nodes[i].second;
 }
 
 #ifdef WITH_WORD_POS
@@ -54,10 +107,26 @@ near_node::near_node( pool_type &p, query_node *left, query_node *right ) :
 }
 #endif /* WITH_WORD_POS */
 
+or_node::or_node( pool_type &p, query_node *left, query_node *right ) :
+  query_node( p )
+{
+  child_nodes_.push_back( left  );
+  child_nodes_.push_back( right );
+}
+
 word_node::word_node( pool_type &p, char const *word, word_range const &range,
                       meta_id_type meta_id ) :
   query_node( p ), word_( new_strdup( word ) ), range_( range ),
-  meta_id_( meta_id )
+  meta_id_( meta_id ), weight_( 1 )
+{
+  // do nothing else
+}
+
+word_node::word_node( pool_type &p, char const *word,
+                      index_segment const &matches, meta_id_type meta_id ) :
+  query_node( p ), word_( new_strdup( word ) ), matches_( matches ),
+  range_( matches_.begin(), matches_.end() ),
+  meta_id_( meta_id ), weight_( 1 )
 {
   // do nothing else
 }
@@ -73,6 +142,7 @@ and_node::~and_node() {
 #ifdef WITH_WORD_POS
 near_node     ::~near_node    () { /* See comment in ~and_node(). */ }
 not_near_node ::~not_near_node() { /* See comment in ~and_node(). */ }
+proximity_node::~proximity_node() { /* See comment in ~and_node(). */ }
 #endif /* WITH_WORD_POS */
 not_node      ::~not_node     () { /* See comment in ~and_node(). */ }
 or_node       ::~or_node      () { /* See comment in ~and_node(). */ }
@@ -83,6 +153,161 @@ query_node::visitor::~visitor() {
   // Out-of-line because it's virtual.
 }
 
+////////// optimizer //////////////////////////////////////////////////////////
+
+/**
+ * Merges word_nodes for the same word(s) among a list of child nodes.
+ *
+ * @param nodes The child nodes.
+ */
+static void merge_word_nodes( query_node::child_node_list &nodes ) {
+  for ( auto i = nodes.begin(); i != nodes.end(); ++i ) {
+    word_node *const word = dynamic_cast<word_node*>( *i );
+    if ( !word )
+      continue;
+    nodes.erase(
+      ::remove_if(
+        i + 1, nodes.end(),
+        [word]( query_node *node ) {
+          word_node const *const other = dynamic_cast<word_node*>( node );
+          return other && word->merge( *other );
+        }
+      ),
+      nodes.end()
+    );
+  } // for
+}
+
+void and_node::optimize() {
+  merge_word_nodes( child_nodes_ );
+}
+
+void or_node::optimize() {
+  child_node_list new_child_nodes;
+  for ( auto const &child : child_nodes_ ) {
+    if ( or_node *const o = dynamic_cast<or_node*>( child ) ) {
+      o->optimize();
+      new_child_nodes.insert(
+        new_child_nodes.end(), o->child_nodes_.begin(), o->child_nodes_.end()
+      );
+    } else if ( !dynamic_cast<empty_node*>( child ) ) {
+      new_child_nodes.push_back( child );
+    }
+  } // for
+  merge_word_nodes( new_child_nodes );
+  child_nodes_.swap( new_child_nodes );
+}
+
+#ifdef WITH_WORD_POS
+/**
+ * Makes a word_node for the bigram of two words, if the index has it.
+ *
+ * @param p The pool to allocate the word_node from.
+ * @param word0 The word_node of the first word.
+ * @param word1 The word_node of the second word.
+ * @return Returns said word_node or null if either word_node isn't for a
+ * single word without a meta name, either word is too frequent to be
+ * searched for, or the index has no such bigram.
+ */
+static word_node* bigram_node( query_node::pool_type &p,
+                               word_node const *word0,
+                               word_node const *word1 ) {
+  extern thread_local index_segment bigrams;
+  word_node const *const word[] = { word0, word1 };
+  for ( auto const w : word ) {
+    if ( w->range().second - w->range().first != 1 ||
+         w->meta_id() != Meta_ID_None ||
+         is_too_frequent( file_list( w->range().first ).size() ) )
+      return nullptr;
+  } // for
+
+  string const bigram =
+    string( *word0->range().first ) + ' ' + *word1->range().first;
+  less<char const*> const comparator;
+  auto const found = ::lower_bound(
+    bigrams.begin(), bigrams.end(), bigram.c_str(), comparator
+  );
+  if ( found == bigrams.end() || comparator( bigram.c_str(), *found ) )
+    return nullptr;
+  return new word_node(
+    p, bigram.c_str(), word_range( found, found + 1 ), Meta_ID_None
+  );
+}
+
+void proximity_node::optimize() {
+  extern thread_local index_segment bigrams;
+  if ( !bigrams.size() )
+    return;
+
+  if ( !window_ ) {
+    //
+    // Replace every pair of consecutive terms by their bigram, if any, at the
+    // offset of the first.
+    //
+    vector<term> new_terms;
+    for ( size_t i = 0; i < terms_.size(); ++i ) {
+      term const &t = terms_[i];
+      if ( i + 1 < terms_.size() && terms_[ i + 1 ].offset_ == t.offset_ + 1 )
+        if ( word_node *const b =
+               bigram_node( *pool(), t.nodes_[0], terms_[ i + 1 ].nodes_[0] ) ) {
+          new_terms.push_back( term( 1, b, t.offset_ ) );
+          ++i;
+          continue;
+        }
+      new_terms.push_back( t );
+    } // for
+    terms_.swap( new_terms );
+    return;
+  }
+
+  if ( window_ == 1 && terms_.size() == 2 &&
+       terms_[0].nodes_[0]->range() != terms_[1].nodes_[0]->range() ) {
+    //
+    // Two words are within 1 word of each other only if they're adjacent in
+    // either order.  If one bigram exists, then both words are frequent
+    // enough to have bigrams, so if the other doesn't exist, it's because
+    // the words are never adjacent in that order.
+    //
+    word_node *const ab =
+      bigram_node( *pool(), terms_[0].nodes_[0], terms_[1].nodes_[0] );
+    word_node *const ba =
+      bigram_node( *pool(), terms_[1].nodes_[0], terms_[0].nodes_[0] );
+    if ( !ab && !ba )
+      return;
+    term t( 0, nullptr, 0 );
+    if ( ab )
+      t.nodes_.push_back( ab );
+    if ( ba )
+      t.nodes_.push_back( ba );
+    terms_.assign( 1, t );
+  }
+}
+#endif /* WITH_WORD_POS */
+
+bool word_node::merge( word_node const &other ) {
+  if ( other.range_ != range_ || other.meta_id_ != meta_id_ )
+    return false;
+  weight_ += other.weight_;
+  return true;
+}
+
+query_node* query_node::optimizer::operator()( query_node *node ) const {
+  //
+  // Nodes are optimized in place and visited before their child nodes (that
+  // visit() then visits in turn), so an or_node sees its child or_nodes before
+  // they're visited themselves.
+  //
+  if ( and_node *const a = dynamic_cast<and_node*>( node ) )
+    a->optimize();
+  else if ( or_node *const o = dynamic_cast<or_node*>( node ) )
+    o->optimize();
+#ifdef WITH_WORD_POS
+  else if ( proximity_node *const p = dynamic_cast<proximity_node*>( node ) )
+    p->optimize();
+#endif /* WITH_WORD_POS */
+  return node;
+}
+
 ////////// visitors ///////////////////////////////////////////////////////////
 
 query_node* and_node::visit( visitor const &v ) {
@@ -113,10 +338,9 @@ query_node* not_node::visit( visitor const &v ) {
 
 query_node* or_node::visit( visitor const &v ) {
   query_node *const result = v( this );
-  if ( result == this ) {
-    left() ->visit( v );
-    right()->visit( v );
-  }
+  if ( result == this )
+    for ( auto const &child : child_nodes_ )
+      child->visit( v );
   return result;
 }
 
@@ -124,6 +348,63 @@ query_node* query_node::visit( visitor const &v ) {
   return v( this );
 }
 
+////////// costs //////////////////////////////////////////////////////////////
+
+size_t and_node::cost() const {
+  size_t min_cost = ~size_t( 0 );
+  for ( auto const &child : child_nodes_ )
+    min_cost = min( min_cost, child->cost() );
+  return min_cost;
+}
+
+size_t empty_node::cost() const {
+  return 0;
+}
+
+#ifdef WITH_WORD_POS
+size_t near_node::cost() const {
+  return min( left()->cost(), right()->cost() );
+}
+
+size_t not_near_node::cost() const {
+  return left()->cost();
+}
+
+size_t proximity_node::cost() const {
+  size_t min_cost = ~size_t( 0 );
+  for ( auto const &t : terms_ ) {
+    size_t cost = 0;
+    for ( auto const &node : t.nodes_ )
+      cost += node->cost();
+    min_cost = min( min_cost, cost );
+  } // for
+  return min_cost;
+}
+#endif /* WITH_WORD_POS */
+
+size_t not_node::cost() const {
+  extern thread_local index_segment files;
+  return files.size();
+}
+
+size_t or_node::cost() const {
+  extern thread_local index_segment files;
+  size_t sum = 0;
+  for ( auto const &child : child_nodes_ )
+    sum += child->cost();
+  return min( sum, size_t( files.size() ) );
+}
+
+size_t word_node::cost() const {
+  size_t sum = 0;
+  FOR_EACH_IN_PAIR( range_, i ) {
+    file_list const list( i );
+    if ( !is_too_frequent( list.size() ) )
+      sum += list.size();
+  } // for
+  return sum;
+}
+
 void and_node::eval( search_results &results ) {
   //
   // Evaluate the search results for "and" by evaluating all of its child nodes
@@ -139,81 +420,72 @@ void and_node::eval( search_results &results ) {
   //
   // The problem is that the last term always gets 50% of the weighting.
   //
-  // In order to weight all the terms equally, the "and" results for each term
-  // are saved in a list and then and'ed together at the end.
+  // In order to weight all the terms equally, the ranks for all the terms are
+  // summed and only then averaged.
+  //
+  // The child nodes are ordered cheapest first (see the constructor) so the
+  // running intersection is started from the rarest term and, as soon as it
+  // becomes empty, the remaining (more expensive) child nodes are never
+  // evaluated at all.
   //
-  search_results const empty_place_holder;
-  typedef vector<search_results> child_results_type;
-  child_results_type child_results;
-  child_results.reserve( child_nodes_.size() );
+  auto child_node = child_nodes_.begin();
+  (*child_node)->eval( results );
 
-  for ( auto const &child_node : child_nodes_ ) {
-    search_results results;
-    child_node->eval( results );
-    if ( results.empty() ) {
+  while ( ++child_node != child_nodes_.end() ) {
+    if ( results.empty() )
+      return;
+    search_results child_results;
+    if ( not_node const *const not_child =
+           dynamic_cast<not_node const*>( *child_node ) ) {
       //
-      // Since we're evaluating an "and", we can stop immediately if any of the
-      // child nodes return no results.
+      // For "and not", evaluate only what's being negated and remove the
+      // results it matches rather than evaluating the "not" itself that would
+      // rank every other file in the index.
       //
-      return;
+      word_node const *const word =
+        dynamic_cast<word_node const*>( not_child->child() );
+      if ( word && word->subtract( results, not_node::Rank ) )
+        continue;
+      not_child->child()->eval( child_results );
+      results.filter(
+        [&child_results]( int i, int &rank ) {
+          if ( child_results.contains( i ) )
+            return false;
+          rank += not_node::Rank;
+          return true;
+        }
+      );
+      continue;
     }
+    word_node const *const word = dynamic_cast<word_node const*>( *child_node );
+    if ( word && word->intersect( results ) )
+      continue;
+    (*child_node)->eval( child_results );
     //
-    // Temporarily push an empty "place-holder" search_results onto the back of
-    // the vector to increase its size without copying the actual potentially
-    // large search_results.  Then simply swap it with the actual results in
-    // O(1) time.
-    //
-    // Yes, a vector of pointers to search_results could have been used
-    // instead, but then we'd have to make sure to delete all the
-    // search_results when done in two places: above at the "return" and below
-    // when this function "falls out the bottom."
+    // For each search result, see if it's in the child's results: if it is,
+    // sum the ranks; if it isn't, delete the result.
     //
-    child_results.push_back( empty_place_holder );
-    child_results.back().swap( results );
-  } // for
-
-  //
-  // Pluck out one of the child results and make it *the* result so far.  (It's
-  // easiest to use the last one.  Since it's "and", which one we use doesn't
-  // matter.)
-  //
-  results.swap( child_results.back() );
-  child_results.pop_back();
-
-  //
-  // For each search result, see if it's in each child_result: if it is, sum
-  // the ranks; if it isn't, delete the result.
-  //
-  for ( auto result = results.begin(); result != results.end(); ) {
-    bool increment_result_iterator = true;
-    for ( auto const &child_result : child_results ) {
-      auto const found = child_result.find( result->first );
-      if ( found != child_result.end() ) {
-        result->second += found->second;
-        continue;
+    results.filter(
+      [&child_results]( int i, int &rank ) {
+        if ( !child_results.contains( i ) )
+          return false;
+        rank += child_results[i];
+        return true;
       }
-      //
-      // Erasing an element at a given iterator invalidates the iterator: copy
-      // the iterator to a temporary and increment the real iterator off of the
-      // element to be erased so the real iterator won't be invalidated.
-      //
-      auto const erase_me = result++;
-      results.erase( erase_me );
-      increment_result_iterator = false;
-      break;
-    } // for
-    if ( increment_result_iterator )
-      ++result;
-  } // for
+    );
+  } // while
 
   //
-  // Now that the and-results have been summed, divide each by the number of
-  // and-results, i.e., average them.  (It's +1 below because you have to
-  // include the "results" variable itself.)
+  // Once the ranks have been summed, divide each by the number of and-results,
+  // i.e., average them.
   //
-  int const num_ands = child_nodes_.size() + 1;
-  for ( auto &result : results )
-    result.second /= num_ands;
+  int const num_ands = num_ands_;
+  results.filter(
+    [num_ands]( int, int &rank ) {
+      rank /= num_ands;
+      return true;
+    }
+  );
 }
 
 #ifdef WITH_WORD_POS
@@ -271,7 +543,9 @@ void near_node::eval( search_results &results ) {
           //
           int const delta = pos[1] - pos[0];
           if ( pjl_abs( delta ) <= words_near ) {
-            results[ file[0]->index_ ] = (file[0]->rank_ + file[1]->rank_) / 2;
+            results.assign(
+              file[0]->index_, (file[0]->rank_ + file[1]->rank_) / 2
+            );
             break;
           }
           //
@@ -328,15 +602,16 @@ query_node* near_node::distributor::operator()( query_node *node ) const {
     return new and_node( *node->pool(), new_child_nodes );
   }
   if ( or_node *const o = dynamic_cast<or_node*>( node ) ) {
-    near_node *const new_left = make_node(
-      *node->pool(), other_, o->left()->visit( d )
-    );
-    near_node *const new_right = make_node(
-      *node->pool(), other_, o->right()->visit( d )
-    );
-    return new or_node(
-      *node->pool(), new_left->distribute(), new_right->distribute()
-    );
+    query_node *new_node = nullptr;
+    for ( auto const &child : *o ) {
+      near_node *const new_child = make_node(
+        *node->pool(), other_, child->visit( d )
+      );
+      new_node = new_node ?
+        new or_node( *node->pool(), new_node, new_child->distribute() ) :
+        new_child->distribute();
+    } // for
+    return new_node;
   }
   if ( dynamic_cast<not_node*>( node ) )
     internal_error
@@ -371,7 +646,7 @@ void not_near_node::eval( search_results &results ) {
       //
       for ( auto const &file : list0 )
         if ( file.has_meta_id( node[0]->meta_id() ) )
-          results[ file.index_ ] += file.rank_;
+          results.add( file.index_, file.rank_ );
       continue;
     }
 
@@ -421,7 +696,7 @@ void not_near_node::eval( search_results &results ) {
               pos[i] += file[i]->pos_deltas_[ pdi[i] ];
             } // while
           }
-          results[ file[0]->index_ ] += file[0]->rank_;
+          results.add( file[0]->index_, file[0]->rank_ );
         }
 found_near:
         ++file[0];
@@ -431,84 +706,469 @@ found_near:
     } // for
   } // for
 }
+
+void proximity_node::eval( search_results &results ) {
+  //
+  // Only the files all the words are in need their words' positions checked,
+  // which is exactly what a proximity_cursor does, so just use one.
+  //
+  for ( auto cursor = make_cursor(); !cursor->at_end(); cursor->next() )
+    results.add( cursor->doc(), cursor->score() );
+}
 #endif /* WITH_WORD_POS */
 
 void not_node::eval( search_results &results ) {
-  extern index_segment files;
+  extern thread_local index_segment files;
   search_results child_results;
   child_->eval( child_results );
 
   for ( size_t i = 0; i < files.size(); ++i )
-    if ( child_results.find( i ) == child_results.end() )
-      results[i] = 100;
+    if ( !child_results.contains( i ) )
+      results.assign( i, Rank );
+}
+
+#ifdef MULTI_THREADED
+/**
+ * Evaluates the parts of a node in parallel by query_workers, but only if
+ * that's worthwhile.  The parts are split into contiguous chunks of about
+ * equal cost, at most one per worker plus one for the current thread.  Each
+ * chunk is evaluated into its own search_results (the first directly into
+ * \a results by the current thread) and the ranks of the others are then
+ * added into \a results.  Since addition is commutative, the results are the
+ * same as if the parts had all been evaluated in order.
+ *
+ * @tparam EvalChunkFunction The type of function to evaluate a chunk.
+ * @param costs The cost of each part.
+ * @param eval_chunk The function called as <code>eval_chunk( i, j, r
+ * )</code> to evaluate parts [\a i,\a j) into the search_results \a r.
+ * @param results The search results.
+ * @return Returns \c true only if the parts were evaluated.
+ */
+template<class EvalChunkFunction>
+static bool eval_in_parallel( vector<size_t> const &costs,
+                              EvalChunkFunction eval_chunk,
+                              search_results &results ) {
+  if ( !query_workers || costs.size() < 2 )
+    return false;
+  size_t total = 0;
+  for ( auto const cost : costs )
+    total += cost;
+  if ( total < Parallel_Cost_Min )
+    return false;
+  size_t const num_chunks = min( {
+    costs.size(), size_t( query_workers->size() ) + 1,
+    total / Parallel_Chunk_Cost_Min
+  } );
+  if ( num_chunks < 2 )
+    return false;
+
+  //
+  // Split the parts so that the cumulative cost at the end of the kth chunk
+  // is about k/num_chunks of the total.
+  //
+  vector<size_t> ends;
+  size_t sum = 0;
+  for ( size_t i = 0; i < costs.size() && ends.size() < num_chunks - 1; ) {
+    sum += costs[ i++ ];
+    if ( sum * num_chunks >= total * (ends.size() + 1) )
+      ends.push_back( i );
+  } // for
+  ends.push_back( costs.size() );
+
+  //
+  // The chunks' search results are constructed (and so later destroyed) by
+  // this thread so their buffers come from (and go back to) its pool.
+  //
+  vector<search_results> chunk_results( ends.size() - 1 );
+  {
+    work_stealing_pool::task_group group( *query_workers );
+    search_index const *const index = search_index::in_use();
+    for ( size_t k = 1; k < ends.size(); ++k ) {
+      group.run( [&,k]{
+        index->use();
+        eval_chunk( ends[ k - 1 ], ends[ k ], chunk_results[ k - 1 ] );
+      } );
+    } // for
+    eval_chunk( 0, ends.front(), results );
+    group.wait();
+  }
+
+  for ( auto &r : chunk_results )
+    for ( auto const i : r )
+      results.add( i, r[i] );
+  return true;
 }
+#endif /* MULTI_THREADED */
 
-void or_node::eval( search_results &left_results ) {
-  search_results right_results;
+/**
+ * Evaluates "or" of some child nodes.
+ *
+ * @param first An iterator positioned at the first child node.
+ * @param last An iterator positioned one past the last child node.
+ * @param results The search results.
+ */
+static void eval_or( query_node::child_node_list::const_iterator first,
+                     query_node::child_node_list::const_iterator last,
+                     search_results &results ) {
+  if ( first == last )
+    return;
+  (*first)->eval( results );
 
-  left() ->eval( left_results  );
-  right()->eval( right_results );
+  while ( ++first != last ) {
+    search_results child_results;
+    (*first)->eval( child_results );
+    for ( auto const i : child_results )
+      results.add( i, child_results[i] );
+  } // while
+}
 
-  for ( auto const &result : right_results )
-    left_results[ result.first ] += result.second;
+void or_node::eval( search_results &results ) {
+#ifdef MULTI_THREADED
+  if ( query_workers ) {
+    //
+    // Evaluate chunks of the child nodes in parallel.
+    //
+    vector<size_t> costs;
+    costs.reserve( child_nodes_.size() );
+    for ( auto const &child : child_nodes_ )
+      costs.push_back( child->cost() );
+    auto const eval_chunk =
+      [this]( size_t i, size_t j, search_results &r ) {
+        auto const first = child_nodes_.cbegin();
+        eval_or( first + i, first + j, r );
+      };
+    if ( eval_in_parallel( costs, eval_chunk, results ) )
+      return;
+  }
+#endif /* MULTI_THREADED */
+  eval_or( child_nodes_.begin(), child_nodes_.end(), results );
 }
 
 void word_node::eval( search_results &results ) {
+#ifdef MULTI_THREADED
+  if ( query_workers && range_.second - range_.first > 1 ) {
+    //
+    // Evaluate chunks of the words a wildcard matches in parallel.
+    //
+    vector<size_t> costs;
+    costs.reserve( range_.second - range_.first );
+    FOR_EACH_IN_PAIR( range_, i ) {
+      file_list const list( i );
+      costs.push_back( is_too_frequent( list.size() ) ? 0 : list.size() );
+    } // for
+    auto const eval_chunk =
+      [this]( size_t i, size_t j, search_results &r ) {
+        eval_words( range_.first + i, range_.first + j, r );
+      };
+    if ( eval_in_parallel( costs, eval_chunk, results ) )
+      return;
+  }
+#endif /* MULTI_THREADED */
+  eval_words( range_.first, range_.second, results );
+}
+
+/**
+ * Evaluates some of a word_node's words.
+ *
+ * @param first An iterator positioned at the first word.
+ * @param last An iterator positioned one past the last word.
+ * @param results The search results.
+ */
+void word_node::eval_words( index_segment::const_iterator first,
+                            index_segment::const_iterator last,
+                            search_results &results ) const {
+  for ( ; first != last; ++first ) {
+    file_list const list( first );
+    if ( !is_too_frequent( list.size() ) )
+      list.add_ranks( meta_id_, weight_, results );
+  } // for
+}
+
+/**
+ * Gets the bitmap of the files a word is in for a word_node.
+ *
+ * @param range The word_node's range of words.
+ * @param meta_id The word_node's meta ID.
+ * @return Returns said bitmap or null if the range isn't a single word, there
+ * is a meta ID, or the index has no bitmap for the word.
+ */
+static file_list::byte const* word_bitmap( word_range const &range,
+                                           meta_id_type meta_id ) {
+  if ( range.second - range.first != 1 || meta_id != Meta_ID_None )
+    return nullptr;
+  return file_list( range.first ).bitmap();
+}
+
+bool word_node::intersect( search_results &results ) const {
+  file_list::byte const *const bitmap = word_bitmap( range_, meta_id_ );
+  if ( !bitmap )
+    return false;
+  results.filter(
+    [bitmap]( int i, int& ) {
+      return file_list::in_bitmap( bitmap, i );
+    }
+  );
+  //
+  // Only the ranks of the remaining files are needed: step over all the
+  // others in the word's list without decoding them.
+  //
+  file_list const list( range_.first );
+  auto file = list.begin();
+  for ( auto const i : results ) {
+    file.skip_to( i );
+    results.add( i, file->rank_ * weight_ );
+  }
+  return true;
+}
+
+bool word_node::subtract( search_results &results, int rank ) const {
+  file_list::byte const *const bitmap = word_bitmap( range_, meta_id_ );
+  if ( !bitmap )
+    return false;
+  results.filter(
+    [bitmap,rank]( int i, int &file_rank ) {
+      if ( file_list::in_bitmap( bitmap, i ) )
+        return false;
+      file_rank += rank;
+      return true;
+    }
+  );
+  return true;
+}
+
+////////// cursors ////////////////////////////////////////////////////////////
+
+/**
+ * Combines a list of cursors into a single cursor that matches any of them.
+ *
+ * @param cursors The cursors.  They are moved from.
+ * @return Returns an empty_cursor if there are no cursors, the cursor itself
+ * if there is only one, or an or_cursor otherwise.
+ */
+static query_cursor_ptr make_or_cursor( query_cursor_list &cursors ) {
+  switch ( cursors.size() ) {
+    case 0:
+      return query_cursor_ptr( new empty_cursor );
+    case 1:
+      return std::move( cursors.front() );
+    default:
+      return query_cursor_ptr( new or_cursor( cursors ) );
+  } // switch
+}
+
+query_cursor_ptr and_node::make_cursor() const {
+  query_cursor_list children;
+  children.reserve( child_nodes_.size() );
+  for ( auto const &child_node : child_nodes_ )
+    children.push_back( child_node->make_cursor() );
+  return query_cursor_ptr( new and_cursor( children, num_ands_ ) );
+}
+
+query_cursor_ptr empty_node::make_cursor() const {
+  return query_cursor_ptr( new empty_cursor );
+}
+
+#ifdef WITH_WORD_POS
+query_cursor_ptr near_node::make_cursor() const {
+  word_node const *const node[] = {
+    dynamic_cast<word_node*>( left()  ),
+    dynamic_cast<word_node*>( right() )
+  };
+  if ( !node[0] || !node[1] )
+    return query_cursor_ptr( new empty_cursor );
+
+  if ( node[0]->meta_id() != Meta_ID_None &&
+       node[1]->meta_id() != Meta_ID_None &&
+       node[0]->meta_id() != node[1]->meta_id() )
+    return query_cursor_ptr( new empty_cursor );
+
+  near_cursor::posting_cursor_list cursors[2];
+  for ( int i = 0; i < 2; ++i ) {
+    FOR_EACH_IN_PAIR( node[i]->range(), word ) {
+      file_list const list( word );
+      if ( !is_too_frequent( list.size() ) )
+        cursors[i].emplace_back(
+          new posting_cursor( word, node[i]->meta_id() )
+        );
+    } // for
+  } // for
+  return query_cursor_ptr( new near_cursor( cursors[0], cursors[1] ) );
+}
+
+query_cursor_ptr not_near_node::make_cursor() const {
+  word_node const *const node[] = {
+    dynamic_cast<word_node*>( left()  ),
+    dynamic_cast<word_node*>( right() )
+  };
+  if ( !node[0] )
+    return query_cursor_ptr( new empty_cursor );
+
+  query_cursor_list cursors;
+  FOR_EACH_IN_PAIR( node[0]->range(), word0 ) {
+    file_list const list0( word0 );
+    if ( is_too_frequent( list0.size() ) )
+      continue;
+    if ( !node[1] ) {
+      //
+      // See the comment in not_near_node::eval().
+      //
+      cursors.emplace_back( new posting_cursor( word0, node[0]->meta_id() ) );
+      continue;
+    }
+    FOR_EACH_IN_PAIR( node[1]->range(), word1 )
+      cursors.emplace_back(
+        new not_near_cursor(
+          word0, node[0]->meta_id(), word1, node[1]->meta_id()
+        )
+      );
+  } // for
+  return make_or_cursor( cursors );
+}
+
+query_cursor_ptr proximity_node::make_cursor() const {
+  proximity_cursor::term_list terms( terms_.size() );
+  for ( size_t i = 0; i < terms_.size(); ++i ) {
+    for ( auto const &node : terms_[i].nodes_ ) {
+      FOR_EACH_IN_PAIR( node->range(), word ) {
+        file_list const list( word );
+        if ( !is_too_frequent( list.size() ) )
+          terms[i].words_.emplace_back(
+            new posting_cursor( word, node->meta_id(), false )
+          );
+      } // for
+    } // for
+    if ( terms[i].words_.empty() )
+      return query_cursor_ptr( new empty_cursor );
+    terms[i].offset_ = terms_[i].offset_;
+    terms[i].either_ = terms_[i].nodes_.size() > 1;
+  } // for
+  return query_cursor_ptr(
+    new proximity_cursor( terms, window_, num_words_ )
+  );
+}
+#endif /* WITH_WORD_POS */
+
+query_cursor_ptr not_node::make_cursor() const {
+  extern thread_local index_segment files;
+  return query_cursor_ptr(
+    new not_cursor( child_->make_cursor(), files.size() )
+  );
+}
+
+query_cursor_ptr or_node::make_cursor() const {
+  query_cursor_list children;
+  children.reserve( child_nodes_.size() );
+  for ( auto const &child_node : child_nodes_ )
+    children.push_back( child_node->make_cursor() );
+  return make_or_cursor( children );
+}
+
+query_cursor_ptr word_node::make_cursor() const {
+  if ( range_.second - range_.first > Word_Cursors_Max ) {
+    //
+    // Merging a cursor per word costs more than it saves for this many words,
+    // so get the results all at once as word_node::eval() does.  (Bounding
+    // which words to read by their maximum ranks wouldn't save anything: all
+    // of their files have to be stepped over anyway to count the results and
+    // adding their ranks while doing so costs next to nothing more.)  The
+    // results_cursor still skips files whose ranks are too low once pruning.
+    //
+    search_results results;
+    eval_words( range_.first, range_.second, results );
+    return query_cursor_ptr( new results_cursor( std::move( results ) ) );
+  }
+  query_cursor_list cursors;
   FOR_EACH_IN_PAIR( range_, i ) {
     file_list const list( i );
-    if ( is_too_frequent( list.size() ) )
-      continue;
-    for ( auto const &file : list )
-      if ( file.has_meta_id( meta_id_ ) )
-        results[ file.index_ ] += file.rank_;
+    if ( !is_too_frequent( list.size() ) )
+      cursors.emplace_back( new posting_cursor( i, meta_id_ ) );
   } // for
+  query_cursor_ptr cursor( make_or_cursor( cursors ) );
+  if ( weight_ != 1 )
+    cursor.reset( new scaled_cursor( std::move( cursor ), weight_ ) );
+  return cursor;
 }
 
-#ifdef DEBUG_eval_query
 ////////// print //////////////////////////////////////////////////////////////
 
-ostream& and_node::print( ostream &o ) const {
-  bool flag = false;
-  for ( auto const &child : child_nodes_ ) {
-    if ( flag )
-      o << "and";
-    else
-      flag = true;
-    o << " (" << child->print( o ) << ") ";
-  }
+/**
+ * Prints the indentation for a node at a given depth within a query tree.
+ *
+ * @param o The ostream to print to.
+ * @param depth The depth.
+ * @return Returns \a o.
+ */
+static ostream& indent( ostream &o, int depth ) {
+  while ( depth-- > 0 )
+    o << "  ";
+  return o;
+}
+
+ostream& and_node::print( ostream &o, int depth ) const {
+  indent( o, depth ) << "and cost=" << cost() << '\n';
+  for ( auto const &child : child_nodes_ )
+    child->print( o, depth + 1 );
   return o;
 }
 
-ostream& empty_node::print( ostream &o ) const {
-  return o << "<empty>";
+ostream& empty_node::print( ostream &o, int depth ) const {
+  return indent( o, depth ) << "<empty> cost=" << cost() << '\n';
 }
 
-ostream& near_node::print( ostream &o ) const {
-  o << " (" << left() ->print( o ) << ") near ("
-    <<         right()->print( o ) << ") ";
+#ifdef WITH_WORD_POS
+ostream& near_node::print( ostream &o, int depth ) const {
+  indent( o, depth ) << "near cost=" << cost() << '\n';
+  left() ->print( o, depth + 1 );
+  right()->print( o, depth + 1 );
   return o;
 }
 
-ostream& not_near_node::print( ostream &o ) const {
-  o << " (" << left() ->print( o ) << ") not near ("
-    <<         right()->print( o ) << ") ";
+ostream& not_near_node::print( ostream &o, int depth ) const {
+  indent( o, depth ) << "not near cost=" << cost() << '\n';
+  left() ->print( o, depth + 1 );
+  right()->print( o, depth + 1 );
   return o;
 }
 
-ostream& not_node::print( ostream &o ) const {
-  return o << "not (" << child_->print( o ) << ") ";
+ostream& proximity_node::print( ostream &o, int depth ) const {
+  indent( o, depth );
+  if ( window_ )
+    o << "near/" << window_;
+  else
+    o << "phrase";
+  o << " cost=" << cost() << '\n';
+  for ( auto const &t : terms_ ) {
+    if ( t.nodes_.size() > 1 ) {
+      indent( o, depth + 1 ) << "either\n";
+      for ( auto const &node : t.nodes_ )
+        node->print( o, depth + 2 );
+    } else
+      t.nodes_[0]->print( o, depth + 1 );
+  } // for
+  return o;
+}
+#endif /* WITH_WORD_POS */
+
+ostream& not_node::print( ostream &o, int depth ) const {
+  indent( o, depth ) << "not cost=" << cost() << '\n';
+  return child_->print( o, depth + 1 );
 }
 
-ostream& or_node::print( ostream &o ) const {
-  o << " (" << left() ->print( o ) << ") or ("
-    <<         right()->print( o ) << ") ";
+ostream& or_node::print( ostream &o, int depth ) const {
+  indent( o, depth ) << "or cost=" << cost() << '\n';
+  for ( auto const &child : child_nodes_ )
+    child->print( o, depth + 1 );
   return o;
 }
 
-ostream& word_node::print( ostream &o ) const {
-  return o << '"' << word_ << '"';
+ostream& word_node::print( ostream &o, int depth ) const {
+  indent( o, depth ) << '"' << word_ << "\" cost=" << cost();
+  if ( range_.second - range_.first != 1 )
+    o << " words=" << range_.second - range_.first;
+  if ( weight_ != 1 )
+    o << " weight=" << weight_;
+  return o << '\n';
 }
-#endif /* DEBUG_eval_query */
 
 ///////////////////////////////////////////////////////////////////////////////
 /* vim:set et sw=2 ts=2: */
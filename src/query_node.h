@@ -28,12 +28,13 @@
 #include "query.h"
 
 // standard
-#ifdef DEBUG_eval_query
 #include <iostream>
-#endif /* DEBUG_eval_query */
 #include <new>
+#include <utility>                      /* for pair */
 #include <vector>
 
+class word_node;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -41,6 +42,8 @@
  */
 class query_node : public PJL::auto_delete_obj<query_node> {
 public:
+  typedef std::vector<query_node*> child_node_list;
+
   /**
    * A %visitor is an abstract base class for an object that "visits" nodes in
    * the tree during traversal.
@@ -51,13 +54,69 @@ public:
     virtual query_node* operator()( query_node* ) const = 0;
   };
 
+  /**
+   * An %optimizer is-a visitor that rewrites a query tree in place into one
+   * that's cheaper to evaluate yet yields exactly the same results.  It:
+   *
+   *  + Flattens nested or_nodes into a single or_node.  For example:
+   *    \code
+   *    (cat or dog) or (bird or fish)
+   *    \endcode
+   *    becomes a single "or" of all four words.  (Nested and_nodes can't be
+   *    flattened since that would change the ranks.)
+   *  + Removes empty_node children of or_nodes.
+   *  + Merges word_nodes for the same word(s) that are children of the same
+   *    and_node or or_node into a single word_node whose ranks are counted as
+   *    many times.  For example, in:
+   *    \code
+   *    cat or dog or cat
+   *    \endcode
+   *    "cat" is evaluated only once.
+   *  + Replaces pairs of adjacent words in exact phrases and "near/1" by their
+   *    bigrams, if the index has them.  See proximity_node::optimize().
+   *
+   * Meta names need not be "pushed down" since the parser already gives them
+   * to every word_node.
+   */
+  class optimizer : public visitor {
+  public:
+    query_node* operator()( query_node* ) const;
+  };
+
   virtual ~query_node();
 
+  /**
+   * Estimates the number of files in this node's results.  The estimate is
+   * computed from the sizes of the words' lists of files and is an upper
+   * bound.  It's used to evaluate the cheapest child nodes of an and_node
+   * first.
+   *
+   * @return Returns said estimate.
+   */
+  virtual size_t cost() const = 0;
+
   virtual void eval( search_results& ) = 0;
+
+  /**
+   * Compiles this node (and all its child nodes) into a tree of cursors for
+   * evaluating the query document-at-a-time.  The cursors yield the same
+   * results as eval().
+   *
+   * @return Returns the root of the cursor tree.
+   */
+  virtual query_cursor_ptr make_cursor() const = 0;
+
+  /**
+   * Prints this node (and all its child nodes) as an indented tree, one node
+   * per line, along with its cost().
+   *
+   * @param o The ostream to print to.
+   * @param depth The depth of this node within the tree.
+   * @return Returns \a o.
+   */
+  virtual std::ostream& print( std::ostream &o, int depth = 0 ) const = 0;
+
   virtual query_node* visit( visitor const& );
-# ifdef DEBUG_eval_query
-  virtual std::ostream& print( std::ostream& ) const = 0;
-# endif
 
 protected:
   query_node() { }
@@ -69,8 +128,6 @@ protected:
  */
 class and_node : public query_node {
 public:
-  typedef std::vector<query_node*> child_node_list;
-
   typedef child_node_list::iterator iterator;
   typedef child_node_list::const_iterator const_iterator;
   typedef child_node_list::reverse_iterator reverse_iterator;
@@ -83,14 +140,27 @@ public:
   const_iterator  begin() const       { return child_nodes_.begin(); }
   iterator        end()               { return child_nodes_.end(); }
   const_iterator  end() const         { return child_nodes_.end(); }
+  size_t          cost() const;
   void            eval( search_results& );
+  query_cursor_ptr make_cursor() const;
+
+  /**
+   * Merges child word_nodes for the same word(s).  See optimizer.
+   */
+  void            optimize();
+
+  std::ostream&   print( std::ostream&, int = 0 ) const;
   query_node*     visit( visitor const& );
-# ifdef DEBUG_eval_query
-  std::ostream&   print( std::ostream& ) const;
-# endif
 
 protected:
   child_node_list child_nodes_;
+
+  //
+  // The sum of the ranks of the child nodes is divided by this.  It's kept
+  // separately from the number of child nodes since optimize() can reduce
+  // that number without changing the ranks.
+  //
+  int num_ands_;
 };
 
 /**
@@ -107,10 +177,10 @@ public:
   void  operator delete( void*, size_t )    { /* do nothing */ }
 
   // inherited
+  size_t cost() const;
   void eval( search_results& );
-# ifdef DEBUG_eval_query
-  std::ostream& print( std::ostream& ) const;
-# endif
+  query_cursor_ptr make_cursor() const;
+  std::ostream& print( std::ostream&, int = 0 ) const;
 
 private:
   static empty_node singleton_;
@@ -169,15 +239,14 @@ public:
    */
   query_node* distribute();
 
+  size_t      cost() const;
   void        eval( search_results& );
   query_node* left () const             { return left_child_ ; }
+  query_cursor_ptr make_cursor() const;
+  std::ostream& print( std::ostream&, int = 0 ) const;
   query_node* right() const             { return right_child_; }
   query_node* visit( visitor const& );
 
-# ifdef DEBUG_eval_query
-  std::ostream& print( std::ostream& ) const;
-# endif
-
 private:
   query_node *const left_child_, *const right_child_;
 };
@@ -191,11 +260,76 @@ public:
     near_node( pool, left, right ) { }
   ~not_near_node();
 
+  size_t cost() const;
   void eval( search_results& );
+  query_cursor_ptr make_cursor() const;
+  std::ostream& print( std::ostream&, int = 0 ) const;
+};
+
+/**
+ * A %proximity_node is-a query_node that implements either an exact phrase
+ * (words in quotes) or "near/N" among any number of words in queries.  Like a
+ * near_node, its terms MUST be word_nodes.  Unlike a near_node, it's evaluated
+ * via a proximity_cursor that decodes the words' positions only for those
+ * files all the words are in.
+ */
+class proximity_node : public query_node {
+public:
+  /**
+   * Constructs a %proximity_node.
+   *
+   * @param p The pool the node is allocated from.
+   * @param window The maximum number of words the terms may span: 0 for an
+   * exact phrase.
+   */
+  proximity_node( pool_type &p, int window ) :
+    query_node( p ), num_words_( 0 ), window_( window ) { }
+  ~proximity_node();
+
+  /**
+   * Adds a term.
+   *
+   * @param node The word_node for the term.
+   * @param offset For an exact phrase, the term's position within it; for
+   * "near/N," 0.
+   */
+  void add_term( word_node *node, int offset ) {
+    terms_.push_back( term( 1, node, offset ) );
+    ++num_words_;
+  }
 
-# ifdef DEBUG_eval_query
-  std::ostream& print( std::ostream& ) const;
-# endif
+  size_t      cost() const;
+  void        eval( search_results& );
+  query_cursor_ptr make_cursor() const;
+
+  /**
+   * Replaces pairs of adjacent single words (without meta names) by their
+   * bigram, if the index has it.  For an exact phrase, every pair of
+   * consecutive terms is a candidate; for "near/1" of two words, the term
+   * becomes either of the words' two bigrams.  The ranks don't change since a
+   * bigram's rank is the sum of its words' ranks.  See optimizer.
+   */
+  void        optimize();
+
+  std::ostream& print( std::ostream&, int = 0 ) const;
+  int         window() const            { return window_; }
+
+private:
+  //
+  // A term is usually a single word_node, but optimize() can make it either
+  // of two bigram word_nodes.
+  //
+  struct term {
+    term( size_t n, word_node *node, int offset ) :
+      nodes_( n, node ), offset_( offset ) { }
+
+    std::vector<word_node*> nodes_;     // any one of which may match
+    int offset_;
+  };
+
+  std::vector<term> terms_;
+  int num_words_;                       // the sum of the ranks is divided by
+  int const window_;
 };
 #endif /* WITH_WORD_POS */
 
@@ -204,40 +338,54 @@ public:
  */
 class not_node : public query_node {
 public:
+  /**
+   * The rank of every file a "not" matches.
+   */
+  static int const Rank = 100;
+
   not_node( pool_type &p, query_node *child ) :
     query_node( p ), child_( child ) { }
   ~not_node();
 
   query_node* child() const { return child_; }
+  size_t      cost() const;
   void        eval( search_results& );
+  query_cursor_ptr make_cursor() const;
+  std::ostream& print( std::ostream&, int = 0 ) const;
   query_node* visit( visitor const& );
-# ifdef DEBUG_eval_query
-  std::ostream& print( std::ostream& ) const;
-# endif
 
 private:
   query_node *const child_;
 };
 
 /**
- * An %or_node is-a query_node that implements "or" in queries.
+ * An %or_node is-a query_node that implements "or" in queries.  The parser
+ * creates it with two child nodes, but optimize() can give it any number.
  */
 class or_node : public query_node {
 public:
-  or_node( pool_type &p, query_node *left, query_node *right ) :
-    query_node( p ), left_child_( left ), right_child_( right ) { }
+  typedef child_node_list::const_iterator const_iterator;
+
+  or_node( pool_type&, query_node *left, query_node *right );
   ~or_node();
 
+  const_iterator begin() const { return child_nodes_.begin(); }
+  const_iterator end() const   { return child_nodes_.end(); }
+  size_t      cost() const;
   void        eval( search_results& );
-  query_node* left () const { return left_child_ ; }
-  query_node* right() const { return right_child_; }
+  query_cursor_ptr make_cursor() const;
+
+  /**
+   * Flattens child or_nodes into this one, removes child empty_nodes, and
+   * merges child word_nodes for the same word(s).  See optimizer.
+   */
+  void        optimize();
+
+  std::ostream& print( std::ostream&, int = 0 ) const;
   query_node* visit( visitor const& );
-# ifdef DEBUG_eval_query
-  std::ostream& print( std::ostream& ) const;
-# endif /* DEBUG_eval_query */
 
 private:
-  query_node *const left_child_, *const right_child_;
+  child_node_list child_nodes_;
 };
 
 /**
@@ -247,19 +395,71 @@ private:
 class word_node : public query_node {
 public:
   word_node( pool_type&, char const*, word_range const&, meta_id_type );
+
+  /**
+   * Constructs a %word_node for all the words of a segment.
+   *
+   * @param p The pool to allocate the node from.
+   * @param word The word (wildcard) as given in the query.
+   * @param matches The subset of the words segment the wildcard matches.  A
+   * copy is kept by the node.
+   * @param meta_id The meta ID the words must be in, if any.
+   */
+  word_node( pool_type &p, char const *word, index_segment const &matches,
+             meta_id_type meta_id );
+
   ~word_node();
 
+  size_t cost() const;
   void eval( search_results& );
+
+  /**
+   * Removes the search results for files the word isn't in and adds the
+   * word's ranks to the rest.  This is done only if the node is for a single
+   * word without a meta name and the index has a bitmap of the files the
+   * word is in.
+   *
+   * @param results The search results to filter.
+   * @return Returns \c true only if the results were filtered.
+   */
+  bool intersect( search_results &results ) const;
+
+  query_cursor_ptr make_cursor() const;
+
+  /**
+   * Merges another word_node for the same word(s) into this one so this
+   * node's ranks count as many times as both nodes' ranks would have.
+   *
+   * @param other The other word_node.
+   * @return Returns \c true only if \a other is for the same word(s) and
+   * meta ID and so was merged.
+   */
+  bool merge( word_node const &other );
+
   meta_id_type meta_id() const { return meta_id_; }
+  std::ostream& print( std::ostream&, int = 0 ) const;
   word_range const& range() const { return range_; }
-# ifdef DEBUG_eval_query
-  std::ostream& print( std::ostream& ) const;
-# endif /* DEBUG_eval_query */
+
+  /**
+   * Removes the search results for files the word is in and adds the given
+   * rank to the rest.  This is done only under the same conditions as for
+   * intersect().
+   *
+   * @param results The search results to filter.
+   * @param rank The rank to add.
+   * @return Returns \c true only if the results were filtered.
+   */
+  bool subtract( search_results &results, int rank ) const;
 
 private:
+  void eval_words( index_segment::const_iterator,
+                   index_segment::const_iterator, search_results& ) const;
+
   char *const word_;
+  index_segment const matches_;         // empty unless a subset of the words
   word_range const range_;
   meta_id_type const meta_id_;
+  int weight_;                          // ranks are multiplied by this
 };
 
 ////////// inlines ////////////////////////////////////////////////////////////
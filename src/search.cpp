@@ -20,27 +20,36 @@
 */
 
 // local
+#include "binary_protocol.h"
 #include "classic_formatter.h"
 #include "config.h"
 #include "exit_codes.h"
 #include "file_info.h"
 #include "file_list.h"
+#include "http_protocol.h"
 #include "indexer.h"
 #include "IndexFile.h"
 #include "index_segment.h"
+#include "json_formatter.h"
 #include "pjl/less.h"
-#include "pjl/mmap_file.h"
 #include "pjl/omanip.h"
 #include "pjl/option_stream.h"
 #include "query.h"
 #include "ResultSeparator.h"
+#include "QueryEvaluator.h"
 #include "ResultsFormat.h"
 #include "results_formatter.h"
 #include "ResultsMax.h"
+#include "FuzzyWordsMax.h"
+#include "HugePages.h"
 #include "search.h"
+#include "search_index.h"
 #include "StemWords.h"
 #include "token.h"
 #include "util.h"
+#include "WarmUp.h"
+#include "WarmUpLock.h"
+#include "WarmUpQueries.h"
 #include "WordFilesMax.h"
 #include "WordPercentMax.h"
 #ifdef WITH_WORD_POS
@@ -49,11 +58,18 @@
 #include "word_util.h"
 #include "xml_formatter.h"
 #ifdef WITH_SEARCH_DAEMON
+#include "DaemonHTTP.h"
+#include "DaemonIO.h"
+#include "DaemonListeners.h"
+#include "DaemonPinListeners.h"
 #include "Group.h"
 #ifdef __APPLE__
 #include "LaunchdCooperation.h"
 #endif /* __APPLE__ */
 #include "PidFile.h"
+#include "pjl/work_stealing_pool.h"
+#include "QueryThreads.h"
+#include "ReloadInterval.h"
 #include "SearchBackground.h"
 #include "SearchDaemon.h"
 #include "SocketAddress.h"
@@ -70,10 +86,15 @@
 #include <algorithm>                    /* for binary_search(), etc */
 #include <cstdlib>                      /* for exit(3) */
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <iterator>
 #include <memory>                       /* for unique_ptr */
+#include <sstream>
 #include <string>
+#ifdef MULTI_THREADED
+#include <pthread.h>
+#endif /* MULTI_THREADED */
 #include <sys/resource.h>               /* for RLIMIT_* */
 #include <sys/time.h>                   /* needed by FreeBSD systems */
 #include <time.h>                       /* needed by sys/resource.h */
@@ -95,19 +116,28 @@ typedef pair<int,int> search_result;
 //
 //*****************************************************************************
 
-index_segment       directories, files, meta_names, stop_words, words;
+FuzzyWordsMax       fuzzy_words_max;
+HugePages           huge_pages;
 IndexFile           index_file_name;
 ResultsMax          max_results;
 char const*         me;                         // executable name
+QueryEvaluator      query_evaluator;
 ResultSeparator     result_separator;
 ResultsFormat       results_format;
 StemWords           stem_words;
+WarmUp              warm_up;
+WarmUpLock          warm_up_lock;
+WarmUpQueries       warm_up_queries;
 WordFilesMax        word_files_max;
 WordPercentMax      word_percent_max;
 #ifdef WITH_WORD_POS
 WordsNear           words_near;
 #endif /* WITH_WORD_POS */
 #ifdef WITH_SEARCH_DAEMON
+DaemonHTTP          daemon_http;
+DaemonIO            daemon_io;
+DaemonListeners     daemon_listeners;
+DaemonPinListeners  daemon_pin_listeners;
 SearchDaemon        daemon_type;
 Group               group;
 #ifdef __APPLE__
@@ -116,6 +146,8 @@ LaunchdCooperation  launchd_cooperation;
 ThreadsMax          max_threads;
 ThreadsMin          min_threads;
 PidFile             pid_file_name;
+QueryThreads        query_threads;
+ReloadInterval      reload_interval;
 SearchBackground    search_background;
 SocketAddress       socket_address;
 SocketFile          socket_file_name;
@@ -128,6 +160,7 @@ void                become_daemon();
 #endif /* WITH_SEARCH_DAEMON */
 static void         dump_single_word( char const*, ostream& = cout );
 static void         dump_word_window( char const*, int, int, ostream& = cout );
+static void         warm_up_with_queries( char const* );
 static ostream&     write_file_info( ostream&, char const* );
 
 inline omanip<char const*> index_file_info( int index ) {
@@ -154,16 +187,28 @@ int main( int argc, char *argv[] ) {
   //
   conf_var::parse_file( opt.config_file_name_arg );
 
-  if ( opt.index_file_name_arg )
-    index_file_name = opt.index_file_name_arg;
+  if ( opt.fuzzy_words_max_arg )
+    fuzzy_words_max = opt.fuzzy_words_max_arg;
+  if ( opt.huge_pages_arg )
+    huge_pages = opt.huge_pages_arg;
+  if ( opt.index_file_name_args.size() == 1 )
+    index_file_name = opt.index_file_name_args[0];
   if ( opt.max_results_arg )
     max_results = opt.max_results_arg;
+  if ( opt.query_evaluator_arg )
+    query_evaluator = opt.query_evaluator_arg;
   if ( opt.results_format_arg )
     results_format = opt.results_format_arg;
   if ( opt.result_separator_arg )
     result_separator = opt.result_separator_arg;
   if ( opt.stem_words_opt )
     stem_words = true;
+  if ( opt.warm_up_arg )
+    warm_up = opt.warm_up_arg;
+  if ( opt.warm_up_lock_opt )
+    warm_up_lock = true;
+  if ( opt.warm_up_queries_arg )
+    warm_up_queries = opt.warm_up_queries_arg;
   if ( opt.word_files_max_arg )
     word_files_max = opt.word_files_max_arg;
   if ( opt.word_percent_max_arg )
@@ -173,6 +218,12 @@ int main( int argc, char *argv[] ) {
     words_near = opt.words_near_arg;
 #endif /* WITH_WORD_POS */
 #ifdef WITH_SEARCH_DAEMON
+  if ( opt.http_opt )
+    daemon_http = true;
+  if ( opt.daemon_io_arg )
+    daemon_io = opt.daemon_io_arg;
+  if ( opt.daemon_listeners_arg )
+    daemon_listeners = opt.daemon_listeners_arg;
   if ( opt.daemon_type_arg )
     daemon_type = opt.daemon_type_arg;
   if ( opt.group_arg )
@@ -187,6 +238,12 @@ int main( int argc, char *argv[] ) {
     min_threads = opt.min_threads_arg;
   if ( opt.pid_file_name_arg )
     pid_file_name = opt.pid_file_name_arg;
+  if ( opt.pin_listeners_opt )
+    daemon_pin_listeners = true;
+  if ( opt.query_threads_arg )
+    query_threads = opt.query_threads_arg;
+  if ( opt.reload_interval_arg )
+    reload_interval = opt.reload_interval_arg;
   if ( opt.search_background_opt
 #ifdef __APPLE__
        || launchd_cooperation
@@ -214,6 +271,7 @@ int main( int argc, char *argv[] ) {
   bool const dump_something =
     opt.dump_entire_index_opt ||
     opt.dump_meta_names_opt   ||
+    opt.dump_resident_opt     ||
     opt.dump_stop_words_opt   ||
     opt.dump_word_index_opt   ||
     opt.print_help_opt        ||
@@ -245,19 +303,29 @@ int main( int argc, char *argv[] ) {
     max_out_limit( RLIMIT_AS );         // max-out total avail. memory
 #endif /* RLIMIT_AS */
 
-  mmap_file const the_index( index_file_name );
-  if ( !the_index ) {
-    error() << "could not read index from \"" << index_file_name
-            << '"' << error_string( the_index.error() );
+  //
+  // More than one index may be given via multiple -i options or a manifest
+  // file: each index is a "shard" that's searched in parallel.
+  //
+  vector<char const*> index_file_names( opt.index_file_name_args );
+  if ( index_file_names.size() <= 1 )
+    index_file_names.assign( 1, index_file_name );
+  search_index::set_huge_pages(
+    huge_pages == "advise" ? search_index::hp_advise :
+    huge_pages == "copy"   ? search_index::hp_copy :
+                             search_index::hp_none
+  );
+  search_index::set_warm_up(
+    warm_up == "tables"     ? search_index::wu_tables :
+    warm_up == "dictionary" ? search_index::wu_dictionary :
+    warm_up == "all"        ? search_index::wu_all :
+                              search_index::wu_none,
+    warm_up_lock
+  );
+  if ( !search_index::load( index_file_names ) )
     ::exit( Exit_No_Read_Index );
-  }
-  the_index.behavior( mmap_file::bt_random );
-
-  words      .set_index_file( the_index, index_segment::isi_word      );
-  stop_words .set_index_file( the_index, index_segment::isi_stop_word );
-  directories.set_index_file( the_index, index_segment::isi_dir       );
-  files      .set_index_file( the_index, index_segment::isi_file      );
-  meta_names .set_index_file( the_index, index_segment::isi_meta_name );
+  if ( !dump_something && *warm_up_queries )
+    warm_up_with_queries( warm_up_queries );
 
 #ifdef WITH_SEARCH_DAEMON
   ////////// Become a daemon //////////////////////////////////////////////////
@@ -268,6 +336,9 @@ int main( int argc, char *argv[] ) {
 
   ////////// Perform the query ////////////////////////////////////////////////
 
+#ifdef MULTI_THREADED
+  start_query_threads();
+#endif /* MULTI_THREADED */
   service_request( argv, opt );
   ::exit( Exit_Success );
 }
@@ -370,72 +441,414 @@ static void dump_word_window( char const *word, int window_size, int match,
   out << '\n';
 }
 
+/**
+ * Compares two search results by rank (highest first) and, for equal ranks,
+ * by file index (lowest first) so the order of results is deterministic.
+ *
+ * @param i The first search result.
+ * @param j The second search result.
+ * @return Returns \c true only if \a i should be output before \a j.
+ */
+inline bool ranks_before( search_result const &i, search_result const &j ) {
+  return i.second > j.second || (i.second == j.second && i.first < j.first);
+}
+
+/**
+ * A %top_results selects the top search results in rank order.  Only the top
+ * \a n results are ever kept (in a heap whose top is the worst result kept)
+ * so the time taken is O(r log n) rather than O(r log r) to sort all \a r
+ * results.  Results may be added in any order.
+ */
+class top_results {
+public:
+  /**
+   * Constructs a %top_results.
+   *
+   * @param n The number of top results to keep.
+   */
+  explicit top_results( size_t n ) : n_( n ), total_( 0 ) { }
+
+  /**
+   * Adds a search result.
+   *
+   * @param i The file's index.
+   * @param rank The file's rank.
+   */
+  void add( int i, int rank );
+
+  /**
+   * Sorts the top results.  No results may be added afterwards.
+   *
+   * @return Returns the top results, best first.
+   */
+  vector<search_result> const& sorted() {
+    ::sort_heap( top_.begin(), top_.end(), ranks_before );
+    return top_;
+  }
+
+  /**
+   * Checks whether \a n results are being kept, i.e., whether a result must
+   * now have a rank greater than threshold() to be kept.
+   *
+   * @return Returns \c true only if full.
+   */
+  bool full() const {
+    return n_ && top_.size() == n_;
+  }
+
+  /**
+   * Sets the total number of results when it's known by other means.
+   *
+   * @param total The total number of results.
+   */
+  void set_total( size_t total ) {
+    total_ = total;
+  }
+
+  /**
+   * Gets the rank of the worst result kept.  The results must be full().
+   *
+   * @return Returns said rank.
+   */
+  int threshold() const {
+    return top_.front().second;
+  }
+
+  /**
+   * Gets the total number of results added.
+   *
+   * @return Returns said number.
+   */
+  size_t total() const {
+    return total_;
+  }
+
+private:
+  size_t const n_;
+  size_t total_;
+  vector<search_result> top_;
+};
+
+void top_results::add( int i, int rank ) {
+  ++total_;
+  search_result const result( i, rank );
+  if ( top_.size() < n_ ) {
+    top_.push_back( result );
+    ::push_heap( top_.begin(), top_.end(), ranks_before );
+  } else if ( n_ && ranks_before( result, top_.front() ) ) {
+    ::pop_heap( top_.begin(), top_.end(), ranks_before );
+    top_.back() = result;
+    ::push_heap( top_.begin(), top_.end(), ranks_before );
+  }
+}
+
+/**
+ * Reports that a query is malformed.  If not running as a daemon, exits.
+ *
+ * @param err The ostream to print the error to.
+ * @return Returns \c false.
+ */
+static bool malformed_query( ostream &err ) {
+  err << error << "malformed query\n";
+#ifdef WITH_SEARCH_DAEMON
+  if ( daemon_type != "none" )
+    return false;
+#endif /* WITH_SEARCH_DAEMON */
+  ::exit( Exit_Malformed_Query );
+}
+
+/**
+ * Parses a query and prints how it would be evaluated.
+ *
+ * @param query The text of the query.
+ * @param out The ostream to print the query plan to.
+ * @param err The ostream to print errors to.
+ */
+static bool explain( char const *query, ostream &out, ostream &err ) {
+  token_stream  query_stream( query );
+  stop_word_set stop_words_found;
+  if ( !explain_query( query_stream, out, stop_words_found ) )
+    return malformed_query( err );
+  return true;
+}
+
+/**
+ * Parses a query and performs a search against the index the current thread is
+ * using.
+ *
+ * @param query The text of the query.
+ * @param evaluator The query evaluator.
+ * @param top The top results to add to.
+ * @param stop_words_found The stop-words in the query.
+ * @return Returns \c true only if the query was well-formed.
+ */
+static bool evaluate( char const *query, char const *evaluator,
+                      top_results &top, stop_word_set &stop_words_found ) {
+  token_stream    query_stream( query );
+  bool            parsed;
+
+  if ( to_lower( *evaluator ) == 'c' /* must be "cursor" */ ) {
+    query_cursor_ptr cursor;
+    parsed = parse_query( query_stream, cursor, stop_words_found );
+    if ( parsed ) {
+      //
+      // If the files the query matches can be counted quickly, the cursor can
+      // skip over those files whose ranks can't make it into the top results
+      // since they'd only have been counted.
+      //
+      bool const prune = cursor->can_mark_files();
+      vector<bool> marks;
+      if ( prune ) {
+        marks.resize( files.size() );
+        cursor->mark_files( marks );
+      }
+      for ( ; !cursor->at_end(); cursor->next() ) {
+        top.add( cursor->doc(), cursor->score() );
+        if ( prune && top.full() )
+          cursor->prune_below( top.threshold() );
+      } // for
+      if ( prune )
+        top.set_total( ::count( marks.begin(), marks.end(), true ) );
+    }
+  } else {
+    search_results results;
+    parsed = parse_query( query_stream, results, stop_words_found );
+    if ( parsed )
+      for ( auto const i : results )
+        top.add( i, results[i] );
+  }
+
+  return parsed && query_stream.eof();
+}
+
+/**
+ * A %shard_search is the search of a single index (shard) when more than one
+ * index is being searched.
+ */
+struct shard_search {
+  search_index const *index;
+  char const         *query;
+  char const         *evaluator;
+  top_results         top;
+  stop_word_set       stop_words_found;
+  bool                ok;
+
+  shard_search( search_index const *i, char const *q, char const *e,
+                size_t n ) :
+    index( i ), query( q ), evaluator( e ), top( n ), ok( false )
+  {
+  }
+
+  void operator()() {
+    index->use();
+    ok = evaluate( query, evaluator, top, stop_words_found );
+  }
+};
+
+#ifdef MULTI_THREADED
+/**
+ * The main function for a thread that searches a single shard.
+ *
+ * This function is declared <code>extern "C"</code> since it is called via the
+ * C library function \c pthread_create() and, because it's a C function, it
+ * expects C linkage.
+ *
+ * @param p Pointer to an instance of a shard_search.
+ * @return Always returns null.
+ */
+extern "C" void* search_shard_thread_main( void *p ) {
+  (*static_cast<shard_search*>( p ))();
+  return nullptr;
+}
+#endif /* MULTI_THREADED */
+
+/**
+ * A %ranked_result is a search result from a particular shard.
+ */
+struct ranked_result {
+  int    rank;
+  size_t shard;
+  int    file_index;
+};
+
+/**
+ * Compares two ranked results by rank (highest first) and, for equal ranks, by
+ * shard, then file index (lowest first) so the order of results is
+ * deterministic.
+ *
+ * @param i The first ranked result.
+ * @param j The second ranked result.
+ * @return Returns \c true only if \a i should be output before \a j.
+ */
+inline bool ranked_before( ranked_result const &i, ranked_result const &j ) {
+  if ( i.rank != j.rank )
+    return i.rank > j.rank;
+  if ( i.shard != j.shard )
+    return i.shard < j.shard;
+  return i.file_index < j.file_index;
+}
+
+/**
+ * The merged results of searching one or more indices.
+ */
+struct merged_results {
+  std::vector<std::unique_ptr<shard_search>> shards;
+  std::vector<ranked_result>  ranked;   // best first
+  size_t                      total;
+  stop_word_set               stop_words_found;
+
+  merged_results() : total( 0 ) { }
+};
+
+/**
+ * Parses a query, performs a search, and merges the results.  If there is
+ * more than one index, each is searched in its own thread (if threads are
+ * available) and the top results of each are merged.
+ *
+ * @param first An iterator positioned at the first index to search.
+ * @param last An iterator positioned one past the last index to search.
+ * @param query The text of the query.
+ * @param evaluator The query evaluator.
+ * @param num_top The number of top results to keep (per index).
+ * @param results The merged results.
+ * @return Returns \c true only if the query was well-formed.
+ */
+static bool search( search_index::list_type::const_iterator first,
+                    search_index::list_type::const_iterator last,
+                    char const *query, char const *evaluator, size_t num_top,
+                    merged_results &results ) {
+  auto &shards = results.shards;
+  for ( ; first != last; ++first )
+    shards.emplace_back(
+      new shard_search( first->get(), query, evaluator, num_top )
+    );
+
+#ifdef MULTI_THREADED
+  if ( query_workers ) {
+    //
+    // Search all but the first shard via the query threads and the first in
+    // this thread.
+    //
+    work_stealing_pool::task_group group( *query_workers );
+    for ( auto s = shards.begin() + 1; s != shards.end(); ++s ) {
+      shard_search *const shard = s->get();
+      group.run( [shard]{ (*shard)(); } );
+    } // for
+    (*shards.front())();
+    group.wait();
+  } else {
+  //
+  // Search all but the first shard in their own threads and the first in this
+  // one.  If a thread can't be created, just search its shard in this thread.
+  //
+  vector<pthread_t> threads;
+  for ( auto s = shards.begin() + 1; s != shards.end(); ++s ) {
+    pthread_t thread;
+    if ( ::pthread_create( &thread, nullptr, search_shard_thread_main,
+                           s->get() ) ) {
+      (**s)();
+      continue;
+    }
+    threads.push_back( thread );
+  } // for
+  (*shards.front())();
+  for ( auto const thread : threads )
+    ::pthread_join( thread, nullptr );
+  }
+#else
+  for ( auto &shard : shards )
+    (*shard)();
+#endif /* MULTI_THREADED */
+
+  //
+  // Merge the top results, total, and stop-words of all shards.
+  //
+  for ( size_t i = 0; i < shards.size(); ++i ) {
+    shard_search &shard = *shards[i];
+    if ( !shard.ok )
+      return false;
+    results.total += shard.top.total();
+    results.stop_words_found.insert(
+      shard.stop_words_found.begin(), shard.stop_words_found.end()
+    );
+    for ( auto const &r : shard.top.sorted() )
+      results.ranked.push_back( ranked_result{ r.second, i, r.first } );
+  } // for
+  ::sort( results.ranked.begin(), results.ranked.end(), ranked_before );
+  return true;
+}
+
+#ifdef MULTI_THREADED
+void start_query_threads() {
+  if ( query_threads && !query_workers )
+    query_workers = new work_stealing_pool( query_threads );
+}
+#endif /* MULTI_THREADED */
+
 /**
  * Parses a query, performs a search, and outputs the results.
  *
+ * @param indices The indicies to search.
  * @param query The text of the query.
  * @param skip_results The number of initial results to skip.
  * @param max_results The maximum number of results to output.
  * @param results_format The results format.
+ * @param evaluator The query evaluator.
  * @param out The ostream to print the results to.
  * @param err The ostream to print errors to.
  */
-static bool search( char const *query, unsigned skip_results,
-                    unsigned max_results, char const *results_format,
+static bool search( search_index::list_type const &indices, char const *query,
+                    unsigned skip_results, unsigned max_results,
+                    char const *results_format, char const *evaluator,
                     ostream &out, ostream &err ) {
-  token_stream    query_stream( query );
-  search_results  results;
-  stop_word_set   stop_words_found;
-
-  if ( !(parse_query( query_stream, results, stop_words_found ) &&
-         query_stream.eof()) ) {
-    err << error << "malformed query\n";
-#ifdef WITH_SEARCH_DAEMON
-    if ( daemon_type != "none" )
-      return false;
-#endif /* WITH_SEARCH_DAEMON */
-    ::exit( Exit_Malformed_Query );
-  }
+  merged_results results;
+  if ( !search( indices.begin(), indices.end(), query, evaluator,
+                skip_results + size_t( max_results ), results ) )
+    return malformed_query( err );
+  auto const &shards = results.shards;
+  auto const &merged = results.ranked;
+  size_t const total = results.total;
+  stop_word_set const &stop_words_found = results.stop_words_found;
 
   ////////// Print the results ////////////////////////////////////////////////
 
   unique_ptr<results_formatter const> format;
-  if ( to_lower( *results_format ) == 'x' /* must be "xml" */ )
-    format.reset( new xml_formatter( out, results.size() ) );
-  else
-    format.reset( new classic_formatter( out, results.size() ) );
+  switch ( to_lower( *results_format ) ) {
+    case 'j': // must be "json"
+      format.reset( new json_formatter( out, total ) );
+      break;
+    case 'x': // must be "xml"
+      format.reset( new xml_formatter( out, total ) );
+      break;
+    default:
+      format.reset( new classic_formatter( out, total ) );
+  } // switch
 
   format->pre( stop_words_found );
   if ( !out )
     return false;
-  if ( skip_results < results.size() && max_results ) {
-    typedef vector<search_result> sorted_results_type;
-    sorted_results_type sorted;
-    sorted.reserve( results.size() );
-    ::copy( results.begin(), results.end(), ::back_inserter( sorted ) );
-    ::sort(
-      sorted.begin(), sorted.end(),
-      []( search_result const &i, search_result const &j ) {
-        return i.second > j.second;
-      }
-    );
+  if ( skip_results < total && max_results ) {
     //
-    // Compute the highest rank and the normalization factor.
+    // Compute the highest rank (across all shards) and the normalization
+    // factor.
     //
-    int const highest_rank = sorted[0].second;
+    int const highest_rank = merged[0].rank;
     double const normalize = 100.0 / highest_rank;
     //
     // Print the sorted results skipping some if requested to and not exceeding
     // the maximum.
     //
-    for ( auto r = sorted.begin() + skip_results;
-          r != sorted.end() && max_results-- > 0 && out; ++r ) {
-      int rank = static_cast<int>( r->second * normalize );
+    for ( auto r = merged.begin() + skip_results;
+          r != merged.end() && max_results-- > 0 && out; ++r ) {
+      int rank = static_cast<int>( r->rank * normalize );
       if ( !rank )
         rank = 1;
+      shards[ r->shard ]->index->use();
       format->result(
         rank,
-        file_info( reinterpret_cast<unsigned char const*>( files[ r->first ] ) )
+        file_info(
+          reinterpret_cast<unsigned char const*>( files[ r->file_index ] )
+        )
       );
       if ( !out )
         return false;
@@ -454,31 +867,45 @@ search_options::search_options( int *argc, char ***argv,
   dump_entire_index_opt = false;
   dump_match_arg        = 0;
   dump_meta_names_opt   = false;
+  dump_resident_opt     = false;
   dump_stop_words_opt   = false;
   dump_window_size_arg  = 0;
   dump_word_index_opt   = false;
-  index_file_name_arg   = nullptr;
+  explain_query_opt     = false;
+  fuzzy_words_max_arg   = nullptr;
+  huge_pages_arg        = nullptr;
   max_results_arg       = nullptr;
   print_help_opt        = false;
   print_version_opt     = false;
+  query_evaluator_arg   = nullptr;
   results_format_arg    = nullptr;
   result_separator_arg  = nullptr;
   skip_results_arg      = 0;
   stem_words_opt        = false;
+  warm_up_arg           = nullptr;
+  warm_up_lock_opt      = false;
+  warm_up_queries_arg   = nullptr;
   word_files_max_arg    = nullptr;
   word_percent_max_arg  = nullptr;
 #ifdef WITH_WORD_POS
   words_near_arg        = 0;
 #endif /* WITH_WORD_POS */
 #ifdef WITH_SEARCH_DAEMON
+  daemon_io_arg         = nullptr;
+  daemon_listeners_arg  = nullptr;
   daemon_type_arg       = nullptr;
   group_arg             = nullptr;
+  http_opt              = false;
+  keep_alive_opt        = false;
 #ifdef __APPLE__
   launchd_opt           = false;
 #endif /* __APPLE__ */
   max_threads_arg       = 0;
   min_threads_arg       = 0;
   pid_file_name_arg     = nullptr;
+  pin_listeners_opt     = false;
+  query_threads_arg     = nullptr;
+  reload_interval_arg   = 0;
   search_background_opt = false;
   socket_address_arg    = nullptr;
   socket_file_name_arg  = nullptr;
@@ -501,6 +928,10 @@ search_options::search_options( int *argc, char ***argv,
         socket_address_arg = opt.arg();
         break;
 
+      case 'A': // Number of listener threads.
+        daemon_listeners_arg = opt.arg();
+        break;
+
       case 'b': // Run as a daemon.
         daemon_type_arg = opt.arg();
         break;
@@ -514,6 +945,12 @@ search_options::search_options( int *argc, char ***argv,
         config_file_name_arg = opt.arg();
         break;
 
+#ifdef WITH_SEARCH_DAEMON
+      case 'C': // Pin listener threads to CPUs.
+        pin_listeners_opt = true;
+        break;
+#endif /* WITH_SEARCH_DAEMON */
+
       case 'd': // Dump query word indices.
         dump_word_index_opt = true;
         break;
@@ -522,6 +959,13 @@ search_options::search_options( int *argc, char ***argv,
         dump_entire_index_opt = true;
         break;
 
+      case 'e': // Query evaluator.
+        if ( query_evaluator.is_legal( opt.arg(), err ) )
+          query_evaluator_arg = opt.arg();
+        else
+          bad_ = true;
+        break;
+
       case 'f': // Word/files file maximum.
         word_files_max_arg = opt.arg();
         break;
@@ -533,14 +977,52 @@ search_options::search_options( int *argc, char ***argv,
           bad_ = true;
         break;
 
+      case 'g': // Huge pages.
+        if ( huge_pages.is_legal( opt.arg(), err ) )
+          huge_pages_arg = opt.arg();
+        else
+          bad_ = true;
+        break;
+
 #ifdef WITH_SEARCH_DAEMON
       case 'G': // Group.
         group_arg = opt.arg();
         break;
+
+      case 'h': // Also serve HTTP requests.
+        http_opt = true;
+        break;
+
+      case 'H': // Reload interval.
+        reload_interval_arg = ::atoi( opt.arg() );
+        break;
+#endif /* WITH_SEARCH_DAEMON */
+
+#ifdef WITH_SEARCH_DAEMON
+      case 'I': // Daemon I/O event loop.
+        if ( daemon_io.is_legal( opt.arg(), err ) )
+          daemon_io_arg = opt.arg();
+        else
+          bad_ = true;
+        break;
+#endif /* WITH_SEARCH_DAEMON */
+
+      case 'i': // Index file (may be given more than once).
+        index_file_name_args.push_back( opt.arg() );
+        break;
+
+#ifdef WITH_SEARCH_DAEMON
+      case 'j': // Number of threads to evaluate parts of a query.
+        query_threads_arg = opt.arg();
+        break;
+
+      case 'k': // Keep the connection open after the request.
+        keep_alive_opt = true;
+        break;
 #endif /* WITH_SEARCH_DAEMON */
 
-      case 'i': // Index file.
-        index_file_name_arg = opt.arg();
+      case 'L': // Lock warmed-up part of index into memory.
+        warm_up_lock_opt = true;
         break;
 
       case 'm': // Max. number of results.
@@ -583,6 +1065,10 @@ search_options::search_options( int *argc, char ***argv,
         break;
 #endif /* WITH_SEARCH_DAEMON */
 
+      case 'Q': // Warm-up queries file.
+        warm_up_queries_arg = opt.arg();
+        break;
+
       case 'r': // Number of initial results to skip.
         skip_results_arg = ::atoi( opt.arg() );
         if ( skip_results_arg < 0 )
@@ -623,6 +1109,13 @@ search_options::search_options( int *argc, char ***argv,
         print_version_opt = true;
         break;
 
+      case 'W': // Warm-up.
+        if ( warm_up.is_legal( opt.arg(), err ) )
+          warm_up_arg = opt.arg();
+        else
+          bad_ = true;
+        break;
+
       case 'w': { // Dump words around query words.
         dump_window_size_arg = ::atoi( opt.arg() );
         if ( dump_window_size_arg < 0 )
@@ -636,12 +1129,24 @@ search_options::search_options( int *argc, char ***argv,
         break;
       }
 
+      case 'x': // Explain query.
+        explain_query_opt = true;
+        break;
+
 #if defined( WITH_SEARCH_DAEMON ) && defined( __APPLE__ )
       case 'X': // Cooperate with Mac OS X's launchd.
         launchd_opt = true;
         break;
 #endif
 
+      case 'Y': // Dump index residency.
+        dump_resident_opt = true;
+        break;
+
+      case 'z': // Fuzzy word maximum.
+        fuzzy_words_max_arg = opt.arg();
+        break;
+
       default: // Bad option.
         err << usage;
         bad_ = true;
@@ -655,8 +1160,16 @@ search_options::search_options( int *argc, char ***argv,
   *argc -= opt_in.shift(), *argv += opt_in.shift();
 }
 
-bool service_request( char *argv[], search_options const &opt, ostream &out,
-                      ostream &err ) {
+/**
+ * Dumps (part of) the index the current thread is using.
+ *
+ * @param argv The words to dump, if any.
+ * @param opt The set of options specified for the request.
+ * @param out The ostream to dump to.
+ * @return Returns \c true only if the dump succeeded.
+ */
+static bool dump_index( char *argv[], search_options const &opt,
+                        ostream &out ) {
   if ( opt.dump_window_size_arg ) {
     while ( *argv && out )
       dump_word_window( *argv++,
@@ -688,6 +1201,11 @@ bool service_request( char *argv[], search_options const &opt, ostream &out,
     return true;
   }
 
+  if ( opt.dump_resident_opt ) {
+    search_index::in_use()->dump_resident( out );
+    return !!out;
+  }
+
   if ( opt.dump_stop_words_opt ) {
     for ( auto const &word : stop_words ) {
       out << word << '\n';
@@ -697,10 +1215,37 @@ bool service_request( char *argv[], search_options const &opt, ostream &out,
     return true;
   }
 
-  if ( opt.dump_meta_names_opt ) {
-    for ( auto const &meta_name : meta_names ) {
-      out << meta_name << '\n';
-      if ( !out )
+  // must be opt.dump_meta_names_opt
+  for ( auto const &meta_name : meta_names ) {
+    out << meta_name << '\n';
+    if ( !out )
+      return false;
+  } // for
+  return true;
+}
+
+bool service_request( char *argv[], search_options const &opt, ostream &out,
+                      ostream &err ) {
+  //
+  // Hold on to the current indicies for the duration of the request even if
+  // they're reloaded in the meantime.
+  //
+  search_index::list_ptr const indices_ptr = search_index::current();
+  search_index::list_type const &indices = *indices_ptr;
+  //
+  // When there's more than one index, dumps and query plans are per index, so
+  // each is preceded by the name of its index.
+  //
+  bool const sharded = indices.size() > 1;
+
+  if ( opt.dump_window_size_arg || opt.dump_word_index_opt ||
+       opt.dump_entire_index_opt || opt.dump_stop_words_opt ||
+       opt.dump_meta_names_opt || opt.dump_resident_opt ) {
+    for ( auto const &index : indices ) {
+      index->use();
+      if ( sharded )
+        out << "# index: " << index->name() << '\n';
+      if ( !dump_index( argv, opt, out ) )
         return false;
     } // for
     return true;
@@ -727,15 +1272,420 @@ bool service_request( char *argv[], search_options const &opt, ostream &out,
     query += *argv++;
   } // while
 
+  if ( opt.explain_query_opt ) {
+    for ( auto const &index : indices ) {
+      index->use();
+      if ( sharded )
+        out << "# index: " << index->name() << '\n';
+      if ( !explain( query.c_str(), out, err ) )
+        return false;
+    } // for
+    return true;
+  }
+
   return search(
-    query.c_str(),
+    indices, query.c_str(),
     opt.skip_results_arg,
     opt.max_results_arg ? ::atoi( opt.max_results_arg ) : max_results,
     opt.results_format_arg ? opt.results_format_arg : results_format,
+    opt.query_evaluator_arg ? opt.query_evaluator_arg : query_evaluator,
     out, err
   );
 }
 
+#ifdef WITH_SEARCH_DAEMON
+/**
+ * Makes a binary response have the given status and no results.
+ *
+ * @param response The response.
+ * @param status The status.
+ * @return Returns \c false.
+ */
+static bool binary_failure( string &response, binary_status status ) {
+  response.resize( Binary_Response_Header_Size );
+  response[2] = static_cast<char>( status );
+  return false;
+}
+
+bool service_binary_request( string const &request, string &response,
+                             bool *keep_alive ) {
+  response.clear();
+  binary_put8( response, Binary_Magic );
+  binary_put8( response, Binary_Version );
+  binary_put8( response, bs_ok );
+  binary_put8( response, 0 );
+  binary_put32( response, 0 );          // length: set below
+  binary_put32( response, 0 );          // total: set below
+  binary_put32( response, 0 );          // results: set below
+
+  char const *const p = request.data();
+  *keep_alive = false;
+  if ( request.size() < Binary_Request_Header_Size ||
+       static_cast<unsigned char>( p[1] ) != Binary_Version ||
+       request.size() != Binary_Request_Header_Size + binary_get16( p + 14 ) )
+    return binary_failure( response, bs_bad_request );
+
+  unsigned const flags = binary_get16( p + 2 );
+  uint32_t const skip_results = binary_get32( p + 4 );
+  uint32_t max = binary_get32( p + 8 );
+  if ( max == Binary_Default_Max )
+    max = max_results;
+  unsigned const index = binary_get16( p + 12 );
+  *keep_alive = (flags & bf_keep_alive) != 0;
+
+  //
+  // Hold on to the current indicies for the duration of the request even if
+  // they're reloaded in the meantime.
+  //
+  search_index::list_ptr const indices_ptr = search_index::current();
+  search_index::list_type const &indices = *indices_ptr;
+  auto first = indices.begin(), last = indices.end();
+  if ( index != Binary_All_Indices ) {
+    if ( index >= indices.size() )
+      return binary_failure( response, bs_bad_request );
+    first += index, last = first + 1;
+  }
+
+  string const query( request, Binary_Request_Header_Size );
+  merged_results results;
+  if ( !search( first, last, query.c_str(), query_evaluator,
+                skip_results + size_t( max ), results ) )
+    return binary_failure( response, bs_malformed_query );
+
+  uint32_t num_results = 0;
+  if ( skip_results < results.total && max ) {
+    auto const &merged = results.ranked;
+    double const normalize = 100.0 / merged[0].rank;
+    unsigned const first_index =
+      static_cast<unsigned>( first - indices.begin() );
+    for ( auto r = merged.begin() + skip_results;
+          r != merged.end() && max-- > 0; ++r, ++num_results ) {
+      int rank = static_cast<int>( r->rank * normalize );
+      if ( !rank )
+        rank = 1;
+      binary_put32( response, r->file_index );
+      binary_put16( response, first_index + r->shard );
+      binary_put16( response, rank );
+      if ( !(flags & (bf_path | bf_size | bf_title)) )
+        continue;
+      //
+      // The strings are copied straight from the index file.
+      //
+      results.shards[ r->shard ]->index->use();
+      file_info const fi(
+        reinterpret_cast<unsigned char const*>( files[ r->file_index ] )
+      );
+      if ( flags & bf_path ) {
+        char const *const dir = directories[ fi.dir_index() ];
+        size_t const dir_len = ::strlen( dir );
+        size_t const name_len = ::strlen( fi.file_name() );
+        size_t const n = min( dir_len + 1 + name_len, size_t( 0xFFFF ) );
+        binary_put16( response, static_cast<unsigned>( n ) );
+        size_t const start = response.size();
+        response.append( dir, dir_len );
+        response += '/';
+        response.append( fi.file_name(), name_len );
+        response.resize( start + n );
+      }
+      if ( flags & bf_size )
+        binary_put64( response, fi.size() );
+      if ( flags & bf_title )
+        binary_put_string( response, fi.title() );
+    } // for
+  }
+
+  binary_set32(
+    response, 4,
+    static_cast<uint32_t>( response.size() - Binary_Response_Header_Size )
+  );
+  binary_set32( response, 8, static_cast<uint32_t>( results.total ) );
+  binary_set32( response, 12, num_results );
+  return true;
+}
+
+/**
+ * Gets the value of a hexadecimal digit.
+ *
+ * @param c The character.
+ * @return Returns said value or -1 if \a c isn't a hexadecimal digit.
+ */
+static int hex_value( char c ) {
+  if ( c >= '0' && c <= '9' )
+    return c - '0';
+  c = to_lower( c );
+  if ( c >= 'a' && c <= 'f' )
+    return c - 'a' + 10;
+  return -1;
+}
+
+/**
+ * Decodes a component of a URL's query string: a \c '+' becomes a space and a
+ * \c %XX escape becomes the character it encodes.  A malformed escape is left
+ * as-is.
+ *
+ * See also:
+ *    Tim Berners-Lee, et al.  "Uniform Resource Identifier (URI): Generic
+ *    Syntax," RFC 3986, section 2.1, January 2005.
+ *
+ * @param begin A pointer to the first character of the component.
+ * @param end A pointer to one past the last character of the component.
+ * @return Returns the decoded component.
+ */
+static string url_decode( char const *begin, char const *end ) {
+  string result;
+  result.reserve( end - begin );
+  for ( ; begin != end; ++begin ) {
+    switch ( *begin ) {
+      case '+':
+        result += ' ';
+        continue;
+      case '%':
+        if ( end - begin >= 3 ) {
+          int const hi = hex_value( begin[1] ), lo = hex_value( begin[2] );
+          if ( hi != -1 && lo != -1 ) {
+            result += static_cast<char>( hi << 4 | lo );
+            begin += 2;
+            continue;
+          }
+        }
+        result += *begin;               // not an escape: take it literally
+        break;
+      default:
+        result += *begin;
+    } // switch
+  } // for
+  return result;
+}
+
+/**
+ * Parses the value of an HTTP query parameter that's a number.
+ *
+ * @param s The value.
+ * @param n Set to the number.
+ * @return Returns \c true only if \a s is entirely digits (and not too big).
+ */
+static bool http_parse_unsigned( string const &s, unsigned *n ) {
+  if ( s.empty() || s.size() > 9 ||
+       s.find_first_not_of( "0123456789" ) != string::npos )
+    return false;
+  *n = static_cast<unsigned>( ::atoi( s.c_str() ) );
+  return true;
+}
+
+/**
+ * Makes an HTTP response.
+ *
+ * @param response Set to the response.
+ * @param status The status code and reason phrase.
+ * @param body The body.
+ * @param head If \c true, the request was a \c HEAD so the body is omitted
+ * (but its length is still given).
+ * @param keep_alive If \c true, the connection will be kept alive.
+ * @param http_1_0 If \c true, the request was HTTP/1.0.
+ * @param headers Additional headers, if any, each ending in a carriage return
+ * and newline.
+ */
+static void http_response( string &response, char const *status,
+                           string const &body, bool head, bool keep_alive,
+                           bool http_1_0, char const *headers = "" ) {
+  response = "HTTP/1.1 ";
+  response += status;
+  response += "\r\nContent-Type: application/json\r\nContent-Length: ";
+  response += to_string( body.size() );
+  response += "\r\n";
+  if ( !keep_alive )
+    response += "Connection: close\r\n";
+  else if ( http_1_0 )
+    response += "Connection: keep-alive\r\n";
+  response += headers;
+  response += "\r\n";
+  if ( !head )
+    response += body;
+}
+
+/**
+ * Makes an HTTP response for an error.  The body is a JSON object whose sole
+ * member is the error message.
+ *
+ * @param response Set to the response.
+ * @param status The status code and reason phrase.
+ * @param message The error message.
+ * @param head If \c true, the request was a \c HEAD.
+ * @param keep_alive If \c true, the connection will be kept alive.
+ * @param http_1_0 If \c true, the request was HTTP/1.0.
+ * @param headers Additional headers, if any.
+ */
+static void http_error( string &response, char const *status,
+                        char const *message, bool head, bool keep_alive,
+                        bool http_1_0, char const *headers = "" ) {
+  string body = "{ \"error\": \"";
+  body += message;
+  body += "\" }\n";
+  http_response( response, status, body, head, keep_alive, http_1_0, headers );
+}
+
+void service_http_request( string const &request, string &response,
+                           bool *keep_alive ) {
+  auto const line_end = request.find_first_of( "\r\n" );
+  string const line( request, 0, line_end );
+  bool const http_1_0 = line[ line.size() - 1 ] == '0';
+  auto const sp1 = line.find( ' ' ), sp2 = line.rfind( ' ' );
+  string const method( line, 0, sp1 );
+  bool const head = method == "HEAD";
+
+  if ( http_headers_end( request, line_end ) != request.size() ) {
+    *keep_alive = false;
+    return http_error(
+      response, "431 Request Header Fields Too Large", "request too large",
+      head, false, http_1_0
+    );
+  }
+  if ( sp1 == sp2 ) {
+    *keep_alive = false;
+    return http_error(
+      response, "400 Bad Request", "bad request", head, false, http_1_0
+    );
+  }
+
+  //
+  // HTTP/1.1 connections are persistent by default; HTTP/1.0 connections
+  // aren't.  Either default may be overridden by the Connection header.
+  //
+  *keep_alive = !http_1_0;
+  for ( auto pos = request.find( '\n', line_end ) + 1;
+        pos < request.size(); ) {
+    auto const end = request.find( '\n', pos );
+    string header( request, pos, end - pos );
+    pos = end + 1;
+    if ( !header.empty() && header.back() == '\r' )
+      header.pop_back();
+    auto const colon = header.find( ':' );
+    if ( colon == string::npos )
+      continue;
+    unique_ptr<char[]> const name(
+      to_lower_r( header.data(), header.data() + colon )
+    );
+    if ( ::strcmp( name.get(), "connection" ) != 0 )
+      continue;
+    unique_ptr<char[]> const value(
+      to_lower_r( header.data() + colon + 1, header.data() + header.size() )
+    );
+    if ( ::strstr( value.get(), "close" ) )
+      *keep_alive = false;
+    else if ( ::strstr( value.get(), "keep-alive" ) )
+      *keep_alive = true;
+  } // for
+
+  if ( method != "GET" && !head )
+    return http_error(
+      response, "405 Method Not Allowed", "method not allowed", head,
+      *keep_alive, http_1_0, "Allow: GET, HEAD\r\n"
+    );
+
+  //
+  // Split the target into its path and query string and parse the latter's
+  // parameters.
+  //
+  string const target( line, sp1 + 1, sp2 - sp1 - 1 );
+  auto const question = target.find( '?' );
+  if ( target.compare( 0, question, "/search" ) != 0 )
+    return http_error(
+      response, "404 Not Found", "not found", head, *keep_alive, http_1_0
+    );
+
+  string query;
+  bool has_query = false;
+  unsigned skip = 0, max = max_results;
+  if ( question != string::npos ) {
+    char const *p = target.c_str() + question + 1;
+    char const *const end = target.c_str() + target.size();
+    while ( p < end ) {
+      char const *amp = ::strchr( p, '&' );
+      if ( !amp )
+        amp = end;
+      char const *eq = ::strchr( p, '=' );
+      if ( !eq || eq > amp )
+        eq = amp;
+      string const name( url_decode( p, eq ) );
+      string const value( url_decode( eq + (eq < amp), amp ) );
+      p = amp + 1;
+      if ( name == "q" ) {
+        query = value;
+        has_query = true;
+      } else if ( name == "max" ) {
+        if ( !http_parse_unsigned( value, &max ) )
+          return http_error(
+            response, "400 Bad Request", "bad max", head, *keep_alive,
+            http_1_0
+          );
+      } else if ( name == "skip" ) {
+        if ( !http_parse_unsigned( value, &skip ) )
+          return http_error(
+            response, "400 Bad Request", "bad skip", head, *keep_alive,
+            http_1_0
+          );
+      }
+    } // while
+  }
+  if ( !has_query )
+    return http_error(
+      response, "400 Bad Request", "no query", head, *keep_alive, http_1_0
+    );
+
+  //
+  // Hold on to the current indicies for the duration of the request even if
+  // they're reloaded in the meantime.
+  //
+  search_index::list_ptr const indices_ptr = search_index::current();
+  ostringstream body, err;
+  if ( !search( *indices_ptr, query.c_str(), skip, max, "json",
+                query_evaluator, body, err ) )
+    return http_error(
+      response, "400 Bad Request", "malformed query", head, *keep_alive,
+      http_1_0
+    );
+  http_response( response, "200 OK", body.str(), head, *keep_alive, http_1_0 );
+}
+#endif /* WITH_SEARCH_DAEMON */
+
+/**
+ * Warms up the index by searching every index for every query in a file,
+ * discarding the results, so the parts of the index that queries typically
+ * touch are in memory before the first real query arrives.  Blank lines and
+ * lines starting with \c # are ignored.
+ *
+ * @param file_name The name of the file of queries, one per line.
+ */
+static void warm_up_with_queries( char const *file_name ) {
+  ifstream in( file_name );
+  if ( !in ) {
+    error() << "could not read warm-up queries from \"" << file_name << '"'
+            << error_string;
+    ::exit( Exit_No_Read_Queries );
+  }
+
+  search_index::list_ptr const indices = search_index::current();
+  for ( string query; getline( in, query ); ) {
+    if ( query.empty() || query[0] == '#' )
+      continue;
+    for ( auto const &index : *indices ) {
+      index->use();
+      top_results top( max_results );
+      stop_word_set stop_words_found;
+      if ( !evaluate( query.c_str(), query_evaluator, top, stop_words_found ) )
+        continue;
+      //
+      // Also touch the file information of the results since a real query
+      // would print it.
+      //
+      for ( auto const &result : top.sorted() )
+        file_info const fi(
+          reinterpret_cast<unsigned char const*>( files[ result.first ] )
+        );
+    } // for
+  } // for
+}
+
 /**
  * Parses a file_info from an index file and write it to an ostream.
  *
@@ -759,18 +1709,32 @@ ostream& usage( ostream &o ) {
   "-?   | --help             : Print this help message\n"
 #ifdef WITH_SEARCH_DAEMON
   "-a a | --socket-address a : Socket address [default: *:" << SocketPort_Default << "]\n"
+  "-A n | --listeners n      : Daemon listener threads [default: " << DaemonListeners_Default << "]\n"
   "-b t | --daemon-type t    : Daemon type to run as [default: none]\n"
   "-B   | --no-background    : Don't run daemon in the background [default: do]\n"
 #endif /* WITH_SEARCH_DAEMON */
   "-c f | --config-file f    : Name of configuration file [default: " << ConfigFile_Default << "]\n"
+#ifdef WITH_SEARCH_DAEMON
+  "-C   | --pin-listeners    : Pin daemon listener threads to CPUs [default: no]\n"
+#endif /* WITH_SEARCH_DAEMON */
   "-d   | --dump-words       : Dump query word indices, exit\n"
   "-D   | --dump-index       : Dump entire word index, exit\n"
+  "-e e | --evaluator e      : Query evaluator [default: node]\n"
   "-f n | --word-files n     : Word/file maximum [default: infinity]\n"
   "-F f | --format f         : Results format [default: classic]\n"
+  "-g t | --huge-pages t     : Back index with huge pages [default: none]\n"
 #ifdef WITH_SEARCH_DAEMON
   "-G s | --group s          : Daemon group to run as [default: " << Group_Default << "]\n"
+  "-h   | --http             : Daemon also serves HTTP requests [default: no]\n"
+  "-H s | --reload-interval s: Index reload check interval [default: never]\n"
+#endif /* WITH_SEARCH_DAEMON */
+  "-i f | --index-file f     : Name of index file(s) [default: " << IndexFile_Default << "]\n"
+#ifdef WITH_SEARCH_DAEMON
+  "-I t | --daemon-io t      : Daemon I/O event loop [default: epoll]\n"
+  "-j n | --query-threads n  : Threads to evaluate parts of a query [default: 0]\n"
+  "-k   | --keep-alive       : Daemon request: keep connection open [default: no]\n"
 #endif /* WITH_SEARCH_DAEMON */
-  "-i f | --index-file f     : Name of index file [default: " << IndexFile_Default << "]\n"
+  "-L   | --warm-up-lock     : Lock warmed-up part of index into memory [default: no]\n"
   "-m n | --max-results n    : Maximum number of results [default: " << ResultsMax_Default << "]\n"
   "-M   | --dump-meta        : Dump meta-name index, exit\n"
 #ifdef WITH_WORD_POS
@@ -785,6 +1749,7 @@ ostream& usage( ostream &o ) {
   "-P f | --pid-file f       : Name of file to record daemon PID in [default: none]\n"
   "-q n | --queue-size n     : Maximum queued socket connections [default: " << SocketQueueSize_Default << "]\n"
 #endif /* WITH_SEARCH_DAEMON */
+  "-Q f | --warm-up-queries f: Queries file to warm up index with [default: none]\n"
   "-r n | --skip-results n   : Number of initial results to skip [default: 0]\n"
   "-R s | --separator s      : Result separator string [default: \" \"]\n"
   "-s   | --stem-words       : Stem words prior to search [default: no]\n"
@@ -797,9 +1762,13 @@ ostream& usage( ostream &o ) {
 #endif /* WITH_SEARCH_DAEMON */
   "-V   | --version          : Print version number, exit\n"
   "-w n[,m] | --window n[,m] : Dump window of words around query words [default: 0]\n"
+  "-W t | --warm-up t        : Part of index to read into memory [default: none]\n"
+  "-x   | --explain          : Print how query would be evaluated, exit\n"
 #if defined( WITH_SEARCH_DAEMON ) && defined( __APPLE__ )
   "-X   | --launchd          : If a daemon, cooperate with Mac OS X's launchd\n"
 #endif
+  "-Y   | --dump-resident    : Dump how much of index is in memory, exit\n"
+  "-z n | --fuzzy-words n    : Maximum words a word~N matches [default: " << FuzzyWordsMax_Default << "]\n"
   ;
   return o;
 }
@@ -28,6 +28,8 @@
 
 // standard
 #include <iostream>
+#include <string>
+#include <vector>
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -49,31 +51,46 @@ struct search_options {
   bool        dump_entire_index_opt;
   int         dump_match_arg;
   bool        dump_meta_names_opt;
+  bool        dump_resident_opt;
   bool        dump_stop_words_opt;
   int         dump_window_size_arg;
   bool        dump_word_index_opt;
-  char const *index_file_name_arg;
+  bool        explain_query_opt;
+  char const *fuzzy_words_max_arg;
+  char const *huge_pages_arg;
+  std::vector<char const*> index_file_name_args;
   char const *max_results_arg;
   bool        print_help_opt;
   bool        print_version_opt;
+  char const *query_evaluator_arg;
   char const *results_format_arg;
   char const *result_separator_arg;
   int         skip_results_arg;
   bool        stem_words_opt;
+  char const *warm_up_arg;
+  bool        warm_up_lock_opt;
+  char const *warm_up_queries_arg;
   char const *word_files_max_arg;
   char const *word_percent_max_arg;
 #ifdef WITH_WORD_POS
   int         words_near_arg;
 #endif /* WITH_WORD_POS */
 #ifdef WITH_SEARCH_DAEMON
+  char const *daemon_io_arg;
+  char const *daemon_listeners_arg;
   char const *daemon_type_arg;
   char const *group_arg;
+  bool        http_opt;
+  bool        keep_alive_opt;
 #ifdef __APPLE__
   bool        launchd_opt;
 #endif /* __APPLE__ */
   int         max_threads_arg;
   int         min_threads_arg;
   char const *pid_file_name_arg;
+  bool        pin_listeners_opt;
+  char const *query_threads_arg;
+  int         reload_interval_arg;
   bool        search_background_opt;
   char const *socket_address_arg;
   char const *socket_file_name_arg;
@@ -123,6 +140,41 @@ bool service_request( char *argv[], search_options const &opts,
                       std::ostream &out = std::cout,
                       std::ostream &err = std::cerr );
 
+#ifdef WITH_SEARCH_DAEMON
+/**
+ * Services a binary request (see binary_protocol.h) from a client via a
+ * socket.
+ *
+ * @param request The request.
+ * @param response Set to the response.
+ * @param keep_alive Set to whether the request asked to keep the connection
+ * alive.
+ * @return Returns \c true only if the request was serviced successfully.
+ */
+bool service_binary_request( std::string const &request,
+                             std::string &response, bool *keep_alive );
+
+/**
+ * Services an HTTP request (see http_protocol.h) from a client via a socket.
+ * Even a bad request gets a response (with an error status).
+ *
+ * @param request The request line and headers.
+ * @param response Set to the response.
+ * @param keep_alive Set to whether the connection is to be kept alive.
+ */
+void service_http_request( std::string const &request,
+                           std::string &response, bool *keep_alive );
+#endif /* WITH_SEARCH_DAEMON */
+
+#ifdef MULTI_THREADED
+/**
+ * Starts the threads that parts of queries are evaluated by in parallel, if
+ * any (see QueryThreads).  When running as a daemon, this must be called
+ * after forking.
+ */
+void start_query_threads();
+#endif /* MULTI_THREADED */
+
 /**
  * Emits the usage message to the given ostream.
  *
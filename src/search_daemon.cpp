@@ -20,9 +20,13 @@
 */
 
 // local
+#include "DaemonIO.h"
+#include "DaemonListeners.h"
+#include "DaemonPinListeners.h"
 #include "exit_codes.h"
 #include "Group.h"
 #include "PidFile.h"
+#include "ReloadInterval.h"
 #ifdef __APPLE__
 #include "LaunchdCooperation.h"
 #endif /* __APPLE__ */
@@ -35,16 +39,22 @@
 #include "ThreadsMax.h"
 #include "ThreadsMin.h"
 #include "ThreadTimeout.h"
+#include "search.h"
+#include "search_index.h"
+#include "search_reactor.h"
 #include "search_thread.h"
+#include "search_uring.h"
 #include "User.h"
 #include "util.h"                       /* for max_out_limit() */
 
 // standard
 #include <algorithm>                    /* for max() */
 #include <arpa/inet.h>                  /* for Internet networking stuff */
+#include <atomic>
 #include <cerrno>
 #include <cstdlib>                      /* for exit(3) */
 #include <cstring>
+#include <fcntl.h>                      /* for fcntl(2) */
 #include <fstream>
 #include <iostream>
 #include <signal.h>
@@ -53,7 +63,9 @@
 #include <sys/resource.h>               /* for RLIMIT_* */
 #include <sys/socket.h>                 /* for bind(3), socket(3), etc. */
 #include <sys/un.h>                     /* for sockaddr_un */
+#include <thread>
 #include <unistd.h>                     /* for fork(2), setsid(2), unlink(2) */
+#include <vector>
 
 #ifndef AF_LOCAL
 #define AF_LOCAL AF_UNIX
@@ -101,8 +113,31 @@ using namespace std;
 
 void reset_socket( int fd );
 
+/**
+ * The SIGHUP handler writes a byte to this pipe to request that the index
+ * file(s) be reloaded.  (A pipe is used rather than a flag because the signal
+ * may be handled by any thread, but only a file descriptor can also wake up
+ * the main thread waiting in select(2).)
+ */
+static int reload_pipe[2];
+
 ////////// local functions ////////////////////////////////////////////////////
 
+/**
+ * Handles SIGHUP by requesting that the index file(s) be reloaded.  The reload
+ * itself is done by the main loop since little can be done safely within a
+ * signal handler.
+ *
+ * This function is declared <code>extern "C"</code> since it is called via
+ * the C library and, because it's a C function, it expects C linkage.
+ */
+extern "C" void search_daemon_sighup( int ) {
+  int const saved_errno = errno;
+  char const c = 0;
+  (void)::write( reload_pipe[1], &c, 1 );
+  errno = saved_errno;
+}
+
 /**
  * Detach from the terminal.  From [Stevens 1993], p. 417, "Coding Rules":
  *
@@ -128,6 +163,19 @@ static void detach_from_terminal() {
     ::exit( Exit_Success );             // ... just exit as described
 }
 
+#ifndef HAVE_EPOLL_CREATE1
+/**
+ * Gets the pool of threads that service requests, creating it the first time.
+ *
+ * @return Returns said pool.
+ */
+static thread_pool& search_threads() {
+  static thread_pool threads = thread_pool(
+    new search_thread( threads ), min_threads, max_threads, thread_timeout
+  );
+  return threads;
+}
+
 /**
  * Handles a recently accepted socket file descriptor.  If the accept(2) went
  * OK, try to queue the request.  If that doesn't work (because all the request
@@ -151,29 +199,42 @@ static void handle_accept( int fd ) {
     ::exit( Exit_No_Accept );
   }
 
-  static thread_pool threads = thread_pool(
-    new search_thread( threads ), min_threads, max_threads, thread_timeout
-  );
+  search_request *const request = new search_request( fd );
 # ifdef DEBUG_threads
   cerr << "queueing request\n";
 # endif
-  if ( !threads.new_task( fd ) ) {
+  if ( !search_threads().new_task( request ) ) {
+    delete request;
     reset_socket( fd );
     ::close( fd );
   }
 }
+#endif /* HAVE_EPOLL_CREATE1 */
 
 /**
  * Creates, binds, and listens on a TCP socket.
  *
+ * @param reuse_port If \c true, set the \c SO_REUSEPORT socket option so
+ * that several sockets can be bound to the same address and port and the
+ * kernel distributes incoming connections among them.
  * @return Returns the associated Unix file descriptor.
  */
-static int open_tcp_socket() {
+static int open_tcp_socket( bool reuse_port = false ) {
   int const fd = ::socket( AF_INET, SOCK_STREAM, 0 );
   if ( fd == -1 ) {
     error() << "TCP socket() failed" << error_string;
     ::exit( Exit_No_TCP_Socket );
   }
+#ifdef SO_REUSEPORT
+  if ( reuse_port ) {
+    int const on = 1;
+    ::setsockopt( fd, SOL_SOCKET, SO_REUSEPORT,
+      reinterpret_cast<char const*>( &on ), sizeof on
+    );
+  }
+#else
+  (void)reuse_port;
+#endif /* SO_REUSEPORT */
   struct sockaddr_in addr;
   ::memset( &addr, 0, sizeof addr );
   addr.sin_family = AF_INET;
@@ -219,8 +280,198 @@ void set_signal_handlers() {
   //
   sa.sa_handler = SIG_IGN;
   ::sigaction( SIGPIPE, &sa, nullptr );
+  //
+  // Reload the index file(s) upon SIGHUP.
+  //
+  if ( ::pipe( reload_pipe ) == -1 ) {
+    error() << "pipe() failed" << error_string;
+    ::exit( Exit_No_Pipe );
+  }
+  ::fcntl( reload_pipe[0], F_SETFL, O_NONBLOCK );
+  ::fcntl( reload_pipe[1], F_SETFL, O_NONBLOCK );
+  sa.sa_handler = search_daemon_sighup;
+  sa.sa_flags = SA_RESTART;
+  ::sigaction( SIGHUP, &sa, nullptr );
 }
 
+/**
+ * The number of requests to reload the index file(s) not yet done; while
+ * non-zero, a thread is reloading them.
+ */
+static atomic<unsigned> reload_requests;
+
+/**
+ * Reloads the index file(s) in a separate thread so that opening and warming
+ * them up (that, for a large index, can take a while) doesn't stop the event
+ * loop from accepting connections and reading requests in the meantime.  If
+ * they're already being reloaded, they're reloaded again once that's done.
+ * Requests already being serviced continue to use the old indicies that are
+ * unmapped only after the last such request completes.
+ */
+static void reload_index() {
+  if ( reload_requests++ )
+    return;                             // the thread will reload again
+  thread(
+    []() {
+      for ( unsigned n = 1; ; n = reload_requests ) {
+        if ( search_index::reload() )
+          cerr << me << ": reloaded index\n";
+        else
+          cerr << error
+               << "index reload failed; still using previous index\n";
+        if ( reload_requests.fetch_sub( n ) == n )
+          break;                        // no more requests came in meanwhile
+      } // for
+    }
+  ).detach();
+}
+
+/**
+ * Checks whether the index file(s) should be reloaded because they changed.
+ *
+ * @return Returns \c true only if they should be reloaded.
+ */
+static bool index_changed() {
+  //
+  // Don't check while the files are being reloaded since the reloading thread
+  // updates what's checked.
+  //
+  return !reload_requests && search_index::changed();
+}
+
+/**
+ * Handles the reload pipe being readable because one or more SIGHUPs were
+ * received.
+ *
+ * @param fd The read end of the reload pipe.
+ */
+static void handle_reload_pipe( int fd ) {
+  char buf[ 64 ];
+  while ( ::read( fd, buf, sizeof buf ) > 0 )
+    ;                                   // coalesce multiple SIGHUPs
+  reload_index();
+}
+
+#ifdef HAVE_EPOLL_CREATE1
+/**
+ * A %listener is a thread that accepts connections and reads their requests
+ * via its own event loop and gives them to its own pool of threads.  When
+ * there is more than one, each has its own TCP socket (bound to the same
+ * address and port via \c SO_REUSEPORT) so the kernel distributes connections
+ * among them, but they all share the Unix domain socket; no queue of requests
+ * is shared among them.
+ */
+struct listener {
+  int       tcp_fd;                     // TCP socket or -1 if none
+  int       unix_fd;                    // Unix domain socket or -1 if none
+  bool      shared;                     // unix_fd shared with other listeners?
+  bool      reloads;                    // also handles reloading the index?
+  int       cpu;                        // CPU to pin to or -1 if none
+  unsigned  min_threads, max_threads;   // of its thread pool
+};
+
+/**
+ * Gets the CPUs the process may run on.
+ *
+ * @return Returns said CPUs or an empty vector if they can't be determined.
+ */
+static vector<int> usable_cpus() {
+  vector<int> cpus;
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  cpu_set_t set;
+  CPU_ZERO( &set );
+  if ( !::pthread_getaffinity_np( ::pthread_self(), sizeof set, &set ) )
+    for ( int cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+      if ( CPU_ISSET( cpu, &set ) )
+        cpus.push_back( cpu );
+#endif /* HAVE_PTHREAD_SETAFFINITY_NP */
+  return cpus;
+}
+
+/**
+ * Pins the calling thread to a CPU.  Threads it creates subsequently (such as
+ * those of its thread pool) inherit this.
+ *
+ * @param cpu The CPU.
+ */
+static void pin_to_cpu( int cpu ) {
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  cpu_set_t set;
+  CPU_ZERO( &set );
+  CPU_SET( cpu, &set );
+  int const err =
+    ::pthread_setaffinity_np( ::pthread_self(), sizeof set, &set );
+  if ( err )
+    error() << "can not pin listener to CPU " << cpu << error_string( err );
+#else
+  (void)cpu;
+#endif /* HAVE_PTHREAD_SETAFFINITY_NP */
+}
+
+/**
+ * Services requests via an event loop forever.
+ *
+ * @tparam EventLoop The type of event loop: search_reactor or search_uring.
+ * @param loop The event loop.
+ * @param l The listener the event loop is for.
+ */
+template<class EventLoop>
+static void serve( EventLoop &loop, listener const &l ) {
+  if ( l.tcp_fd != -1 )
+    loop.listen( l.tcp_fd );
+  if ( l.unix_fd != -1 )
+    loop.listen( l.unix_fd, l.shared );
+  if ( l.reloads )
+    loop.watch( reload_pipe[0], handle_reload_pipe );
+
+  bool const checks = l.reloads && reload_interval;
+  time_t last_check = ::time( nullptr );
+  while ( true ) {
+    //
+    // If the index file(s) are to be checked for changes, wait at most until
+    // the next check.
+    //
+    loop.poll( checks ? static_cast<int>( reload_interval ) : -1 );
+    if ( checks ) {
+      time_t const now = ::time( nullptr );
+      if ( now - last_check >= reload_interval ) {
+        last_check = now;
+        if ( index_changed() )
+          reload_index();
+      }
+    }
+  } // while
+}
+
+/**
+ * Services requests on a listener forever: creates its thread pool and event
+ * loop (in the calling thread, since an io_uring is best used by only the
+ * thread that created it).
+ *
+ * @param l The listener.
+ */
+static void run_listener( listener const &l ) {
+  if ( l.cpu != -1 )
+    pin_to_cpu( l.cpu );
+  thread_pool threads(
+    new search_thread( threads ), l.min_threads, l.max_threads, thread_timeout
+  );
+  if ( daemon_io == "io_uring" ) {
+#ifdef WITH_SEARCH_URING
+    search_uring uring( threads, socket_timeout );
+    if ( uring )
+      serve( uring, l );                // never returns
+    error() << "can not use io_uring; using epoll instead"
+            << error_string( uring.error() );
+#else
+    error() << "io_uring not supported; using epoll instead\n";
+#endif /* WITH_SEARCH_URING */
+  }
+  search_reactor reactor( threads, socket_timeout );
+  serve( reactor, l );
+}
+#endif /* HAVE_EPOLL_CREATE1 */
+
 ////////// extern functions ///////////////////////////////////////////////////
 
 /**
@@ -265,12 +516,47 @@ void become_daemon() {
   ////////// Create socket(s) /////////////////////////////////////////////////
 
   bool const is_tcp  = daemon_type == "tcp"  || daemon_type == "both";
-  int const tcp_fd = is_tcp ? open_tcp_socket() : -1;
-
   bool const is_unix = daemon_type == "unix" || daemon_type == "both";
-  int const unix_fd = is_unix ? open_unix_socket() : -1;
+#ifdef HAVE_EPOLL_CREATE1
+  //
+  // All of the listeners' sockets must be created now since binding to a
+  // privileged port requires still being root.
+  //
+  vector<int> const cpus( usable_cpus() );
+  unsigned num_listeners = daemon_listeners;
+  if ( !num_listeners ) {
+    long const n = ::sysconf( _SC_NPROCESSORS_ONLN );
+    num_listeners = cpus.empty() ?
+      static_cast<unsigned>( max( n, 1L ) ) :
+      static_cast<unsigned>( cpus.size() );
+  }
+  if ( daemon_pin_listeners && cpus.empty() )
+    error() << "can not pin listeners to CPUs\n";
 
-  int const max_fd = max( tcp_fd, unix_fd ) + 1;
+  int const unix_fd = is_unix ? open_unix_socket() : -1;
+  vector<listener> listeners( num_listeners );
+  for ( unsigned i = 0; i < num_listeners; ++i ) {
+    listener &l = listeners[i];
+    l.tcp_fd = is_tcp ? open_tcp_socket( num_listeners > 1 ) : -1;
+    l.unix_fd = unix_fd;
+    l.shared = num_listeners > 1;
+    l.reloads = i == 0;
+    l.cpu = daemon_pin_listeners && !cpus.empty() ?
+      cpus[ i % cpus.size() ] : -1;
+    //
+    // Divide the threads among the listeners, but give each at least one.
+    //
+    l.min_threads =
+      max( 1u, (min_threads + num_listeners - 1) / num_listeners );
+    l.max_threads =
+      max( 1u, (max_threads + num_listeners - 1) / num_listeners );
+  } // for
+#else
+  if ( daemon_listeners != 1 )
+    error() << "multiple listeners not supported; using 1\n";
+  int const tcp_fd = is_tcp ? open_tcp_socket() : -1;
+  int const unix_fd = is_unix ? open_unix_socket() : -1;
+#endif /* HAVE_EPOLL_CREATE1 */
 
   ////////// Do miscellaneous daemon stuff ////////////////////////////////////
 
@@ -333,10 +619,21 @@ void become_daemon() {
 #endif /* DEBUG_threads */
 
   set_signal_handlers();
+  start_query_threads();
 
   ////////// Accept requests //////////////////////////////////////////////////
 
+#ifdef HAVE_EPOLL_CREATE1
+  //
+  // This thread is the first listener; every other one gets its own thread.
+  //
+  for ( unsigned i = 1; i < num_listeners; ++i )
+    std::thread( run_listener, listeners[i] ).detach();
+  run_listener( listeners.front() );    // never returns
+#else
+  time_t last_check = ::time( nullptr );
   search_thread::socket_timeout = socket_timeout;
+  int const max_fd = max( tcp_fd, unix_fd ) + 1;
   while ( true ) {
 #   ifdef DEBUG_threads
     cerr << "waiting for request\n";
@@ -348,11 +645,29 @@ void become_daemon() {
       FD_SET( tcp_fd, &rset );
     if ( is_unix )
       FD_SET( unix_fd, &rset );
+    FD_SET( reload_pipe[0], &rset );
     //
     // Sit around and wait until one of the socket file descriptors is "ready."
     // See: [Stevens 1998], pp. 150-154.
     //
-    int const num_fds = ::select( max_fd, &rset, nullptr, nullptr, nullptr );
+    // If the index file(s) are to be checked for changes, wait at most until
+    // the next check.
+    //
+    struct timeval timeout;
+    timeout.tv_sec = reload_interval;
+    timeout.tv_usec = 0;
+    int const num_fds = ::select(
+      max( max_fd, reload_pipe[0] + 1 ), &rset, nullptr, nullptr,
+      reload_interval ? &timeout : nullptr
+    );
+    if ( reload_interval ) {
+      time_t const now = ::time( nullptr );
+      if ( now - last_check >= reload_interval ) {
+        last_check = now;
+        if ( index_changed() )
+          reload_index();
+      }
+    }
     if ( !num_fds )
       continue;
     if ( num_fds == -1 ) {
@@ -362,6 +677,9 @@ void become_daemon() {
       ::exit( Exit_No_Select );
     }
 
+    if ( FD_ISSET( reload_pipe[0], &rset ) )
+      handle_reload_pipe( reload_pipe[0] );
+
     //
     // Handle one or both requests.
     //
@@ -376,6 +694,7 @@ void become_daemon() {
       handle_accept( ::accept( unix_fd, (struct sockaddr*)&addr, &len ) );
     }
   } // while
+#endif /* HAVE_EPOLL_CREATE1 */
 }
 
 /**
@@ -0,0 +1,462 @@
+/*
+**      SWISH++
+**      src/search_index.cpp
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+// local
+#include "config.h"
+#include "search_index.h"
+#include "util.h"
+
+// standard
+#include <algorithm>                    /* for sort() */
+#include <cerrno>
+#include <climits>                      /* for PATH_MAX */
+#include <cstdint>                      /* for uintptr_t */
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <sys/resource.h>               /* for RLIMIT_* */
+#include <sys/stat.h>
+#include <unistd.h>                     /* for getcwd(3) */
+
+using namespace PJL;
+using namespace std;
+
+thread_local index_segment directories, files, meta_names, reversed,
+                           stop_words, trigrams, words;
+#ifdef WITH_WORD_POS
+thread_local index_segment bigrams;
+#endif /* WITH_WORD_POS */
+
+search_index::list_ptr search_index::current_;
+search_index::huge_pages_type search_index::huge_pages_;
+search_index::warm_up_type search_index::warm_up_;
+bool search_index::warm_up_lock_;
+thread_local search_index const *search_index::in_use_;
+
+/**
+ * A %watched_file is an index (or manifest) file that's checked to see whether
+ * it has changed since it was loaded.
+ */
+struct watched_file {
+  string      name;
+  struct stat loaded;                   // status when loaded
+  struct stat seen;                     // status when last checked
+};
+typedef vector<watched_file> watched_list;
+
+/**
+ * The file names given to load(): the first of each pair is the absolute file
+ * name, the second as given.
+ */
+static vector<pair<string,string>> load_names;
+static watched_list   watched_files;
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Watches a file for changes.
+ *
+ * @param file_name The name of the file.
+ * @param watched The list of watched files to append to.
+ */
+static void watch( string const &file_name, watched_list &watched ) {
+  watched_file w;
+  w.name = file_name;
+  if ( ::stat( file_name.c_str(), &w.loaded ) == -1 )
+    ::memset( &w.loaded, 0, sizeof w.loaded );
+  w.seen = w.loaded;
+  watched.push_back( w );
+}
+
+/**
+ * The names of the segments (for dump_resident()), in segment_id order.
+ */
+static char const *const segment_name[] = {
+  "words",
+  "stop-words",
+  "directories",
+  "files",
+  "meta-names",
+  "bigrams",
+  "reversed",
+  "trigrams"
+};
+
+/**
+ * Merges a range of memory into a list of ranges sorted by address, merging it
+ * with the last range if they overlap or are adjacent.
+ *
+ * @param ranges The list of ranges.
+ * @param begin A pointer to the start of the range.
+ * @param end A pointer to one past the end of the range.
+ */
+static void add_range( vector<pair<char const*,char const*>> &ranges,
+                       char const *begin, char const *end ) {
+  if ( !ranges.empty() && begin <= ranges.back().second ) {
+    if ( end > ranges.back().second )
+      ranges.back().second = end;
+  } else {
+    ranges.emplace_back( begin, end );
+  }
+}
+
+/**
+ * Checks whether a file is (plausibly) an index file by checking that the
+ * headers of all the segments every index file has are within the file.  This
+ * guards against searching a file that's been truncated or isn't an index
+ * file at all.
+ *
+ * @param file The file to check.
+ * @return Returns \c true only if the file is an index file.
+ */
+static bool is_index_file( mmap_file const &file ) {
+  typedef index_segment::size_type size_type;
+  auto c = file.begin();
+  for ( int id = 0; id <= index_segment::isi_meta_name; ++id ) {
+    if ( size_t( file.end() - c ) < sizeof( size_type ) )
+      return false;
+    size_type const num_entries = *reinterpret_cast<size_type const*>( c );
+    c += sizeof( size_type );
+    if ( size_t( file.end() - c ) / sizeof( off_t ) < num_entries )
+      return false;
+    c += num_entries * sizeof( off_t );
+  } // for
+  return true;
+}
+
+/**
+ * Checks whether two file statuses are of the same unmodified file.
+ *
+ * @param i The first status.
+ * @param j The second status.
+ * @return Returns \c true only if they are.
+ */
+inline bool same_file( struct stat const &i, struct stat const &j ) {
+  return  i.st_dev   == j.st_dev  && i.st_ino   == j.st_ino &&
+          i.st_size  == j.st_size && i.st_mtime == j.st_mtime;
+}
+
+/**
+ * Opens a single index file.
+ *
+ * @param file_name The name of the index file.
+ * @param name The name to refer to the index by.
+ * @param indices The list to append the opened index to.
+ * @param watched The list of watched files to append to.
+ * @return Returns \c true only if the index file was opened.
+ */
+static bool open_index( string const &file_name, string const &name,
+                        search_index::list_type &indices,
+                        watched_list &watched ) {
+  watch( file_name, watched );
+  unique_ptr<search_index> index(
+    new search_index( file_name.c_str(), name.c_str() )
+  );
+  if ( index->error() ) {
+    error() << "could not read index from \"" << name
+            << '"' << error_string( index->error() );
+    return false;
+  }
+  indices.push_back( move( index ) );
+  return true;
+}
+
+/**
+ * Opens all the index files listed in a manifest file.
+ *
+ * @param manifest_name The name of the manifest file.
+ * @param indices The list to append the opened indicies to.
+ * @param watched The list of watched files to append to.
+ * @return Returns \c true only if all the index files were opened.
+ */
+static bool open_manifest( string const &manifest_name,
+                           search_index::list_type &indices,
+                           watched_list &watched ) {
+  watch( manifest_name, watched );
+  ifstream manifest( manifest_name.c_str() );
+  if ( !manifest ) {
+    error() << "could not read index manifest \"" << manifest_name
+            << '"' << error_string;
+    return false;
+  }
+
+  string dir( manifest_name );
+  auto const slash = dir.rfind( '/' );
+  dir.erase( slash == string::npos ? 0 : slash + 1 );
+
+  bool opened_any = false;
+  for ( string line; getline( manifest, line ); ) {
+    auto const begin = line.find_first_not_of( " \t\r" );
+    if ( begin == string::npos || line[ begin ] == '#' )
+      continue;
+    auto const end = line.find_last_not_of( " \t\r" );
+    string const name( line, begin, end - begin + 1 );
+    string const file_name( name[0] == '/' ? name : dir + name );
+    if ( !open_index( file_name, name, indices, watched ) )
+      return false;
+    opened_any = true;
+  } // for
+
+  if ( !opened_any ) {
+    error() << "index manifest \"" << manifest_name << "\" is empty\n";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Opens the index files given to load().
+ *
+ * @param indices The list to append the opened indicies to.
+ * @param watched The list of watched files to append to.
+ * @return Returns \c true only if all the index files were opened.
+ */
+static bool open_all( search_index::list_type &indices,
+                      watched_list &watched ) {
+  for ( auto const &name : load_names ) {
+    if ( !(name.second[0] == '@' ?
+           open_manifest( name.first, indices, watched ) :
+           open_index( name.first, name.second, indices, watched )) )
+      return false;
+  } // for
+  return true;
+}
+
+////////// member functions ///////////////////////////////////////////////////
+
+search_index::search_index( char const *file_name, char const *name ) :
+  name_( name ? name : file_name ), file_( file_name ), error_( file_.error() )
+{
+  if ( error_ )
+    return;
+  if ( !is_index_file( file_ ) ) {
+    error_ = EINVAL;
+    return;
+  }
+  if ( huge_pages_ != hp_none ) {
+    //
+    // This must be done before the segments are set since the file may be
+    // moved in memory.
+    //
+    int const err = file_.huge_pages( huge_pages_ == hp_copy );
+    if ( err )
+      ::error() << "could not use huge pages for \"" << name_ << '"'
+              << error_string( err );
+  }
+  file_.behavior( mmap_file::bt_random );
+  for ( int id = 0; id <= index_segment::isi_trigram; ++id )
+    segment_[ id ].set_index_file(
+      file_, static_cast<index_segment::segment_id>( id )
+    );
+}
+
+bool search_index::changed() {
+  bool changed = false;
+  for ( auto &w : watched_files ) {
+    struct stat now;
+    if ( ::stat( w.name.c_str(), &now ) == -1 )
+      continue;                         // being replaced: check again later
+    if ( !same_file( now, w.loaded ) && same_file( now, w.seen ) )
+      changed = true;
+    w.seen = now;
+  } // for
+  return changed;
+}
+
+bool search_index::load( vector<char const*> const &file_names ) {
+  string cwd;
+  char buf[ PATH_MAX ];
+  if ( ::getcwd( buf, sizeof buf ) )
+    cwd = string( buf ) + '/';
+
+  load_names.clear();
+  for ( auto const file_name : file_names ) {
+    string path( file_name + (*file_name == '@') );
+    if ( path[0] != '/' )
+      path.insert( 0, cwd );
+    load_names.emplace_back( path, file_name );
+  } // for
+
+  auto const indices = make_shared<list_type>();
+  watched_files.clear();
+  if ( !open_all( *indices, watched_files ) )
+    return false;
+  for ( auto const &index : *indices )
+    index->warm_up();
+  atomic_store( &current_, list_ptr( indices ) );
+  return true;
+}
+
+bool search_index::reload() {
+  auto const indices = make_shared<list_type>();
+  watched_list watched;
+  if ( !open_all( *indices, watched ) ) {
+    //
+    // Keep searching the current indicies, but don't try reloading again
+    // until the files change again.
+    //
+    for ( auto &w : watched_files )
+      w.loaded = w.seen;
+    return false;
+  }
+  for ( auto const &index : *indices )
+    if ( warm_up_ == wu_none )
+      index->file_.behavior( mmap_file::bt_willneed );
+    else
+      index->warm_up();
+  watched_files.swap( watched );
+  atomic_store( &current_, list_ptr( indices ) );
+  return true;
+}
+
+ostream& search_index::dump_resident( ostream &o ) const {
+  auto const page_size = mmap_file::page_size();
+  for ( auto const &r : regions() ) {
+    //
+    // Count pages the same way resident() does: every page any part of the
+    // region is on.
+    //
+    auto const offset = reinterpret_cast<uintptr_t>( r.begin ) % page_size;
+    size_t const size = r.end - r.begin;
+    size_t const pages = (offset + size + page_size - 1) / page_size;
+    size_t const resident = file_.resident( r.begin, size );
+    o << (r.id < 0 ? "tables" : segment_name[ r.id ]) << ' '
+      << resident << '/' << pages << " pages "
+      << (pages ? resident * 100 / pages : 100) << "%\n";
+  } // for
+  return o;
+}
+
+/**
+ * Gets the regions of the index file: the offset tables of all the segments
+ * followed by the data of every non-empty segment (except the reversed-word
+ * segment that has no data of its own), in file order.
+ *
+ * @return Returns said regions.
+ */
+search_index::region_list search_index::regions() const {
+  region_list data;
+  for ( int id = 0; id <= index_segment::isi_trigram; ++id )
+    if ( id != index_segment::isi_reversed && segment_[ id ].size() )
+      data.push_back( region{ id, segment_[ id ][ 0 ], nullptr } );
+  ::sort(
+    data.begin(), data.end(),
+    []( region const &i, region const &j ) { return i.begin < j.begin; }
+  );
+  for ( size_t i = 0; i < data.size(); ++i )
+    data[i].end = i + 1 < data.size() ? data[ i + 1 ].begin : file_.end();
+
+  region_list regions;
+  regions.push_back( region{
+    -1, file_.begin(), data.empty() ? file_.end() : data.front().begin
+  } );
+  regions.insert( regions.end(), data.begin(), data.end() );
+  return regions;
+}
+
+void search_index::set_warm_up( warm_up_type type, bool lock ) {
+  warm_up_ = type;
+  warm_up_lock_ = lock;
+#ifdef RLIMIT_MEMLOCK
+  if ( lock )
+    max_out_limit( RLIMIT_MEMLOCK );
+#endif /* RLIMIT_MEMLOCK */
+}
+
+/**
+ * Reads the part of the index given by set_warm_up() into memory by first
+ * requesting that its pages be read ahead (so they're read in large requests)
+ * and then touching every page.
+ */
+void search_index::warm_up() const {
+  if ( warm_up_ == wu_none )
+    return;
+  auto const page_size = mmap_file::page_size();
+
+  vector<pair<char const*,char const*>> ranges;
+  for ( auto const &r : regions() ) {
+    switch ( r.id ) {
+      case -1:
+      case index_segment::isi_stop_word:
+      case index_segment::isi_dir:
+      case index_segment::isi_file:
+      case index_segment::isi_meta_name:
+        if ( r.id == -1 || warm_up_ >= wu_dictionary )
+          add_range( ranges, r.begin, r.end );
+        continue;
+      case index_segment::isi_word:
+      case index_segment::isi_bigram:
+        if ( warm_up_ == wu_dictionary ) {
+          //
+          // Only the words themselves are needed to look them up, not the
+          // files they're in that follow each.
+          //
+          for ( auto const word : segment_[ r.id ] )
+            add_range( ranges, word, word + ::strlen( word ) + 1 );
+          continue;
+        }
+        break;
+    } // switch
+    if ( warm_up_ == wu_all )
+      add_range( ranges, r.begin, r.end );
+  } // for
+
+  for ( auto const &range : ranges )
+    file_.behavior(
+      mmap_file::bt_willneed, range.first, range.second - range.first
+    );
+  char volatile sum = 0;
+  for ( auto const &range : ranges ) {
+    auto p = range.first;
+    p -= reinterpret_cast<uintptr_t>( p ) % page_size;
+    for ( ; p < range.second; p += page_size )
+      sum += *p;
+  } // for
+
+  if ( warm_up_lock_ ) {
+    for ( auto const &range : ranges ) {
+      int const err =
+        file_.lock( range.first, range.second - range.first );
+      if ( err ) {
+        ::error() << "could not lock \"" << name_ << "\" into memory"
+                << error_string( err );
+        break;
+      }
+    } // for
+  }
+}
+
+void search_index::use() const {
+  in_use_     = this;
+  words       = segment_[ index_segment::isi_word      ];
+  stop_words  = segment_[ index_segment::isi_stop_word ];
+  directories = segment_[ index_segment::isi_dir       ];
+  files       = segment_[ index_segment::isi_file      ];
+  meta_names  = segment_[ index_segment::isi_meta_name ];
+  reversed    = segment_[ index_segment::isi_reversed  ];
+  trigrams    = segment_[ index_segment::isi_trigram   ];
+#ifdef WITH_WORD_POS
+  bigrams     = segment_[ index_segment::isi_bigram    ];
+#endif /* WITH_WORD_POS */
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
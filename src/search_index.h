@@ -0,0 +1,230 @@
+/*
+**      SWISH++
+**      src/search_index.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef search_index_H
+#define search_index_H
+
+// local
+#include "config.h"
+#include "index_segment.h"
+#include "pjl/mmap_file.h"
+
+// standard
+#include <iostream>
+#include <memory>                       /* for unique_ptr */
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The segments of the index the current thread searches.  They're per-thread
+ * so that several indicies ("shards") can be searched at once, each in its own
+ * thread: all the query code uses these and so needn't know which index it's
+ * searching.  They're set by search_index::use().
+ */
+extern thread_local index_segment directories, files, meta_names, reversed,
+                                  stop_words, trigrams, words;
+#ifdef WITH_WORD_POS
+extern thread_local index_segment bigrams;
+#endif /* WITH_WORD_POS */
+
+/**
+ * A %search_index is an index file mapped into memory along with its segments.
+ * When more than one index is searched at once, each is a "shard" of the
+ * entire collection of files.
+ *
+ * The list of indicies being searched is reference-counted so it can be
+ * replaced by a newly loaded list (when the index files are regenerated) while
+ * requests are still searching the old one: the old list (and its mappings)
+ * is destroyed only once the last such request releases it.
+ */
+class search_index {
+public:
+  typedef std::vector<std::unique_ptr<search_index>> list_type;
+  typedef std::shared_ptr<list_type const> list_ptr;
+
+  /**
+   * How much of an index to read into memory when it's loaded (so the first
+   * searches of it don't all incur page faults).
+   */
+  enum warm_up_type {
+    wu_none,
+    wu_tables,                          // offset tables of all segments
+    wu_dictionary,                      // tables + words + small segments
+    wu_all                              // the entire file
+  };
+
+  /**
+   * Whether the memory an index is mapped into is backed by (transparent) huge
+   * pages to reduce TLB misses when searching a large index.
+   */
+  enum huge_pages_type {
+    hp_none,
+    hp_advise,                          // advise the file mapping to use them
+    hp_copy                             // copy the file into anonymous memory
+  };
+
+  /**
+   * Constructs a %search_index by mapping the given index file into memory.
+   *
+   * @param file_name The name of the index file.
+   * @param name The name to refer to the index by or null to use \a file_name.
+   */
+  explicit search_index( char const *file_name, char const *name = nullptr );
+
+  /**
+   * Gets the error, if any, of mapping the index file into memory.
+   *
+   * @return Returns said error (\c EINVAL if the file isn't an index file) or 0
+   * if none.
+   */
+  int error() const {
+    return error_;
+  }
+
+  /**
+   * Gets the name of the index file (as it was given).
+   *
+   * @return Returns said name.
+   */
+  char const* name() const {
+    return name_.c_str();
+  }
+
+  /**
+   * Writes how much of each segment of the index is resident in memory.
+   *
+   * @param o The ostream to write to.
+   * @return Returns \a o.
+   */
+  std::ostream& dump_resident( std::ostream &o ) const;
+
+  /**
+   * Gets the index the current thread is searching.
+   *
+   * @return Returns said index or null if none.
+   */
+  static search_index const* in_use() {
+    return in_use_;
+  }
+
+  /**
+   * Makes this index the one the current thread searches by setting the
+   * thread's segments to this index's.
+   */
+  void use() const;
+
+  /**
+   * Checks whether any of the index (or manifest) files have been replaced or
+   * modified since they were last loaded.  To avoid loading a file that's
+   * still being written, a file is considered changed only if it's also
+   * unchanged since the previous call.
+   *
+   * @return Returns \c true only if the files should be reloaded.
+   */
+  static bool changed();
+
+  /**
+   * Gets the list of indicies currently being searched.  The list remains
+   * valid for as long as the returned pointer (or a copy of it) exists even
+   * if reload() is called in the meantime.
+   *
+   * @return Returns said list.
+   */
+  static list_ptr current() {
+    return std::atomic_load( &current_ );
+  }
+
+  /**
+   * Loads one or more index files and makes them the ones being searched.  If
+   * a file name starts with \c '@', the rest is the name of a "manifest" file
+   * that lists the names of the index files, one per line.  (Blank lines and
+   * lines starting with \c '#' are ignored; names are relative to the
+   * directory the manifest is in.)  Relative file names are made absolute so
+   * they can be reloaded after the current directory changes.
+   *
+   * @param file_names The file names.
+   * @return Returns \c true only if all the index files were loaded.
+   */
+  static bool load( std::vector<char const*> const &file_names );
+
+  /**
+   * Reloads the index files given to load() and, only if all of them can be
+   * loaded, atomically makes them the ones being searched.  The new files are
+   * warmed up as set by set_warm_up() or, if not set, their pages are
+   * requested to be read ahead asynchronously so that the first searches of
+   * them don't all incur page faults.
+   *
+   * @return Returns \c true only if all the index files were reloaded.
+   */
+  static bool reload();
+
+  /**
+   * Sets whether every index subsequently loaded is backed by huge pages.
+   *
+   * @param type How to use huge pages, if at all.
+   */
+  static void set_huge_pages( huge_pages_type type ) {
+    huge_pages_ = type;
+  }
+
+  /**
+   * Sets how much of every index subsequently loaded to read into memory.
+   *
+   * @param type How much to read.
+   * @param lock If \c true, also lock what's read into memory so it won't be
+   * paged out.
+   */
+  static void set_warm_up( warm_up_type type, bool lock );
+
+private:
+  /**
+   * A %region is a contiguous part of an index file.
+   */
+  struct region {
+    int         id;                     // segment_id or -1 for the tables
+    char const *begin, *end;
+  };
+  typedef std::vector<region> region_list;
+
+  region_list regions() const;
+  void warm_up() const;
+
+  std::string const name_;
+  PJL::mmap_file    file_;
+  int               error_;
+  index_segment     segment_[ index_segment::isi_trigram + 1 ];
+
+  static list_ptr current_;
+  static huge_pages_type huge_pages_;
+  static warm_up_type warm_up_;
+  static bool warm_up_lock_;
+  static thread_local search_index const *in_use_;
+
+  search_index( search_index const& ) = delete;
+  search_index& operator=( search_index const& ) = delete;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* search_index_H */
+/* vim:set et sw=2 ts=2: */
@@ -31,6 +31,7 @@ static option_stream::spec const opt_spec[] = {
   { "help",           0, '?', option_stream::arg_lone, "" },
   { "dump-words",     0, 'd', "", "" },
   { "dump-index",     0, 'D', "", "" },
+  { "evaluator",      1, 'e', "", "" },
   { "word-files",     1, 'f', "", "" },
   { "format",         1, 'F', "", "" },
   { "max-results",    1, 'm', "", "" },
@@ -45,21 +46,39 @@ static option_stream::spec const opt_spec[] = {
   { "dump-stop",      0, 'S', "", "" },
   { "version",        0, 'V', option_stream::arg_lone, "" },
   { "window",         1, 'w', "", "" },
-#ifndef SEARCH_DAEMON_OPTIONS_ONLY
+  { "explain",        0, 'x', "", "" },
+  { "dump-resident",  0, 'Y', "", "" },
+  { "fuzzy-words",    1, 'z', "", "" },
+#ifdef SEARCH_DAEMON_OPTIONS_ONLY
+  //
+  // Conversely, this option makes sense only in a request to the daemon.
+  //
+  { "keep-alive",     0, 'k', "", "" },
+#else
   //
   // Once running as a daemon, 'search' no longer accepts any of the remaining
   // options.
   //
   { "config-file",    1, 'c', "", "" },
+  { "huge-pages",     1, 'g', "", "" },
   { "index-file",     1, 'i', "", "" },
+  { "warm-up",        1, 'W', "", "" },
+  { "warm-up-lock",   0, 'L', "", "" },
+  { "warm-up-queries", 1, 'Q', "", "" },
 #ifdef WITH_SEARCH_DAEMON
   { "daemon-type",    1, 'b', "", "" },
+  { "daemon-io",      1, 'I', "", "" },
+  { "listeners",      1, 'A', "", "" },
+  { "pin-listeners",  0, 'C', "", "" },
 #ifdef __APPLE__
   { "launchd",        0, 'X', "", "" },
 #endif /* __APPLE__ */
   { "no-background",  0, 'B', "", "" },
   { "group",          1, 'G', "", "" },
+  { "http",           0, 'h', "", "" },
   { "pid-file",       1, 'P', "", "" },
+  { "query-threads",  1, 'j', "", "" },
+  { "reload-interval", 1, 'H', "", "" },
   { "socket-timeout", 1, 'o', "", "" },
   { "thread-timeout", 1, 'O', "", "" },
   { "queue-size",     1, 'q', "", "" },
@@ -0,0 +1,374 @@
+/*
+**      SWISH++
+**      src/search_reactor.cpp
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+// local
+#include "config.h"
+#include "exit_codes.h"
+#include "search_reactor.h"
+#include "search_thread.h"
+#include "util.h"
+
+#ifdef HAVE_EPOLL_CREATE1
+
+// standard
+#include <algorithm>                    /* for min() */
+#include <cerrno>
+#include <cstdint>                      /* for uint64_t */
+#include <cstdlib>                      /* for exit(3) */
+#include <cstring>
+#include <fcntl.h>                      /* for fcntl(2) */
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>                 /* for accept4(2), recv(2) */
+#include <time.h>                       /* for clock_gettime(2) */
+#include <unistd.h>                     /* for close(2), read(2), write(2) */
+
+using namespace PJL;
+using namespace std;
+
+extern void reset_socket( int fd );
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Gets the number of seconds on the monotonic clock.
+ *
+ * @return Returns said number.
+ */
+static long monotonic_seconds() {
+  struct timespec ts;
+  ::clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ts.tv_sec;
+}
+
+////////// member functions ///////////////////////////////////////////////////
+
+search_reactor::search_reactor( thread_pool &threads, unsigned timeout ) :
+  epoll_fd_( ::epoll_create1( EPOLL_CLOEXEC ) ),
+  threads_( threads ),
+  timeout_( timeout ),
+  last_tick_( monotonic_seconds() ),
+  wake_fd_( ::eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK ) ),
+  wake_pending_( false )
+{
+  if ( epoll_fd_ == -1 ) {
+    error() << "epoll_create1() failed" << error_string;
+    ::exit( Exit_No_Epoll );
+  }
+  if ( wake_fd_ == -1 ) {
+    error() << "eventfd() failed" << error_string;
+    ::exit( Exit_No_Epoll );
+  }
+  add( wake_fd_, EPOLLIN );
+}
+
+search_reactor::~search_reactor() {
+  for ( auto const &c : connections_ )
+    ::close( c.first );
+  for ( auto const &r : resumed_ )
+    ::close( r.first );
+  ::close( wake_fd_ );
+  ::close( epoll_fd_ );
+}
+
+/**
+ * Accepts all pending connections on a listening socket.  Each connection's
+ * request line is tried to be read immediately since it has often arrived
+ * already.
+ *
+ * @param listen_fd The listening socket's file descriptor.
+ */
+void search_reactor::accept_all( int listen_fd ) {
+  while ( true ) {
+    int const fd = ::accept4( listen_fd, nullptr, nullptr, SOCK_NONBLOCK );
+    if ( fd == -1 ) {
+      switch ( errno ) {
+        case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+        case EWOULDBLOCK:
+#endif
+          return;
+        case ECONNABORTED:              // POSIX.1g
+        case EINTR:
+#ifdef EPROTO
+        case EPROTO:                    // SVR4
+#endif /* EPROTO */
+          continue;
+        case EMFILE:
+        case ENFILE:
+        case ENOBUFS:
+        case ENOMEM:
+          //
+          // Out of resources: leave the rest of the connections queued and
+          // stop listening until the next tick when, hopefully, some
+          // connections will have been closed.
+          //
+          error() << "accept() failed" << error_string;
+          ::epoll_ctl( epoll_fd_, EPOLL_CTL_DEL, listen_fd, nullptr );
+          paused_.push_back( listen_fd );
+          return;
+      }
+      error() << "accept() failed" << error_string;
+      ::exit( Exit_No_Accept );
+    }
+#   ifdef DEBUG_threads
+    cerr << "accepted connection " << fd << '\n';
+#   endif
+    connection &c = connections_[ fd ];
+    c.timer = timers_.schedule( fd, timeout_ + 1 );
+    add( fd, EPOLLIN | EPOLLRDHUP | EPOLLET );
+    read( fd );
+  } // while
+}
+
+/**
+ * Adds a file descriptor to the epoll set.
+ *
+ * @param fd The file descriptor.
+ * @param events The events to be notified of.
+ */
+void search_reactor::add( int fd, unsigned events ) {
+  struct epoll_event ev;
+  ::memset( &ev, 0, sizeof ev );
+  ev.events = events;
+  ev.data.fd = fd;
+  if ( ::epoll_ctl( epoll_fd_, EPOLL_CTL_ADD, fd, &ev ) == -1 ) {
+    error() << "epoll_ctl() failed" << error_string;
+    ::exit( Exit_No_Epoll );
+  }
+}
+
+/**
+ * Closes a client connection whose (next) request line was never completely
+ * read.
+ *
+ * @param fd The connection's file descriptor.
+ * @param reset If \c true, reset the connection rather than closing it
+ * normally.
+ */
+void search_reactor::close( int fd, bool reset ) {
+  auto const c = connections_.find( fd );
+  if ( c != connections_.end() ) {
+    if ( c->second.timer )
+      timers_.cancel( c->second.timer );
+    connections_.erase( c );
+  }
+  if ( reset )
+    reset_socket( fd );
+  ::close( fd );                        // also removes it from the epoll set
+}
+
+/**
+ * Gives a complete request to a search_thread.  The connection is no longer
+ * the reactor's unless it's given back via resume().
+ *
+ * @param fd The connection's file descriptor.
+ * @param line The request line.
+ */
+void search_reactor::dispatch( int fd, string const &line ) {
+  auto const c = connections_.find( fd );
+  timers_.cancel( c->second.timer );
+  search_request *const request =
+    new search_request( fd, line, c->second.buf );
+  request->resume = [this]( search_request &r ) {
+    resume( r.fd, std::move( r.pending ) );
+  };
+  connections_.erase( c );
+  ::epoll_ctl( epoll_fd_, EPOLL_CTL_DEL, fd, nullptr );
+  //
+  // The thread writes the results with blocking I/O.
+  //
+  ::fcntl( fd, F_SETFL, ::fcntl( fd, F_GETFL ) & ~O_NONBLOCK );
+
+# ifdef DEBUG_threads
+  cerr << "queueing request\n";
+# endif
+  if ( !threads_.new_task( request ) ) {
+    delete request;
+    reset_socket( fd );
+    ::close( fd );
+  }
+}
+
+void search_reactor::listen( int fd, bool shared ) {
+  ::fcntl( fd, F_SETFL, ::fcntl( fd, F_GETFL ) | O_NONBLOCK );
+  unsigned events = EPOLLIN;
+#ifdef EPOLLEXCLUSIVE
+  //
+  // Otherwise every reactor would be woken for every connection only for all
+  // but one of them to find there's nothing to accept.
+  //
+  if ( shared )
+    events |= EPOLLEXCLUSIVE;
+#else
+  (void)shared;
+#endif /* EPOLLEXCLUSIVE */
+  listeners_[ fd ] = events;
+  add( fd, events );
+}
+
+void search_reactor::poll( int max_wait ) {
+  //
+  // If there are connections that can time out (or listening sockets to
+  // resume), wake up at least every second to advance the timer wheel.
+  //
+  int timeout_ms = max_wait < 0 ? -1 : max_wait * 1000;
+  if ( !timers_.empty() || !paused_.empty() )
+    timeout_ms = timeout_ms < 0 ? 1000 : min( timeout_ms, 1000 );
+
+  struct epoll_event events[ 64 ];
+  int const num_events =
+    ::epoll_wait( epoll_fd_, events, sizeof events / sizeof events[0],
+                  timeout_ms );
+  if ( num_events == -1 && errno != EINTR ) {
+    error() << "epoll_wait() failed" << error_string;
+    ::exit( Exit_No_Epoll );
+  }
+
+  for ( int i = 0; i < num_events; ++i ) {
+    int const fd = events[i].data.fd;
+    if ( fd == wake_fd_ ) {
+      resume_all();
+      continue;
+    }
+    if ( listeners_.count( fd ) ) {
+      accept_all( fd );
+      continue;
+    }
+    auto const w = watched_.find( fd );
+    if ( w != watched_.end() ) {
+      (*w->second)( fd );
+      continue;
+    }
+    //
+    // A connection may have been closed by an earlier event in this batch
+    // (and its descriptor even reused by an accepted connection that's been
+    // read already).
+    //
+    if ( connections_.count( fd ) )
+      read( fd );
+  } // for
+
+  long const now = monotonic_seconds();
+  if ( last_tick_ < now ) {
+    for ( int const fd : paused_ )
+      add( fd, listeners_[ fd ] );
+    paused_.clear();
+    last_tick_ = now;
+  }
+  timers_.advance_to(
+    now,
+    [this]( int fd ) {
+#     ifdef DEBUG_threads
+      cerr << "connection " << fd << " timed out\n";
+#     endif
+      connections_[ fd ].timer = timer_wheel::handle();
+      close( fd, true );
+    }
+  );
+}
+
+/**
+ * Reads all that's available from a client connection.  If the request line
+ * is complete, gives it to a thread; if the client disconnected or there was
+ * an error before then, closes the connection.
+ *
+ * @param fd The connection's file descriptor.
+ */
+void search_reactor::read( int fd ) {
+  connection &c = connections_[ fd ];
+  while ( true ) {
+    string line;
+    if ( get_request_line( c.buf, line, c.resumed ) ) {
+      dispatch( fd, line );
+      return;
+    }
+
+    char chunk[ Request_Line_Max ];
+    ssize_t const bytes_read = ::recv( fd, chunk, sizeof chunk, 0 );
+    if ( bytes_read == -1 ) {
+      if ( errno == EINTR )
+        continue;
+      if ( errno == EAGAIN || errno == EWOULDBLOCK )
+        return;                         // wait for more
+      close( fd, true );
+      return;
+    }
+    if ( !bytes_read ) {
+      //
+      // The client disconnected: that's premature unless it's simply done
+      // sending requests on a connection kept alive.
+      //
+      close( fd, !(c.resumed && c.buf.empty()) );
+      return;
+    }
+    c.buf.append( chunk, bytes_read );
+  } // while
+}
+
+void search_reactor::resume( int fd, string &&pending ) {
+  {
+    lock_guard<mutex> const lock( resumed_lock_ );
+    resumed_.emplace_back( fd, std::move( pending ) );
+  }
+  //
+  // Wake up the main thread only if it's not already been woken for earlier
+  // connections.
+  //
+  if ( !wake_pending_.exchange( true ) ) {
+    uint64_t const one = 1;
+    (void)::write( wake_fd_, &one, sizeof one );
+  }
+}
+
+/**
+ * Takes back all the connections given by resume() and reads their next
+ * requests.
+ */
+void search_reactor::resume_all() {
+  uint64_t count;
+  (void)::read( wake_fd_, &count, sizeof count );
+  wake_pending_ = false;
+  vector<resumption> resumed;
+  {
+    lock_guard<mutex> const lock( resumed_lock_ );
+    resumed.swap( resumed_ );
+  }
+  for ( auto &r : resumed ) {
+    int const fd = r.first;
+    ::fcntl( fd, F_SETFL, ::fcntl( fd, F_GETFL ) | O_NONBLOCK );
+    connection &c = connections_[ fd ];
+    c.buf = std::move( r.second );
+    c.resumed = true;
+    c.timer = timers_.schedule( fd, timeout_ + 1 );
+    add( fd, EPOLLIN | EPOLLRDHUP | EPOLLET );
+    read( fd );
+  } // for
+}
+
+void search_reactor::watch( int fd, watch_function f ) {
+  watched_[ fd ] = f;
+  add( fd, EPOLLIN | EPOLLET );
+}
+
+#endif /* HAVE_EPOLL_CREATE1 */
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
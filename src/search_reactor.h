@@ -0,0 +1,162 @@
+/*
+**      SWISH++
+**      src/search_reactor.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef search_reactor_H
+#define search_reactor_H
+
+// local
+#include "config.h"
+#include "pjl/thread_pool.h"
+#include "pjl/timer_wheel.h"
+
+// standard
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>                      /* for pair */
+#include <vector>
+
+#ifdef HAVE_EPOLL_CREATE1
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %search_reactor is an event loop (via Linux's epoll(7)) that accepts
+ * client connections and reads their request lines without blocking: only
+ * once a connection's request line is complete is the request given to a
+ * search_thread.  Hence idle or slow clients tie up no threads, only a file
+ * descriptor and a buffer each.  Clients that don't send a complete request
+ * line in time are disconnected via a timer_wheel.
+ *
+ * A connection kept alive after a request is given back to the reactor to
+ * read the next request.
+ *
+ * A %search_reactor is used only by the main thread (except for resume()).
+ */
+class search_reactor {
+public:
+  /**
+   * A function that's called when a watched file descriptor is readable.
+   *
+   * @param fd The file descriptor.
+   */
+  typedef void (*watch_function)( int fd );
+
+  /**
+   * Constructs a %search_reactor.
+   *
+   * @param threads The thread pool to give complete requests to.
+   * @param timeout The number of seconds a client has to send a complete
+   * request line.
+   */
+  search_reactor( PJL::thread_pool &threads, unsigned timeout );
+
+  ~search_reactor();
+
+  /**
+   * Adds a listening socket to accept client connections from.
+   *
+   * @param fd The socket's file descriptor.
+   * @param shared If \c true, the socket is also being listened on by other
+   * %search_reactor objects (in other threads): only one of them is woken
+   * per connection (where supported).
+   */
+  void listen( int fd, bool shared = false );
+
+  /**
+   * Waits for and handles events once.
+   *
+   * @param max_wait The maximum number of seconds to wait or -1 to wait
+   * until there's an event.
+   */
+  void poll( int max_wait );
+
+  /**
+   * Gives a connection back after the results of a request that kept it alive
+   * have been written so the next request is read.  This is called by a
+   * search_thread.
+   *
+   * @param fd The connection's file descriptor.
+   * @param pending What was received after the request line.
+   */
+  void resume( int fd, std::string &&pending );
+
+  /**
+   * Adds a file descriptor to call a function for whenever it's readable.
+   * The function must read all that's available since only changes in
+   * readability are reported.
+   *
+   * @param fd The file descriptor.
+   * @param f The function to call.
+   */
+  void watch( int fd, watch_function f );
+
+private:
+  typedef PJL::timer_wheel<int> timer_wheel;
+
+  /**
+   * A %connection is a client connection whose request line has yet to be
+   * completely read.
+   */
+  struct connection {
+    std::string         buf;            // what's been read so far
+    timer_wheel::handle timer;          // when it times out
+    bool                resumed;        // kept alive after a request?
+
+    connection() : resumed( false ) { }
+  };
+  typedef std::unordered_map<int,connection> connection_map;
+  typedef std::pair<int,std::string> resumption; // fd and what's pending
+  typedef std::unordered_map<int,unsigned> listener_map; // fd -> events
+  typedef std::unordered_map<int,watch_function> watch_map;
+
+  void accept_all( int listen_fd );
+  void add( int fd, unsigned events );
+  void close( int fd, bool reset );
+  void dispatch( int fd, std::string const &line );
+  void read( int fd );
+  void resume_all();
+
+  int                     epoll_fd_;
+  PJL::thread_pool       &threads_;
+  unsigned const          timeout_;
+  connection_map          connections_;
+  listener_map            listeners_;
+  std::vector<int>        paused_;      // listeners not accepting for now
+  watch_map               watched_;
+  timer_wheel             timers_;
+  long                    last_tick_;   // seconds on the monotonic clock
+
+  int                     wake_fd_;     // eventfd signalled by resume()
+  std::atomic<bool>       wake_pending_;
+  std::mutex              resumed_lock_;
+  std::vector<resumption> resumed_;     // given by resume(), not yet read
+
+  search_reactor( search_reactor const& ) = delete;
+  search_reactor& operator=( search_reactor const& ) = delete;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* HAVE_EPOLL_CREATE1 */
+#endif /* search_reactor_H */
+/* vim:set et sw=2 ts=2: */
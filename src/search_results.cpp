@@ -0,0 +1,104 @@
+/*
+**      SWISH++
+**      src/search_results.cpp
+**
+**      Copyright (C) 1998-2016  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+// local
+#include "index_segment.h"
+#include "search_results.h"
+
+// standard
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * The maximum number of buffers kept in a thread's pool.  Evaluating a query
+ * needs about one buffer per level of nesting (plus one per child of an "and")
+ * so this is plenty for typical queries.
+ */
+static size_t const Pool_Max = 8;
+
+/**
+ * If there are more than 1/Scan_Ratio as many hits as files, it's faster to
+ * rebuild the list of hits by scanning all the ranks than to sort the list.
+ */
+static size_t const Scan_Ratio = 16;
+
+///////////////////////////////////////////////////////////////////////////////
+
+search_results::rank_type const search_results::No_Rank;
+
+search_results::buffer_pool& search_results::pool() {
+  static thread_local buffer_pool pool;
+  return pool;
+}
+
+search_results::search_results() {
+  extern thread_local index_segment files;
+  buffer_pool &pool = search_results::pool();
+  if ( pool.empty() ) {
+    buf_ = new buffer;
+  } else {
+    buf_ = pool.back().release();
+    pool.pop_back();
+  }
+  if ( buf_->ranks_.size() != files.size() ) {
+    //
+    // Either the buffer is new or the index changed since it was last used.
+    //
+    buf_->ranks_.assign( files.size(), No_Rank );
+  }
+  buf_->sorted_ = true;
+}
+
+search_results::~search_results() {
+  if ( !buf_ )                          // moved from
+    return;
+  buffer_pool &pool = search_results::pool();
+  if ( pool.size() >= Pool_Max ) {
+    delete buf_;
+    return;
+  }
+  //
+  // Reset only those ranks that were set so the cost is proportional to the
+  // number of results rather than the number of files.
+  //
+  for ( auto const i : buf_->hits_ )
+    buf_->ranks_[i] = No_Rank;
+  buf_->hits_.clear();
+  pool.emplace_back( buf_ );
+}
+
+void search_results::sort_hits() {
+  auto &hits = buf_->hits_;
+  auto const &ranks = buf_->ranks_;
+  if ( hits.size() > ranks.size() / Scan_Ratio ) {
+    hits.clear();
+    for ( size_t i = 0; i < ranks.size(); ++i )
+      if ( ranks[i] != No_Rank )
+        hits.push_back( i );
+  } else {
+    ::sort( hits.begin(), hits.end() );
+  }
+  buf_->sorted_ = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
@@ -0,0 +1,218 @@
+/*
+**      SWISH++
+**      src/search_results.h
+**
+**      Copyright (C) 1998-2016  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef search_results_H
+#define search_results_H
+
+// standard
+#include <cstddef>                      /* for size_t */
+#include <memory>                       /* for unique_ptr */
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %search_results contains a set of search results: file indicies and their
+ * ranks.
+ *
+ * Ranks are accumulated into a dense array having one element per file in the
+ * index so adding to a file's rank is O(1).  The indicies of the files having
+ * ranks are additionally kept in a list that's sorted only when iterated over
+ * so the results can be iterated over (in file index order) and cleared in
+ * time proportional to their number rather than the number of files.
+ *
+ * The arrays are taken from and returned to a per-thread pool so they're
+ * allocated only once per thread rather than once per query.
+ */
+class search_results {
+public:
+  ////////// typedefs /////////////////////////////////////////////////////////
+
+  typedef int file_index_type;
+  typedef int rank_type;
+  typedef size_t size_type;
+  typedef std::vector<file_index_type>::const_iterator const_iterator;
+
+  ////////// constructors & destructor ////////////////////////////////////////
+
+  search_results();
+  search_results( search_results &&from ) noexcept : buf_( from.buf_ ) {
+    from.buf_ = nullptr;
+  }
+  ~search_results();
+
+  search_results( search_results const& ) = delete;
+  search_results& operator=( search_results const& ) = delete;
+
+  ////////// iterators ////////////////////////////////////////////////////////
+
+  /**
+   * Gets an iterator positioned at the first file index; the indicies are in
+   * ascending order.
+   *
+   * @return Returns said iterator.
+   */
+  const_iterator begin() {
+    sort();
+    return buf_->hits_.begin();
+  }
+
+  const_iterator end() {
+    return buf_->hits_.end();
+  }
+
+  ////////// member functions /////////////////////////////////////////////////
+
+  /**
+   * Adds to the rank of the given file, adding the file first if necessary.
+   *
+   * @param i The file's index.
+   * @param rank The rank to add.
+   */
+  void add( file_index_type i, rank_type rank ) {
+    touch( i ) += rank;
+  }
+
+  /**
+   * Sets the rank of the given file, adding the file first if necessary.
+   *
+   * @param i The file's index.
+   * @param rank The new rank.
+   */
+  void assign( file_index_type i, rank_type rank ) {
+    touch( i ) = rank;
+  }
+
+  /**
+   * Checks whether the given file is among the results.
+   *
+   * @param i The file's index.
+   * @return Returns \c true only if the file is among the results.
+   */
+  bool contains( file_index_type i ) const {
+    return buf_->ranks_[i] != No_Rank;
+  }
+
+  bool empty() const {
+    return buf_->hits_.empty();
+  }
+
+  /**
+   * Removes the files for which the given predicate returns \c false.
+   *
+   * @tparam KeepPredicate The predicate type.
+   * @param keep The predicate called as <code>keep( i, rank )</code> where \a
+   * rank is a reference to the file's rank that it may also modify.
+   */
+  template<class KeepPredicate>
+  void filter( KeepPredicate keep );
+
+  /**
+   * Gets the rank of the given file.
+   *
+   * @param i The file's index.  The file must be among the results.
+   * @return Returns said rank.
+   */
+  rank_type operator[]( file_index_type i ) const {
+    return buf_->ranks_[i];
+  }
+
+  size_type size() const {
+    return buf_->hits_.size();
+  }
+
+  void swap( search_results &other ) {
+    buffer *const temp = buf_;
+    buf_ = other.buf_;
+    other.buf_ = temp;
+  }
+
+private:
+  /**
+   * The value of a rank for a file that is not among the results.
+   */
+  static rank_type const No_Rank = -1;
+
+  struct buffer {
+    std::vector<rank_type>        ranks_; // rank for every file in the index
+    std::vector<file_index_type>  hits_;  // indicies of files having ranks
+    bool                          sorted_;// are hits_ sorted?
+  };
+
+  typedef std::vector<std::unique_ptr<buffer>> buffer_pool;
+
+  buffer *buf_;
+
+  /**
+   * Gets the pool of buffers for the current thread.
+   *
+   * @return Returns said pool.
+   */
+  static buffer_pool& pool();
+
+  /**
+   * Ensures the file indicies are sorted.
+   */
+  void sort() {
+    if ( !buf_->sorted_ )
+      sort_hits();
+  }
+
+  void sort_hits();
+
+  /**
+   * Adds the given file (if it isn't already among the results).
+   *
+   * @param i The file's index.
+   * @return Returns a reference to the file's rank.
+   */
+  rank_type& touch( file_index_type i ) {
+    rank_type &rank = buf_->ranks_[i];
+    if ( rank == No_Rank ) {
+      if ( !buf_->hits_.empty() && i < buf_->hits_.back() )
+        buf_->sorted_ = false;
+      buf_->hits_.push_back( i );
+      rank = 0;
+    }
+    return rank;
+  }
+};
+
+////////// inlines ////////////////////////////////////////////////////////////
+
+template<class KeepPredicate>
+void search_results::filter( KeepPredicate keep ) {
+  auto &hits = buf_->hits_;
+  auto to = hits.begin();
+  for ( auto const i : hits ) {
+    rank_type &rank = buf_->ranks_[i];
+    if ( keep( i, rank ) )
+      *to++ = i;
+    else
+      rank = No_Rank;
+  } // for
+  hits.erase( to, hits.end() );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* search_results_H */
+/* vim:set et sw=2 ts=2: */
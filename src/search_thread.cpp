@@ -20,7 +20,10 @@
 */
 
 // local
+#include "binary_protocol.h"
 #include "config.h"
+#include "DaemonHTTP.h"
+#include "http_protocol.h"
 #include "pjl/fdbuf.h"
 #include "search.h"
 #include "search_thread.h"
@@ -33,6 +36,8 @@
 #include <cstring>
 #include <fcntl.h>
 #include <iostream>
+#include <memory>                       /* for unique_ptr */
+#include <sstream>                      /* for stringbuf */
 #include <sys/socket.h>                 /* for recv(3) */
 #include <time.h>
 #include <unistd.h>                     /* for close(2) */
@@ -68,7 +73,8 @@ extern void reset_socket( int fd );
 
 // local functions
 static int  split_args( char *s, char *argv[], int arg_max );
-static bool timed_read_line( int fd, char *buf, int buf_size, int seconds );
+static bool timed_read_line( int fd, string &buf, string &line,
+                             bool resumed, int seconds );
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -77,10 +83,15 @@ search_thread::thread* search_thread::create( thread_pool &p ) const {
 }
 
 /**
- * Reads a "command-line" from the client via a socket, service a request, and
- * return the results via the same socket.
+ * Reads a "command-line" (or a binary or HTTP request) from the client via a
+ * socket
+ * (unless it was already read), service a request, and return the results via
+ * the same socket (or give them to the request's reply function, if any).  If
+ * the request keeps the connection alive, the (text) results are preceded by
+ * their length and the next request is then read (or the connection is given
+ * to the request's resume function, if any).
  *
- * @param arg The \c i member is the socket file descriptor.
+ * @param arg The \c p member is a pointer to the search_request.
  */
 void search_thread::main( argument_type arg ) {
 #define SEARCH_DAEMON_OPTIONS_ONLY
@@ -90,47 +101,203 @@ void search_thread::main( argument_type arg ) {
   cerr << "in search_thread::main()\n";
 # endif
 
-  char buf[ 1024 ];
-  bool ok = false;
-  if ( timed_read_line( arg.i, buf, sizeof buf, socket_timeout ) ) {
-
-#   ifdef DEBUG_threads
-    cerr << "query=" << buf << "\n";
-#   endif
-
-    char*   argv_vec[ ARG_MAX ];
-    char**  argv = argv_vec;
-    int     argc = split_args( buf, argv, ARG_MAX );
-    fdbuf   buf( arg.i );
-    ostream out( &buf );
-
-    if ( !argc ) {
-      out << usage;
-    } else if ( argc == ARG_MAX ) {
-      out << error << "more than " << ARG_MAX << " arguments" << endl;
-    } else {
-      search_options const opt( &argc, &argv, opt_spec, out );
-      if ( opt )
-        ok = service_request( argv, opt, out, out );
+  unique_ptr<search_request> const request(
+    static_cast<search_request*>( arg.p )
+  );
+  int const fd = request->fd;
+
+  for ( bool resumed = false; ; resumed = true ) {
+    string line;
+    bool got_line = true;
+    if ( request->has_line )
+      line = request->line;
+    else
+      got_line = timed_read_line(
+        fd, request->pending, line, resumed, socket_timeout
+      );
+
+    if ( !got_line && resumed && request->pending.empty() ) {
+      //
+      // The client is simply done sending requests.
+      //
+      ::close( fd );
+      return;
     }
-    out << flush;
-  }
 
-  if ( !ok ) {
-    //
-    // It was a bad request because it (a) timed out, (b) had too few or many
-    // arguments, (c) had an error in usage, or (d) was malformed.  That being
-    // the case, reset the TCP connection.
-    //
-    // The reason for doing this is so we don't potentially have a socket
-    // lingering in TIME-WAIT from a client that was too dumb to give us a
-    // valid request in the first place.  This helps alleviate denial-of-
-    // service attacks (if that's what's going on).
-    //
-    reset_socket( arg.i );
-  }
+    bool ok = false;
+    request->keep_alive = false;
+    string results;                     // if collected in memory
+    bool collected = false;
+
+    if ( got_line && is_binary_request( line ) ) {
+      ok = service_binary_request( line, results, &request->keep_alive );
+      request->keep_alive = request->keep_alive && ok;
+      collected = true;
+    } else if ( got_line && daemon_http && is_http_request( line ) ) {
+      service_http_request( line, results, &request->keep_alive );
+      //
+      // Even an HTTP request that failed gets a response that the client
+      // must be able to read, so the connection is never reset.
+      //
+      ok = true;
+      collected = true;
+    } else if ( got_line ) {
+      char buf[ Request_Line_Max ];
+      ::strncpy( buf, line.c_str(), sizeof buf - 1 );
+      buf[ sizeof buf - 1 ] = '\0';
+
+#     ifdef DEBUG_threads
+      cerr << "query=" << buf << "\n";
+#     endif
+
+      char*   argv_vec[ ARG_MAX ];
+      char**  argv = argv_vec;
+      int     argc = split_args( buf, argv, ARG_MAX );
+      //
+      // Parse the options before writing anything since whether the
+      // connection is to be kept alive determines how the results are
+      // written.
+      //
+      ostringstream opt_err;
+      unique_ptr<search_options> const opt( argc && argc < ARG_MAX ?
+        new search_options( &argc, &argv, opt_spec, opt_err ) : nullptr
+      );
+      request->keep_alive = opt && *opt && opt->keep_alive_opt;
+      //
+      // If the results are to be given back or preceded by their length,
+      // collect them in memory rather than writing them to the socket.
+      //
+      bool const collect = request->reply || request->keep_alive;
+      unique_ptr<streambuf> const out_buf( collect ?
+        static_cast<streambuf*>( new stringbuf ) : new fdbuf( fd )
+      );
+      ostream out( out_buf.get() );
+
+      if ( !argc ) {
+        out << usage;
+      } else if ( argc == ARG_MAX ) {
+        out << error << "more than " << ARG_MAX << " arguments" << endl;
+      } else {
+        out << opt_err.str();
+        if ( *opt )
+          ok = service_request( argv, *opt, out, out );
+      }
+      out << flush;
+      request->keep_alive = request->keep_alive && ok;
+
+      if ( collect ) {
+        results = static_cast<stringbuf*>( out_buf.get() )->str();
+        if ( request->keep_alive )
+          results.insert( 0, to_string( results.size() ) + '\n' );
+        collected = true;
+      }
+    }
+
+    if ( collected ) {
+      if ( request->reply ) {
+        request->reply( *request, std::move( results ), ok );
+        return;
+      }
+      fdbuf fd_buf( fd );
+      ostream( &fd_buf ) << results << flush;
+    }
+
+    if ( !ok ) {
+      //
+      // It was a bad request because it (a) timed out, (b) had too few or
+      // many arguments, (c) had an error in usage, or (d) was malformed.  That
+      // being the case, reset the TCP connection.
+      //
+      // The reason for doing this is so we don't potentially have a socket
+      // lingering in TIME-WAIT from a client that was too dumb to give us a
+      // valid request in the first place.  This helps alleviate denial-of-
+      // service attacks (if that's what's going on).
+      //
+      reset_socket( fd );
+    }
+
+    if ( !request->keep_alive ) {
+      ::close( fd );
+      return;
+    }
+    if ( request->resume ) {
+      //
+      // If the client pipelined its next request behind this one, service it
+      // now: giving the connection back would only have the event loop give
+      // it right back to a thread -- and, with a small thread pool, there
+      // may not be one that isn't busy since this one still is.
+      //
+      if ( !get_request_line( request->pending, request->line, true ) ) {
+        request->resume( *request );
+        return;
+      }
+      request->has_line = true;
+      continue;
+    }
+    request->has_line = false;
+  } // for
+}
 
-  ::close( arg.i );
+/**
+ * Gets a request line from the start of what's been received from a client.
+ * The line ends at the first carriage return or newline; a line too long is
+ * truncated.  A binary request is gotten whole (except that the header alone
+ * is gotten if the query is too long so the request is rejected without
+ * waiting for it).  If DaemonHTTP is set, an HTTP request is gotten through
+ * the blank line after its headers (and is truncated if too long).
+ *
+ * @param buf What's been received.  The line and its terminator are removed
+ * from it.
+ * @param line Set to the line (without its terminator).
+ * @param resumed If \c true, the connection was kept alive after a previous
+ * request, so line terminators at the start of \a buf are skipped.
+ * @return Returns \c true only if a complete line was gotten.
+ */
+bool get_request_line( string &buf, string &line, bool resumed ) {
+  if ( resumed )
+    buf.erase( 0, buf.find_first_not_of( "\r\n" ) );
+  if ( is_binary_request( buf ) ) {
+    if ( buf.size() < Binary_Request_Header_Size )
+      return false;
+    size_t size = binary_get16( buf.data() + 14 );
+    size = size < static_cast<size_t>( Request_Line_Max ) ?
+      Binary_Request_Header_Size + size : Binary_Request_Header_Size;
+    if ( buf.size() < size )
+      return false;
+    line.assign( buf, 0, size );
+    buf.erase( 0, size );
+    return true;
+  }
+  //
+  // An HTTP request line (that has a URL) may be longer than a text one.
+  //
+  size_t const line_max =
+    daemon_http ? Http_Request_Max : Request_Line_Max - 1;
+  auto const end = buf.find_first_of( "\r\n" );
+  if ( end != string::npos ) {
+    if ( daemon_http && is_http_request_line( buf.data(), end ) ) {
+      size_t const size = http_headers_end( buf, end );
+      if ( size == string::npos ) {
+        if ( buf.size() < Http_Request_Max )
+          return false;
+        line.assign( buf, 0, Http_Request_Max );
+        buf.clear();
+        return true;
+      }
+      line.assign( buf, 0, size );
+      buf.erase( 0, size );
+      return true;
+    }
+    line.assign( buf, 0, end );
+    buf.erase( 0, end + 1 );
+    return true;
+  }
+  if ( buf.size() >= line_max ) {
+    line.assign( buf, 0, line_max );
+    buf.clear();
+    return true;
+  }
+  return false;
 }
 
 /**
@@ -176,21 +343,23 @@ static int split_args( char *s, char *argv[], int arg_max ) {
 
 /**
  * Reads a line of text (a string of characters ending in either a carriage
- * return or a newline) from a Unix file descriptor and store it in the given
- * buffer, null-terminated; but time-out if we don't get it in a certain amount
- * of time.  The carriage return or newline is discarded.
+ * return or a newline) from a Unix file descriptor; but time-out if we don't
+ * get it in a certain amount of time.  Anything received after the line is
+ * kept for the next call.
  *
  * See also:
  *    W. Richard Stevens.  "Unix Network Programming, Vol 1, 2nd ed."
  *    Prentice-Hall, Upper Saddle River, NJ, 1998.  pp. 352-353.
  *
  * @param fd The Unix file descriptor to read from.
- * @param buf The buffer to read into.
- * @param buf_size The size of \a buf.
+ * @param buf What's been received but not yet used.
+ * @param line Set to the line (without its terminator).
+ * @param resumed Passed to get_request_line().
  * @param seconds The number of seconds until a time-out.
  * @return Returns \c true only if an entire line was read in the time allotted.
  */
-static bool timed_read_line( int fd, char *buf, int buf_size, int seconds ) {
+static bool timed_read_line( int fd, string &buf, string &line, bool resumed,
+                             int seconds ) {
   //
   // In a single-threaded application, we could simply use alarm(2) to set a
   // time-out before reading; however, in a multi-threaded application, we
@@ -202,7 +371,10 @@ static bool timed_read_line( int fd, char *buf, int buf_size, int seconds ) {
   //
   time_t const start_time = ::time( nullptr );
   int seconds_remaining = seconds;
-  while ( seconds_remaining > 0 ) {
+  while ( !get_request_line( buf, line, resumed ) ) {
+    if ( seconds_remaining <= 0 )
+      return false;
+
     fd_set rset;
     FD_ZERO( &rset );
     FD_SET( fd, &rset );
@@ -212,18 +384,15 @@ static bool timed_read_line( int fd, char *buf, int buf_size, int seconds ) {
     tv.tv_usec = 0;
 
     if ( ::select( fd + 1, &rset, nullptr, nullptr, &tv ) < 1 )
-      break;
+      return false;
     if ( !FD_ISSET( fd, &rset ) )       // shouldn't happen, but...
-      break;
-
-    ssize_t const bytes_read = ::recv( fd, buf, buf_size, 0 );
-    if ( bytes_read == -1 )             // error
-      break;
-    buf += bytes_read, buf_size -= bytes_read;
-    if ( buf[-1] == '\r' || buf[-1] == '\n' || buf_size <= 0 ) {
-      buf[-1] = '\0';
-      return true;                    // got a line: woohoo!
-    }
+      return false;
+
+    char chunk[ Request_Line_Max ];
+    ssize_t const bytes_read = ::recv( fd, chunk, sizeof chunk, 0 );
+    if ( bytes_read <= 0 )              // error or client disconnected
+      return false;
+    buf.append( chunk, bytes_read );
     //
     // We haven't gotten a complete line yet: see how much time has elapsed
     // and, if there's more time left before the time-out expires, try to read
@@ -233,7 +402,7 @@ static bool timed_read_line( int fd, char *buf, int buf_size, int seconds ) {
     seconds_remaining = seconds - elapsed_time;
   } // while
 
-  return false;
+  return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -25,8 +25,99 @@
 // local
 #include "pjl/thread_pool.h"
 
+// standard
+#include <functional>
+#include <string>
+
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * A %search_request is a request from a client to be serviced by a
+ * search_thread.  It's passed to the thread as the \c p member of its argument
+ * and is deleted by the thread.
+ *
+ * If the request asks to keep the connection alive, the results are preceded
+ * by a line containing their length in bytes and, afterwards, the next request
+ * is read from the same connection (so a client may send several requests
+ * without waiting for the results of each).
+ */
+struct search_request {
+  /**
+   * The type of function that's given the results of a request (rather than
+   * the thread writing them to the socket and closing it).
+   *
+   * @param request The request.
+   * @param results The results.
+   * @param ok If \c false, the request was bad.
+   */
+  typedef std::function<void(search_request &request, std::string &&results,
+                             bool ok)>
+          reply_function;
+
+  /**
+   * The type of function that's given a connection back after the thread has
+   * written the results of a request that kept it alive (rather than the
+   * thread reading the next request itself).
+   *
+   * @param request The request.
+   */
+  typedef std::function<void(search_request &request)> resume_function;
+
+  int             fd;                   // the client's socket
+  bool            has_line;             // was the request line already read?
+  std::string     line;                 // the request line, if so
+  std::string     pending;              // what was received after it
+  bool            keep_alive;           // keep the connection open after?
+  reply_function  reply;                // given the results, if set
+  resume_function resume;               // given the connection back, if set
+
+  /**
+   * Constructs a %search_request whose request line has yet to be read from
+   * the socket (by the thread).
+   *
+   * @param sock_fd The client's socket.
+   */
+  explicit search_request( int sock_fd ) :
+    fd( sock_fd ), has_line( false ), keep_alive( false )
+  {
+  }
+
+  /**
+   * Constructs a %search_request whose request line has already been read.
+   *
+   * @param sock_fd The client's socket.
+   * @param req_line The request line (without its terminating newline).
+   * @param rest What was received after the request line, if anything.
+   */
+  search_request( int sock_fd, std::string const &req_line,
+                  std::string const &rest = std::string() ) :
+    fd( sock_fd ), has_line( true ), line( req_line ), pending( rest ),
+    keep_alive( false )
+  {
+  }
+};
+
+/**
+ * Gets a request line from the start of what's been received from a client.
+ * The line ends at the first carriage return or newline; a line too long is
+ * truncated.  A binary request (see binary_protocol.h) is gotten whole as is
+ * an HTTP request's line and headers (see http_protocol.h).
+ *
+ * @param buf What's been received.  The line and its terminator are removed
+ * from it.
+ * @param line Set to the line (without its terminator).
+ * @param resumed If \c true, the connection was kept alive after a previous
+ * request, so line terminators at the start of \a buf are skipped (as what's
+ * left of a carriage return and newline pair).
+ * @return Returns \c true only if a complete line was gotten.
+ */
+bool get_request_line( std::string &buf, std::string &line, bool resumed );
+
+/**
+ * The maximum size of a request line (including its terminating newline).
+ */
+int const Request_Line_Max = 1024;
+
 /**
  * A %search_thread is-a thread_pool::thread that performs a search based
  * on a query and returns the results.
@@ -0,0 +1,498 @@
+/*
+**      SWISH++
+**      src/search_uring.cpp
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+// local
+#include "config.h"
+#include "exit_codes.h"
+#include "search_thread.h"
+#include "search_uring.h"
+#include "util.h"
+
+#ifdef WITH_SEARCH_URING
+
+// standard
+#include <algorithm>                    /* for min() */
+#include <cerrno>
+#include <cstdlib>                      /* for exit(3) */
+#include <poll.h>                       /* for POLLIN */
+#include <sys/eventfd.h>
+#include <sys/socket.h>                 /* for MSG_* */
+#include <time.h>                       /* for clock_gettime(2) */
+#include <unistd.h>                     /* for close(2), write(2) */
+
+using namespace PJL;
+using namespace std;
+
+extern void reset_socket( int fd );
+
+/**
+ * The number of entries in the submission queue.  More are submitted if
+ * needed.
+ */
+static unsigned const Ring_Entries = 256;
+
+/**
+ * The number of buffers provided for receiving request lines.  A buffer is
+ * used only while a completion is being handled, not while a connection is
+ * idle, so this bounds the completions per loop iteration, not the number of
+ * connections.
+ */
+static unsigned const Recv_Buffers = 256;
+
+////////// local functions ////////////////////////////////////////////////////
+
+/**
+ * Gets the number of seconds on the monotonic clock.
+ *
+ * @return Returns said number.
+ */
+static long monotonic_seconds() {
+  struct timespec ts;
+  ::clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ts.tv_sec;
+}
+
+/**
+ * Gets a submission queue entry or exits if none can be had.
+ *
+ * @param ring The io_ring to get the entry from.
+ * @return Returns said entry.
+ */
+static io_ring::sqe_type* get_sqe( io_ring &ring ) {
+  io_ring::sqe_type *const sqe = ring.get_sqe();
+  if ( !sqe ) {
+    error() << "io_uring_enter() failed" << error_string;
+    ::exit( Exit_No_IO_Uring );
+  }
+  return sqe;
+}
+
+////////// member functions ///////////////////////////////////////////////////
+
+search_uring::search_uring( thread_pool &threads, unsigned timeout ) :
+  ring_( Ring_Entries ),
+  error_( ring_.error() ),
+  threads_( threads ),
+  timeout_( timeout ),
+  last_tick_( monotonic_seconds() ),
+  wake_fd_( -1 ),
+  wake_count_( 0 ),
+  wake_pending_( false )
+{
+  if ( error_ )
+    return;
+  if ( (error_ = ring_.provide_buffers( Recv_Buffers, Request_Line_Max )) )
+    return;
+  //
+  // The eventfd must be blocking so the read of it waits in the kernel.
+  //
+  wake_fd_ = ::eventfd( 0, EFD_CLOEXEC );
+  if ( wake_fd_ == -1 ) {
+    error_ = errno;
+    return;
+  }
+  wait_for_wake();
+}
+
+search_uring::~search_uring() {
+  for ( auto const &c : connections_ )
+    ::close( c.first );
+  for ( response *const r : responses_ )
+    delete r;
+  if ( wake_fd_ != -1 )
+    ::close( wake_fd_ );
+}
+
+/**
+ * Submits a multishot accept for a listening socket: it completes once for
+ * every connection accepted until it fails.
+ *
+ * @param listen_fd The listening socket's file descriptor.
+ */
+void search_uring::accept( int listen_fd ) {
+  io_ring::sqe_type *const sqe = get_sqe( ring_ );
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = listen_fd;
+  sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+  sqe->user_data = static_cast<uint64_t>( listen_fd ) << Op_Bits | op_accept;
+}
+
+/**
+ * Closes a client connection whose (next) request line was never completely
+ * read.  There must be no receive pending for it.
+ *
+ * @param fd The connection's file descriptor.
+ * @param reset If \c true, reset the connection rather than closing it
+ * normally.
+ */
+void search_uring::close( int fd, bool reset ) {
+  auto const c = connections_.find( fd );
+  if ( c != connections_.end() ) {
+    if ( c->second.timer )
+      timers_.cancel( c->second.timer );
+    connections_.erase( c );
+  }
+  if ( reset )
+    reset_socket( fd );
+  ::close( fd );
+}
+
+/**
+ * Handles a completion.
+ *
+ * @param cqe The completion queue entry.
+ */
+void search_uring::complete( io_ring::cqe_type const &cqe ) {
+  uint64_t const data = cqe.user_data;
+  int const fd = static_cast<int>( data >> Op_Bits );
+
+  switch ( static_cast<op_type>( data & ((1u << Op_Bits) - 1) ) ) {
+
+    case op_accept:
+      if ( cqe.res >= 0 ) {
+#       ifdef DEBUG_threads
+        cerr << "accepted connection " << cqe.res << '\n';
+#       endif
+        connection &c = connections_[ cqe.res ];
+        c.timer = timers_.schedule( cqe.res, timeout_ + 1 );
+        recv( cqe.res );
+      } else {
+        switch ( -cqe.res ) {
+          case ECONNABORTED:            // POSIX.1g
+          case EINTR:
+          case EPROTO:
+            break;
+          case EMFILE:
+          case ENFILE:
+          case ENOBUFS:
+          case ENOMEM:
+            //
+            // Out of resources: stop accepting until the next tick when,
+            // hopefully, some connections will have been closed.
+            //
+            ::error() << "accept() failed" << error_string( -cqe.res );
+            if ( !(cqe.flags & IORING_CQE_F_MORE) )
+              paused_.push_back( fd );
+            return;
+          default:
+            ::error() << "accept() failed" << error_string( -cqe.res );
+            ::exit( Exit_No_Accept );
+        }
+      }
+      if ( !(cqe.flags & IORING_CQE_F_MORE) )
+        accept( fd );                   // the kernel stopped it: resubmit
+      break;
+
+    case op_cancel:                     // only failures complete
+    case op_send:
+      break;
+
+    case op_close: {
+      //
+      // If the send failed (or was short because the client went away), the
+      // linked close was cancelled, so close it here.
+      //
+      response *const r = reinterpret_cast<response*>(
+        data & ~static_cast<uint64_t>( (1u << Op_Bits) - 1 )
+      );
+      if ( cqe.res == -ECANCELED )
+        ::close( r->fd );
+      delete r;
+      break;
+    }
+
+    case op_recv:
+      received( fd, cqe.res, cqe.flags );
+      break;
+
+    case op_resume: {
+      //
+      // The results of a request that kept the connection alive were sent (or
+      // not, if the client went away): receive the next request.
+      //
+      response *const r = reinterpret_cast<response*>(
+        data & ~static_cast<uint64_t>( (1u << Op_Bits) - 1 )
+      );
+      if ( cqe.res == static_cast<int>( r->results.size() ) ) {
+        connection &c = connections_[ r->fd ];
+        c.buf = std::move( r->pending );
+        c.resumed = true;
+        c.timer = timers_.schedule( r->fd, timeout_ + 1 );
+        next_request( r->fd );
+      } else {
+        close( r->fd, true );
+      }
+      delete r;
+      break;
+    }
+
+    case op_wake:
+      send_responses();
+      wait_for_wake();
+      break;
+
+    case op_watch: {
+      auto const w = watched_.find( fd );
+      if ( w != watched_.end() ) {
+        (*w->second)( fd );
+        wait_for_watched( fd );
+      }
+      break;
+    }
+  } // switch
+}
+
+/**
+ * Gives a complete request to a search_thread.  The results will be given
+ * back via reply().
+ *
+ * @param fd The connection's file descriptor.
+ * @param line The request line.
+ */
+void search_uring::dispatch( int fd, string const &line ) {
+  auto const c = connections_.find( fd );
+  timers_.cancel( c->second.timer );
+  search_request *const request =
+    new search_request( fd, line, c->second.buf );
+  request->reply = [this]( search_request &r, string &&results, bool ok ) {
+    reply( r, std::move( results ), ok );
+  };
+  connections_.erase( c );
+
+# ifdef DEBUG_threads
+  cerr << "queueing request\n";
+# endif
+  if ( !threads_.new_task( request ) ) {
+    delete request;
+    reset_socket( fd );
+    ::close( fd );
+  }
+}
+
+void search_uring::listen( int fd, bool ) {
+  accept( fd );
+}
+
+/**
+ * Gives the next request line received on a client connection to a thread if
+ * it's complete; otherwise receives more.
+ *
+ * @param fd The connection's file descriptor.
+ */
+void search_uring::next_request( int fd ) {
+  connection &c = connections_[ fd ];
+  string line;
+  if ( get_request_line( c.buf, line, c.resumed ) )
+    dispatch( fd, line );
+  else
+    recv( fd );                         // wait for more (or a free buffer)
+}
+
+void search_uring::poll( int max_wait ) {
+  //
+  // If there are connections that can time out (or listening sockets to
+  // resume), wake up at least every second to advance the timer wheel.
+  //
+  int timeout_ms = max_wait < 0 ? -1 : max_wait * 1000;
+  if ( !timers_.empty() || !paused_.empty() )
+    timeout_ms = timeout_ms < 0 ? 1000 : min( timeout_ms, 1000 );
+
+  if ( ring_.wait( timeout_ms ) == -1 ) {
+    ::error() << "io_uring_enter() failed" << error_string;
+    ::exit( Exit_No_IO_Uring );
+  }
+  ring_.for_each_cqe(
+    [this]( io_ring::cqe_type const &cqe ) {
+      complete( cqe );
+    }
+  );
+
+  long const now = monotonic_seconds();
+  if ( last_tick_ < now ) {
+    for ( int const fd : paused_ )
+      accept( fd );
+    paused_.clear();
+    last_tick_ = now;
+  }
+  timers_.advance_to(
+    now,
+    [this]( int fd ) {
+#     ifdef DEBUG_threads
+      cerr << "connection " << fd << " timed out\n";
+#     endif
+      //
+      // The receive is pending, so cancel it: its completion then closes
+      // the connection.
+      //
+      connection &c = connections_[ fd ];
+      c.timer = timer_wheel::handle();
+      c.timed_out = true;
+      io_ring::sqe_type *const sqe = get_sqe( ring_ );
+      sqe->opcode = IORING_OP_ASYNC_CANCEL;
+      sqe->addr = static_cast<uint64_t>( fd ) << Op_Bits | op_recv;
+      sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+      sqe->user_data = static_cast<uint64_t>( fd ) << Op_Bits | op_cancel;
+    }
+  );
+}
+
+/**
+ * Submits a receive for a client connection into a provided buffer.
+ *
+ * @param fd The connection's file descriptor.
+ */
+void search_uring::recv( int fd ) {
+  io_ring::sqe_type *const sqe = get_sqe( ring_ );
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = 0;
+  sqe->user_data = static_cast<uint64_t>( fd ) << Op_Bits | op_recv;
+}
+
+/**
+ * Handles a completed receive.  If the request line is complete, gives it to
+ * a thread; if the client disconnected, there was an error, or the connection
+ * timed out before then, closes the connection; otherwise receives more.
+ *
+ * @param fd The connection's file descriptor.
+ * @param result The result of the receive: the number of bytes received or a
+ * negative error code.
+ * @param flags The completion's flags.
+ */
+void search_uring::received( int fd, int result, unsigned flags ) {
+  connection &c = connections_[ fd ];
+  if ( flags & IORING_CQE_F_BUFFER ) {
+    unsigned const id = flags >> IORING_CQE_BUFFER_SHIFT;
+    if ( result > 0 )
+      c.buf.append( ring_.buffer( id ), result );
+    ring_.recycle( id );
+  }
+  if ( c.timed_out || (result <= 0 && result != -ENOBUFS) ) {
+    //
+    // If the client disconnected, that's premature unless it's simply done
+    // sending requests on a connection kept alive.
+    //
+    close( fd, c.timed_out || result || !c.resumed || !c.buf.empty() );
+    return;
+  }
+  next_request( fd );
+}
+
+void search_uring::reply( search_request &request, string &&results,
+                          bool ok ) {
+  response *const r = new response;
+  r->fd = request.fd;
+  r->results = std::move( results );
+  r->ok = ok;
+  r->keep_alive = request.keep_alive;
+  if ( r->keep_alive )
+    r->pending = std::move( request.pending );
+  {
+    lock_guard<mutex> const lock( responses_lock_ );
+    responses_.push_back( r );
+  }
+  //
+  // Wake up the main thread only if it's not already been woken for earlier
+  // responses.
+  //
+  if ( !wake_pending_.exchange( true ) ) {
+    uint64_t const one = 1;
+    (void)::write( wake_fd_, &one, sizeof one );
+  }
+}
+
+/**
+ * Submits sends of all the responses given by reply(), each linked to a close
+ * of the connection (unless it's being kept alive).  A send is done with
+ * \c MSG_WAITALL so that a short send is continued by the kernel rather than
+ * breaking the link.
+ */
+void search_uring::send_responses() {
+  wake_pending_ = false;
+  vector<response*> responses;
+  {
+    lock_guard<mutex> const lock( responses_lock_ );
+    responses.swap( responses_ );
+  }
+  for ( response *const r : responses ) {
+    if ( r->keep_alive ) {
+      io_ring::sqe_type *const sqe = get_sqe( ring_ );
+      sqe->opcode = IORING_OP_SEND;
+      sqe->fd = r->fd;
+      sqe->addr = reinterpret_cast<uint64_t>( r->results.data() );
+      sqe->len = static_cast<unsigned>( r->results.size() );
+      sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL;
+      sqe->user_data = reinterpret_cast<uint64_t>( r ) | op_resume;
+      continue;
+    }
+    if ( !r->ok )
+      reset_socket( r->fd );
+    if ( !r->results.empty() ) {
+      io_ring::sqe_type *const sqe = get_sqe( ring_ );
+      sqe->opcode = IORING_OP_SEND;
+      sqe->fd = r->fd;
+      sqe->addr = reinterpret_cast<uint64_t>( r->results.data() );
+      sqe->len = static_cast<unsigned>( r->results.size() );
+      sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL;
+      sqe->flags = IOSQE_IO_LINK | IOSQE_CQE_SKIP_SUCCESS;
+      sqe->user_data = static_cast<uint64_t>( r->fd ) << Op_Bits | op_send;
+    }
+    io_ring::sqe_type *const sqe = get_sqe( ring_ );
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = r->fd;
+    sqe->user_data = reinterpret_cast<uint64_t>( r ) | op_close;
+  } // for
+}
+
+/**
+ * Submits a read of the eventfd signalled by reply().
+ */
+void search_uring::wait_for_wake() {
+  io_ring::sqe_type *const sqe = get_sqe( ring_ );
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = wake_fd_;
+  sqe->addr = reinterpret_cast<uint64_t>( &wake_count_ );
+  sqe->len = sizeof wake_count_;
+  sqe->user_data = static_cast<uint64_t>( wake_fd_ ) << Op_Bits | op_wake;
+}
+
+/**
+ * Submits a poll of a watched file descriptor for it being readable.
+ *
+ * @param fd The file descriptor.
+ */
+void search_uring::wait_for_watched( int fd ) {
+  io_ring::sqe_type *const sqe = get_sqe( ring_ );
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = POLLIN;
+  sqe->user_data = static_cast<uint64_t>( fd ) << Op_Bits | op_watch;
+}
+
+void search_uring::watch( int fd, watch_function f ) {
+  watched_[ fd ] = f;
+  wait_for_watched( fd );
+}
+
+#endif /* WITH_SEARCH_URING */
+///////////////////////////////////////////////////////////////////////////////
+/* vim:set et sw=2 ts=2: */
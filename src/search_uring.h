@@ -0,0 +1,220 @@
+/*
+**      SWISH++
+**      src/search_uring.h
+**
+**      Copyright (C) 2026  Paul J. Lucas
+**
+**      This program is free software; you can redistribute it and/or modify
+**      it under the terms of the GNU General Public License as published by
+**      the Free Software Foundation; either version 2 of the License, or
+**      (at your option) any later version.
+**
+**      This program is distributed in the hope that it will be useful,
+**      but WITHOUT ANY WARRANTY; without even the implied warranty of
+**      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**      GNU General Public License for more details.
+**
+**      You should have received a copy of the GNU General Public License
+**      along with this program; if not, write to the Free Software
+**      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef search_uring_H
+#define search_uring_H
+
+// local
+#include "config.h"
+#include "pjl/io_ring.h"
+#include "pjl/thread_pool.h"
+#include "pjl/timer_wheel.h"
+
+#if defined( HAVE_EPOLL_CREATE1 ) && defined( HAVE_IO_RING )
+#define WITH_SEARCH_URING 1
+
+// standard
+#include <atomic>
+#include <cstdint>                      /* for uint64_t */
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct search_request;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A %search_uring is an event loop (via Linux's io_uring(7)) that does the
+ * same as a search_reactor, but with far fewer system calls:
+ *
+ *  + Connections are accepted by one "multishot" accept per listening socket.
+ *  + Request lines are received into buffers provided to the kernel up front.
+ *  + Results are given back by the search_thread and sent by a send linked to
+ *    a close, i.e., without the thread doing any socket I/O.  (If the request
+ *    kept the connection alive, the send isn't linked to a close; instead,
+ *    the next request is received once it completes.)
+ *
+ * All of these are submitted and completed in batches by a single
+ * io_uring_enter(2) per loop iteration.
+ *
+ * A %search_uring is used only by the main thread (except for reply()).
+ */
+class search_uring {
+public:
+  /**
+   * A function that's called when a watched file descriptor is readable.
+   *
+   * @param fd The file descriptor.
+   */
+  typedef void (*watch_function)( int fd );
+
+  /**
+   * Constructs a %search_uring.  If io_uring can't be used, the %search_uring
+   * is invalid.
+   *
+   * @param threads The thread pool to give complete requests to.
+   * @param timeout The number of seconds a client has to send a complete
+   * request line.
+   */
+  search_uring( PJL::thread_pool &threads, unsigned timeout );
+
+  ~search_uring();
+
+  /**
+   * Gets the error that prevented io_uring from being used, if any.
+   *
+   * @return Returns said error or 0 if none.
+   */
+  int error() const {
+    return error_;
+  }
+
+  /**
+   * Adds a listening socket to accept client connections from.
+   *
+   * @param fd The socket's file descriptor.
+   * @param shared If \c true, the socket is also being listened on by other
+   * %search_uring objects (in other threads).  (It makes no difference since
+   * each connection completes only one ring's accept request anyway.)
+   */
+  void listen( int fd, bool shared = false );
+
+  /**
+   * Waits for and handles events once.
+   *
+   * @param max_wait The maximum number of seconds to wait or -1 to wait
+   * until there's an event.
+   */
+  void poll( int max_wait );
+
+  /**
+   * Gives the results of a request back to be sent to the client after which
+   * the connection is closed (unless the request kept it alive).  This is
+   * called by a search_thread.
+   *
+   * @param request The request.
+   * @param results The results.
+   * @param ok If \c false, reset the connection rather than closing it
+   * normally.
+   */
+  void reply( search_request &request, std::string &&results, bool ok );
+
+  /**
+   * Adds a file descriptor to call a function for whenever it's readable.
+   *
+   * @param fd The file descriptor.
+   * @param f The function to call.
+   */
+  void watch( int fd, watch_function f );
+
+  /**
+   * Checks whether the %search_uring is valid.
+   *
+   * @return Returns \c true only if so.
+   */
+  explicit operator bool() const {
+    return !error_;
+  }
+
+private:
+  typedef PJL::timer_wheel<int> timer_wheel;
+
+  /**
+   * The kind of operation a completion is for.  It's kept in the low bits of
+   * the user data; the rest is a file descriptor or a pointer to a %response.
+   */
+  enum op_type {
+    op_accept,
+    op_cancel,
+    op_close,                           // rest is a response*
+    op_recv,
+    op_resume,                          // rest is a response*
+    op_send,
+    op_wake,
+    op_watch
+  };
+  static unsigned const Op_Bits = 3;
+
+  /**
+   * A %connection is a client connection whose request line has yet to be
+   * completely read.
+   */
+  struct connection {
+    std::string         buf;            // what's been read so far
+    timer_wheel::handle timer;          // when it times out
+    bool                timed_out;      // cancelled, but recv still pending
+    bool                resumed;        // kept alive after a request?
+
+    connection() : timed_out( false ), resumed( false ) { }
+  };
+  typedef std::unordered_map<int,connection> connection_map;
+
+  /**
+   * A %response is the results of a request being sent to the client.
+   */
+  struct response {
+    int         fd;
+    std::string results;
+    bool        ok;
+    bool        keep_alive;
+    std::string pending;                // what was received after the request
+  };
+
+  typedef std::unordered_map<int,watch_function> watch_map;
+
+  void accept( int listen_fd );
+  void close( int fd, bool reset );
+  void complete( PJL::io_ring::cqe_type const& );
+  void dispatch( int fd, std::string const &line );
+  void next_request( int fd );
+  void recv( int fd );
+  void received( int fd, int result, unsigned flags );
+  void send_responses();
+  void wait_for_wake();
+  void wait_for_watched( int fd );
+
+  PJL::io_ring              ring_;
+  int                       error_;
+  PJL::thread_pool         &threads_;
+  unsigned const            timeout_;
+  connection_map            connections_;
+  std::vector<int>          paused_;    // listeners not accepting for now
+  watch_map                 watched_;
+  timer_wheel               timers_;
+  long                      last_tick_; // seconds on the monotonic clock
+
+  int                       wake_fd_;   // eventfd signalled by reply()
+  uint64_t                  wake_count_;
+  std::atomic<bool>         wake_pending_;
+  std::mutex                responses_lock_;
+  std::vector<response*>    responses_; // given by reply(), not yet sent
+
+  search_uring( search_uring const& ) = delete;
+  search_uring& operator=( search_uring const& ) = delete;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif /* HAVE_EPOLL_CREATE1 && HAVE_IO_RING */
+#endif /* search_uring_H */
+/* vim:set et sw=2 ts=2: */
@@ -26,36 +26,80 @@
 
 // local
 #include "config.h"
+#include "pjl/hash.h"
 #include "stem_word.h"
 #include "word_util.h"
-#include "util.h"                       /* for new_strdup() */
 
 // standard
-#include <cctype>
+#include <climits>                     /* for CHAR_BIT */
+#include <cstdint>
 #include <cstring>
-#include <map>
 #ifdef WITH_SEARCH_DAEMON
 #include <mutex>
 #endif /* WITH_SEARCH_DAEMON */
+#include <vector>
 
 using namespace std;
 
 ///////////////////////////////////////////////////////////////////////////////
 
-struct rule_list {
+/**
+ * A %suffix_rule is a rule for replacing the suffix of a word.
+ */
+struct suffix_rule {
   short           id;
   char const     *old_suffix, *new_suffix;
   unsigned short  old_suffix_len, new_suffix_len;
   short           min_stem_size;
-  bool          (*condition)(char const*);
+  //
+  // The condition, if any, is called with the word having had its old suffix
+  // chopped off but with the end of the word prior to the chopping.
+  //
+  bool          (*condition)( char const *word, char const *word_end );
 };
 
-static char *word_end; // iterator at end of word being stemmed
-// Access to this global variable is protected by the cache_lock mutex in
-// stem_word().
+/**
+ * A %rule_set is a set of suffix replacement rules at most one of which is
+ * applied to a word.  The old suffixes of the rules are stored reversed in a
+ * trie so all the rules whose old suffix matches a word can be found by
+ * walking the trie backwards from the end of the word only once.
+ */
+class rule_set {
+public:
+  /**
+   * Constructs a %rule_set.
+   *
+   * @tparam N The number of rules.
+   * @param rules The rules in the order in which they are to be tried.
+   */
+  template<size_t N>
+  rule_set( suffix_rule const (&rules)[N] );
+
+  /**
+   * Replaces the suffix of a word using the first rule, if any, whose old
+   * suffix matches and whose conditions are met.
+   *
+   * @param word The word to be stemmed.
+   * @param word_end The iterator at the end of \a word.  It is updated if a
+   * rule is applied.
+   * @return Returns the ID for the rule applied, zero otherwise.
+   */
+  int apply( char *word, char *&word_end ) const;
+
+private:
+  typedef uint32_t rule_mask;           // bit i set = rules_[i]
+
+  struct node {
+    unsigned short  child[ 26 ];        // node index for 'a'..'z'; 0 = none
+    rule_mask       rules;              // rules whose old suffix ends here
+  };
+
+  suffix_rule const  *const rules_;
+  vector<node>        nodes_;           // nodes_[0] is the root
+};
 
 // local functions
-static bool ends_with_cvc( char const* );
+static bool ends_with_cvc( char const*, char const* );
 static int  word_size( char const* );
 
 ////////// local functions ////////////////////////////////////////////////////
@@ -64,12 +108,13 @@ static int  word_size( char const* );
  * Checks whether a word should have an 'e' added.  This is used only by rule
  * #122.
  *
- * @param word    The word to be checked.
+ * @param word The word to be checked.
+ * @param word_end The iterator at the end of \a word.
  * @return Returns \c true only if the word meets the conditions for having an
  * 'e' added.
  */
-static bool add_e( char const *word ) {
-  return word_size( word ) == 1 && ends_with_cvc( word );
+static bool add_e( char const *word, char const *word_end ) {
+  return word_size( word ) == 1 && ends_with_cvc( word, word_end );
 }
 
 /**
@@ -78,10 +123,11 @@ static bool add_e( char const *word ) {
  * only to a stem with this characteristic.
  *
  * @param word The word to be checked.
+ * @param word_end The iterator at the end of \a word.
  * @return Returns \c true only if the word ends with a consonant-vowel-
  * consonant triple as described above.
  */
-static bool ends_with_cvc( char const *word ) {
+static bool ends_with_cvc( char const *word, char const *word_end ) {
   if ( word_end - word < 3 )
     return false;
 
@@ -97,61 +143,36 @@ static bool ends_with_cvc( char const *word ) {
  * @param word The word to be checked.
  * @return Returns \c true only if the word has a vowel in it.
  */
-static bool has_vowel( char const *word ) {
+static bool has_vowel( char const *word, char const* ) {
   if ( !*word )
     return false;
   return is_vowel( *word ) || ::strpbrk( word + 1, "aeiouy" );
 }
 
 /**
- * Checks whether a word should have an 'e' removed.  This is used only by rule
- * #502.
+ * Checks whether the given word can be stemmed.
  *
  * @param word The word to check.
- * @return Returns \c true only if the word meets the conditions for having an
- * 'e' removed.
+ * @param len The length of \a word.
+ * @return Returns \c true only if the word is composed entirely of letters and
+ * will fit into a buffer of Stem_Buf_Size.
  */
-static bool remove_e( char const *word ) {
-  return word_size( word ) == 1 && !ends_with_cvc( word );
+inline bool is_stemmable( char const *word, size_t len ) {
+  return  len <= static_cast<size_t>( Word_Hard_Max_Size ) &&
+          ::strspn( word, "abcdefghijklmnopqrstuvwxyz" ) == len;
 }
 
 /**
- * Replaces the suffix of a word if a rule to do so can be found.
+ * Checks whether a word should have an 'e' removed.  This is used only by rule
+ * #502.
  *
- * @param word The word to be stemmed.
- * @param rule A pointer to the first rule in the ruleset to apply.
- * @return Returns the ID for the rule applied, zero otherwise.
+ * @param word The word to check.
+ * @param word_end The iterator at the end of \a word.
+ * @return Returns \c true only if the word meets the conditions for having an
+ * 'e' removed.
  */
-static int replace_suffix( char *word, rule_list const *rule ) {
-# ifdef DEBUG_stem_word
-  cerr << "---> replace_suffix( \"" << word << "\" )\n";
-# endif
-
-  for ( ; rule->id; ++rule ) {
-    char *const suffix = word_end - rule->old_suffix_len;
-    if ( suffix < word )
-      continue;
-
-#   ifdef DEBUG_stem_word
-    cerr << "---> suffix=" << suffix << ", old=" << rule->old_suffix << "\n";
-#   endif
-    if ( ::strcmp( suffix, rule->old_suffix ) )
-      continue;
-
-    char const ch = *suffix;            // chop off ...
-    *suffix = '\0';                     // ... the old suffix
-    if ( word_size( word ) > rule->min_stem_size &&
-       ( !rule->condition || (*rule->condition)( word ) ) ) {
-      ::strcpy( suffix, rule->new_suffix );
-#     ifdef DEBUG_stem_word
-      cerr << "---> replaced word=" << word << "\n";
-#     endif
-      word_end = suffix + rule->new_suffix_len;
-      break;
-    }
-    *suffix = ch;                       // no match: put back
-  } // for
-  return rule->id;
+static bool remove_e( char const *word, char const *word_end ) {
+  return word_size( word ) == 1 && !ends_with_cvc( word, word_end );
 }
 
 /**
@@ -204,161 +225,267 @@ static int word_size( char const *word ) {
   return size;
 }
 
-////////// member functions ///////////////////////////////////////////////////
+////////// rules //////////////////////////////////////////////////////////////
 
-char const* less_stem::no_stem( char const *word ) {
-  return word;
-}
+static suffix_rule const rules_1a[] = {
+  { 101, "sses",    "ss",    4,  2,  -1, nullptr },
+  { 102, "ies",     "i",     3,  1,  -1, nullptr },
+  { 103, "ss",      "ss",    2,  2,  -1, nullptr },
+  { 104, "s",       "",      1,  0,  -1, nullptr }
+};
+static suffix_rule const rules_1b[] = {
+  { 105, "eed",     "ee",    3,  2,  0, nullptr   },
+  { 106, "ed",      "",      2,  0, -1, has_vowel },
+  { 107, "ing",     "",      3,  0, -1, has_vowel }
+};
+static suffix_rule const rules_1b1[] = {
+  { 108, "at",      "ate",   2,  3, -1, nullptr   },
+  { 109, "bl",      "ble",   2,  3, -1, nullptr   },
+  { 110, "iz",      "ize",   2,  3, -1, nullptr   },
+  { 111, "bb",      "b",     2,  1, -1, nullptr   },
+  { 112, "dd",      "d",     2,  1, -1, nullptr   },
+  { 113, "ff",      "f",     2,  1, -1, nullptr   },
+  { 114, "gg",      "g",     2,  1, -1, nullptr   },
+  { 115, "mm",      "m",     2,  1, -1, nullptr   },
+  { 116, "nn",      "n",     2,  1, -1, nullptr   },
+  { 117, "pp",      "p",     2,  1, -1, nullptr   },
+  { 118, "rr",      "r",     2,  1, -1, nullptr   },
+  { 119, "tt",      "t",     2,  1, -1, nullptr   },
+  { 120, "ww",      "w",     2,  1, -1, nullptr   },
+  { 121, "xx",      "x",     2,  1, -1, nullptr   },
+  { 122, "",        "e",     0,  1, -1, add_e     }
+};
+static suffix_rule const rules_1c[] = {
+  { 123, "y",       "i",     1,  1, -1, has_vowel }
+};
+static suffix_rule const rules_2[] = {
+  { 201, "ational", "ate",   7,  3,  0, nullptr   },
+  { 202, "tional",  "tion",  6,  4,  0, nullptr   },
+  { 203, "enci",    "ence",  4,  4,  0, nullptr   },
+  { 204, "anci",    "ance",  4,  4,  0, nullptr   },
+  { 205, "izer",    "ize",   4,  3,  0, nullptr   },
+  { 206, "abli",    "able",  4,  4,  0, nullptr   },
+  { 207, "alli",    "al",    4,  2,  0, nullptr   },
+  { 208, "entli",   "ent",   5,  3,  0, nullptr   },
+  { 209, "eli",     "e",     3,  1,  0, nullptr   },
+  { 210, "ousli",   "ous",   5,  3,  0, nullptr   },
+  { 211, "ization", "ize",   7,  3,  0, nullptr   },
+  { 212, "ation",   "ate",   5,  3,  0, nullptr   },
+  { 213, "ator",    "ate",   4,  3,  0, nullptr   },
+  { 214, "alism",   "al",    5,  2,  0, nullptr   },
+  { 215, "iveness", "ive",   7,  3,  0, nullptr   },
+  { 216, "fulnes",  "ful",   6,  3,  0, nullptr   },
+  { 217, "ousness", "ous",   7,  3,  0, nullptr   },
+  { 218, "aliti",   "al",    5,  2,  0, nullptr   },
+  { 219, "iviti",   "ive",   5,  3,  0, nullptr   },
+  { 220, "biliti",  "ble",   6,  3,  0, nullptr   }
+};
+static suffix_rule const rules_3[] = {
+  { 301, "icate",   "ic",    5,  2,  0, nullptr   },
+  { 302, "ative",   "",      5,  0,  0, nullptr   },
+  { 303, "alize",   "al",    5,  2,  0, nullptr   },
+  { 304, "iciti",   "ic",    5,  2,  0, nullptr   },
+  { 305, "ical",    "ic",    4,  2,  0, nullptr   },
+  { 308, "ful",     "",      3,  0,  0, nullptr   },
+  { 309, "ness",    "",      4,  0,  0, nullptr   }
+};
+static suffix_rule const rules_4[] = {
+  { 401, "al",      "",      2,  0,  1, nullptr   },
+  { 402, "ance",    "",      4,  0,  1, nullptr   },
+  { 403, "ence",    "",      4,  0,  1, nullptr   },
+  { 405, "er",      "",      2,  0,  1, nullptr   },
+  { 406, "ic",      "",      2,  0,  1, nullptr   },
+  { 407, "able",    "",      4,  0,  1, nullptr   },
+  { 408, "ible",    "",      4,  0,  1, nullptr   },
+  { 409, "ant",     "",      3,  0,  1, nullptr   },
+  { 410, "ement",   "",      5,  0,  1, nullptr   },
+  { 411, "ment",    "",      4,  0,  1, nullptr   },
+  { 412, "ent",     "",      3,  0,  1, nullptr   },
+  { 413, "sion",    "s",     4,  1,  1, nullptr   },
+  { 414, "tion",    "t",     4,  1,  1, nullptr   },
+  { 415, "ou",      "",      2,  0,  1, nullptr   },
+  { 416, "ism",     "",      3,  0,  1, nullptr   },
+  { 417, "ate",     "",      3,  0,  1, nullptr   },
+  { 418, "iti",     "",      3,  0,  1, nullptr   },
+  { 419, "ous",     "",      3,  0,  1, nullptr   },
+  { 420, "ive",     "",      3,  0,  1, nullptr   },
+  { 421, "ize",     "",      3,  0,  1, nullptr   }
+};
+static suffix_rule const rules_5a[] = {
+  { 501, "e",       "",      1,  0,  1, nullptr   },
+  { 502, "e",       "",      1,  0, -1, remove_e  }
+};
+static suffix_rule const rules_5b[] = {
+  { 503, "ll",      "l",     2,  1,  1,  nullptr  }
+};
 
-char const* less_stem::stem_word( char const *word ) {
-  static rule_list const rules_1a[] = {
-    { 101, "sses",    "ss",    4,  2,  -1, nullptr },
-    { 102, "ies",     "i",     3,  1,  -1, nullptr },
-    { 103, "ss",      "ss",    2,  2,  -1, nullptr },
-    { 104, "s",       "",      1,  0,  -1, nullptr },
-    { 0,   nullptr,   nullptr, 0,  0,   0, nullptr }
-  };
-  static rule_list const rules_1b[] = {
-    { 105, "eed",     "ee",    3,  2,  0, nullptr   },
-    { 106, "ed",      "",      2,  0, -1, has_vowel },
-    { 107, "ing",     "",      3,  0, -1, has_vowel },
-    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
-  };
-  static rule_list const rules_1b1[] = {
-    { 108, "at",      "ate",   2,  3, -1, nullptr   },
-    { 109, "bl",      "ble",   2,  3, -1, nullptr   },
-    { 110, "iz",      "ize",   2,  3, -1, nullptr   },
-    { 111, "bb",      "b",     2,  1, -1, nullptr   },
-    { 112, "dd",      "d",     2,  1, -1, nullptr   },
-    { 113, "ff",      "f",     2,  1, -1, nullptr   },
-    { 114, "gg",      "g",     2,  1, -1, nullptr   },
-    { 115, "mm",      "m",     2,  1, -1, nullptr   },
-    { 116, "nn",      "n",     2,  1, -1, nullptr   },
-    { 117, "pp",      "p",     2,  1, -1, nullptr   },
-    { 118, "rr",      "r",     2,  1, -1, nullptr   },
-    { 119, "tt",      "t",     2,  1, -1, nullptr   },
-    { 120, "ww",      "w",     2,  1, -1, nullptr   },
-    { 121, "xx",      "x",     2,  1, -1, nullptr   },
-    { 122, "",        "e",     0,  1, -1, add_e     },
-    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
-  };
-  static rule_list const rules_1c[] = {
-    { 123, "y",       "i",     1,  1, -1, has_vowel },
-    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
-  };
-  static rule_list const rules_2[] = {
-    { 201, "ational", "ate",   7,  3,  0, nullptr   },
-    { 202, "tional",  "tion",  6,  4,  0, nullptr   },
-    { 203, "enci",    "ence",  4,  4,  0, nullptr   },
-    { 204, "anci",    "ance",  4,  4,  0, nullptr   },
-    { 205, "izer",    "ize",   4,  3,  0, nullptr   },
-    { 206, "abli",    "able",  4,  4,  0, nullptr   },
-    { 207, "alli",    "al",    4,  2,  0, nullptr   },
-    { 208, "entli",   "ent",   5,  3,  0, nullptr   },
-    { 209, "eli",     "e",     3,  1,  0, nullptr   },
-    { 210, "ousli",   "ous",   5,  3,  0, nullptr   },
-    { 211, "ization", "ize",   7,  3,  0, nullptr   },
-    { 212, "ation",   "ate",   5,  3,  0, nullptr   },
-    { 213, "ator",    "ate",   4,  3,  0, nullptr   },
-    { 214, "alism",   "al",    5,  2,  0, nullptr   },
-    { 215, "iveness", "ive",   7,  3,  0, nullptr   },
-    { 216, "fulnes",  "ful",   6,  3,  0, nullptr   },
-    { 217, "ousness", "ous",   7,  3,  0, nullptr   },
-    { 218, "aliti",   "al",    5,  2,  0, nullptr   },
-    { 219, "iviti",   "ive",   5,  3,  0, nullptr   },
-    { 220, "biliti",  "ble",   6,  3,  0, nullptr   },
-    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
-  };
-  static rule_list const rules_3[] = {
-    { 301, "icate",   "ic",    5,  2,  0, nullptr   },
-    { 302, "ative",   "",      5,  0,  0, nullptr   },
-    { 303, "alize",   "al",    5,  2,  0, nullptr   },
-    { 304, "iciti",   "ic",    5,  2,  0, nullptr   },
-    { 305, "ical",    "ic",    4,  2,  0, nullptr   },
-    { 308, "ful",     "",      3,  0,  0, nullptr   },
-    { 309, "ness",    "",      4,  0,  0, nullptr   },
-    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
-  };
-  static rule_list const rules_4[] = {
-    { 401, "al",      "",      2,  0,  1, nullptr   },
-    { 402, "ance",    "",      4,  0,  1, nullptr   },
-    { 403, "ence",    "",      4,  0,  1, nullptr   },
-    { 405, "er",      "",      2,  0,  1, nullptr   },
-    { 406, "ic",      "",      2,  0,  1, nullptr   },
-    { 407, "able",    "",      4,  0,  1, nullptr   },
-    { 408, "ible",    "",      4,  0,  1, nullptr   },
-    { 409, "ant",     "",      3,  0,  1, nullptr   },
-    { 410, "ement",   "",      5,  0,  1, nullptr   },
-    { 411, "ment",    "",      4,  0,  1, nullptr   },
-    { 412, "ent",     "",      3,  0,  1, nullptr   },
-    { 413, "sion",    "s",     4,  1,  1, nullptr   },
-    { 414, "tion",    "t",     4,  1,  1, nullptr   },
-    { 415, "ou",      "",      2,  0,  1, nullptr   },
-    { 416, "ism",     "",      3,  0,  1, nullptr   },
-    { 417, "ate",     "",      3,  0,  1, nullptr   },
-    { 418, "iti",     "",      3,  0,  1, nullptr   },
-    { 419, "ous",     "",      3,  0,  1, nullptr   },
-    { 420, "ive",     "",      3,  0,  1, nullptr   },
-    { 421, "ize",     "",      3,  0,  1, nullptr   },
-    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
-  };
-  static rule_list const rules_5a[] = {
-    { 501, "e",       "",      1,  0,  1, nullptr   },
-    { 502, "e",       "",      1,  0, -1, remove_e  },
-    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr   }
-  };
-  static rule_list const rules_5b[] = {
-    { 503, "ll",      "l",     2,  1,  1,  nullptr  },
-    { 0,   nullptr,   nullptr, 0,  0,  0, nullptr  }
-  };
+static rule_set const rule_set_1a ( rules_1a  );
+static rule_set const rule_set_1b ( rules_1b  );
+static rule_set const rule_set_1b1( rules_1b1 );
+static rule_set const rule_set_1c ( rules_1c  );
+static rule_set const rule_set_2  ( rules_2   );
+static rule_set const rule_set_3  ( rules_3   );
+static rule_set const rule_set_4  ( rules_4   );
+static rule_set const rule_set_5a ( rules_5a  );
+static rule_set const rule_set_5b ( rules_5b  );
+
+////////// rule_set ///////////////////////////////////////////////////////////
+
+template<size_t N>
+rule_set::rule_set( suffix_rule const (&rules)[N] ) :
+  rules_( rules ), nodes_( 1, node() )
+{
+  static_assert( N <= sizeof( rule_mask ) * CHAR_BIT, "too many rules" );
+  for ( size_t i = 0; i < N; ++i ) {
+    char const *const old_suffix = rules[i].old_suffix;
+    size_t n = 0;
+    for ( char const *c = old_suffix + rules[i].old_suffix_len;
+          c > old_suffix; ) {
+      int const letter = *--c - 'a';
+      if ( !nodes_[ n ].child[ letter ] ) {
+        nodes_[ n ].child[ letter ] =
+          static_cast<unsigned short>( nodes_.size() );
+        nodes_.push_back( node() );
+      }
+      n = nodes_[ n ].child[ letter ];
+    } // for
+    nodes_[ n ].rules |= rule_mask(1) << i;
+  } // for
+}
 
-  ////////// Ensure word is exclusively alphabetic ////////////////////////////
+int rule_set::apply( char *word, char *&word_end ) const {
+# ifdef DEBUG_stem_word
+  cerr << "---> apply( \"" << word << "\" )\n";
+# endif
 
-  size_t const len = ::strlen( word );
-  if ( ::strspn( word, "abcdefghijklmnopqrstuvwxyz" ) < len )
-    return word;
+  //
+  // Walk the trie from the end of the word towards its beginning collecting
+  // all the rules whose old suffix matches.
+  //
+  rule_mask matches = nodes_[0].rules;
+  size_t n = 0;
+  for ( char const *c = word_end; c > word; ) {
+    if ( !(n = nodes_[ n ].child[ *--c - 'a' ]) )
+      break;
+    matches |= nodes_[ n ].rules;
+  } // for
 
-  ////////// Stemming is really slow: look in a private cache /////////////////
+  //
+  // Try the matching rules in the order in which they're listed: the first
+  // whose conditions are met is applied.
+  //
+  for ( size_t i = 0; matches; ++i, matches >>= 1 ) {
+    if ( !(matches & 1) )
+      continue;
+    suffix_rule const &rule = rules_[i];
+    char *const suffix = word_end - rule.old_suffix_len;
 
-  typedef map<char const*,char const*> stem_cache;
-  static stem_cache cache;
-#ifdef WITH_SEARCH_DAEMON
-  static mutex cache_mutex;
-  lock_guard<mutex> const lock( mutex );
-#endif /* WITH_SEARCH_DAEMON */
-  auto const found = cache.find( word );
-  if ( found != cache.end() )
-    return found->second;
+    char const ch = *suffix;            // chop off ...
+    *suffix = '\0';                     // ... the old suffix
+    if ( word_size( word ) > rule.min_stem_size &&
+       ( !rule.condition || (*rule.condition)( word, word_end ) ) ) {
+      ::strcpy( suffix, rule.new_suffix );
+#     ifdef DEBUG_stem_word
+      cerr << "---> replaced word=" << word << "\n";
+#     endif
+      word_end = suffix + rule.new_suffix_len;
+      return rule.id;
+    }
+    *suffix = ch;                       // no match: put back
+  } // for
+  return 0;
+}
 
-  ////////// Stem the word ////////////////////////////////////////////////////
+////////// stem functions /////////////////////////////////////////////////////
 
+/**
+ * Stems the given word in place.
+ *
+ * @param word The word to be stemmed.
+ * @param len The length of \a word.
+ */
+static void stem( char *word, size_t len ) {
 # ifdef DEBUG_stem_word
   cerr << "\n---> stem_word( \"" << word << "\" )\n";
 # endif
 
-  char word_buf[ Word_Hard_Max_Size ];
-  ::strcpy( word_buf, word );
-  word_end = word_buf + len;
-
-  replace_suffix( word_buf, rules_1a );
-  int const rule = replace_suffix( word_buf, rules_1b );
+  char *word_end = word + len;
+  rule_set_1a.apply( word, word_end );
+  int const rule = rule_set_1b.apply( word, word_end );
   if ( rule == 106 || rule == 107 )
-    replace_suffix( word_buf, rules_1b1 );
-  replace_suffix( word_buf, rules_1c );
-  replace_suffix( word_buf, rules_2  );
-  replace_suffix( word_buf, rules_3  );
-  replace_suffix( word_buf, rules_4  );
-  replace_suffix( word_buf, rules_5a );
-  replace_suffix( word_buf, rules_5b );
+    rule_set_1b1.apply( word, word_end );
+  rule_set_1c.apply( word, word_end );
+  rule_set_2 .apply( word, word_end );
+  rule_set_3 .apply( word, word_end );
+  rule_set_4 .apply( word, word_end );
+  rule_set_5a.apply( word, word_end );
+  rule_set_5b.apply( word, word_end );
 
 # ifdef DEBUG_stem_word
-  cerr << "\n---> stemmed word=" << word_buf << "\n";
+  cerr << "\n---> stemmed word=" << word << "\n";
 # endif
+}
+
+char const* porter_stem( char const *word, char *buf ) {
+  size_t const len = ::strlen( word );
+  if ( !is_stemmable( word, len ) )
+    return word;
+  stem( ::strcpy( buf, word ), len );
+  return buf;
+}
+
+////////// stem cache /////////////////////////////////////////////////////////
+
+/**
+ * A %stem_cache_shard is one shard of the cache of stemmed words.  Each word
+ * hashes to exactly one slot so the cache never grows and lookup never has to
+ * probe more than one entry.
+ */
+struct stem_cache_shard {
+  struct entry {
+    char word[ Stem_Buf_Size ];
+    char stem[ Stem_Buf_Size ];
+  };
+#ifdef WITH_SEARCH_DAEMON
+  mutex mutex_;
+#endif /* WITH_SEARCH_DAEMON */
+  entry entries_[ Stem_Cache_Shard_Size ];
+};
 
-  char const *const new_word = new_strdup( word_buf );
-  cache[ new_strdup( word ) ] = new_word;
+static stem_cache_shard stem_cache[ Stem_Cache_Shards ];
+
+#ifdef WITH_SEARCH_DAEMON
+# define STEM_CACHE_LOCK(SHARD) \
+    lock_guard<mutex> const lock( (SHARD).mutex_ )
+#else
+# define STEM_CACHE_LOCK(SHARD) /* nothing */
+#endif /* WITH_SEARCH_DAEMON */
+
+char const* stem_word( char const *word, char *buf ) {
+  size_t const len = ::strlen( word );
+  if ( !is_stemmable( word, len ) )
+    return word;
 
-  return new_word;
+  size_t const hash = PJL::hash_string( word );
+  stem_cache_shard &shard = stem_cache[ hash % Stem_Cache_Shards ];
+  stem_cache_shard::entry &entry =
+    shard.entries_[ hash / Stem_Cache_Shards % Stem_Cache_Shard_Size ];
+
+  { // local scope
+    STEM_CACHE_LOCK( shard );
+    if ( ::strcmp( entry.word, word ) == 0 )
+      return ::strcpy( buf, entry.stem );
+  }
+
+  //
+  // Stem the word without holding the lock and then replace whatever word was
+  // in the entry.
+  //
+  stem( ::strcpy( buf, word ), len );
+  STEM_CACHE_LOCK( shard );
+  ::strcpy( entry.word, word );
+  ::strcpy( entry.stem, buf );
+  return buf;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
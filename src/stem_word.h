@@ -24,12 +24,57 @@
 
 // local
 #include "pjl/less.h"
+#include "swishxx-config.h"
 
 // standard
 #include <cstring>
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * The minimum size of the buffer given to stem_word() and porter_stem().
+ */
+int const Stem_Buf_Size = Word_Hard_Max_Size + 1;
+
+/**
+ * Stems the given word by applying Porter's algorithm: run through several
+ * sets of suffix replacement rules applying at most one per set.  A word is
+ * stemmed only if it is composed entirely of letters and is no longer than
+ * Word_Hard_Max_Size.  The suffixes of each set are matched via a trie of
+ * reversed suffixes so no rule is compared more than once and no memory is
+ * allocated.
+ *
+ * Caveat:
+ *    This algorithm is (obviosuly) geared only for English.
+ *
+ * See also:
+ *    M.F. Porter. "An Algorithm For Suffix Stripping," Program, 14(3), July
+ *    1980, pp. 130-137.
+ *
+ * @param word The word to be stemmed.  It is presumed to have already been
+ * converted to lower case.
+ * @param buf The buffer to put the stemmed word into.  It must be at least
+ * Stem_Buf_Size characters.
+ * @return Returns either \a buf containing the word stemmed or \a word if it
+ * can not be stemmed.
+ */
+char const* porter_stem( char const *word, char *buf );
+
+/**
+ * Stems the given word the same as porter_stem() but first looks in a cache of
+ * previously stemmed words.  The cache is of a fixed size and is split into
+ * shards each having its own lock so concurrent searches in the search daemon
+ * rarely contend.
+ *
+ * @param word The word to be stemmed.  It is presumed to have already been
+ * converted to lower case.
+ * @param buf The buffer to put the stemmed word into.  It must be at least
+ * Stem_Buf_Size characters.
+ * @return Returns either \a buf containing the word stemmed or \a word if it
+ * can not be stemmed.
+ */
+char const* stem_word( char const *word, char *buf );
+
 /**
  * A %less_stem is-a less&lt;char const*&gt; that compares C-style strings but
  * possibly stems (suffix strips) the words before comparison.
@@ -39,11 +84,12 @@ struct less_stem : std::less<char const*> {
 
   result_type operator()( first_argument_type a,
                           second_argument_type b ) const {
-    return std::strcmp( stem_func_( a ), stem_func_( b ) ) < 0;
+    char a_buf[ Stem_Buf_Size ], b_buf[ Stem_Buf_Size ];
+    return std::strcmp( stem_func_( a, a_buf ), stem_func_( b, b_buf ) ) < 0;
   }
 
 private:
-  char const* (*const stem_func_)( char const *word );
+  char const* (*const stem_func_)( char const *word, char *buf );
 
   /**
    * A no-op just to have a function to point to.
@@ -51,25 +97,9 @@ private:
    * @param word The word.
    * @return Returns \a word.
    */
-  static char const* no_stem( char const *word );
-
-  /**
-   * Stems the given word by applying Porter's algorithm: run through several
-   * sets of suffix replacement rules applying at most one per set.  A word
-   * is stemmed only if it is composed entirely of letters.
-   *
-   * Caveat:
-   *    This algorithm is (obviosuly) geared only for English.
-   *
-   * See also:
-   *    M.F. Porter. "An Algorithm For Suffix Stripping," Program, 14(3), July
-   *    1980, pp. 130-137.
-   *
-   * @param word The word to be stemmed.  It is presumed to have already been
-   * converted to lower case.
-   * @return Returns the word stemmed.
-   */
-  static char const* stem_word( char const *word );
+  static char const* no_stem( char const *word, char* ) {
+    return word;
+  }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
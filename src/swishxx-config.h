@@ -187,6 +187,30 @@ int const   ThreadsMax_Default          = 100;
  */
 int const   ThreadTimeout_Default       = 30;   // seconds
 
+/**
+ * The number of threads the search daemon accepts connections on, each with
+ * its own event loop and pool of threads (ThreadsMin and ThreadsMax are then
+ * divided among them); 0 means one per CPU.  This can be overridden either in
+ * a config. file or on the command line.
+ */
+int const   DaemonListeners_Default     = 1;
+
+/**
+ * The number of threads that parts of a single query are evaluated by in
+ * parallel; 0 means none (the query is evaluated only by the thread servicing
+ * it).  This can be overridden either in a config. file or on the command
+ * line.
+ */
+int const   QueryThreads_Default        = 0;
+
+/**
+ * The number of seconds between checks of whether the index file(s) have been
+ * regenerated and so should be reloaded; 0 means to reload only when sent a
+ * SIGHUP.  This can be overridden either in a config. file or on the command
+ * line.
+ */
+int const   ReloadInterval_Default      = 0;    // seconds
+
 /**
  * The user to switch to after initialization (if root to begin with).  This
  * can be overridden either in a config. file or on the command line.
@@ -252,6 +276,55 @@ char const  IndexFile_Default[]         = "swish++.index";
  */
 int const   ResultsMax_Default          = 100;
 
+/**
+ * Default maximum number of words a fuzzy word (word~N) can match; this can be
+ * overridden either in a config. file or on the command line.
+ */
+int const   FuzzyWordsMax_Default       = 50;
+
+/**
+ * The maximum number of edits (insertions, deletions, or substitutions of
+ * characters) a fuzzy word can have: beyond that, a fuzzy word matches far
+ * too many words to be useful and finding them approaches checking every word
+ * in the index.  This parameter is used only in \c query.cpp.
+ */
+int const   Fuzzy_Edits_Max             = 3;
+
+/**
+ * A word that is in at least 1/File_Bitmap_Ratio of the files in an index also
+ * has a bitmap of the files it's in written to the index so search can check
+ * whether a file is among them in O(1).  The bitmap is in addition to the
+ * word's file list, so it makes the index larger in exchange for those O(1)
+ * checks: for N files, the bitmap takes N/7 bytes (7 files per byte) while,
+ * at this density, the delta-encoded file list takes roughly N/8 bytes, so
+ * the bitmap about doubles the size of such a word's entry.  (The more files a
+ * word is in, the smaller its bitmap is relative to its file list.)  This
+ * parameter is used only in \c index.cpp.
+ */
+int const   File_Bitmap_Ratio           = 8;
+
+/**
+ * The maximum number of words a "word*" query may match for the cursor query
+ * evaluator to use a cursor per word.  A query matching more words is
+ * evaluated all at once instead since merging that many cursors costs more
+ * than it saves.  This parameter is used only in \c query_node.cpp.
+ */
+int const   Word_Cursors_Max            = 64;
+
+/**
+ * The number of shards the cache of stemmed words is split into; each shard
+ * has its own lock.  This should be a power of 2.  This parameter is used only
+ * in \c stem_word.cpp.
+ */
+int const   Stem_Cache_Shards           = 16;
+
+/**
+ * The number of words each shard of the cache of stemmed words can hold.  A
+ * word that hashes to an occupied slot simply replaces the word there.  This
+ * should be a power of 2.  This parameter is used only in \c stem_word.cpp.
+ */
+int const   Stem_Cache_Shard_Size       = 256;
+
 /**
  * Characters in a Unix shell command that delimit file names.  Note that this
  * says "file" (not "path") names.
@@ -302,6 +375,21 @@ int const   Title_Max_Size              = 200;
  * command line.
  */
 int const   WordsNear_Default           = 10;
+
+/**
+ * The maximum N of a "near/N": a larger N is taken to be this.  (No document
+ * has words that far apart that are meaningfully "near" each other.)  This
+ * parameter is used only in \c token.cpp.
+ */
+int const   Near_Window_Max             = 1000000;
+
+/**
+ * Default minimum percentage of files both words of an adjacent pair must
+ * occur in for the pair to be indexed as a "bigram"; this can be overridden
+ * either in a config. file or on the command line.  Zero means not to index
+ * bigrams.
+ */
+int const   BigramPercentMin_Default    = 0;
 #endif /* WITH_WORD_POS */
 
 /**
@@ -27,6 +27,7 @@
 #include "word_util.h"
 
 // standard
+#include <algorithm>                    /* for min() */
 #include <cctype>
 #include <cstring>
 
@@ -44,7 +45,12 @@ token_stream& operator>>( token_stream &ts, token &t ) {
     return ts;
   }
   t.type_ = token::tt_none;
+  t.fuzzy_edits_ = 0;
+#ifdef WITH_WORD_POS
+  t.near_window_ = 0;
+#endif /* WITH_WORD_POS */
   bool in_word = false;
+  bool star_word = false;               // word preceded by '*'
   char c;
 
   while ( ts.get( c ) ) {
@@ -61,7 +67,7 @@ token_stream& operator>>( token_stream &ts, token &t ) {
         t.buf_[ t.len_++ ] = c;
         continue;
       }
-      in_word = false;                    // too big: skip chars
+      in_word = star_word = false;        // too big: skip chars
       while ( ts.get( c ) && is_word_char( c ) )
         ;
       continue;
@@ -69,8 +75,26 @@ token_stream& operator>>( token_stream &ts, token &t ) {
 
     if ( in_word ) {
       if ( c == '*' )
-        t.type_ = token::tt_word_star;
-      else
+        t.type_ = star_word ? token::tt_star_word_star : token::tt_word_star;
+      else if ( c == '~' ) {
+        //
+        // Check for "word~N" where N is the maximum number of edits.
+        //
+        t.type_ = token::tt_word_fuzzy;
+        t.fuzzy_edits_ = 1;
+        if ( isdigit( ts.peek() ) ) {
+          t.fuzzy_edits_ = 0;
+          //
+          // Any N larger than the maximum is the same as the maximum, so stop
+          // accumulating digits past it lest N overflow.
+          //
+          while ( ts.get( c ) && isdigit( static_cast<unsigned char>( c ) ) )
+            if ( t.fuzzy_edits_ <= Fuzzy_Edits_Max )
+              t.fuzzy_edits_ = t.fuzzy_edits_ * 10 + c - '0';
+          if ( ts )
+            ts.putback( c );
+        }
+      } else
         ts.putback( c );
       break;
     }
@@ -79,12 +103,18 @@ token_stream& operator>>( token_stream &ts, token &t ) {
       case '(': t.type_ = token::tt_lparen; return ts;
       case ')': t.type_ = token::tt_rparen; return ts;
       case '=': t.type_ = token::tt_equal ; return ts;
+#ifdef WITH_WORD_POS
+      case '"': t.type_ = token::tt_quote ; return ts;
+#endif /* WITH_WORD_POS */
     } // switch
+    star_word = c == '*';
   } // while
 
   if ( in_word ) {
     t.buf_[ t.len_ ] = '\0';
     to_lower( t.lower_buf_, t.buf_ );
+    if ( !t.type_ && star_word )
+      t.type_ = token::tt_star_word;
     if ( t.type_ )
       return ts;
 
@@ -97,8 +127,24 @@ token_stream& operator>>( token_stream &ts, token &t ) {
     else if ( !::strcmp( t.lower_buf_, "or"  ) )
       t.type_ = token::tt_or;
 #ifdef WITH_WORD_POS
-    else if ( !::strcmp( t.lower_buf_, "near" ) )
+    else if ( !::strcmp( t.lower_buf_, "near" ) ) {
       t.type_ = token::tt_near;
+      //
+      // Check for "near/N" where N is the maximum number of words apart.
+      // Any N larger than the maximum is the same as the maximum, so stop
+      // accumulating digits past it lest N overflow.  An N of 0 (or none) is
+      // the same as a plain "near".
+      //
+      if ( ts.peek() == '/' ) {
+        ts.get( c );
+        while ( ts.get( c ) && isdigit( static_cast<unsigned char>( c ) ) )
+          if ( t.near_window_ < Near_Window_Max )
+            t.near_window_ =
+              min( t.near_window_ * 10 + c - '0', Near_Window_Max );
+        if ( ts )
+          ts.putback( c );
+      }
+    }
 #endif /* WITH_WORD_POS */
     else if ( !::strcmp( t.lower_buf_, "not" ) )
       t.type_ = token::tt_not;
@@ -54,8 +54,14 @@ public:
 #endif /* WITH_WORD_POS */
     tt_not,
     tt_or,
+#ifdef WITH_WORD_POS
+    tt_quote,
+#endif /* WITH_WORD_POS */
     tt_rparen,
-    tt_word_star,
+    tt_star_word,                       // *word
+    tt_star_word_star,                  // *word*
+    tt_word_fuzzy,                      // word~N
+    tt_word_star,                       // word*
     tt_word
   };
 
@@ -69,6 +75,23 @@ public:
   char const* str() const               { return buf_; }
   char const* lower_str() const         { return lower_buf_; }
 
+  /**
+   * Gets the N of a "word~N" token.
+   *
+   * @return Returns said N (1 if not given) or 0 if the token isn't a fuzzy
+   * word.
+   */
+  int         fuzzy_edits() const       { return fuzzy_edits_; }
+#ifdef WITH_WORD_POS
+  /**
+   * Gets the N of a "near/N" token.
+   *
+   * @return Returns said N or 0 if the token is either a plain "near" or not
+   * a "near" at all.
+   */
+  int         near_window() const       { return near_window_; }
+#endif /* WITH_WORD_POS */
+
   friend token_stream& operator>>( token_stream&, token& );
 
 private:
@@ -76,6 +99,10 @@ private:
   char buf_[ Word_Hard_Max_Size + 1 ];
   char lower_buf_[ Word_Hard_Max_Size + 1 ];
   int  len_;
+  int  fuzzy_edits_;
+#ifdef WITH_WORD_POS
+  int  near_window_;
+#endif /* WITH_WORD_POS */
 };
 
 /**
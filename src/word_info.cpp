@@ -41,6 +41,23 @@ word_info::file::file( unsigned index ) :
   // do nothing else
 }
 
+void word_info::write_max_rank( ostream &o, unsigned max_rank ) {
+  o << Max_Rank_List_Marker << vlq::encode( max_rank ) << Stop_Marker
+    << assert_stream;
+}
+
+void word_info::write_file_bitmap( ostream &o, vector<bool> const &files ) {
+  o << File_Bitmap_List_Marker << assert_stream;
+  for ( size_t i = 0; i < files.size(); i += File_Bitmap_Bits ) {
+    unsigned char bits = 0;
+    for ( int j = 0; j < File_Bitmap_Bits && i + j < files.size(); ++j )
+      if ( files[ i + j ] )
+        bits |= 1u << j;
+    o << bits << assert_stream;
+  } // for
+  o << Stop_Marker << assert_stream;
+}
+
 void word_info::file::write_meta_ids( ostream &o ) const {
   o << Meta_Name_List_Marker << assert_stream;
   for ( auto meta_id : meta_ids_ )
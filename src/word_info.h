@@ -31,9 +31,7 @@
 #include <map>
 #include <string>
 #include <unordered_set>
-#ifdef WITH_WORD_POS
 #include <vector>
-#endif /* WITH_WORD_POS */
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -54,9 +52,10 @@ public:
     void write_meta_ids( std::ostream& ) const;
 
 #ifdef WITH_WORD_POS
-    typedef short delta_type;
+    typedef unsigned delta_type;
     typedef std::vector<delta_type> pos_delta_list;
     pos_delta_list pos_deltas_;
+    unsigned last_pos_;                 // absolute position of last delta
 
     void add_word_pos( unsigned );
     void write_word_pos( std::ostream& ) const;
@@ -80,6 +79,26 @@ public:
 
   word_info() : occurrences_( 0 ) { }
 
+  /**
+   * Writes the maximum rank of a word over all the files it's in.  This must
+   * be written as part of the first file of the word's entry.
+   *
+   * @param o The ostream to write to.
+   * @param max_rank The maximum rank.
+   */
+  static void write_max_rank( std::ostream &o, unsigned max_rank );
+
+  /**
+   * Writes a bitmap of all the files a word is in.  This must be written as
+   * part of the first file of the word's entry.
+   *
+   * @param o The ostream to write to.
+   * @param files The files, one per file in the index: \c files[i] is \c true
+   * only if the word is in file \a i.
+   */
+  static void write_file_bitmap( std::ostream &o,
+                                 std::vector<bool> const &files );
+
   word_info( word_info const& ) = default;
   word_info& operator=( word_info const& ) = default;
 };
@@ -101,9 +120,9 @@ inline void word_info::file::add_word_pos( unsigned absolute_pos ) {
     // in a variable-length binary representation in the generated index file
     // and smaller integers take less bytes.
     // 
-    delta_type const prev_pos = pos_deltas_.back();
-    pos_deltas_.push_back( absolute_pos - prev_pos );
+    pos_deltas_.push_back( absolute_pos - last_pos_ );
   }
+  last_pos_ = absolute_pos;
 }
 #endif /* WITH_WORD_POS */
 
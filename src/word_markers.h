@@ -47,6 +47,29 @@ unsigned char const Meta_Name_List_Marker = '\x01';
 unsigned char const Word_Pos_List_Marker = '\x02';
 #endif /* WITH_WORD_POS */
 
+/**
+ * This byte marks the beginning of a "list" containing the single maximum rank
+ * of a word over all the files it's in.  It's present only in the first file
+ * of a word entry in an index file.  (Older versions of search simply skip it
+ * as an unknown list.)
+ */
+unsigned char const Max_Rank_List_Marker = '\x03';
+
+/**
+ * This byte marks the beginning of a "list" that is a bitmap of all the files
+ * a word is in: each number is a single byte holding the bits for 7 files
+ * (the least significant bit for the lowest file index).  It's present only in
+ * the first file of a word entry in an index file and only for words that are
+ * in many files.  (Older versions of search simply skip it as an unknown
+ * list.)
+ */
+unsigned char const File_Bitmap_List_Marker = '\x04';
+
+/**
+ * The number of files per byte of a File_Bitmap_List_Marker list.
+ */
+int const File_Bitmap_Bits = 7;
+
 /**
  * This byte marks that a word entry continues (the opposite of the
  * Stop_Marker).
@@ -43,7 +43,7 @@ using namespace std;
 #define SEARCH_RESULTS_PHYS_URI SWISH_PHYS_URI "/" SEARCH_RESULTS
 #define SEARCH_RESULTS_XSD      SEARCH_RESULTS ".xsd"
 
-extern index_segment directories;
+extern thread_local index_segment directories;
 
 ////////// local functions ////////////////////////////////////////////////////
 
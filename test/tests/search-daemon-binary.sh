@@ -0,0 +1,162 @@
+#! /bin/sh
+##
+#	SWISH++
+#	test/tests/search-daemon-binary.sh
+#
+#	Copyright (C) 2026  Paul J. Lucas
+#
+#	This program is free software; you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation; either version 2 of the Licence, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+##
+# Checks a search daemon's binary protocol, for each event loop (-I):
+#
+#   + A request for every result field on a connection kept alive followed by
+#     one for no fields: each response's header (including its length) and
+#     fields must be laid out as documented and match the results of search
+#     itself.
+#
+#   + Malformed requests (a bad version, a query that's too long, and a
+#     malformed query) get a response of only a header with the right status.
+#
+# usage: search-daemon-binary.sh output-file log-file
+##
+
+OUTPUT="$1"
+LOG_FILE="$2"
+SOCKET=/tmp/swishxx_test_socket_$$_
+EVENT_LOOPS="epoll io_uring"
+
+{ search -i text.index year &&
+  search -i text.index -m 1 -r 1 year | sed 's/^\([0-9]*\) .*/\1/'
+  cat <<END
+bad version: status 2 length 0 total 0 results 0
+too long: status 2 length 0 total 0 results 0
+malformed query: status 1 length 0 total 0 results 0
+END
+} > $OUTPUT.expected 2> $LOG_FILE || exit 1
+
+PIDS=
+for IO in $EVENT_LOOPS
+do
+  search -i text.index -b unix -u $SOCKET$IO -B -I $IO 2>> $LOG_FILE &
+  PIDS="$PIDS $!"
+done
+trap "kill $PIDS 2>/dev/null; rm -f $SOCKET* $OUTPUT.expected" EXIT
+
+for IO in $EVENT_LOOPS
+do
+  i=0
+  while [ ! -S $SOCKET$IO ]
+  do
+    [ $i -ge 50 ] && exit 1
+    sleep 0.1; i=`expr $i + 1`
+  done
+done
+
+for IO in $EVENT_LOOPS
+do
+  perl -MSocket -e '
+    use strict;
+
+    sub request {                       # version flags skip max query
+      my( $version, $flags, $skip, $max, $query ) = @_;
+      return pack( "C C n N N n n", 0xFE, $version, $flags, $skip, $max,
+                   0xFFFF, length( $query ) ) . $query;
+    }
+
+    sub open_search {
+      socket( my $s, PF_UNIX, SOCK_STREAM, 0 ) || die "socket: $!\n";
+      connect( $s, sockaddr_un( $ARGV[0] ) ) || die "connect: $!\n";
+      select( ( select( $s ), $| = 1 )[0] );
+      return $s;
+    }
+
+    ##
+    # Reads a response and checks its header.  Returns the status, length,
+    # total, number of results, and the results themselves.
+    ##
+    sub response {
+      my $s = shift;
+      read( $s, my $header, 16 ) == 16 || die "short header\n";
+      my( $magic, $version, $status, $zero, $length, $total, $n ) =
+        unpack( "C C C C N N N", $header );
+      die "bad magic\n" unless $magic == 0xFE;
+      die "bad version\n" unless $version == 1;
+      die "bad padding\n" unless $zero == 0;
+      my $results = "";
+      read( $s, $results, $length ) == $length || die "short results\n"
+        if $length;
+      return ( $status, $length, $total, $n, $results );
+    }
+
+    sub string {                        # a length-prefixed string
+      my $r = shift;
+      my $n = unpack( "n", substr( $$r, 0, 2, "" ) );
+      return substr( $$r, 0, $n, "" );
+    }
+
+    my $s = open_search();
+    print $s request( 1, 0x0F, 0, 0xFFFFFFFF, "year" ),
+             request( 1, 0x00, 1, 1, "year" );
+
+    ##
+    # Every field: print the results as search would.
+    ##
+    my( $status, $length, $total, $n, $r ) = response( $s );
+    die "status $status\n" if $status;
+    print "# results: $total\n";
+    for ( 1 .. $n ) {
+      my( $file, $index, $rank ) = unpack( "N n n", substr( $r, 0, 8, "" ) );
+      die "bad index $index\n" if $index;
+      my $path = string( \$r );
+      my( $hi, $lo ) = unpack( "N N", substr( $r, 0, 8, "" ) );
+      my $title = string( \$r );
+      print "$rank $path ", $hi * 2**32 + $lo, " $title\n";
+    }
+    die "extra bytes\n" if length( $r );
+
+    ##
+    # No fields: 8 bytes per result.
+    ##
+    ( $status, $length, $total, $n, $r ) = response( $s );
+    die "status $status\n" if $status;
+    die "bad length $length\n" unless $length == 8 * $n;
+    print "# results: $total\n";
+    for ( 1 .. $n ) {
+      my( $file, $index, $rank ) = unpack( "N n n", substr( $r, 0, 8, "" ) );
+      print "$rank\n";
+    }
+    die "not closed\n" if defined( getc( $s ) );
+
+    ##
+    # Malformed requests.
+    ##
+    for ( [ "bad version", request( 2, 0, 0, 10, "year" ) ],
+          [ "too long", request( 1, 0, 0, 10, "year " x 400 ) ],
+          [ "malformed query", request( 1, 0, 0, 10, "year and (" ) ] ) {
+      my( $name, $request ) = @$_;
+      $s = open_search();
+      print $s $request;
+      ( $status, $length, $total, $n ) = response( $s );
+      print "$name: status $status length $length total $total results $n\n";
+    }
+  ' $SOCKET$IO > $OUTPUT 2>> $LOG_FILE || {
+    echo "$IO: binary requests failed" >> $LOG_FILE
+    exit 1
+  }
+  diff $OUTPUT.expected $OUTPUT >> $LOG_FILE || exit 1
+done
+
+# vim:set noet sw=8 ts=8:
@@ -0,0 +1,127 @@
+#! /bin/sh
+##
+#	SWISH++
+#	test/tests/search-daemon-http.sh
+#
+#	Copyright (C) 2026  Paul J. Lucas
+#
+#	This program is free software; you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation; either version 2 of the Licence, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+##
+# Checks a search daemon's HTTP requests (-h), for each event loop (-I): a
+# GET with a URL-encoded query, a HEAD, a bad path, a bad method, a bad max,
+# and a pair of pipelined requests on a connection kept alive.
+#
+# usage: search-daemon-http.sh output-file log-file
+##
+
+OUTPUT="$1"
+LOG_FILE="$2"
+SOCKET=/tmp/swishxx_test_socket_$$_
+EVENT_LOOPS="epoll io_uring"
+
+##
+# Prints the response (without CRs) that a daemon must send for a GET (or a
+# HEAD) of the results of search for the given arguments, closing the
+# connection or not.
+##
+ok() {
+  method=$1 connection=$2; shift 2
+  search -i text.index -F json "$@" > $OUTPUT.json || exit 1
+  echo 'HTTP/1.1 200 OK'
+  echo 'Content-Type: application/json'
+  echo "Content-Length: `wc -c < $OUTPUT.json | tr -d ' '`"
+  [ $connection = close ] && echo 'Connection: close'
+  echo
+  [ $method = GET ] && cat $OUTPUT.json
+}
+
+##
+# Prints the response (without CRs) that a daemon must send for an error.
+##
+error() {
+  echo "HTTP/1.1 $1"
+  echo 'Content-Type: application/json'
+  echo "Content-Length: `echo \"$2\" | wc -c | tr -d ' '`"
+  echo 'Connection: close'
+  [ "$3" ] && echo "$3"
+  echo
+  echo "$2"
+}
+
+{ ok GET close -m 2 'year or abominable'; echo --
+  ok HEAD close year; echo --
+  error '404 Not Found' '{ "error": "not found" }'; echo --
+  error '405 Method Not Allowed' '{ "error": "method not allowed" }' \
+    'Allow: GET, HEAD'; echo --
+  error '400 Bad Request' '{ "error": "bad max" }'; echo --
+  ok GET keep-alive -m 1 year
+  ok GET close -r 2 year; echo --
+} > $OUTPUT.expected 2> $LOG_FILE || exit 1
+rm -f $OUTPUT.json
+
+PIDS=
+for IO in $EVENT_LOOPS
+do
+  search -i text.index -b unix -u $SOCKET$IO -B -I $IO -h 2>> $LOG_FILE &
+  PIDS="$PIDS $!"
+done
+trap "kill $PIDS 2>/dev/null; rm -f $SOCKET* $OUTPUT.expected" EXIT
+
+for IO in $EVENT_LOOPS
+do
+  i=0
+  while [ ! -S $SOCKET$IO ]
+  do
+    [ $i -ge 50 ] && exit 1
+    sleep 0.1; i=`expr $i + 1`
+  done
+done
+
+for IO in $EVENT_LOOPS
+do
+  ##
+  # Send each request (or pair of requests) on its own connection and print
+  # the response(s) up to the connection being closed, without CRs.
+  ##
+  perl -MSocket -e '
+    for my $request (
+          "GET /search?q=year+or+%61bominable&max=2 HTTP/1.1\r\n" .
+            "Host: localhost\r\nConnection: close\r\n\r\n",
+          "HEAD /search?q=year HTTP/1.0\r\n\r\n",
+          "GET /nowhere?q=year HTTP/1.0\r\n\r\n",
+          "POST /search?q=year HTTP/1.0\r\n\r\n",
+          "GET /search?q=year&max=x HTTP/1.0\r\n\r\n",
+          "GET /search?q=year&max=1 HTTP/1.1\r\n\r\n" .
+            "GET /search?skip=2&q=year HTTP/1.1\r\nConnection: close\r\n\r\n" ) {
+      socket( SEARCH, PF_UNIX, SOCK_STREAM, 0 ) || die "socket: $!\n";
+      connect( SEARCH, sockaddr_un( $ARGV[0] ) ) || die "connect: $!\n";
+      select( ( select( SEARCH ), $| = 1 )[0] );
+      print SEARCH $request || die "write: $!\n";
+      while ( <SEARCH> ) {
+        s/\r//g;
+        print;
+      }
+      print "--\n";
+      close( SEARCH );
+    }
+  ' $SOCKET$IO > $OUTPUT 2>> $LOG_FILE || {
+    echo "$IO: HTTP requests failed" >> $LOG_FILE
+    exit 1
+  }
+  diff $OUTPUT.expected $OUTPUT >> $LOG_FILE || exit 1
+done
+
+# vim:set noet sw=8 ts=8:
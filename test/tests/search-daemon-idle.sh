@@ -0,0 +1,75 @@
+#! /bin/sh
+##
+#	SWISH++
+#	test/tests/search-daemon-idle.sh
+#
+#	Copyright (C) 2026  Paul J. Lucas
+#
+#	This program is free software; you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation; either version 2 of the Licence, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+##
+# Checks that a search daemon that has been idle for longer than the socket
+# timeout still serves the next request rather than timing it out at once,
+# for each event loop (-I).
+#
+# usage: search-daemon-idle.sh output-file log-file
+##
+
+OUTPUT="$1"
+LOG_FILE="$2"
+SOCKET=/tmp/swishxx_test_socket_$$_
+EVENT_LOOPS="epoll io_uring"
+
+search -i text.index year > $OUTPUT.expected 2> $LOG_FILE || exit 1
+
+PIDS=
+for IO in $EVENT_LOOPS
+do
+  search -i text.index -b unix -u $SOCKET$IO -B -I $IO -o 2 2>> $LOG_FILE &
+  PIDS="$PIDS $!"
+done
+trap "kill $PIDS 2>/dev/null; rm -f $SOCKET* $OUTPUT.expected" EXIT
+
+##
+# Wait for the daemons to start, then stay idle for longer than the socket
+# timeout (plus the second of slack a daemon gives it).
+##
+for IO in $EVENT_LOOPS
+do
+  i=0
+  while [ ! -S $SOCKET$IO ]
+  do
+    [ $i -ge 50 ] && exit 1
+    sleep 0.1; i=`expr $i + 1`
+  done
+done
+sleep 4
+
+for IO in $EVENT_LOOPS
+do
+  perl -MSocket -e '
+    socket( SEARCH, PF_UNIX, SOCK_STREAM, 0 ) || die "socket: $!\n";
+    connect( SEARCH, sockaddr_un( $ARGV[0] ) ) || die "connect: $!\n";
+    select( ( select( SEARCH ), $| = 1 )[0] );
+    print SEARCH "search year\n" || die "write: $!\n";
+    print while <SEARCH>;
+  ' $SOCKET$IO > $OUTPUT 2>> $LOG_FILE || {
+    echo "$IO: request failed after being idle" >> $LOG_FILE
+    exit 1
+  }
+  diff $OUTPUT.expected $OUTPUT >> $LOG_FILE || exit 1
+done
+
+# vim:set noet sw=8 ts=8:
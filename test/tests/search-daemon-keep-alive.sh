@@ -0,0 +1,86 @@
+#! /bin/sh
+##
+#	SWISH++
+#	test/tests/search-daemon-keep-alive.sh
+#
+#	Copyright (C) 2026  Paul J. Lucas
+#
+#	This program is free software; you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation; either version 2 of the Licence, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+##
+# Checks that a search daemon services requests pipelined on a connection
+# kept alive (-k): the results of each such request are preceded by their
+# length and the connection is closed only after a request without -k, for
+# each event loop (-I).
+#
+# usage: search-daemon-keep-alive.sh output-file log-file
+##
+
+OUTPUT="$1"
+LOG_FILE="$2"
+SOCKET=/tmp/swishxx_test_socket_$$_
+EVENT_LOOPS="epoll io_uring"
+
+{ search -i text.index year &&
+  search -i text.index -m 1 -r 1 year &&
+  search -i text.index -m 2 year
+} > $OUTPUT.expected 2> $LOG_FILE || exit 1
+
+PIDS=
+for IO in $EVENT_LOOPS
+do
+  search -i text.index -b unix -u $SOCKET$IO -B -I $IO 2>> $LOG_FILE &
+  PIDS="$PIDS $!"
+done
+trap "kill $PIDS 2>/dev/null; rm -f $SOCKET* $OUTPUT.expected" EXIT
+
+for IO in $EVENT_LOOPS
+do
+  i=0
+  while [ ! -S $SOCKET$IO ]
+  do
+    [ $i -ge 50 ] && exit 1
+    sleep 0.1; i=`expr $i + 1`
+  done
+done
+
+for IO in $EVENT_LOOPS
+do
+  ##
+  # Send all the requests at once, then read each length-prefixed result
+  # (that must be exactly that long) and finally the results of the last
+  # request up to the connection being closed.
+  ##
+  perl -MSocket -e '
+    socket( SEARCH, PF_UNIX, SOCK_STREAM, 0 ) || die "socket: $!\n";
+    connect( SEARCH, sockaddr_un( $ARGV[0] ) ) || die "connect: $!\n";
+    select( ( select( SEARCH ), $| = 1 )[0] );
+    print SEARCH "search -k year\nsearch --keep-alive -m 1 -r 1 year\n" .
+                 "search -m 2 year\n" || die "write: $!\n";
+    for ( 1 .. 2 ) {
+      my $length = <SEARCH>;
+      $length =~ /^(\d+)\n$/ || die "bad length: $length\n";
+      read( SEARCH, my $results, $1 ) == $1 || die "short results\n";
+      print $results;
+    }
+    print while <SEARCH>;
+  ' $SOCKET$IO > $OUTPUT 2>> $LOG_FILE || {
+    echo "$IO: pipelined requests failed" >> $LOG_FILE
+    exit 1
+  }
+  diff $OUTPUT.expected $OUTPUT >> $LOG_FILE || exit 1
+done
+
+# vim:set noet sw=8 ts=8:
@@ -0,0 +1,108 @@
+#! /bin/sh
+##
+#	SWISH++
+#	test/tests/search-daemon-listeners.sh
+#
+#	Copyright (C) 2026  Paul J. Lucas
+#
+#	This program is free software; you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation; either version 2 of the Licence, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+##
+# Checks that a search daemon with two listeners (-A 2) pinned to CPUs (-C)
+# services concurrent requests on both its Unix domain and TCP sockets, for
+# each event loop (-I).
+#
+# usage: search-daemon-listeners.sh output-file log-file
+##
+
+OUTPUT="$1"
+LOG_FILE="$2"
+SOCKET=/tmp/swishxx_test_socket_$$_
+PORT=`expr 20000 + $$ % 10000 \* 2`
+EVENT_LOOPS="epoll io_uring"
+REQUESTS=16
+
+: > $OUTPUT.expected
+i=0
+while [ $i -lt $REQUESTS ]
+do
+  search -i text.index -m 1 -r `expr $i % 3` year >> $OUTPUT.expected \
+    2> $LOG_FILE || exit 1
+  i=`expr $i + 1`
+done
+
+PIDS=
+for IO in $EVENT_LOOPS
+do
+  search -i text.index -b both -u $SOCKET$IO -a 127.0.0.1:$PORT -A 2 -C -B \
+    -I $IO 2>> $LOG_FILE &
+  PIDS="$PIDS $!"
+  eval PORT_$IO=$PORT
+  PORT=`expr $PORT + 1`
+done
+trap "kill $PIDS 2>/dev/null; rm -f $SOCKET* $OUTPUT.expected" EXIT
+
+for IO in $EVENT_LOOPS
+do
+  i=0
+  while [ ! -S $SOCKET$IO ]
+  do
+    [ $i -ge 50 ] && exit 1
+    sleep 0.1; i=`expr $i + 1`
+  done
+done
+
+for IO in $EVENT_LOOPS
+do
+  ##
+  # Open all the connections on a socket before sending any request so they
+  # are spread among the listeners, then read each response in turn.
+  ##
+  for FAMILY in unix tcp
+  do
+    eval PORT=\$PORT_$IO
+    perl -MSocket -e '
+      my( $family, $socket, $port, $requests ) = @ARGV;
+      my @s;
+      for ( 1 .. $requests ) {
+        my $s;
+        if ( $family eq "unix" ) {
+          socket( $s, PF_UNIX, SOCK_STREAM, 0 ) || die "socket: $!\n";
+          connect( $s, sockaddr_un( $socket ) ) || die "connect: $!\n";
+        } else {
+          socket( $s, PF_INET, SOCK_STREAM, getprotobyname( "tcp" ) )
+            || die "socket: $!\n";
+          connect( $s, sockaddr_in( $port, inet_aton( "127.0.0.1" ) ) )
+            || die "connect: $!\n";
+        }
+        select( ( select( $s ), $| = 1 )[0] );
+        push( @s, $s );
+      }
+      for ( 0 .. $#s ) {
+        my $s = $s[$_];
+        print $s "search -m 1 -r ", $_ % 3, " year\n" || die "write: $!\n";
+      }
+      for my $s ( @s ) {
+        print while <$s>;
+      }
+    ' $FAMILY $SOCKET$IO $PORT $REQUESTS > $OUTPUT 2>> $LOG_FILE || {
+      echo "$IO: $FAMILY requests failed" >> $LOG_FILE
+      exit 1
+    }
+    diff $OUTPUT.expected $OUTPUT >> $LOG_FILE || exit 1
+  done
+done
+
+# vim:set noet sw=8 ts=8: